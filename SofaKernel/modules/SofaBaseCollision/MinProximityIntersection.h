@@ -52,6 +52,9 @@ public:
 
     void init() override;
 
+    /// The mesh intersectors registered in the factory (MeshMinProximityIntersection) read the free positions
+    bool useFreePosition() const override { return true; }
+
     bool getUseSurfaceNormals();
 
     void draw(const core::visual::VisualParams* vparams) override;
@@ -0,0 +1,312 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaBaseMechanics/BarycentricMappers/BarycentricMapperElementGrid.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace sofa::component::mapping::_barycentricmapperelementgrid_
+{
+
+using sofa::core::topology::BaseMeshTopology;
+
+/// Tolerance used by the mappers on the normal coordinate of the surface elements
+static constexpr double s_surfaceTolerance = 0.01;
+/// Maximum number of cells per element
+static constexpr double s_maxCellsPerElement = 8;
+/// Smallest determinant of an invertible matrix, as in defaulttype::invertMatrix
+static constexpr double s_minDeterminant = 1.0e-100;
+
+void ElementGrid::clear()
+{
+    m_minBBox.clear();
+    m_maxBBox.clear();
+    m_centers.clear();
+    m_boxCellBegin.clear();
+    m_boxCellElements.clear();
+    m_centerCellBegin.clear();
+    m_centerCellElements.clear();
+    m_size = Vec3i(0,0,0);
+}
+
+void ElementGrid::build(const helper::vector<Vector3>& minBBox, const helper::vector<Vector3>& maxBBox,
+                        const helper::vector<Vector3>& centers, SReal cellSize)
+{
+    clear();
+    if (centers.empty())
+        return;
+
+    m_minBBox = minBBox;
+    m_maxBBox = maxBBox;
+    m_centers = centers;
+    const std::size_t nbElements = centers.size();
+
+    // Grid extent and average size of the bounding boxes
+    Vector3 gridMin = centers[0];
+    Vector3 gridMax = centers[0];
+    SReal averageSize = 0;
+    std::size_t nbBoxes = 0;
+    for (std::size_t e = 0; e < nbElements; ++e)
+    {
+        const bool isEmpty = minBBox[e][0] > maxBBox[e][0] || minBBox[e][1] > maxBBox[e][1] || minBBox[e][2] > maxBBox[e][2];
+        for (int k = 0; k < 3; ++k)
+        {
+            gridMin[k] = std::min(gridMin[k], centers[e][k]);
+            gridMax[k] = std::max(gridMax[k], centers[e][k]);
+            if (!isEmpty)
+            {
+                gridMin[k] = std::min(gridMin[k], minBBox[e][k]);
+                gridMax[k] = std::max(gridMax[k], maxBBox[e][k]);
+            }
+        }
+        if (!isEmpty)
+        {
+            const Vector3 size = maxBBox[e] - minBBox[e];
+            averageSize += std::max(size[0], std::max(size[1], size[2]));
+            ++nbBoxes;
+        }
+    }
+
+    const Vector3 extent = gridMax - gridMin;
+    const SReal maxExtent = std::max(extent[0], std::max(extent[1], extent[2]));
+    if (!(cellSize > 0) && nbBoxes > 0)
+        cellSize = averageSize / SReal(nbBoxes);
+    if (!(cellSize > 0))
+        cellSize = maxExtent / std::cbrt(SReal(nbElements));
+    if (!(cellSize > 0))
+        cellSize = 1;
+
+    // Keep the number of cells proportional to the number of elements
+    const double maxNbCells = s_maxCellsPerElement * double(nbElements) + 1;
+    while (true)
+    {
+        double nbCells = 1;
+        for (int k = 0; k < 3; ++k)
+            nbCells *= std::floor(extent[k] / cellSize) + 1;
+        if (nbCells <= maxNbCells)
+            break;
+        cellSize *= std::max(1.1, std::cbrt(nbCells / maxNbCells));
+    }
+
+    m_origin = gridMin;
+    m_cellSize = cellSize;
+    m_invCellSize = 1 / cellSize;
+    for (int k = 0; k < 3; ++k)
+        m_size[k] = int(std::floor(extent[k] * m_invCellSize)) + 1;
+    const std::size_t nbCells = std::size_t(m_size[0]) * std::size_t(m_size[1]) * std::size_t(m_size[2]);
+
+    // Compressed rows of the elements overlapping each cell, filled in increasing order of the elements
+    const auto forEachOverlappedCell = [&](std::size_t e, auto f)
+    {
+        if (minBBox[e][0] > maxBBox[e][0] || minBBox[e][1] > maxBBox[e][1] || minBBox[e][2] > maxBBox[e][2])
+            return;
+        const Vec3i cellMin = getCellCoordinates(minBBox[e]);
+        const Vec3i cellMax = getCellCoordinates(maxBBox[e]);
+        for (int k = cellMin[2]; k <= cellMax[2]; ++k)
+            for (int j = cellMin[1]; j <= cellMax[1]; ++j)
+                for (int i = cellMin[0]; i <= cellMax[0]; ++i)
+                    f(getCellIndex(Vec3i(i,j,k)));
+    };
+
+    m_boxCellBegin.assign(nbCells + 1, 0);
+    for (std::size_t e = 0; e < nbElements; ++e)
+        forEachOverlappedCell(e, [&](std::size_t cell) { ++m_boxCellBegin[cell+1]; });
+    for (std::size_t cell = 0; cell < nbCells; ++cell)
+        m_boxCellBegin[cell+1] += m_boxCellBegin[cell];
+    m_boxCellElements.resize(m_boxCellBegin[nbCells]);
+    helper::vector<Index> fill(m_boxCellBegin.begin(), m_boxCellBegin.end() - 1);
+    for (std::size_t e = 0; e < nbElements; ++e)
+        forEachOverlappedCell(e, [&](std::size_t cell) { m_boxCellElements[fill[cell]++] = Index(e); });
+
+    // Compressed rows of the elements whose center is in each cell
+    m_centerCellBegin.assign(nbCells + 1, 0);
+    for (std::size_t e = 0; e < nbElements; ++e)
+        ++m_centerCellBegin[getCellIndex(getCellCoordinates(centers[e])) + 1];
+    for (std::size_t cell = 0; cell < nbCells; ++cell)
+        m_centerCellBegin[cell+1] += m_centerCellBegin[cell];
+    m_centerCellElements.resize(nbElements);
+    fill.assign(m_centerCellBegin.begin(), m_centerCellBegin.end() - 1);
+    for (std::size_t e = 0; e < nbElements; ++e)
+        m_centerCellElements[fill[getCellIndex(getCellCoordinates(centers[e]))]++] = Index(e);
+}
+
+Vec3i ElementGrid::getCellCoordinates(const Vector3& pos) const
+{
+    Vec3i cell;
+    for (int k = 0; k < 3; ++k)
+    {
+        const SReal x = std::floor((pos[k] - m_origin[k]) * m_invCellSize);
+        cell[k] = x <= 0 ? 0 : (x >= SReal(m_size[k] - 1) ? m_size[k] - 1 : int(x));
+    }
+    return cell;
+}
+
+ElementGrid::Index ElementGrid::findNearestCenter(const Vector3& pos) const
+{
+    Index nearest = sofa::InvalidID;
+    if (m_centers.empty())
+        return nearest;
+
+    double nearestDistance = std::numeric_limits<double>::max();
+    const auto checkCell = [&](int i, int j, int k)
+    {
+        const std::size_t cell = getCellIndex(Vec3i(i,j,k));
+        for (Index c = m_centerCellBegin[cell]; c < m_centerCellBegin[cell+1]; ++c)
+        {
+            const Index e = m_centerCellElements[c];
+            const double d = (pos - m_centers[e]).norm2();
+            if (d < nearestDistance || (d == nearestDistance && e < nearest))
+            {
+                nearest = e;
+                nearestDistance = d;
+            }
+        }
+    };
+
+    const Vec3i start = getCellCoordinates(pos);
+    const int maxRing = std::max(m_size[0], std::max(m_size[1], m_size[2]));
+    for (int ring = 0; ring < maxRing; ++ring)
+    {
+        Vec3i ringMin, ringMax;
+        for (int k = 0; k < 3; ++k)
+        {
+            ringMin[k] = std::max(start[k] - ring, 0);
+            ringMax[k] = std::min(start[k] + ring, m_size[k] - 1);
+        }
+
+        // Visit the cells at distance ring (in number of cells) from the start cell
+        for (int k = ringMin[2]; k <= ringMax[2]; ++k)
+        {
+            const bool kOnRing = std::abs(k - start[2]) == ring;
+            for (int j = ringMin[1]; j <= ringMax[1]; ++j)
+            {
+                const bool jkOnRing = kOnRing || std::abs(j - start[1]) == ring;
+                if (jkOnRing)
+                {
+                    for (int i = ringMin[0]; i <= ringMax[0]; ++i)
+                        checkCell(i, j, k);
+                }
+                else
+                {
+                    if (start[0] - ring >= 0)
+                        checkCell(start[0] - ring, j, k);
+                    if (ring > 0 && start[0] + ring < m_size[0])
+                        checkCell(start[0] + ring, j, k);
+                }
+            }
+        }
+
+        // Lower bound of the distance to the centers in the cells not visited yet
+        double bound = std::numeric_limits<double>::max();
+        bool isComplete = true;
+        for (int k = 0; k < 3; ++k)
+        {
+            if (ringMin[k] > 0)
+            {
+                isComplete = false;
+                bound = std::min(bound, std::max(0.0, double(pos[k] - (m_origin[k] + ringMin[k] * m_cellSize))));
+            }
+            if (ringMax[k] < m_size[k] - 1)
+            {
+                isComplete = false;
+                bound = std::min(bound, std::max(0.0, double(m_origin[k] + (ringMax[k] + 1) * m_cellSize - pos[k])));
+            }
+        }
+        if (isComplete || (nearest != sofa::InvalidID && bound * bound > nearestDistance))
+            break;
+    }
+    return nearest;
+}
+
+void ElementGrid::computeBoundingBox(Vector3& minBBox, Vector3& maxBBox, const Vector3& origin, const Mat3x3d& base,
+                                     const helper::vector<Vector3>& barycentricCorners)
+{
+    // Degenerated elements cannot contain any point
+    Mat3x3d frame;
+    if (barycentricCorners.empty() || std::abs(defaulttype::determinant(base)) <= s_minDeterminant || !frame.invert(base))
+    {
+        minBBox = Vector3(1,1,1);
+        maxBBox = Vector3(-1,-1,-1);
+        return;
+    }
+
+    minBBox = maxBBox = origin + frame * barycentricCorners[0];
+    for (const Vector3& corner : barycentricCorners)
+    {
+        const Vector3 p = origin + frame * corner;
+        for (int k = 0; k < 3; ++k)
+        {
+            minBBox[k] = std::min(minBBox[k], p[k]);
+            maxBBox[k] = std::max(maxBBox[k], p[k]);
+        }
+    }
+
+    // Enlarge the box to be robust to the rounding errors of the barycentric coordinates
+    const Vector3 size = maxBBox - minBBox;
+    const SReal epsilon = 1e-8 * std::max(size[0], std::max(size[1], size[2]));
+    minBBox -= Vector3(epsilon, epsilon, epsilon);
+    maxBBox += Vector3(epsilon, epsilon, epsilon);
+}
+
+template<>
+const helper::vector<Vector3>& ElementGrid::getBarycentricCorners<BaseMeshTopology::Edge>()
+{
+    static const helper::vector<Vector3> corners { {0,0,0}, {1,0,0} };
+    return corners;
+}
+
+template<>
+const helper::vector<Vector3>& ElementGrid::getBarycentricCorners<BaseMeshTopology::Triangle>()
+{
+    static const helper::vector<Vector3> corners {
+        {0,0,-s_surfaceTolerance}, {1,0,-s_surfaceTolerance}, {0,1,-s_surfaceTolerance},
+        {0,0, s_surfaceTolerance}, {1,0, s_surfaceTolerance}, {0,1, s_surfaceTolerance} };
+    return corners;
+}
+
+template<>
+const helper::vector<Vector3>& ElementGrid::getBarycentricCorners<BaseMeshTopology::Quad>()
+{
+    static const helper::vector<Vector3> corners {
+        {0,0,-s_surfaceTolerance}, {1,0,-s_surfaceTolerance}, {0,1,-s_surfaceTolerance}, {1,1,-s_surfaceTolerance},
+        {0,0, s_surfaceTolerance}, {1,0, s_surfaceTolerance}, {0,1, s_surfaceTolerance}, {1,1, s_surfaceTolerance} };
+    return corners;
+}
+
+template<>
+const helper::vector<Vector3>& ElementGrid::getBarycentricCorners<BaseMeshTopology::Tetrahedron>()
+{
+    static const helper::vector<Vector3> corners { {0,0,0}, {1,0,0}, {0,1,0}, {0,0,1} };
+    return corners;
+}
+
+template<>
+const helper::vector<Vector3>& ElementGrid::getBarycentricCorners<BaseMeshTopology::Hexahedron>()
+{
+    static const helper::vector<Vector3> corners {
+        {0,0,0}, {1,0,0}, {0,1,0}, {1,1,0},
+        {0,0,1}, {1,0,1}, {0,1,1}, {1,1,1} };
+    return corners;
+}
+
+} // namespace sofa::component::mapping::_barycentricmapperelementgrid_
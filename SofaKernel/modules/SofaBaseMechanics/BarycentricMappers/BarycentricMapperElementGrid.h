@@ -0,0 +1,159 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_COMPONENT_MAPPING_BARYCENTRICMAPPERELEMENTGRID_H
+#define SOFA_COMPONENT_MAPPING_BARYCENTRICMAPPERELEMENTGRID_H
+#include <SofaBaseMechanics/config.h>
+
+#include <sofa/core/topology/BaseMeshTopology.h>
+#include <sofa/defaulttype/Mat.h>
+#include <sofa/defaulttype/Vec.h>
+#include <sofa/helper/vector.h>
+
+namespace sofa::component::mapping
+{
+
+namespace _barycentricmapperelementgrid_
+{
+
+using sofa::defaulttype::Mat3x3d;
+using sofa::defaulttype::Vector3;
+using sofa::defaulttype::Vec3i;
+
+/// Uniform grid indexing the elements of a mesh, used by the barycentric mappers to find the element
+/// in which each point is mapped without testing all the elements.
+///
+/// Each element is registered in the cells overlapped by the bounding box of the region where its
+/// barycentric coordinates are considered valid, which contains its center. A point can then only be
+/// inside the elements registered in its cell, and the element with the nearest center is found by
+/// visiting the cells in rings of increasing size around the point.
+class SOFA_BASE_MECHANICS_API ElementGrid
+{
+public:
+    using Index = sofa::Index;
+
+    /// Build the grid from the bounding box and the center of each element.
+    /// An element with an empty bounding box (min > max) is only found through its center.
+    /// If cellSize is not positive, the average size of the bounding boxes is used.
+    /// The cell size is increased if needed to keep the number of cells proportional to the number of elements.
+    void build(const helper::vector<Vector3>& minBBox, const helper::vector<Vector3>& maxBBox,
+               const helper::vector<Vector3>& centers, SReal cellSize = 0);
+
+    void clear();
+
+    std::size_t getNbElements() const { return m_centers.size(); }
+    SReal getCellSize() const { return m_cellSize; }
+
+    /// Call f(e) for each element e whose bounding box contains pos, in increasing order of e.
+    template<class F>
+    void forEachCandidate(const Vector3& pos, const F& f) const
+    {
+        if (m_centers.empty())
+            return;
+
+        const std::size_t cell = getCellIndex(getCellCoordinates(pos));
+        for (Index i = m_boxCellBegin[cell]; i < m_boxCellBegin[cell+1]; ++i)
+        {
+            const Index e = m_boxCellElements[i];
+            const Vector3& minBBox = m_minBBox[e];
+            const Vector3& maxBBox = m_maxBBox[e];
+            if (pos[0] >= minBBox[0] && pos[0] <= maxBBox[0]
+                    && pos[1] >= minBBox[1] && pos[1] <= maxBBox[1]
+                    && pos[2] >= minBBox[2] && pos[2] <= maxBBox[2])
+                f(e);
+        }
+    }
+
+    /// Element whose center is the nearest to pos (the smallest index in case of tie), InvalidID if there is no element.
+    Index findNearestCenter(const Vector3& pos) const;
+
+    /// Find the element in which pos is mapped, with the same result as an exhaustive search:
+    /// among the elements containing pos (distance(e) <= 0), the one with the smallest distance,
+    /// otherwise the element whose center is the nearest.
+    /// distance(e) is only evaluated for the elements whose bounding box contains pos.
+    template<class DistanceFunction>
+    Index findElement(const Vector3& pos, const DistanceFunction& distance) const
+    {
+        Index element = sofa::InvalidID;
+        double elementDistance = 0;
+        forEachCandidate(pos, [&](Index e)
+        {
+            const double d = distance(e);
+            if (d <= 0 && (element == sofa::InvalidID || d < elementDistance))
+            {
+                element = e;
+                elementDistance = d;
+            }
+        });
+
+        if (element == sofa::InvalidID)
+            element = findNearestCenter(pos);
+        return element;
+    }
+
+    /// Bounding box of the points origin + base^-1 * v, for v in the convex hull of the given barycentric coordinates.
+    /// base is the matrix giving the barycentric coordinates of a point relative to origin, as computed by the mappers.
+    /// The box is empty if base cannot be inverted.
+    static void computeBoundingBox(Vector3& minBBox, Vector3& maxBBox, const Vector3& origin, const Mat3x3d& base,
+                                   const helper::vector<Vector3>& barycentricCorners);
+
+    /// Corners of the region of the barycentric coordinates where a point is inside an element of the given type,
+    /// including the tolerance the mappers use on the normal coordinate of surface elements.
+    template<class Element>
+    static const helper::vector<Vector3>& getBarycentricCorners();
+
+protected:
+    Vec3i getCellCoordinates(const Vector3& pos) const;
+    std::size_t getCellIndex(const Vec3i& cell) const
+    {
+        return std::size_t(cell[0]) + std::size_t(m_size[0]) * (std::size_t(cell[1]) + std::size_t(m_size[1]) * std::size_t(cell[2]));
+    }
+
+    Vector3 m_origin;
+    SReal m_cellSize {1};
+    SReal m_invCellSize {1};
+    Vec3i m_size;
+
+    helper::vector<Vector3> m_minBBox;
+    helper::vector<Vector3> m_maxBBox;
+    helper::vector<Vector3> m_centers;
+
+    /// Elements overlapping each cell, in compressed rows: m_boxCellElements[m_boxCellBegin[c] .. m_boxCellBegin[c+1][
+    helper::vector<Index> m_boxCellBegin;
+    helper::vector<Index> m_boxCellElements;
+    /// Elements whose center is in each cell, in compressed rows
+    helper::vector<Index> m_centerCellBegin;
+    helper::vector<Index> m_centerCellElements;
+};
+
+template<> const helper::vector<Vector3>& ElementGrid::getBarycentricCorners<core::topology::BaseMeshTopology::Edge>();
+template<> const helper::vector<Vector3>& ElementGrid::getBarycentricCorners<core::topology::BaseMeshTopology::Triangle>();
+template<> const helper::vector<Vector3>& ElementGrid::getBarycentricCorners<core::topology::BaseMeshTopology::Quad>();
+template<> const helper::vector<Vector3>& ElementGrid::getBarycentricCorners<core::topology::BaseMeshTopology::Tetrahedron>();
+template<> const helper::vector<Vector3>& ElementGrid::getBarycentricCorners<core::topology::BaseMeshTopology::Hexahedron>();
+
+} // namespace _barycentricmapperelementgrid_
+
+using _barycentricmapperelementgrid_::ElementGrid;
+
+} // namespace sofa::component::mapping
+
+#endif
@@ -64,6 +64,7 @@ public:
     typedef typename MatrixType::Index MatrixTypeIndex;
 
     typedef typename Inherit1::ForceMask ForceMask;
+    typedef typename Inherit1::WeightMatrix WeightMatrix;
 
     using Index = sofa::Index;
 
@@ -103,6 +104,8 @@ protected:
 
     void addMatrixContrib(MatrixType* m, int row, int col, Real value);
 
+    bool computeWeightMatrix(WeightMatrix& weights) override;
+
     sofa::helper::vector< MappingData1D >  m_map1d;
     sofa::helper::vector< MappingData2D >  m_map2d;
     sofa::helper::vector< MappingData3D >  m_map3d;
@@ -23,7 +23,9 @@
 #define SOFA_COMPONENT_MAPPING_BARYCENTRICMAPPERMESHTOPOLOGY_INL
 
 #include "BarycentricMapperMeshTopology.h"
+#include <SofaBaseMechanics/BarycentricMappers/BarycentricMapperElementGrid.h>
 #include <sofa/core/visual/VisualParams.h>
+#include <sofa/simulation/ParallelForEach.h>
 
 namespace sofa
 {
@@ -41,6 +43,9 @@ using sofa::defaulttype::Vector3;
 using sofa::defaulttype::Matrix3;
 using sofa::defaulttype::Mat3x3d;
 using sofa::defaulttype::Vec3d;
+
+/// Minimum number of points located by each task during the initialization
+static constexpr std::size_t s_meshPointLocationGrainSize = 256;
 typedef typename sofa::core::topology::BaseMeshTopology::Edge Edge;
 typedef typename sofa::core::topology::BaseMeshTopology::Triangle Triangle;
 typedef typename sofa::core::topology::BaseMeshTopology::Quad Quad;
@@ -151,30 +156,52 @@ void BarycentricMapperMeshTopology<In,Out>::init ( const typename Out::VecCoord&
                 bases[nbTriangles+q].invert ( mt );
                 centers[nbTriangles+q] = ( in[quads[q][0]]+in[quads[q][1]]+in[quads[q][2]]+in[quads[q][3]] ) *0.25;
             }
-            for ( std::size_t i=0; i<out.size(); i++ )
+            // Index the elements in a uniform grid, then locate the points concurrently
+            // with the same result as testing all the elements
+            const auto computeDistance = [&](std::size_t e, const Vector3& outPos, Vector3& v)
             {
-                Vector3 outPos = Out::getCPos(out[i]);
-                Vector3 coefs;
-                Index index = sofa::InvalidID;
-                double distance = 1e10;
-                for ( std::size_t t = 0; t < triangles.size(); t++ )
+                double d;
+                if ( e < nbTriangles )
+                {
+                    v = bases[e] * ( outPos - in[triangles[e][0]] );
+                    d = std::max ( std::max ( -v[0],-v[1] ),std::max ( ( v[2]<0?-v[2]:v[2] )-0.01,v[0]+v[1]-1 ) );
+                }
+                else
                 {
-                    Vec3d v = bases[t] * ( outPos - in[triangles[t][0]] );
-                    double d = std::max ( std::max ( -v[0],-v[1] ),std::max ( ( v[2]<0?-v[2]:v[2] )-0.01,v[0]+v[1]-1 ) );
-                    if ( d>0 ) d = ( outPos-centers[t] ).norm2();
-                    if ( d<distance ) { coefs = v; distance = d; index = (t); }
+                    v = bases[e] * ( outPos - in[quads[e-nbTriangles][0]] );
+                    d = std::max ( std::max ( -v[0],-v[1] ),std::max ( std::max ( v[1]-1,v[0]-1 ),std::max ( v[2]-0.01,-v[2]-0.01 ) ) );
                 }
-                for ( std::size_t q = 0; q < quads.size(); q++ )
+                return d;
+            };
+
+            helper::vector<Vector3> minBBox ( triangles.size() +quads.size() );
+            helper::vector<Vector3> maxBBox ( triangles.size() +quads.size() );
+            for ( std::size_t t = 0; t < triangles.size(); t++ )
+                ElementGrid::computeBoundingBox ( minBBox[t], maxBBox[t], in[triangles[t][0]], bases[t], ElementGrid::getBarycentricCorners<core::topology::BaseMeshTopology::Triangle>() );
+            for ( std::size_t q = 0; q < quads.size(); q++ )
+                ElementGrid::computeBoundingBox ( minBBox[nbTriangles+q], maxBBox[nbTriangles+q], in[quads[q][0]], bases[nbTriangles+q], ElementGrid::getBarycentricCorners<core::topology::BaseMeshTopology::Quad>() );
+            ElementGrid elementGrid;
+            elementGrid.build ( minBBox, maxBBox, centers );
+
+            helper::vector<Index> indices ( out.size() );
+            helper::vector<Vector3> coefs ( out.size() );
+            simulation::parallelForEachRange(this->m_taskScheduler, 0, out.size(), [&](std::size_t begin, std::size_t end)
+            {
+                for ( std::size_t i=begin; i<end; i++ )
                 {
-                    Vec3d v = bases[nbTriangles+q] * ( outPos - in[quads[q][0]] );
-                    double d = std::max ( std::max ( -v[0],-v[1] ),std::max ( std::max ( v[1]-1,v[0]-1 ),std::max ( v[2]-0.01,-v[2]-0.01 ) ) );
-                    if ( d>0 ) d = ( outPos-centers[nbTriangles+q] ).norm2();
-                    if ( d<distance ) { coefs = v; distance = d; index = nbTriangles+q; }
+                    Vector3 outPos = Out::getCPos(out[i]);
+                    Vector3 v;
+                    indices[i] = elementGrid.findElement ( outPos, [&](Index e) { return computeDistance ( e, outPos, v ); } );
+                    computeDistance ( indices[i], outPos, coefs[i] );
                 }
-                if ( index < (nbTriangles) )
-                    addPointInTriangle ( index, coefs.ptr() );
+            }, s_meshPointLocationGrainSize);
+
+            for ( std::size_t i=0; i<out.size(); i++ )
+            {
+                if ( indices[i] < (nbTriangles) )
+                    addPointInTriangle ( indices[i], coefs[i].ptr() );
                 else
-                    addPointInQuad ( index-nbTriangles, coefs.ptr() );
+                    addPointInQuad ( indices[i]-nbTriangles, coefs[i].ptr() );
             }
         }
     }
@@ -204,30 +231,52 @@ void BarycentricMapperMeshTopology<In,Out>::init ( const typename Out::VecCoord&
             bases[nbTetras+h].invert ( mt );
             centers[nbTetras+h] = ( in[hexas[h][0]]+in[hexas[h][1]]+in[hexas[h][2]]+in[hexas[h][3]]+in[hexas[h][4]]+in[hexas[h][5]]+in[hexas[h][6]]+in[hexas[h][7]] ) *0.125;
         }
-        for ( std::size_t i=0; i<out.size(); i++ )
+        // Index the elements in a uniform grid, then locate the points concurrently
+        // with the same result as testing all the elements
+        const auto computeDistance = [&](std::size_t e, const Vector3& pos, Vector3& v)
         {
-            Vector3 pos = Out::getCPos(out[i]);
-            Vector3 coefs;
-            Index index = sofa::InvalidID;
-            double distance = 1e10;
-            for ( std::size_t t = 0; t < tetras.size(); t++ )
+            double d;
+            if ( e < nbTetras )
+            {
+                v = bases[e] * ( pos - in[tetras[e][0]] );
+                d = std::max ( std::max ( -v[0],-v[1] ),std::max ( -v[2],v[0]+v[1]+v[2]-1 ) );
+            }
+            else
             {
-                Vector3 v = bases[t] * ( pos - in[tetras[t][0]] );
-                double d = std::max ( std::max ( -v[0],-v[1] ),std::max ( -v[2],v[0]+v[1]+v[2]-1 ) );
-                if ( d>0 ) d = ( pos-centers[t] ).norm2();
-                if ( d<distance ) { coefs = v; distance = d; index = (t); }
+                v = bases[e] * ( pos - in[hexas[e-nbTetras][0]] );
+                d = std::max ( std::max ( -v[0],-v[1] ),std::max ( std::max ( -v[2],v[0]-1 ),std::max ( v[1]-1,v[2]-1 ) ) );
             }
-            for ( std::size_t h = 0; h < hexas.size(); h++ )
+            return d;
+        };
+
+        helper::vector<Vector3> minBBox ( tetras.size() + hexas.size() );
+        helper::vector<Vector3> maxBBox ( tetras.size() + hexas.size() );
+        for ( std::size_t t = 0; t < tetras.size(); t++ )
+            ElementGrid::computeBoundingBox ( minBBox[t], maxBBox[t], in[tetras[t][0]], bases[t], ElementGrid::getBarycentricCorners<core::topology::BaseMeshTopology::Tetrahedron>() );
+        for ( std::size_t h = 0; h < hexas.size(); h++ )
+            ElementGrid::computeBoundingBox ( minBBox[nbTetras+h], maxBBox[nbTetras+h], in[hexas[h][0]], bases[nbTetras+h], ElementGrid::getBarycentricCorners<core::topology::BaseMeshTopology::Hexahedron>() );
+        ElementGrid elementGrid;
+        elementGrid.build ( minBBox, maxBBox, centers );
+
+        helper::vector<Index> indices ( out.size() );
+        helper::vector<Vector3> coefs ( out.size() );
+        simulation::parallelForEachRange(this->m_taskScheduler, 0, out.size(), [&](std::size_t begin, std::size_t end)
+        {
+            for ( std::size_t i=begin; i<end; i++ )
             {
-                Vector3 v = bases[nbTetras+h] * ( pos - in[hexas[h][0]] );
-                double d = std::max ( std::max ( -v[0],-v[1] ),std::max ( std::max ( -v[2],v[0]-1 ),std::max ( v[1]-1,v[2]-1 ) ) );
-                if ( d>0 ) d = ( pos-centers[nbTetras+h] ).norm2();
-                if ( d<distance ) { coefs = v; distance = d; index = (nbTetras+h); }
+                Vector3 pos = Out::getCPos(out[i]);
+                Vector3 v;
+                indices[i] = elementGrid.findElement ( pos, [&](Index e) { return computeDistance ( e, pos, v ); } );
+                computeDistance ( indices[i], pos, coefs[i] );
             }
-            if ( index < (nbTetras) )
-                addPointInTetra ( index, coefs.ptr() );
+        }, s_meshPointLocationGrainSize);
+
+        for ( std::size_t i=0; i<out.size(); i++ )
+        {
+            if ( indices[i] < (nbTetras) )
+                addPointInTetra ( indices[i], coefs[i].ptr() );
             else
-                addPointInCube ( index-nbTetras, coefs.ptr() );
+                addPointInCube ( indices[i]-nbTetras, coefs[i].ptr() );
         }
     }
 }
@@ -237,6 +286,7 @@ template <class In, class Out>
 void BarycentricMapperMeshTopology<In,Out>::clearMap1dAndReserve ( std::size_t size )
 {
     m_updateJ = true;
+    this->invalidateWeightMatrix();
     m_map1d.clear();
     if ( size>0 ) m_map1d.reserve ( size );
 }
@@ -246,6 +296,7 @@ template <class In, class Out>
 void BarycentricMapperMeshTopology<In,Out>::clearMap2dAndReserve ( std::size_t size )
 {
     m_updateJ = true;
+    this->invalidateWeightMatrix();
     m_map2d.clear();
     if ( size>0 ) m_map2d.reserve ( size );
 }
@@ -255,6 +306,7 @@ template <class In, class Out>
 void BarycentricMapperMeshTopology<In,Out>::clearMap3dAndReserve ( std::size_t size )
 {
     m_updateJ = true;
+    this->invalidateWeightMatrix();
     m_map3d.clear();
     if ( size>0 ) m_map3d.reserve ( size );
 }
@@ -459,6 +511,12 @@ BarycentricMapperMeshTopology<In,Out>::createPointInQuad ( const typename Out::C
 template <class In, class Out>
 void BarycentricMapperMeshTopology<In,Out>::applyJT ( typename In::MatrixDeriv& out, const typename Out::MatrixDeriv& in )
 {
+    if (this->updateWeightMatrix(m_map1d.size() + m_map2d.size() + m_map3d.size()))
+    {
+        this->applyJTWithWeightMatrix(out, in);
+        return;
+    }
+
     const SeqLines& lines = this->m_fromTopology->getLines();
     const SeqTriangles& triangles = this->m_fromTopology->getTriangles();
     const SeqQuads& quads = this->m_fromTopology->getQuads();
@@ -806,6 +864,12 @@ const sofa::defaulttype::BaseMatrix* BarycentricMapperMeshTopology<In,Out>::getJ
 template <class In, class Out>
 void BarycentricMapperMeshTopology<In,Out>::applyJT ( typename In::VecDeriv& out, const typename Out::VecDeriv& in )
 {
+    if (this->updateWeightMatrix(m_map1d.size() + m_map2d.size() + m_map3d.size()))
+    {
+        this->applyJTWithWeightMatrix(out, in);
+        return;
+    }
+
     const SeqLines& lines = this->m_fromTopology->getLines();
     const SeqTriangles& triangles = this->m_fromTopology->getTriangles();
     const SeqQuads& quads = this->m_fromTopology->getQuads();
@@ -926,6 +990,12 @@ void BarycentricMapperMeshTopology<In,Out>::applyJT ( typename In::VecDeriv& out
 template <class In, class Out>
 void BarycentricMapperMeshTopology<In,Out>::applyJ ( typename Out::VecDeriv& out, const typename In::VecDeriv& in )
 {
+    if (this->updateWeightMatrix(m_map1d.size() + m_map2d.size() + m_map3d.size()))
+    {
+        this->applyJWithWeightMatrix(out, in);
+        return;
+    }
+
     out.resize( m_map1d.size() +m_map2d.size() +m_map3d.size() );
 
     const SeqLines& lines = this->m_fromTopology->getLines();
@@ -1029,6 +1099,12 @@ void BarycentricMapperMeshTopology<In,Out>::resize( core::State<Out>* toModel )
 template <class In, class Out>
 void BarycentricMapperMeshTopology<In,Out>::apply ( typename Out::VecCoord& out, const typename In::VecCoord& in )
 {
+    if (this->updateWeightMatrix(m_map1d.size() + m_map2d.size() + m_map3d.size()))
+    {
+        this->applyWithWeightMatrix(out, in);
+        return;
+    }
+
     out.resize( m_map1d.size() +m_map2d.size() +m_map3d.size() );
 
     const SeqLines& lines = this->m_fromTopology->getLines();
@@ -1114,11 +1190,85 @@ void BarycentricMapperMeshTopology<In,Out>::apply ( typename Out::VecCoord& out,
     }
 }
 
+template <class In, class Out>
+bool BarycentricMapperMeshTopology<In,Out>::computeWeightMatrix(WeightMatrix& weights)
+{
+    const SeqLines& lines = this->m_fromTopology->getLines();
+    const SeqTriangles& triangles = this->m_fromTopology->getTriangles();
+    const SeqQuads& quads = this->m_fromTopology->getQuads();
+    const SeqTetrahedra& tetrahedra = this->m_fromTopology->getTetrahedra();
+    const SeqHexahedra& cubes = this->m_fromTopology->getHexahedra();
+
+    // same weights, in the same order, as in apply
+    for ( const MappingData1D& data : m_map1d )
+    {
+        const Real fx = data.baryCoords[0];
+        const Edge& line = lines[data.in_index];
+        weights.addWeight(line[0], ( 1-fx ));
+        weights.addWeight(line[1], fx);
+        weights.endRow();
+    }
+
+    for ( const MappingData2D& data : m_map2d )
+    {
+        const Real fx = data.baryCoords[0];
+        const Real fy = data.baryCoords[1];
+        const Index index = data.in_index;
+        if ( index<triangles.size() )
+        {
+            const Triangle& triangle = triangles[index];
+            weights.addWeight(triangle[0], ( 1-fx-fy ));
+            weights.addWeight(triangle[1], fx);
+            weights.addWeight(triangle[2], fy);
+        }
+        else if (quads.size())
+        {
+            const Quad& quad = quads[index-triangles.size()];
+            weights.addWeight(quad[0], ( ( 1-fx ) * ( 1-fy ) ));
+            weights.addWeight(quad[1], ( ( fx ) * ( 1-fy ) ));
+            weights.addWeight(quad[3], ( ( 1-fx ) * ( fy ) ));
+            weights.addWeight(quad[2], ( ( fx ) * ( fy ) ));
+        }
+        weights.endRow();
+    }
+
+    for ( const MappingData3D& data : m_map3d )
+    {
+        const Real fx = data.baryCoords[0];
+        const Real fy = data.baryCoords[1];
+        const Real fz = data.baryCoords[2];
+        const Index index = data.in_index;
+        if ( index<tetrahedra.size() )
+        {
+            const Tetra& tetra = tetrahedra[index];
+            weights.addWeight(tetra[0], ( 1-fx-fy-fz ));
+            weights.addWeight(tetra[1], fx);
+            weights.addWeight(tetra[2], fy);
+            weights.addWeight(tetra[3], fz);
+        }
+        else
+        {
+            const Hexa& cube = cubes[index-tetrahedra.size()];
+            weights.addWeight(cube[0], ( ( 1-fx ) * ( 1-fy ) * ( 1-fz ) ));
+            weights.addWeight(cube[1], ( ( fx ) * ( 1-fy ) * ( 1-fz ) ));
+            weights.addWeight(cube[3], ( ( 1-fx ) * ( fy ) * ( 1-fz ) ));
+            weights.addWeight(cube[2], ( ( fx ) * ( fy ) * ( 1-fz ) ));
+            weights.addWeight(cube[4], ( ( 1-fx ) * ( 1-fy ) * ( fz ) ));
+            weights.addWeight(cube[5], ( ( fx ) * ( 1-fy ) * ( fz ) ));
+            weights.addWeight(cube[7], ( ( 1-fx ) * ( fy ) * ( fz ) ));
+            weights.addWeight(cube[6], ( ( fx ) * ( fy ) * ( fz ) ));
+        }
+        weights.endRow();
+    }
+    return true;
+}
+
 template <class In, class Out>
 std::istream& operator >> ( std::istream& in, BarycentricMapperMeshTopology<In, Out> &b )
 {
     std::size_t size_vec;
     in >> size_vec;
+    b.invalidateWeightMatrix();
     b.m_map1d.clear();
     typename BarycentricMapperMeshTopology<In, Out>::MappingData1D value1d;
     for (std::size_t i=0; i<size_vec; i++)
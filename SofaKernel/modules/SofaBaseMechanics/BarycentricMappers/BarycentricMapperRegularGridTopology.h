@@ -56,6 +56,7 @@ public:
     typedef typename Inherit1::MatrixType MatrixType;
     typedef typename MatrixType::Index MatrixTypeIndex;
     typedef typename Inherit1::ForceMask ForceMask;
+    typedef typename Inherit1::WeightMatrix WeightMatrix;
 
     using Index = sofa::Index;
 
@@ -67,7 +68,7 @@ public:
     void clear(std::size_t reserve=0) override;
     void resize( core::State<Out>* toModel ) override;
     virtual bool isEmpty() {return this->m_map.size() == 0;}
-    virtual void setTopology(topology::RegularGridTopology* _topology) {this->m_fromTopology = _topology;}
+    virtual void setTopology(topology::RegularGridTopology* _topology) {this->m_fromTopology = _topology; this->invalidateWeightMatrix();}
     RegularGridTopology *getTopology() {return dynamic_cast<topology::RegularGridTopology *>(this->m_fromTopology);}
     Index addPointInCube(const Index cubeIndex, const SReal* baryCoords) override;
 
@@ -89,6 +90,8 @@ protected:
                                          PointSetTopologyContainer* toTopology);
     void addMatrixContrib(MatrixType* m, int row, int col, Real value);
 
+    bool computeWeightMatrix(WeightMatrix& weights) override;
+
     helper::vector<CubeData> m_map;
     RegularGridTopology* m_fromTopology   {nullptr};
     MatrixType* m_matrixJ                 {nullptr};
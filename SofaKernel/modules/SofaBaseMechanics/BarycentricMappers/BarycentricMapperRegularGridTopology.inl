@@ -57,6 +57,7 @@ template <class In, class Out>
 void BarycentricMapperRegularGridTopology<In,Out>::clear ( std::size_t size )
 {
     m_updateJ = true;
+    this->invalidateWeightMatrix();
     m_map.clear();
     if ( size>0 ) m_map.reserve ( size );
 }
@@ -107,6 +108,12 @@ void BarycentricMapperRegularGridTopology<In,Out>::resize( core::State<Out>* toM
 template <class In, class Out>
 void BarycentricMapperRegularGridTopology<In,Out>::apply ( typename Out::VecCoord& out, const typename In::VecCoord& in )
 {
+    if (this->updateWeightMatrix(m_map.size()))
+    {
+        this->applyWithWeightMatrix(out, in);
+        return;
+    }
+
     out.resize( m_map.size() );
 
     for ( unsigned int i=0; i<m_map.size(); i++ )
@@ -131,6 +138,12 @@ void BarycentricMapperRegularGridTopology<In,Out>::apply ( typename Out::VecCoor
 template <class In, class Out>
 void BarycentricMapperRegularGridTopology<In,Out>::applyJ ( typename Out::VecDeriv& out, const typename In::VecDeriv& in )
 {
+    if (this->updateWeightMatrix(m_map.size()))
+    {
+        this->applyJWithWeightMatrix(out, in);
+        return;
+    }
+
     out.resize( m_map.size() );
 
     for( size_t index=0 ; index<this->maskTo->size() ; ++index)
@@ -156,6 +169,12 @@ void BarycentricMapperRegularGridTopology<In,Out>::applyJ ( typename Out::VecDer
 template <class In, class Out>
 void BarycentricMapperRegularGridTopology<In,Out>::applyJT ( typename In::VecDeriv& out, const typename Out::VecDeriv& in )
 {
+    if (this->updateWeightMatrix(m_map.size()))
+    {
+        this->applyJTWithWeightMatrix(out, in);
+        return;
+    }
+
     ForceMask& mask = *this->maskFrom;
 
     for( size_t index=0 ; index<this->maskTo->size() ; ++index)
@@ -233,6 +252,33 @@ const sofa::defaulttype::BaseMatrix* BarycentricMapperRegularGridTopology<In,Out
 
 
 
+template <class In, class Out>
+bool BarycentricMapperRegularGridTopology<In,Out>::computeWeightMatrix(WeightMatrix& weights)
+{
+    weights.columns.reserve(m_map.size() * 8);
+    weights.values.reserve(m_map.size() * 8);
+
+    // same weights, in the same order, as in apply
+    for ( const CubeData& data : m_map )
+    {
+        const topology::RegularGridTopology::Hexa cube = this->m_fromTopology->getHexaCopy ( data.in_index );
+
+        const Real fx = data.baryCoords[0];
+        const Real fy = data.baryCoords[1];
+        const Real fz = data.baryCoords[2];
+        weights.addWeight(cube[0], ( ( 1-fx ) * ( 1-fy ) * ( 1-fz ) ));
+        weights.addWeight(cube[1], ( ( fx ) * ( 1-fy ) * ( 1-fz ) ));
+        weights.addWeight(cube[3], ( ( 1-fx ) * ( fy ) * ( 1-fz ) ));
+        weights.addWeight(cube[2], ( ( fx ) * ( fy ) * ( 1-fz ) ));
+        weights.addWeight(cube[4], ( ( 1-fx ) * ( 1-fy ) * ( fz ) ));
+        weights.addWeight(cube[5], ( ( fx ) * ( 1-fy ) * ( fz ) ));
+        weights.addWeight(cube[7], ( ( 1-fx ) * ( fy ) * ( fz ) ));
+        weights.addWeight(cube[6], ( ( fx ) * ( fy ) * ( fz ) ));
+        weights.endRow();
+    }
+    return true;
+}
+
 template <class In, class Out>
 void BarycentricMapperRegularGridTopology<In,Out>::draw  (const core::visual::VisualParams* vparams,
                                                           const typename Out::VecCoord& out,
@@ -283,6 +329,12 @@ void BarycentricMapperRegularGridTopology<In,Out>::addMatrixContrib(MatrixType*
 template <class In, class Out>
 void BarycentricMapperRegularGridTopology<In,Out>::applyJT ( typename In::MatrixDeriv& out, const typename Out::MatrixDeriv& in )
 {
+    if (this->updateWeightMatrix(m_map.size()))
+    {
+        this->applyJTWithWeightMatrix(out, in);
+        return;
+    }
+
     typename Out::MatrixDeriv::RowConstIterator rowItEnd = in.end();
 
     for (typename Out::MatrixDeriv::RowConstIterator rowIt = in.begin(); rowIt != rowItEnd; ++rowIt)
@@ -328,6 +380,7 @@ template<class In, class Out>
 std::istream& operator >> ( std::istream& in, BarycentricMapperRegularGridTopology<In, Out> &b )
 {
     in >> b.m_map;
+    b.invalidateWeightMatrix();
     return in;
 }
 
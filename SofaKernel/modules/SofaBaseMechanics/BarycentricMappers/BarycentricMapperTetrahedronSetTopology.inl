@@ -23,6 +23,7 @@
 #define SOFA_COMPONENT_MAPPING_BARYCENTRICMAPPERTETRAHEDRONSETTOPOLOGY_INL
 
 #include "BarycentricMapperTetrahedronSetTopology.h"
+#include <sofa/simulation/ParallelForEach.h>
 
 namespace sofa::component::mapping
 {
@@ -130,12 +131,17 @@ void BarycentricMapperTetrahedronSetTopology<In, Out>::processTopologicalChanges
             const core::topology::PointsAdded * pa = static_cast<const core::topology::PointsAdded*>(*changeIt);
             auto& array = pa->getElementArray();
 
-            for (unsigned i = 0; i<array.size(); i++) {
-                unsigned pid = array[i];
-                processAddPoint(Out::getCPos(out[pid]),
-                    in,
-                    vectorData[pid]);
-            }
+            // Index the elements at their current positions, then locate the added points concurrently
+            this->initHashing(in);
+            simulation::parallelForEachRange(this->m_taskScheduler, 0, array.size(), [&](std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i<end; i++) {
+                    unsigned pid = array[i];
+                    processAddPoint(Out::getCPos(out[pid]),
+                        in,
+                        vectorData[pid]);
+                }
+            });
 
             break;
         }
@@ -169,28 +175,9 @@ void BarycentricMapperTetrahedronSetTopology<In, Out>::processAddPoint(const sof
 {
     const sofa::helper::vector<core::topology::BaseMeshTopology::Tetrahedron>& tetrahedra = this->m_fromTopology->getTetrahedra();
 
-    sofa::defaulttype::Vector3 coefs;
-    int index = -1;
-    double distance = std::numeric_limits<double>::max();
-    for (unsigned int t = 0; t < tetrahedra.size(); t++)
-    {
-        sofa::defaulttype::Mat3x3d base;
-        sofa::defaulttype::Vector3 center;
-        computeBase(base, in, tetrahedra[t]);
-        computeCenter(center, in, tetrahedra[t]);
-
-        sofa::defaulttype::Vec3d v = base * (pos - in[tetrahedra[t][0]]);
-        double d = std::max(std::max(-v[0], -v[1]), std::max(-v[2], v[0] + v[1] + v[2] - 1));
-
-        if (d>0) d = (pos - center).norm2();
-
-        if (d<distance)
-        {
-            coefs = v;
-            distance = d;
-            index = t;
-        }
-    }
+    const typename Inherit1::NearestParams nearestParams = this->findNearestElement(pos, in, tetrahedra);
+    const sofa::defaulttype::Vector3& coefs = nearestParams.baryCoords;
+    const int index = nearestParams.elementId == std::numeric_limits<unsigned int>::max() ? -1 : int(nearestParams.elementId);
 
     vectorData.in_index = index;
     vectorData.baryCoords[0] = (Real)coefs[0];
@@ -24,7 +24,7 @@
 
 #include <SofaBaseTopology/TopologyData.inl>
 #include <SofaBaseMechanics/BarycentricMappers/TopologyBarycentricMapper.h>
-#include <unordered_map>
+#include <SofaBaseMechanics/BarycentricMappers/BarycentricMapperElementGrid.h>
 
 namespace sofa
 {
@@ -66,6 +66,7 @@ public:
     typedef typename Inherit1::MatrixType MatrixType;
 
     typedef typename Inherit1::ForceMask ForceMask;
+    typedef typename Inherit1::WeightMatrix WeightMatrix;
     typedef typename MatrixType::Index MatrixTypeIndex;
     enum { NIn = Inherit1::NIn };
     enum { NOut = Inherit1::NOut };
@@ -95,37 +96,6 @@ public:
 
 protected:
 
-    struct Key
-    {
-        Key(const int& xId, const int& yId, const int& zId)
-        {
-            this->xId=xId;
-            this->yId=yId;
-            this->zId=zId;
-        }
-
-        int xId,yId,zId; // cell indices
-    };
-
-    struct HashFunction
-    {
-        size_t operator()(const Key &key) const
-        {
-            // We use the large prime numbers proposed in paper:
-            // M.Teschner et al "Optimized Spatial Hashing for Collision Detection of Deformable Objects" (2003)
-            int h = (73856093*key.xId^19349663*key.yId^83492791*key.zId);
-            return size_t(h);
-        }
-    };
-
-    struct HashEqual
-    {
-        bool operator()(const Key &key1, const Key &key2) const
-        {
-            return ((key1.xId==key2.xId) && (key1.yId==key2.yId) && (key1.zId==key2.zId));
-        }
-    };
-
     struct NearestParams
     {
         NearestParams()
@@ -148,11 +118,10 @@ protected:
     helper::vector<Mat3x3d> m_bases;
     helper::vector<Vector3> m_centers;
 
-    // Spacial hashing utils
+    // Spatial index utils
     Real m_gridCellSize;
     Real m_convFactor;
-    std::unordered_map<Key, helper::vector<unsigned int>, HashFunction, HashEqual> m_hashTable;
-    std::size_t m_hashTableSize;
+    ElementGrid m_elementGrid;
 
 
     BarycentricMapperTopologyContainer(core::topology::BaseMeshTopology* fromTopology, topology::PointSetTopologyContainer* toTopology);
@@ -166,6 +135,8 @@ protected:
     virtual void addPointInElement(const Index elementIndex, const SReal* baryCoords)=0;
     virtual void computeDistance(double& d, const Vector3& v)=0;
 
+    bool computeWeightMatrix(WeightMatrix& weights) override;
+
     /// Compute the distance between outPos and the element e. If this distance is smaller than the previously stored one,
     /// update nearestParams.
     /// \param e id of the element
@@ -182,12 +153,14 @@ protected:
     /// \param in is the vector of points
     void computeBasesAndCenters( const typename In::VecCoord& in );
 
-    // Spacial hashing following paper:
-    // M.Teschner et al "Optimized Spatial Hashing for Collision Detection of Deformable Objects" (2003)
-    defaulttype::Vec3i getGridIndices(const Vector3& pos);
+    /// Find the nearest element of outPos and its barycentric coordinates, using the element grid
+    /// (initHashing must have been called). This method does not modify the mapper and can be called concurrently.
+    NearestParams findNearestElement(const Vector3& outPos, const typename In::VecCoord& in, const helper::vector<Element>& elements);
+
+    // Spatial indexing of the elements in a uniform grid (see ElementGrid), whose cell size is the average edge length
     void initHashing(const typename In::VecCoord& in);
     void computeHashingCellSize(const typename In::VecCoord& in);
-    void computeHashTable(const typename In::VecCoord& in);
+    void computeElementGrid(const typename In::VecCoord& in);
 
 };
 
@@ -24,6 +24,7 @@
 #include <sofa/core/visual/VisualParams.h>
 
 #include "BarycentricMapperTopologyContainer.h"
+#include <sofa/simulation/ParallelForEach.h>
 
 namespace sofa
 {
@@ -38,9 +39,11 @@ namespace _barycentricmappertopologycontainer_
 {
 
 using defaulttype::Vec3d;
-using defaulttype::Vec3i;
 typedef typename core::topology::BaseMeshTopology::SeqEdges SeqEdges;
 
+/// Minimum number of points located by each task during the initialization
+static constexpr std::size_t s_pointLocationGrainSize = 256;
+
 template <class In, class Out, class MappingDataType, class Element>
 BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::BarycentricMapperTopologyContainer(core::topology::BaseMeshTopology* fromTopology,
                                                                                                        topology::PointSetTopologyContainer* toTopology)
@@ -66,7 +69,8 @@ template <class In, class Out, class MappingDataType, class Element>
 void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::initHashing(const typename In::VecCoord& in)
 {
     computeHashingCellSize(in);
-    computeHashTable(in);
+    computeBasesAndCenters(in);
+    computeElementGrid(in);
 }
 
 
@@ -104,37 +108,17 @@ void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::compute
 
 
 template <class In, class Out, class MappingDataType, class Element>
-void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::computeHashTable( const typename In::VecCoord& in )
+void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::computeElementGrid( const typename In::VecCoord& in )
 {
     const helper::vector<Element>& elements = getElements();
-    m_hashTableSize = elements.size()*2; // Next prime number would be better
-    m_hashTable.clear();
-    if(m_hashTable.size()<m_hashTableSize)
-        m_hashTable.reserve(m_hashTableSize);
+    const helper::vector<Vector3>& barycentricCorners = ElementGrid::getBarycentricCorners<Element>();
+    helper::vector<Vector3> minBBox(elements.size());
+    helper::vector<Vector3> maxBBox(elements.size());
 
     for(unsigned int i=0; i<elements.size(); i++)
-    {
-        Element element = elements[i];
-        Vector3 min=in[element[0]], max=in[element[0]];
+        ElementGrid::computeBoundingBox(minBBox[i], maxBBox[i], in[elements[i][0]], m_bases[i], barycentricCorners);
 
-        for(unsigned int j=0; j<element.size(); j++)
-        {
-            unsigned int pointId = element[j];
-            for(int k=0; k<3; k++)
-            {
-                if(in[pointId][k]<min[k]) min[k]=in[pointId][k];
-                if(in[pointId][k]>max[k]) max[k]=in[pointId][k];
-            }
-        }
-
-        Vec3i i_min=getGridIndices(min);
-        Vec3i i_max=getGridIndices(max);
-
-        for(int j=i_min[0]; j<=i_max[0]; j++)
-            for(int k=i_min[1]; k<=i_max[1]; k++)
-                for(int l=i_min[2]; l<=i_max[2]; l++)
-                    m_hashTable[Key(j,k,l)].push_back(i);
-    }
+    m_elementGrid.build(minBBox, maxBBox, m_centers, m_gridCellSize);
 }
 
 
@@ -143,63 +127,39 @@ void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::init (
 {
     initHashing(in);
     this->clear ( int(out.size()) );
-    computeBasesAndCenters(in);
 
-    // Compute distances to get nearest element and corresponding bary coef
+    // Compute distances to get nearest element and corresponding bary coef.
+    // The points are located concurrently, then added in the map in their order.
     const helper::vector<Element>& elements = getElements();
-    for ( unsigned int i=0; i<out.size(); i++ )
+    helper::vector<NearestParams> nearestParams(out.size());
+    simulation::parallelForEachRange(this->m_taskScheduler, 0, out.size(), [&](std::size_t begin, std::size_t end)
     {
-        Vector3 outPos = Out::getCPos(out[i]);
-        NearestParams nearestParams;
+        for ( std::size_t i=begin; i<end; i++ )
+            nearestParams[i] = findNearestElement(Out::getCPos(out[i]), in, elements);
+    }, s_pointLocationGrainSize);
 
-        // Search nearest element in grid cell
-        Vec3i gridIds = getGridIndices(outPos);
-        Key key(gridIds[0],gridIds[1],gridIds[2]);
+    for ( std::size_t i=0; i<out.size(); i++ )
+        addPointInElement(nearestParams[i].elementId, nearestParams[i].baryCoords.ptr());
+}
 
-        auto it_entries = m_hashTable.find(key);
-        if( it_entries != m_hashTable.end() )
-        {
-            for(auto entry : it_entries->second)
-            {
-                Vector3 inPos = in[elements[entry][0]];
-                checkDistanceFromElement(entry, outPos, inPos, nearestParams);
-            }
-        }
 
-        if(nearestParams.elementId==std::numeric_limits<unsigned int>::max()) // No element in grid cell, perform exhaustive search
-        {
-            for ( unsigned int e = 0; e < elements.size(); e++ )
-            {
-                Vector3 inPos = in[elements[e][0]];
-                checkDistanceFromElement(e, outPos, inPos, nearestParams);
-            }
-            addPointInElement(nearestParams.elementId, nearestParams.baryCoords.ptr());
-        }
-        else if(fabs(nearestParams.distance)>m_gridCellSize/2.) // Nearest element in grid cell may not be optimal, check neighbors
-        {
-            Vec3i centerGridIds = gridIds;
-            for(int xId=-1; xId<=1; xId++)
-                for(int yId=-1; yId<=1; yId++)
-                    for(int zId=-1; zId<=1; zId++)
-                    {
-                        gridIds = Vec3i(centerGridIds[0]+xId,centerGridIds[1]+yId,centerGridIds[2]+zId);
-                        Key key(gridIds[0],gridIds[1],gridIds[2]);
-
-                        auto it_entries = m_hashTable.find(key);
-                        if( it_entries != m_hashTable.end() )
-                        {
-                            for(auto entry : it_entries->second)
-                            {
-                                Vector3 inPos = in[elements[entry][0]];
-                                checkDistanceFromElement(entry, outPos, inPos, nearestParams);
-                            }
-                        }
-                    }
-            addPointInElement(nearestParams.elementId, nearestParams.baryCoords.ptr());
-        }
-        else
-            addPointInElement(nearestParams.elementId, nearestParams.baryCoords.ptr());
-    }
+template <class In, class Out, class MappingDataType, class Element>
+typename BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::NearestParams
+BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::findNearestElement(const Vector3& outPos,
+                                                                                      const typename In::VecCoord& in,
+                                                                                      const helper::vector<Element>& elements)
+{
+    NearestParams nearestParams;
+    const Index e = m_elementGrid.findElement(outPos, [&](Index candidate)
+    {
+        double dist;
+        computeDistance(dist, m_bases[candidate] * ( outPos - in[elements[candidate][0]] ));
+        return dist;
+    });
+
+    if (e != sofa::InvalidID)
+        checkDistanceFromElement(e, outPos, in[elements[e][0]], nearestParams);
+    return nearestParams;
 }
 
 
@@ -248,6 +208,12 @@ void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::checkDi
 template <class In, class Out, class MappingDataType, class Element>
 void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::applyJT ( typename In::MatrixDeriv& out, const typename Out::MatrixDeriv& in )
 {
+    if (this->updateWeightMatrix(d_map.getValue().size(), d_map.getCounter()))
+    {
+        this->applyJTWithWeightMatrix(out, in);
+        return;
+    }
+
     typename Out::MatrixDeriv::RowConstIterator rowItEnd = in.end();
     const helper::vector< Element >& elements = getElements();
 
@@ -311,6 +277,12 @@ const defaulttype::BaseMatrix* BarycentricMapperTopologyContainer<In,Out,Mapping
 template <class In, class Out, class MappingDataType, class Element>
 void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::applyJT ( typename In::VecDeriv& out, const typename Out::VecDeriv& in )
 {
+    if (this->updateWeightMatrix(d_map.getValue().size(), d_map.getCounter()))
+    {
+        this->applyJTWithWeightMatrix(out, in);
+        return;
+    }
+
     const helper::vector<Element>& elements = getElements();
 
     ForceMask& mask = *this->maskFrom;
@@ -334,6 +306,12 @@ void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::applyJT
 template <class In, class Out, class MappingDataType, class Element>
 void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::applyJ ( typename Out::VecDeriv& out, const typename In::VecDeriv& in )
 {
+    if (this->updateWeightMatrix(d_map.getValue().size(), d_map.getCounter()))
+    {
+        this->applyJWithWeightMatrix(out, in);
+        return;
+    }
+
     out.resize( d_map.getValue().size() );
 
     const helper::vector<Element>& elements = getElements();
@@ -372,6 +350,12 @@ bool BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::isEmpty
 template <class In, class Out, class MappingDataType, class Element>
 void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::apply ( typename Out::VecCoord& out, const typename In::VecCoord& in )
 {
+    if (this->updateWeightMatrix(d_map.getValue().size(), d_map.getCounter()))
+    {
+        this->applyWithWeightMatrix(out, in);
+        return;
+    }
+
     out.resize( d_map.getValue().size() );
 
     const helper::vector<Element>& elements = getElements();
@@ -390,6 +374,26 @@ void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::apply (
 }
 
 
+template <class In, class Out, class MappingDataType, class Element>
+bool BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::computeWeightMatrix(WeightMatrix& weights)
+{
+    const helper::vector<Element>& elements = getElements();
+    const helper::vector<MappingDataType>& map = d_map.getValue();
+
+    weights.columns.reserve(map.size() * Element::size());
+    weights.values.reserve(map.size() * Element::size());
+    for (const MappingDataType& data : map)
+    {
+        const Element& element = elements[data.in_index];
+        helper::vector<SReal> baryCoef = getBaryCoef(data.baryCoords);
+        for (unsigned int j=0; j<element.size(); j++)
+            weights.addWeight(element[j], Real(baryCoef[j]));
+        weights.endRow();
+    }
+    return true;
+}
+
+
 template <class In, class Out, class MappingDataType, class Element>
 void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::draw  (const core::visual::VisualParams* vparams,
                                                                                 const typename Out::VecCoord& out,
@@ -419,15 +423,6 @@ void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::draw  (
 }
 
 
-template <class In, class Out, class MappingDataType, class Element>
-Vec3i BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::getGridIndices(const Vector3& pos)
-{
-    Vec3i i_x;
-    for(int i=0; i<3; i++)
-        i_x[i]=floor(pos[i]*m_convFactor);
-
-    return i_x;
-}
 
 
 template<class In, class Out, class MappingData, class Element>
@@ -24,6 +24,11 @@
 #include <SofaBaseMechanics/BarycentricMappers/BarycentricMapper.h>
 #include <SofaBaseTopology/PointSetTopologyContainer.h>
 
+namespace sofa::simulation
+{
+    class TaskScheduler;
+}
+
 namespace sofa::component::mapping
 {
 
@@ -81,7 +86,26 @@ public:
         this->init(out,in);
     }
 
+    /// Apply the mapping with a precomputed sparse matrix of its weights, and the transposed matrix for applyJT,
+    /// processing the points in parallel with the tasks of taskScheduler (sequentially if it is null).
+    /// The mappers which do not provide their weights (see computeWeightMatrix) keep their own implementation.
+    void setUseWeightMatrix(bool useWeightMatrix, simulation::TaskScheduler* taskScheduler = nullptr);
+
 protected:
+    /// Weights of the mapping in compressed sparse rows: the mapped point i is the sum of the parent points
+    /// columns[k] weighted by values[k], for k in [rowBegin[i], rowBegin[i+1]).
+    struct WeightMatrix
+    {
+        helper::vector<Index> rowBegin;
+        helper::vector<Index> columns;
+        helper::vector<Real> values;
+
+        void clear() { rowBegin.assign(1, 0); columns.clear(); values.clear(); }
+        void addWeight(Index column, Real value) { columns.push_back(column); values.push_back(value); }
+        void endRow() { rowBegin.push_back(Index(columns.size())); }
+        std::size_t nbRows() const { return rowBegin.empty() ? 0 : rowBegin.size() - 1; }
+    };
+
     TopologyBarycentricMapper(core::topology::BaseMeshTopology* fromTopology,
                               topology::PointSetTopologyContainer* toTopology = nullptr)
         : m_fromTopology(fromTopology)
@@ -90,8 +114,33 @@ protected:
 
     ~TopologyBarycentricMapper() override {}
 
+    /// Fill the weight matrix with one row per mapped point, in the order of the mapped points.
+    /// Return false if the mapper does not provide its weights.
+    virtual bool computeWeightMatrix(WeightMatrix& weights) { SOFA_UNUSED(weights); return false; }
+
+    /// Force the computation of the weight matrix before its next use
+    void invalidateWeightMatrix() { m_weightMatrixIsValid = false; }
+
+    /// Compute the weight matrix and its transpose when they are outdated: after invalidateWeightMatrix,
+    /// or when the number of mapped points, the revision of the mapping data or the input topology changed.
+    /// Return false if the weight matrix is not used or not available.
+    bool updateWeightMatrix(std::size_t nbMappedPoints, int mapRevision = 0);
+
+    void applyWithWeightMatrix( typename Out::VecCoord& out, const typename In::VecCoord& in );
+    void applyJWithWeightMatrix( typename Out::VecDeriv& out, const typename In::VecDeriv& in );
+    void applyJTWithWeightMatrix( typename In::VecDeriv& out, const typename Out::VecDeriv& in );
+    void applyJTWithWeightMatrix( typename In::MatrixDeriv& out, const typename Out::MatrixDeriv& in );
+
     core::topology::BaseMeshTopology*    m_fromTopology;
     topology::PointSetTopologyContainer* m_toTopology;
+
+    bool m_useWeightMatrix {false};
+    bool m_weightMatrixIsValid {false};
+    int m_weightMatrixMapRevision {-1};
+    int m_weightMatrixTopologyRevision {-1};
+    WeightMatrix m_weightMatrix;
+    WeightMatrix m_transposedWeightMatrix; ///< one row per parent point, the columns are the mapped points
+    simulation::TaskScheduler* m_taskScheduler {nullptr};
 };
 
 #if !defined(SOFA_COMPONENT_MAPPING_TOPOLOGYBARYCENTRICMAPPER_CPP)
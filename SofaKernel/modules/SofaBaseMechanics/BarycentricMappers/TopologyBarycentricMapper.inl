@@ -23,6 +23,10 @@
 #define SOFA_COMPONENT_MAPPING_TOPOLOGYBARYCENTRICMAPPER_INL
 
 #include "TopologyBarycentricMapper.h"
+#include <sofa/simulation/ParallelForEach.h>
+
+#include <algorithm>
+#include <numeric>
 
 namespace sofa::component::mapping
 {
@@ -167,6 +171,173 @@ TopologyBarycentricMapper<In,Out>::createPointInCube(const typename Out::Coord&
     return 0;
 }
 
+/// Minimum number of points processed by a task
+static constexpr std::size_t s_weightMatrixGrainSize = 1024;
+
+template<class In, class Out>
+void TopologyBarycentricMapper<In,Out>::setUseWeightMatrix(bool useWeightMatrix, simulation::TaskScheduler* taskScheduler)
+{
+    m_useWeightMatrix = useWeightMatrix;
+    m_taskScheduler = taskScheduler;
+    invalidateWeightMatrix();
+}
+
+template<class In, class Out>
+bool TopologyBarycentricMapper<In,Out>::updateWeightMatrix(std::size_t nbMappedPoints, int mapRevision)
+{
+    if (!m_useWeightMatrix)
+        return false;
+
+    const int topologyRevision = m_fromTopology ? m_fromTopology->getRevision() : 0;
+    if (m_weightMatrixIsValid && m_weightMatrix.nbRows() == nbMappedPoints
+            && m_weightMatrixMapRevision == mapRevision && m_weightMatrixTopologyRevision == topologyRevision)
+        return true;
+
+    m_weightMatrix.clear();
+    m_weightMatrix.rowBegin.reserve(nbMappedPoints + 1);
+    if (!computeWeightMatrix(m_weightMatrix) || m_weightMatrix.nbRows() != nbMappedPoints)
+    {
+        msg_warning() << "The weights of this mapper are not available, the weight matrix is not used";
+        m_useWeightMatrix = false;
+        m_weightMatrix.clear();
+        m_transposedWeightMatrix.clear();
+        return false;
+    }
+
+    // transposition by counting sort: the mapped points of each parent point keep their order,
+    // so that the forces are accumulated in the same order as the sequential implementations
+    Index nbParents = 0;
+    for (const Index column : m_weightMatrix.columns)
+        nbParents = std::max(nbParents, Index(column + 1));
+
+    WeightMatrix& transposed = m_transposedWeightMatrix;
+    transposed.rowBegin.assign(nbParents + 1, 0);
+    for (const Index column : m_weightMatrix.columns)
+        ++transposed.rowBegin[column + 1];
+    std::partial_sum(transposed.rowBegin.begin(), transposed.rowBegin.end(), transposed.rowBegin.begin());
+
+    transposed.columns.resize(m_weightMatrix.columns.size());
+    transposed.values.resize(m_weightMatrix.values.size());
+    helper::vector<Index> next(transposed.rowBegin.begin(), transposed.rowBegin.end() - 1);
+    for (std::size_t i = 0; i < m_weightMatrix.nbRows(); ++i)
+    {
+        for (Index k = m_weightMatrix.rowBegin[i]; k < m_weightMatrix.rowBegin[i + 1]; ++k)
+        {
+            const Index position = next[m_weightMatrix.columns[k]]++;
+            transposed.columns[position] = Index(i);
+            transposed.values[position] = m_weightMatrix.values[k];
+        }
+    }
+
+    m_weightMatrixIsValid = true;
+    m_weightMatrixMapRevision = mapRevision;
+    m_weightMatrixTopologyRevision = topologyRevision;
+    return true;
+}
+
+template<class In, class Out>
+void TopologyBarycentricMapper<In,Out>::applyWithWeightMatrix( typename Out::VecCoord& out, const typename In::VecCoord& in )
+{
+    const WeightMatrix& weights = m_weightMatrix;
+    out.resize(weights.nbRows());
+
+    simulation::parallelForEachRange(m_taskScheduler, 0, weights.nbRows(), [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            typename In::Deriv pos{0.,0.,0.};
+            for (Index k = weights.rowBegin[i]; k < weights.rowBegin[i + 1]; ++k)
+                pos += in[weights.columns[k]] * weights.values[k];
+            Out::setCPos(out[i], pos);
+        }
+    }, s_weightMatrixGrainSize);
+}
+
+template<class In, class Out>
+void TopologyBarycentricMapper<In,Out>::applyJWithWeightMatrix( typename Out::VecDeriv& out, const typename In::VecDeriv& in )
+{
+    const WeightMatrix& weights = m_weightMatrix;
+    out.resize(weights.nbRows());
+
+    const ForceMask& mask = *this->maskTo;
+    const std::size_t nbRows = std::min(weights.nbRows(), mask.size());
+
+    simulation::parallelForEachRange(m_taskScheduler, 0, nbRows, [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            if (mask.isActivated() && !mask.getEntry(i)) continue;
+
+            typename In::Deriv v{0.,0.,0.};
+            for (Index k = weights.rowBegin[i]; k < weights.rowBegin[i + 1]; ++k)
+                v += in[weights.columns[k]] * weights.values[k];
+            Out::setDPos(out[i], v);
+        }
+    }, s_weightMatrixGrainSize);
+}
+
+template<class In, class Out>
+void TopologyBarycentricMapper<In,Out>::applyJTWithWeightMatrix( typename In::VecDeriv& out, const typename Out::VecDeriv& in )
+{
+    // each parent point gathers the contributions of its mapped points: no concurrent writes
+    const WeightMatrix& transposed = m_transposedWeightMatrix;
+    const ForceMask& maskTo = *this->maskTo;
+    const std::size_t nbActiveRows = std::min(m_weightMatrix.nbRows(), maskTo.size());
+    const std::size_t nbParents = std::min(transposed.nbRows(), out.size());
+
+    // the mask is not thread-safe, it is filled after the parallel loop
+    helper::vector<char> isParentActive(nbParents, 0);
+
+    simulation::parallelForEachRange(m_taskScheduler, 0, nbParents, [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t p = begin; p < end; ++p)
+        {
+            for (Index k = transposed.rowBegin[p]; k < transposed.rowBegin[p + 1]; ++k)
+            {
+                const Index i = transposed.columns[k];
+                if (i >= nbActiveRows || !maskTo.getEntry(i)) continue;
+
+                out[p] += Out::getDPos(in[i]) * transposed.values[k];
+                isParentActive[p] = 1;
+            }
+        }
+    }, s_weightMatrixGrainSize);
+
+    ForceMask& maskFrom = *this->maskFrom;
+    for (std::size_t p = 0; p < nbParents; ++p)
+    {
+        if (isParentActive[p])
+            maskFrom.insertEntry(p);
+    }
+}
+
+template<class In, class Out>
+void TopologyBarycentricMapper<In,Out>::applyJTWithWeightMatrix( typename In::MatrixDeriv& out, const typename Out::MatrixDeriv& in )
+{
+    const WeightMatrix& weights = m_weightMatrix;
+    typename Out::MatrixDeriv::RowConstIterator rowItEnd = in.end();
+
+    for (typename Out::MatrixDeriv::RowConstIterator rowIt = in.begin(); rowIt != rowItEnd; ++rowIt)
+    {
+        typename Out::MatrixDeriv::ColConstIterator colItEnd = rowIt.end();
+        typename Out::MatrixDeriv::ColConstIterator colIt = rowIt.begin();
+
+        if (colIt != colItEnd)
+        {
+            typename In::MatrixDeriv::RowIterator o = out.writeLine(rowIt.index());
+
+            for ( ; colIt != colItEnd; ++colIt)
+            {
+                const Index i = colIt.index();
+                const typename In::Deriv data = typename In::Deriv(Out::getDPos(colIt.val()));
+
+                for (Index k = weights.rowBegin[i]; k < weights.rowBegin[i + 1]; ++k)
+                    o.addCol(weights.columns[k], data * weights.values[k]);
+            }
+        }
+    }
+}
+
 } // namespace _topologybarycentricmapper_
 
 } // namespace sofa::component::mapping
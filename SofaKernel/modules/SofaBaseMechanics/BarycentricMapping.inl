@@ -52,6 +52,8 @@
 #include <sofa/helper/vector.h>
 
 #include <sofa/simulation/Simulation.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/simulation/InitTasks.h>
 
 #include <algorithm>
 #include <iostream>
@@ -97,6 +99,7 @@ static bool is_a(const V * topology) {
 template <class TIn, class TOut>
 BarycentricMapping<TIn, TOut>::BarycentricMapping(core::State<In>* from, core::State<Out>* to, typename Mapper::SPtr mapper)
     : Inherit1 ( from, to )
+    , d_parallel(initData(&d_parallel, false, "parallel", "Apply the mapping with a precomputed sparse matrix of its weights (and its transpose for applyJT), processing the mapped points in parallel with the task scheduler"))
     , d_mapper(initLink("mapper","Internal mapper created depending on the type of topology"), mapper)
     , d_input_topology(initLink("input_topology", "Input topology container (usually the surrounding domain)."))
     , d_output_topology(initLink("output_topology", "Output topology container (usually the immersed domain)."))
@@ -110,6 +113,7 @@ BarycentricMapping<TIn, TOut>::BarycentricMapping(core::State<In>* from, core::S
 template <class TIn, class TOut>
 BarycentricMapping<TIn, TOut>::BarycentricMapping (core::State<In>* from, core::State<Out>* to, BaseMeshTopology * input_topology )
     : Inherit1 ( from, to )
+    , d_parallel(initData(&d_parallel, false, "parallel", "Apply the mapping with a precomputed sparse matrix of its weights (and its transpose for applyJT), processing the mapped points in parallel with the task scheduler"))
     , d_mapper (initLink("mapper","Internal mapper created depending on the type of topology"))
     , d_input_topology(initLink("input_topology", "Input topology container (usually the surrounding domain)."))
     , d_output_topology(initLink("output_topology", "Output topology container (usually the immersed domain)."))
@@ -277,6 +281,18 @@ void BarycentricMapping<TIn, TOut>::init()
     if (!this->toModel)
         return;
 
+    simulation::TaskScheduler* taskScheduler = nullptr;
+    if (d_parallel.getValue())
+    {
+        taskScheduler = simulation::TaskScheduler::getInstance();
+        if (taskScheduler->getThreadCount() < 1)
+        {
+            taskScheduler->init(0);
+            simulation::initThreadLocalData();
+        }
+    }
+    d_mapper->setUseWeightMatrix(d_parallel.getValue(), taskScheduler);
+
     if (useRestPosition.getValue())
         d_mapper->init ( ((const core::State<Out> *)this->toModel)->read(core::ConstVecCoordId::restPosition())->getValue(), ((const core::State<In> *)this->fromModel)->read(core::ConstVecCoordId::restPosition())->getValue() );
     else
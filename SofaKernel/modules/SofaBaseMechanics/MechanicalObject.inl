@@ -506,15 +506,28 @@ void MechanicalObject<DataTypes>::handleStateChange()
         {
             const auto& tab = ( static_cast< const PointsRemoved * >( *itBegin ) )->getArray();
 
-            unsigned int prevSizeMechObj   = getSize();
-            unsigned int lastIndexMech = prevSizeMechObj - 1;
-            for (unsigned int i = 0; i < tab.size(); ++i)
+            // Each removed point is replaced by the last one: the moves of the whole removal are
+            // computed once, then applied to each vector in a single pass.
+            const core::topology::ElementsRemovalRemap remap(getSize(), tab);
+            for (unsigned int i = 0; i < vectorsCoord.size(); ++i)
             {
-                replaceValue(lastIndexMech, tab[i] );
-
-                --lastIndexMech;
+                if (vectorsCoord[i] != nullptr && vectorsCoord[i]->getValue().size() >= getSize())
+                {
+                    VecCoord& vector = *(vectorsCoord[i]->beginEdit());
+                    remap.apply(vector);
+                    vectorsCoord[i]->endEdit();
+                }
+            }
+            for (unsigned int i = 0; i < vectorsDeriv.size(); ++i)
+            {
+                if (vectorsDeriv[i] != nullptr && vectorsDeriv[i]->getValue().size() >= getSize())
+                {
+                    VecDeriv& vector = *(vectorsDeriv[i]->beginEdit());
+                    remap.apply(vector);
+                    vectorsDeriv[i]->endEdit();
+                }
             }
-            resize( prevSizeMechObj - tab.size() );
+            resize( Size(remap.getNewSize()) );
             break;
         }
         case core::topology::POINTSMOVED:
@@ -57,15 +57,11 @@ struct BarycentricMapperTriangleSetTopologyTest :  public Test, public Barycentr
     typedef BarycentricMapperTriangleSetTopology<In,Out> Inherit;
     typedef typename In::Real Real;
 
-    using Inherit::m_hashTable;
-    using Inherit::m_hashTableSize;
     using Inherit::m_gridCellSize;
     using Inherit::m_convFactor;
     using Inherit::m_fromTopology;
     using Inherit::d_map;
 
-    using Inherit::computeHashTable;
-    using Inherit::getGridIndices;
     using Inherit::initHashing;
     using Inherit::init;
 
@@ -144,3 +140,213 @@ TEST_F(BarycentricMapperTriangleSetTopologyTest_d, initHashing)
 }
 
 
+
+
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/simulation/InitTasks.h>
+#include <sofa/core/MechanicalParams.h>
+#include <random>
+
+/// Compare the mapping computed with the parallel weight matrix to the sequential mapper
+struct BarycentricMappingParallel_test : public Test
+{
+    typedef BarycentricMapping<Vec3dTypes,Vec3dTypes> Mapping;
+    typedef MechanicalObject<Vec3dTypes> MechanicalObject3;
+    typedef Vec3dTypes::VecCoord VecCoord;
+    typedef Vec3dTypes::VecDeriv VecDeriv;
+
+    Node::SPtr root;
+    MechanicalObject3::SPtr inDofs;
+    MechanicalObject3::SPtr sequentialDofs;
+    MechanicalObject3::SPtr parallelDofs;
+    Mapping::SPtr sequentialMapping;
+    Mapping::SPtr parallelMapping;
+
+    void SetUp() override
+    {
+        sofa::simulation::TaskScheduler* taskScheduler = sofa::simulation::TaskScheduler::getInstance();
+        taskScheduler->init(4);
+        sofa::simulation::initThreadLocalData();
+
+        Simulation* simu;
+        setSimulation(simu = new DAGSimulation());
+        root = simu->createNewGraph("root");
+
+        // two tetrahedra sharing a face
+        TetrahedronSetTopologyContainer::SPtr topology = New<TetrahedronSetTopologyContainer>();
+        topology->setNbPoints(5);
+        topology->addTetra(0, 1, 2, 3);
+        topology->addTetra(1, 2, 3, 4);
+        root->addObject(topology);
+
+        inDofs = New<MechanicalObject3>();
+        inDofs->resize(5);
+        {
+            sofa::helper::WriteAccessor< sofa::Data<VecCoord> > x = *inDofs->write(sofa::core::VecCoordId::position());
+            x[0] = Vector3(0,0,0);
+            x[1] = Vector3(1,0,0);
+            x[2] = Vector3(0,1,0);
+            x[3] = Vector3(0,0,1);
+            x[4] = Vector3(1,1,1);
+        }
+        root->addObject(inDofs);
+
+        // enough points to be split among the threads, some of them outside of the tetrahedra
+        std::mt19937 generator(0);
+        std::uniform_real_distribution<double> distribution(-0.1, 1.1);
+        VecCoord points(5000);
+        for (auto& p : points)
+            p = Vector3(distribution(generator), distribution(generator), distribution(generator));
+
+        sequentialMapping = createMappedNode("sequential", points, false, sequentialDofs);
+        parallelMapping = createMappedNode("parallel", points, true, parallelDofs);
+
+        simu->init(root.get());
+    }
+
+    void TearDown() override
+    {
+        sofa::simulation::getSimulation()->unload(root);
+    }
+
+    Mapping::SPtr createMappedNode(const std::string& name, const VecCoord& points, bool parallel, MechanicalObject3::SPtr& dofs)
+    {
+        Node::SPtr node = root->createChild(name);
+        dofs = New<MechanicalObject3>();
+        dofs->resize(points.size());
+        *dofs->write(sofa::core::VecCoordId::position()) = points;
+        node->addObject(dofs);
+
+        Mapping::SPtr mapping = New<Mapping>();
+        mapping->setModels(inDofs.get(), dofs.get());
+        mapping->d_parallel.setValue(parallel);
+        node->addObject(mapping);
+        return mapping;
+    }
+
+    static double maxDiff(const VecCoord& a, const VecCoord& b)
+    {
+        EXPECT_EQ(a.size(), b.size());
+        double diff = 0;
+        for (std::size_t i=0; i<std::min(a.size(), b.size()); i++)
+            diff = std::max(diff, (a[i]-b[i]).norm());
+        return diff;
+    }
+};
+
+TEST_F(BarycentricMappingParallel_test, sameResultsAsSequential)
+{
+    const sofa::core::MechanicalParams* mparams = sofa::core::MechanicalParams::defaultInstance();
+
+    // apply
+    sequentialMapping->apply(mparams, *sequentialDofs->write(sofa::core::VecCoordId::position()), *inDofs->read(sofa::core::ConstVecCoordId::position()));
+    parallelMapping->apply(mparams, *parallelDofs->write(sofa::core::VecCoordId::position()), *inDofs->read(sofa::core::ConstVecCoordId::position()));
+    EXPECT_LE(maxDiff(sequentialDofs->x.getValue(), parallelDofs->x.getValue()), 1e-12);
+
+    // applyJ
+    sofa::Data<VecDeriv> inVelocity;
+    inVelocity.setValue(VecDeriv{ Vector3(1,2,3), Vector3(-1,0,2), Vector3(0,0,1), Vector3(4,-2,0), Vector3(1,1,1) });
+    sofa::Data<VecDeriv> sequentialVelocity, parallelVelocity;
+    sequentialMapping->applyJ(mparams, sequentialVelocity, inVelocity);
+    parallelMapping->applyJ(mparams, parallelVelocity, inVelocity);
+    EXPECT_LE(maxDiff(sequentialVelocity.getValue(), parallelVelocity.getValue()), 1e-12);
+
+    // applyJT, accumulated in the parent forces
+    sofa::Data<VecDeriv> outForce;
+    outForce.setValue(VecDeriv(5000, Vector3(0.5,-1,2)));
+    sofa::Data<VecDeriv> sequentialForce, parallelForce;
+    sequentialForce.setValue(VecDeriv(5, Vector3(1,1,1)));
+    parallelForce.setValue(VecDeriv(5, Vector3(1,1,1)));
+    sequentialMapping->applyJT(mparams, sequentialForce, outForce);
+    parallelMapping->applyJT(mparams, parallelForce, outForce);
+    EXPECT_LE(maxDiff(sequentialForce.getValue(), parallelForce.getValue()), 1e-9);
+
+    // the weights sum to one: the total force is preserved
+    Vector3 total;
+    for (const auto& f : parallelForce.getValue())
+        total += f - Vector3(1,1,1);
+    EXPECT_LE((total - Vector3(0.5,-1,2)*5000).norm(), 1e-6);
+}
+
+
+#include <SofaBaseMechanics/BarycentricMappers/BarycentricMapperTetrahedronSetTopology.h>
+using sofa::component::mapping::BarycentricMapperTetrahedronSetTopology;
+
+/// Mapper exposing its map, to compare the point location with the grid to an exhaustive search
+struct TetrahedronMapperTestable : public BarycentricMapperTetrahedronSetTopology<Vec3dTypes, Vec3dTypes>
+{
+    typedef BarycentricMapperTetrahedronSetTopology<Vec3dTypes, Vec3dTypes> Inherit;
+
+    TetrahedronMapperTestable(sofa::component::topology::TetrahedronSetTopologyContainer* fromTopology)
+        : Inherit(fromTopology, nullptr) {}
+
+    const auto& getMap() const { return d_map.getValue(); }
+};
+
+TEST(BarycentricMapperElementGrid_test, sameLocationAsExhaustiveSearch)
+{
+    typedef Vec3dTypes::VecCoord VecCoord;
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<double> jitter(-0.2, 0.2);
+    std::uniform_real_distribution<double> coordinate(-1.0, 4.0);
+
+    // 3x3x3 jittered cubes, each split in 6 tetrahedra
+    const int n = 4;
+    VecCoord in;
+    for (int k = 0; k < n; ++k)
+        for (int j = 0; j < n; ++j)
+            for (int i = 0; i < n; ++i)
+                in.push_back(Vector3(i + jitter(generator), j + jitter(generator), k + jitter(generator)));
+
+    TetrahedronSetTopologyContainer::SPtr container = New<TetrahedronSetTopologyContainer>();
+    const auto id = [n](int i, int j, int k) { return sofa::Index(i + n * (j + n * k)); };
+    for (int k = 0; k < n-1; ++k)
+        for (int j = 0; j < n-1; ++j)
+            for (int i = 0; i < n-1; ++i)
+            {
+                const sofa::Index p0 = id(i,j,k), p1 = id(i+1,j,k), p2 = id(i+1,j+1,k), p3 = id(i,j+1,k);
+                const sofa::Index p4 = id(i,j,k+1), p5 = id(i+1,j,k+1), p6 = id(i+1,j+1,k+1), p7 = id(i,j+1,k+1);
+                container->addTetra(p0, p5, p1, p6);
+                container->addTetra(p0, p1, p2, p6);
+                container->addTetra(p0, p2, p3, p6);
+                container->addTetra(p0, p3, p7, p6);
+                container->addTetra(p0, p7, p4, p6);
+                container->addTetra(p0, p4, p5, p6);
+            }
+
+    // points inside and outside of the mesh
+    VecCoord out;
+    for (int i = 0; i < 3000; ++i)
+        out.push_back(Vector3(coordinate(generator), coordinate(generator), coordinate(generator)));
+
+    sofa::core::sptr<TetrahedronMapperTestable> mapper(new TetrahedronMapperTestable(container.get()));
+    mapper->init(out, in);
+    const auto& map = mapper->getMap();
+    ASSERT_EQ(map.size(), out.size());
+
+    const auto& tetrahedra = container->getTetrahedra();
+    for (std::size_t p = 0; p < out.size(); ++p)
+    {
+        Vector3 coefs;
+        int index = -1;
+        double distance = std::numeric_limits<double>::max();
+        for (std::size_t t = 0; t < tetrahedra.size(); ++t)
+        {
+            sofa::defaulttype::Mat3x3d m, mt, base;
+            m[0] = in[tetrahedra[t][1]] - in[tetrahedra[t][0]];
+            m[1] = in[tetrahedra[t][2]] - in[tetrahedra[t][0]];
+            m[2] = in[tetrahedra[t][3]] - in[tetrahedra[t][0]];
+            mt.transpose(m);
+            base.invert(mt);
+            const Vector3 center = (in[tetrahedra[t][0]] + in[tetrahedra[t][1]] + in[tetrahedra[t][2]] + in[tetrahedra[t][3]]) * 0.25;
+            const Vector3 v = base * (out[p] - in[tetrahedra[t][0]]);
+            double d = std::max(std::max(-v[0], -v[1]), std::max(-v[2], v[0] + v[1] + v[2] - 1));
+            if (d > 0) d = (out[p] - center).norm2();
+            if (d < distance) { coefs = v; distance = d; index = int(t); }
+        }
+
+        ASSERT_EQ(int(map[p].in_index), index) << "point " << p;
+        for (int k = 0; k < 3; ++k)
+            EXPECT_NEAR(map[p].baryCoords[k], coefs[k], 1e-10);
+    }
+}
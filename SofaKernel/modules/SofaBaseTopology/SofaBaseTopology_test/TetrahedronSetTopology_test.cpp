@@ -25,6 +25,7 @@
 #include <SofaBaseTopology/TetrahedronSetTopologyContainer.h>
 #include <SofaBaseTopology/TetrahedronSetGeometryAlgorithms.h>
 #include <sofa/helper/system/FileRepository.h>
+#include <map>
 
 using namespace sofa::component::topology;
 using namespace sofa::helper::testing;
@@ -40,6 +41,7 @@ public:
     bool testVertexBuffers();
     bool checkTopology();
     bool testTetrahedronGeometry();
+    bool testEdgeAndTriangleNumbering();
 
     // ground truth from obj file;
     int nbrTetrahedron = 44;
@@ -442,6 +444,143 @@ bool TetrahedronSetTopology_test::testTetrahedronGeometry()
 }
 
 
+/// Compare the indices of two topology elements (fixed_array has no comparison operator)
+template<class Element>
+bool sameIndices(const Element& expected, const Element& actual)
+{
+    for (std::size_t k = 0; k < expected.size(); ++k)
+    {
+        if (expected[k] != actual[k])
+            return false;
+    }
+    return true;
+}
+
+bool TetrahedronSetTopology_test::testEdgeAndTriangleNumbering()
+{
+    typedef sofa::core::topology::BaseMeshTopology BaseMeshTopology;
+    typedef BaseMeshTopology::PointID PointID;
+    typedef sofa::defaulttype::Vec3d Vec3;
+
+    // a block of 2x2x2 cubes, each cube split in 6 positively oriented tetrahedra around its diagonal
+    const unsigned int n = 3;
+    auto pointId = [n](unsigned int i, unsigned int j, unsigned int k) { return PointID(i + n * (j + n * k)); };
+    const unsigned int axisOrders[6][3] = { {0,1,2}, {0,2,1}, {1,0,2}, {1,2,0}, {2,0,1}, {2,1,0} };
+    sofa::helper::vector<BaseMeshTopology::Tetrahedron> cubeTetrahedra;
+    for (unsigned int k = 0; k + 1 < n; ++k)
+        for (unsigned int j = 0; j + 1 < n; ++j)
+            for (unsigned int i = 0; i + 1 < n; ++i)
+                for (const auto& axes : axisOrders)
+                {
+                    unsigned int c[3] = { i, j, k };
+                    Vec3 p[4];
+                    PointID v[4];
+                    for (unsigned int s = 0; s < 4; ++s)
+                    {
+                        if (s > 0)
+                            ++c[axes[s-1]];
+                        v[s] = pointId(c[0], c[1], c[2]);
+                        p[s] = Vec3(double(c[0]), double(c[1]), double(c[2]));
+                    }
+                    if (dot(p[1] - p[0], cross(p[2] - p[0], p[3] - p[0])) < 0)
+                        std::swap(v[2], v[3]);
+                    cubeTetrahedra.push_back(BaseMeshTopology::Tetrahedron(v[0], v[1], v[2], v[3]));
+                }
+
+    // shuffle the tetrahedra, so that the edges and triangles do not appear in the order of their vertices
+    const size_t nbTetra = cubeTetrahedra.size();
+    sofa::helper::vector<BaseMeshTopology::Tetrahedron> tetrahedra;
+    for (size_t i = 0; i < nbTetra; ++i)
+        tetrahedra.push_back(cubeTetrahedra[(7 * i) % nbTetra]);
+
+    TetrahedronSetTopologyContainer::SPtr topoCon = sofa::core::objectmodel::New< TetrahedronSetTopologyContainer >();
+    for (const BaseMeshTopology::Tetrahedron& t : tetrahedra)
+        topoCon->addTetra(t[0], t[1], t[2], t[3]);
+    topoCon->init();
+
+    // reference numbering: in the order of first appearance, with a map as the container used to do
+    const unsigned int edgesInTetrahedron[6][2] = { {0,1}, {0,2}, {0,3}, {1,2}, {1,3}, {2,3} };
+    std::map<BaseMeshTopology::Edge, BaseMeshTopology::EdgeID> edgeMap;
+    std::map<BaseMeshTopology::Triangle, BaseMeshTopology::TriangleID> triangleMap;
+    sofa::helper::vector<BaseMeshTopology::Edge> edges;
+    sofa::helper::vector<BaseMeshTopology::Triangle> triangles;
+    sofa::helper::vector<BaseMeshTopology::EdgesInTetrahedron> edgesInTetra(nbTetra);
+    sofa::helper::vector<BaseMeshTopology::TrianglesInTetrahedron> trianglesInTetra(nbTetra);
+    for (size_t i = 0; i < nbTetra; ++i)
+    {
+        const BaseMeshTopology::Tetrahedron& t = tetrahedra[i];
+        for (unsigned int j = 0; j < 6; ++j)
+        {
+            PointID v1 = t[edgesInTetrahedron[j][0]], v2 = t[edgesInTetrahedron[j][1]];
+            const BaseMeshTopology::Edge e(std::min(v1, v2), std::max(v1, v2));
+            if (edgeMap.insert(std::make_pair(e, BaseMeshTopology::EdgeID(edges.size()))).second)
+                edges.push_back(e);
+            edgesInTetra[i][j] = edgeMap[e];
+        }
+        for (unsigned int j = 0; j < 4; ++j)
+        {
+            PointID v[3];
+            for (unsigned int k = 0; k < 3; ++k)
+                v[k] = t[sofa::core::topology::trianglesOrientationInTetrahedronArray[j][k]];
+            while (v[0] > v[1] || v[0] > v[2])
+                std::swap(v[0], v[1]), std::swap(v[1], v[2]);
+            const BaseMeshTopology::Triangle opposite(v[0], v[2], v[1]);
+            const BaseMeshTopology::Triangle tr(v[0], v[1], v[2]);
+            if (triangleMap.count(opposite))
+            {
+                trianglesInTetra[i][j] = triangleMap[opposite];
+            }
+            else
+            {
+                EXPECT_EQ(0u, triangleMap.count(tr));
+                triangleMap[tr] = BaseMeshTopology::TriangleID(triangles.size());
+                trianglesInTetra[i][j] = triangleMap[tr];
+                triangles.push_back(tr);
+            }
+        }
+    }
+
+    // 27 vertices, 12 edges per cube side, 3 face diagonals per cube side and one diagonal per cube
+    EXPECT_EQ(size_t(54 + 36 + 8), edges.size());
+    // the faces are shared by two tetrahedra, except the 48 triangles of the boundary
+    EXPECT_EQ((4 * nbTetra + 48) / 2, triangles.size());
+    if (edges.size() != topoCon->getEdges().size() || triangles.size() != topoCon->getTriangles().size())
+        return false;
+    for (size_t i = 0; i < edges.size(); ++i)
+        EXPECT_TRUE(sameIndices(edges[i], topoCon->getEdges()[i])) << "edge " << i;
+    for (size_t i = 0; i < triangles.size(); ++i)
+        EXPECT_TRUE(sameIndices(triangles[i], topoCon->getTriangles()[i])) << "triangle " << i;
+    for (size_t i = 0; i < nbTetra; ++i)
+    {
+        EXPECT_TRUE(sameIndices(edgesInTetra[i], topoCon->getEdgesInTetrahedron(BaseMeshTopology::TetraID(i)))) << "tetrahedron " << i;
+        EXPECT_TRUE(sameIndices(trianglesInTetra[i], topoCon->getTrianglesInTetrahedron(BaseMeshTopology::TetraID(i)))) << "tetrahedron " << i;
+    }
+
+    // the shells list the tetrahedra in increasing order
+    sofa::helper::vector<BaseMeshTopology::TetrahedraAroundVertex> tetraAroundVertex(n * n * n);
+    sofa::helper::vector<BaseMeshTopology::TetrahedraAroundEdge> tetraAroundEdge(edges.size());
+    sofa::helper::vector<BaseMeshTopology::TetrahedraAroundTriangle> tetraAroundTriangle(triangles.size());
+    for (size_t i = 0; i < nbTetra; ++i)
+    {
+        const BaseMeshTopology::TetraID tetra = BaseMeshTopology::TetraID(i);
+        for (unsigned int j = 0; j < 4; ++j)
+            tetraAroundVertex[tetrahedra[i][j]].push_back(tetra);
+        for (unsigned int j = 0; j < 6; ++j)
+            tetraAroundEdge[edgesInTetra[i][j]].push_back(tetra);
+        for (unsigned int j = 0; j < 4; ++j)
+            tetraAroundTriangle[trianglesInTetra[i][j]].push_back(tetra);
+    }
+    for (PointID i = 0; i < tetraAroundVertex.size(); ++i)
+        EXPECT_EQ(tetraAroundVertex[i], topoCon->getTetrahedraAroundVertex(i));
+    for (size_t i = 0; i < edges.size(); ++i)
+        EXPECT_EQ(tetraAroundEdge[i], topoCon->getTetrahedraAroundEdge(BaseMeshTopology::EdgeID(i)));
+    for (size_t i = 0; i < triangles.size(); ++i)
+        EXPECT_EQ(tetraAroundTriangle[i], topoCon->getTetrahedraAroundTriangle(BaseMeshTopology::TriangleID(i)));
+
+    return true;
+}
+
+
 
 TEST_F(TetrahedronSetTopology_test, testEmptyContainer)
 {
@@ -478,6 +617,11 @@ TEST_F(TetrahedronSetTopology_test, testTetrahedronGeometry)
     ASSERT_TRUE(testTetrahedronGeometry());
 }
 
+TEST_F(TetrahedronSetTopology_test, testEdgeAndTriangleNumbering)
+{
+    ASSERT_TRUE(testEdgeAndTriangleNumbering());
+}
+
 
 
 // TODO epernod 2018-07-05: test element on Border
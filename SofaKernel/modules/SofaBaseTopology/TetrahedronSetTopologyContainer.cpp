@@ -24,6 +24,8 @@
 #include <sofa/core/visual/VisualParams.h>
 #include <sofa/core/ObjectFactory.h>
 
+#include <algorithm>
+#include <cstdint>
 
 namespace sofa
 {
@@ -44,6 +46,119 @@ int TetrahedronSetTopologyContainerClass = core::RegisterObject("Tetrahedron set
 const unsigned int edgesInTetrahedronArray[6][2] = {{0,1}, {0,2}, {0,3}, {1,2}, {1,3}, {2,3}};
 ///convention triangles in tetra (orientation interior)
 
+namespace
+{
+
+using PointID = core::topology::BaseMeshTopology::PointID;
+using Tetrahedron = core::topology::BaseMeshTopology::Tetrahedron;
+
+/// Key of an edge independent of its orientation: its two vertices packed in 64 bits, the smallest first
+inline std::uint64_t getEdgeKey(PointID a, PointID b)
+{
+    return (a < b) ? (std::uint64_t(a) << 32) | b : (std::uint64_t(b) << 32) | a;
+}
+
+/// Key of a triangle independent of its orientation: its vertices in increasing order,
+/// the two smallest ones packed in 64 bits
+struct TriangleKey
+{
+    TriangleKey() : first(0), last(0) {}
+    TriangleKey(PointID a, PointID b, PointID c)
+    {
+        if (a > b) std::swap(a, b);
+        if (b > c) std::swap(b, c);
+        if (a > b) std::swap(a, b);
+        first = (std::uint64_t(a) << 32) | b;
+        last = c;
+    }
+
+    bool operator<(const TriangleKey& other) const { return first < other.first || (first == other.first && last < other.last); }
+    bool operator==(const TriangleKey& other) const { return first == other.first && last == other.last; }
+
+    std::uint64_t first;
+    std::uint32_t last;
+};
+
+/// Vertices of the face j of the tetrahedron t, oriented towards the interior, starting with the smallest vertex
+inline void getOrientedFace(const Tetrahedron& t, unsigned int j, PointID v[3])
+{
+    for (PointID k=0; k<3; ++k)
+        v[k] = t[sofa::core::topology::trianglesOrientationInTetrahedronArray[j][k]];
+
+    while ((v[0]>v[1]) || (v[0]>v[2]))
+    {
+        PointID val=v[0];
+        v[0]=v[1];
+        v[1]=v[2];
+        v[2]=val;
+    }
+}
+
+/// Number the distinct keys in the order of their first appearance, as a std::map filled in the order of the keys would.
+/// The keys are sorted with their positions, which is much faster than inserting them in a map for large meshes.
+/// \param keys the key of each slot (edge or face of an element)
+/// \param slotIds output: the number of the key of each slot
+/// \param firstSlots output: the first slot of each distinct key, in the order of their numbers
+template<class Key>
+void numberKeysByFirstAppearance(const sofa::helper::vector<Key>& keys, sofa::helper::vector<Index>& slotIds, sofa::helper::vector<Index>& firstSlots)
+{
+    const Index nbSlots = Index(keys.size());
+    sofa::helper::vector< std::pair<Key, Index> > sortedKeys(nbSlots);
+    for (Index slot = 0; slot < nbSlots; ++slot)
+        sortedKeys[slot] = std::make_pair(keys[slot], slot);
+    std::sort(sortedKeys.begin(), sortedKeys.end());
+
+    // group of each slot, and first slot of each group
+    sofa::helper::vector<Index> slotGroups(nbSlots);
+    sofa::helper::vector<Index> groupFirstSlots;
+    for (Index i = 0; i < nbSlots; ++i)
+    {
+        if (i == 0 || !(sortedKeys[i].first == sortedKeys[i-1].first))
+            groupFirstSlots.push_back(sortedKeys[i].second);
+        slotGroups[sortedKeys[i].second] = Index(groupFirstSlots.size() - 1);
+    }
+
+    // number the groups in the order of their first slot
+    sofa::helper::vector<Index> groupIds(groupFirstSlots.size());
+    firstSlots.clear();
+    firstSlots.reserve(groupFirstSlots.size());
+    for (Index slot = 0; slot < nbSlots; ++slot)
+    {
+        const Index group = slotGroups[slot];
+        if (groupFirstSlots[group] == slot)
+        {
+            groupIds[group] = Index(firstSlots.size());
+            firstSlots.push_back(slot);
+        }
+    }
+
+    slotIds.resize(nbSlots);
+    for (Index slot = 0; slot < nbSlots; ++slot)
+        slotIds[slot] = groupIds[slotGroups[slot]];
+}
+
+/// Create the distinct edges of the tetrahedra, in their order of first appearance, and the edges of each slot (6 per tetrahedron)
+void createEdgesOfTetrahedra(const sofa::helper::vector<Tetrahedron>& tetrahedra, sofa::helper::vector<Index>& slotEdges,
+                             sofa::helper::vector<core::topology::BaseMeshTopology::Edge>& edges)
+{
+    sofa::helper::vector<std::uint64_t> keys(6 * tetrahedra.size());
+    for (size_t i = 0; i < tetrahedra.size(); ++i)
+    {
+        const Tetrahedron &t = tetrahedra[i];
+        for (unsigned int j=0; j<6; ++j)
+            keys[6*i+j] = getEdgeKey(t[edgesInTetrahedronArray[j][0]], t[edgesInTetrahedronArray[j][1]]);
+    }
+
+    sofa::helper::vector<Index> firstSlots;
+    numberKeysByFirstAppearance(keys, slotEdges, firstSlots);
+
+    edges.reserve(edges.size() + firstSlots.size());
+    for (const Index slot : firstSlots)
+        edges.push_back(core::topology::BaseMeshTopology::Edge(PointID(keys[slot] >> 32), PointID(keys[slot] & 0xffffffff)));
+}
+
+} // anonymous namespace
+
 TetrahedronSetTopologyContainer::TetrahedronSetTopologyContainer()
     : TriangleSetTopologyContainer()
 	, d_createTriangleArray(initData(&d_createTriangleArray, bool(false),"createTriangleArray", "Force the creation of a set of triangles associated with each tetrahedron"))
@@ -120,32 +235,12 @@ void TetrahedronSetTopologyContainer::createEdgeSetArray()
         clearTetrahedraAroundEdge();
     }
 
-    // create a temporary map to find redundant edges
-    std::map<Edge,EdgeID> edgeMap;
     helper::WriteAccessor< Data< sofa::helper::vector<Edge> > > m_edge = d_edge;
     helper::ReadAccessor< Data< sofa::helper::vector<Tetrahedron> > > m_tetrahedron = d_tetrahedron;
 
-    /// create the m_edge array at the same time than it fills the m_edgesInTetrahedron array
-    for (size_t i = 0; i < m_tetrahedron.size(); ++i)
-    {
-        const Tetrahedron &t = m_tetrahedron[i];
-        for (EdgeID j=0; j<6; ++j)
-        {
-            const PointID v1 = t[edgesInTetrahedronArray[j][0]];
-            const PointID v2 = t[edgesInTetrahedronArray[j][1]];
-
-            // sort vertices in lexicographic order
-            const Edge e((v1<v2) ? Edge(v1,v2) : Edge(v2,v1));
-
-            if (edgeMap.find(e)==edgeMap.end())
-            {
-                // edge not in edgeMap so create a new one
-                const size_t edgeIndex = edgeMap.size();
-                edgeMap[e] = (EdgeID)edgeIndex;
-                m_edge.push_back(e);
-            }
-        }
-    }
+    /// create the m_edge array, numbering the edges in their order of appearance in the tetrahedra
+    sofa::helper::vector<Index> slotEdges;
+    createEdgesOfTetrahedra(m_tetrahedron.ref(), slotEdges, m_edge.wref());
 }
 
 void TetrahedronSetTopologyContainer::createEdgesInTetrahedronArray()
@@ -170,35 +265,24 @@ void TetrahedronSetTopologyContainer::createEdgesInTetrahedronArray()
         helper::ReadAccessor< Data< sofa::helper::vector<Edge> > > m_edge = d_edge;
 
         m_edgesInTetrahedron.resize(numTetra);
-        /// create a multi map where the key is a vertex index and the content is the indices of edges adjacent to that vertex.
-        std::multimap<PointID, EdgeID> edgesAroundVertexMap;
-        std::multimap<PointID, EdgeID>::iterator it;
+        /// sort the edges by their packed vertex indices to find the edges of each tetrahedron by binary search
+        sofa::helper::vector< std::pair<std::uint64_t, EdgeID> > edgeKeys(numEdges);
+        for (EdgeID edge=0; edge<numEdges; ++edge)
+            edgeKeys[edge] = std::make_pair(getEdgeKey(m_edge[edge][0], m_edge[edge][1]), edge);
+        std::sort(edgeKeys.begin(), edgeKeys.end());
 
-        for (EdgeID edge=0; edge<numEdges; ++edge)  //Todo: check if not better using multimap <PointID ,TriangleID> and for each edge, push each triangle present in both shell
-        {
-            edgesAroundVertexMap.insert(std::pair<PointID, EdgeID> (m_edge[edge][0],edge));
-            edgesAroundVertexMap.insert(std::pair<PointID, EdgeID> (m_edge[edge][1],edge));
-        }
         for ( size_t i = 0 ; (i < numTetra) && (foundEdge == true) ; ++i )
         {
             const Tetrahedron &t = m_tetrahedron[i];
-            // adding edge i in the edge shell of both points
             for ( EdgeID j = 0 ; (j < 6) && (foundEdge == true) ; ++j )
             {
+                // finding edge j in edge array, the one with the smallest index if there are several
+                const std::uint64_t key = getEdgeKey(t[edgesInTetrahedronArray[j][0]], t[edgesInTetrahedronArray[j][1]]);
+                const auto it = std::lower_bound(edgeKeys.begin(), edgeKeys.end(), std::make_pair(key, EdgeID(0)));
 
-                //finding edge i in edge array
-                std::pair<std::multimap<PointID, EdgeID>::iterator, std::multimap<PointID, EdgeID>::iterator > itPair=edgesAroundVertexMap.equal_range(t[edgesInTetrahedronArray[j][0]]);
-
-                foundEdge=false;
-                for(it=itPair.first; (it!=itPair.second) && (foundEdge==false); ++it)
-                {
-                    EdgeID edge = (*it).second;
-                    if ( (m_edge[edge][0] == t[edgesInTetrahedronArray[j][0]] && m_edge[edge][1] == t[edgesInTetrahedronArray[j][1]]) || (m_edge[edge][0] == t[edgesInTetrahedronArray[j][1]] && m_edge[edge][1] == t[edgesInTetrahedronArray[j][0]]))
-                    {
-                        m_edgesInTetrahedron[i][j] = edge;
-                        foundEdge=true;
-                    }
-                }
+                foundEdge = (it != edgeKeys.end() && it->first == key);
+                if (foundEdge)
+                    m_edgesInTetrahedron[i][j] = it->second;
                 msg_warning_when(!foundEdge) << " In getTetrahedronArray, cannot find edge for tetrahedron " << i << "and edge "<< j;
             }
         }
@@ -210,32 +294,14 @@ void TetrahedronSetTopologyContainer::createEdgesInTetrahedronArray()
         const size_t numTetra = getNumberOfTetrahedra();
         m_edgesInTetrahedron.resize (numTetra);
 
-        // create a temporary map to find redundant edges
-        std::map<Edge,EdgeID> edgeMap;
         helper::WriteAccessor< Data< sofa::helper::vector<Edge> > > m_edge = d_edge;
 
         /// create the m_edge array at the same time than it fills the m_edgesInTetrahedron array
+        sofa::helper::vector<Index> slotEdges;
+        createEdgesOfTetrahedra(m_tetrahedron.ref(), slotEdges, m_edge.wref());
         for (size_t i = 0; i < m_tetrahedron.size(); ++i)
-        {
-            const Tetrahedron &t = m_tetrahedron[i];
             for (EdgeID j=0; j<6; ++j)
-            {
-                const PointID v1 = t[edgesInTetrahedronArray[j][0]];
-                const PointID v2 = t[edgesInTetrahedronArray[j][1]];
-
-                // sort vertices in lexicographic order
-                const Edge e((v1<v2) ? Edge(v1,v2) : Edge(v2,v1));
-
-                if (edgeMap.find(e)==edgeMap.end())
-                {
-                    // edge not in edgeMap so create a new one
-                    const size_t edgeIndex = edgeMap.size();
-                    edgeMap[e] = (EdgeID)edgeIndex;
-                    m_edge.push_back(e);
-                }
-                m_edgesInTetrahedron[i][j] = edgeMap[e];
-            }
-        }
+                m_edgesInTetrahedron[i][j] = slotEdges[6*i+j];
     }
 
 }
@@ -253,48 +319,45 @@ void TetrahedronSetTopologyContainer::createTriangleSetArray()
         clearTetrahedraAroundTriangle();
     }
 
-    // create a temporary map to find redundant triangles
-    std::map<Triangle,TriangleID> triangleMap;
     helper::WriteAccessor< Data< sofa::helper::vector<Triangle> > > m_triangle = d_triangle;
     helper::ReadAccessor< Data< sofa::helper::vector<Tetrahedron> > > m_tetrahedron = d_tetrahedron;
 
-    /// create the m_edge array at the same time than it fills the m_edgesInTetrahedron array
+    /// number the faces of the tetrahedra in their order of appearance, independently of their orientation
+    sofa::helper::vector<TriangleKey> keys;
+    keys.reserve(4 * m_tetrahedron.size());
     for (size_t i=0; i<m_tetrahedron.size(); ++i)
     {
         const Tetrahedron &t = m_tetrahedron[i];
-
         for (TriangleID j=0; j<4; ++j)
-        {
-            PointID v[3];
-            for (PointID k=0; k<3; ++k)
-                v[k] = t[sofa::core::topology::trianglesOrientationInTetrahedronArray[j][k]];
+            keys.push_back(TriangleKey(t[(j+1)%4], t[(j+2)%4], t[(j+3)%4]));
+    }
 
-            // sort v such that v[0] is the smallest one
-            while ((v[0]>v[1]) || (v[0]>v[2]))
-            {
-                PointID val=v[0];
-                v[0]=v[1];
-                v[1]=v[2];
-                v[2]=val;
-            }
+    sofa::helper::vector<Index> slotTriangles;
+    sofa::helper::vector<Index> firstSlots;
+    numberKeysByFirstAppearance(keys, slotTriangles, firstSlots);
 
-            // check if a triangle with an opposite orientation already exists
-            Triangle tr = Triangle(v[0], v[2], v[1]);
+    /// each triangle takes the orientation of its first appearance
+    m_triangle.reserve(m_triangle.size() + firstSlots.size());
+    for (const Index slot : firstSlots)
+    {
+        PointID v[3];
+        getOrientedFace(m_tetrahedron[slot/4], slot%4, v);
+        m_triangle.push_back(Triangle(v[0], v[1], v[2]));
+    }
 
-            if (triangleMap.find(tr) == triangleMap.end())
-            {
-                // triangle not in triangleMap so create a new one
-                tr = Triangle(v[0], v[1], v[2]);
-                if (triangleMap.find(tr) == triangleMap.end())
-                {
-                    triangleMap[tr] = (TriangleID)m_triangle.size();
-                    m_triangle.push_back(tr);
-                }
-                else
-                {
-					msg_error() << "Duplicate triangle " << tr << " in tetra " << i <<" : " << t;
-                }
-            }
+    /// a face with the same orientation as an existing triangle is a duplicate
+    for (Index slot = 0; slot < Index(slotTriangles.size()); ++slot)
+    {
+        const Index firstSlot = firstSlots[slotTriangles[slot]];
+        if (firstSlot == slot)
+            continue;
+
+        PointID v[3], first[3];
+        getOrientedFace(m_tetrahedron[slot/4], slot%4, v);
+        getOrientedFace(m_tetrahedron[firstSlot/4], firstSlot%4, first);
+        if (v[1] == first[1])
+        {
+            msg_error() << "Duplicate triangle " << Triangle(v[0], v[1], v[2]) << " in tetra " << slot/4 <<" : " << m_tetrahedron[slot/4];
         }
     }
 }
@@ -312,6 +375,15 @@ void TetrahedronSetTopologyContainer::createTrianglesInTetrahedronArray()
 
     m_trianglesInTetrahedron.resize( getNumberOfTetrahedra());
     helper::ReadAccessor< Data< sofa::helper::vector<Tetrahedron> > > m_tetrahedron = d_tetrahedron;
+    helper::ReadAccessor< Data< sofa::helper::vector<Triangle> > > m_triangle = d_triangle;
+
+    /// sort the triangles by their vertices to find the triangles of each tetrahedron by binary search
+    sofa::helper::vector< std::pair<TriangleKey, TriangleID> > triangleKeys;
+    triangleKeys.reserve(m_triangle.size());
+    for (size_t i = 0; i < m_triangle.size(); ++i)
+        triangleKeys.push_back(std::make_pair(TriangleKey(m_triangle[i][0], m_triangle[i][1], m_triangle[i][2]), TriangleID(i)));
+    std::sort(triangleKeys.begin(), triangleKeys.end());
+
     for(size_t i = 0; i < m_tetrahedron.size(); ++i)
     {
         const Tetrahedron &t=m_tetrahedron[i];
@@ -319,9 +391,14 @@ void TetrahedronSetTopologyContainer::createTrianglesInTetrahedronArray()
         // adding triangles in the triangle list of the ith tetrahedron  i
         for (TriangleID j=0; j<4; ++j)
         {
-            TriangleID triangleIndex = getTriangleIndex(t[(j+1)%4], t[(j+2)%4], t[(j+3)%4]);
-            if (triangleIndex != InvalidID){
-                   m_trianglesInTetrahedron[i][j] = triangleIndex;
+            const TriangleKey key(t[(j+1)%4], t[(j+2)%4], t[(j+3)%4]);
+            const auto range = std::equal_range(triangleKeys.begin(), triangleKeys.end(), std::make_pair(key, TriangleID(0)),
+                                                [](const std::pair<TriangleKey, TriangleID>& a, const std::pair<TriangleKey, TriangleID>& b) { return a.first < b.first; });
+
+            msg_warning_when(range.second - range.first > 1) << "More than one triangle found for indices: [" << t[(j + 1) % 4] << "; " << t[(j + 2) % 4] << "; " << t[(j + 3) % 4] << "]";
+
+            if (range.second - range.first == 1){
+                   m_trianglesInTetrahedron[i][j] = range.first->second;
             }
             else
             {
@@ -348,6 +425,14 @@ void TetrahedronSetTopologyContainer::createTetrahedraAroundVertexArray()
     m_tetrahedraAroundVertex.resize( getNbPoints() );
     helper::ReadAccessor< Data< sofa::helper::vector<Tetrahedron> > > m_tetrahedron = d_tetrahedron;
 
+    // allocate each shell once with its final size
+    sofa::helper::vector<Index> shellSizes(getNbPoints());
+    for (size_t i = 0; i < getNumberOfTetrahedra(); ++i)
+        for (PointID j=0; j<4; ++j)
+            ++shellSizes[ m_tetrahedron[i][j] ];
+    for (size_t i = 0; i < shellSizes.size(); ++i)
+        m_tetrahedraAroundVertex[i].reserve(shellSizes[i]);
+
     for (size_t i = 0; i < getNumberOfTetrahedra(); ++i)
     {
         // adding edge i in the edge shell of both points
@@ -367,6 +452,15 @@ void TetrahedronSetTopologyContainer::createTetrahedraAroundEdgeArray ()
         createEdgesInTetrahedronArray();
 
     m_tetrahedraAroundEdge.resize(getNumberOfEdges());
+
+    // allocate each shell once with its final size
+    sofa::helper::vector<Index> shellSizes(getNumberOfEdges());
+    for (size_t i=0; i< getNumberOfTetrahedra(); ++i)
+        for (EdgeID j=0; j<6; ++j)
+            ++shellSizes[ m_edgesInTetrahedron[i][j] ];
+    for (size_t i = 0; i < shellSizes.size(); ++i)
+        m_tetrahedraAroundEdge[i].reserve(shellSizes[i]);
+
     for (size_t i=0; i< getNumberOfTetrahedra(); ++i)
     {
         // adding edge i in the edge shell of both points
@@ -417,6 +511,10 @@ void TetrahedronSetTopologyContainer::createTetrahedraAroundTriangleArray ()
 
     m_tetrahedraAroundTriangle.resize(numTriangles);
 
+    // a triangle is shared by at most two tetrahedra
+    for (size_t i=0; i<numTriangles; ++i)
+        m_tetrahedraAroundTriangle[i].reserve(2);
+
     for (size_t i=0; i<numTetra; ++i)
     {
         // adding tetrahedron i in the shell of all neighbors triangles
@@ -105,21 +105,19 @@ template <typename TopologyElementType, typename VecT>
 void TopologyDataHandler <TopologyElementType, VecT>::remove( const sofa::helper::vector<Index> &index )
 {
 		
-	container_type& data = *(m_topologyData->beginEdit());
-	if (data.size()>0) 
+    container_type& data = *(m_topologyData->beginEdit());
+    if (data.size()>0)
     {
-        Index last = Index(data.size() -1);
-
+        // The whole removal is applied at once: each removed element is destroyed, then the remaining
+        // values are moved to their final index in a single pass.
+        const sofa::core::topology::ElementsRemovalRemap remap(data.size(), index);
+        const auto& removedElements = remap.getRemovedElements();
         for (std::size_t i = 0; i < index.size(); ++i)
-		{
-			this->applyDestroyFunction( index[i], data[index[i]] );
-			this->swap( index[i], last );
-			--last;
-		}
-
-		data.resize( data.size() - index.size() );
-	}
-	m_topologyData->endEdit();
+            this->applyDestroyFunction( index[i], data[removedElements[i]] );
+
+        remap.apply(data);
+    }
+    m_topologyData->endEdit();
 }
 
 
@@ -23,6 +23,9 @@
 #include <gtest/gtest.h>
 #include <SofaBaseVisual/VisualModelImpl.h>
 #include <sofa/defaulttype/VecTypes.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/simulation/InitTasks.h>
+#include <cmath>
 
 namespace sofa {
 
@@ -38,7 +41,10 @@ struct VisualModelImpl_test : public ::testing::Test
 
 };
 
-struct StubVisualModelImpl : public component::visualmodel::VisualModelImpl {};
+struct StubVisualModelImpl : public component::visualmodel::VisualModelImpl
+{
+    simulation::TaskScheduler* getTaskScheduler() const { return m_taskScheduler; }
+};
 
 // Define the list of DataTypes to instanciate
 using testing::Types;
@@ -120,4 +126,146 @@ TEST( VisualModelImpl_test , checkThatMembersAreCorrectlyConstructed )
     ASSERT_EQ(1u, visualModel.xforms.size());
 }
 
+namespace
+{
+using component::visualmodel::VisualModelImpl;
+
+/// A bumpy grid, alternating pairs of triangles and quads, with texture coordinates.
+/// The parallel loops of VisualModelImpl split their work in ranges of 1024 elements:
+/// the grid holds enough vertices, triangles and quads to be split in several ranges
+static const std::size_t gridSize = 80;
+static const std::size_t nbGridVertices = gridSize * gridSize;
+
+void setupMesh(StubVisualModelImpl& visualModel)
+{
+    helper::vector<VisualModelImpl::Coord> positions;
+    helper::vector<VisualModelImpl::TexCoord> texcoords;
+    helper::vector<VisualModelImpl::VisualTriangle> triangles;
+    helper::vector<VisualModelImpl::VisualQuad> quads;
+    for (std::size_t j = 0; j < gridSize; ++j)
+    {
+        for (std::size_t i = 0; i < gridSize; ++i)
+        {
+            positions.push_back(VisualModelImpl::Coord(i, j, 0.3 * std::sin(0.7 * i) * std::cos(0.4 * j)));
+            texcoords.push_back(VisualModelImpl::TexCoord(float(i) / gridSize, float(j) / gridSize));
+        }
+    }
+    for (std::size_t j = 0; j + 1 < gridSize; ++j)
+    {
+        for (std::size_t i = 0; i + 1 < gridSize; ++i)
+        {
+            const VisualModelImpl::visual_index_type a = j * gridSize + i, b = a + 1, c = b + gridSize, d = a + gridSize;
+            if ((i + j) % 2 == 0)
+            {
+                triangles.push_back(VisualModelImpl::VisualTriangle(a, b, c));
+                triangles.push_back(VisualModelImpl::VisualTriangle(a, c, d));
+            }
+            else
+            {
+                quads.push_back(VisualModelImpl::VisualQuad(a, b, c, d));
+            }
+        }
+    }
+    visualModel.m_positions.setValue(positions);
+    visualModel.m_vtexcoords.setValue(texcoords);
+    visualModel.m_triangles.setValue(triangles);
+    visualModel.m_quads.setValue(quads);
+    visualModel.m_computeTangents.setValue(true);
+
+    ASSERT_LT(2048u, positions.size());
+    ASSERT_LT(2048u, triangles.size());
+    ASSERT_LT(2048u, quads.size());
+}
+
+/// The parallel computations use the scheduler of the visual model, only set by init():
+/// the scheduler is created beforehand with several threads, so that the faces are split
+void initParallel(StubVisualModelImpl& visualModel)
+{
+    simulation::TaskScheduler* taskScheduler = simulation::TaskScheduler::getInstance();
+    if (taskScheduler->getThreadCount() < 2)
+    {
+        taskScheduler->init(4);
+        simulation::initThreadLocalData();
+    }
+    visualModel.d_parallel.setValue(true);
+    visualModel.init();
+    ASSERT_EQ(taskScheduler, visualModel.getTaskScheduler());
+    ASSERT_LT(1u, taskScheduler->getThreadCount());
+}
+}
+
+TEST( VisualModelImpl_test , parallelNormalsAndTangentsMatchSequential )
+{
+    StubVisualModelImpl sequential;
+    StubVisualModelImpl parallel;
+    setupMesh(sequential);
+    setupMesh(parallel);
+    initParallel(parallel);
+
+    for (StubVisualModelImpl* visualModel : { &sequential, &parallel })
+    {
+        visualModel->computeNormals();
+        visualModel->computeTangents();
+    }
+
+    ASSERT_EQ(nbGridVertices, parallel.getVnormals().size());
+    ASSERT_EQ(nbGridVertices, parallel.getVtangents().size());
+    for (std::size_t i = 0; i < nbGridVertices; ++i)
+    {
+        EXPECT_EQ(sequential.getVnormals()[i], parallel.getVnormals()[i]);
+        EXPECT_EQ(sequential.getVtangents()[i], parallel.getVtangents()[i]);
+        EXPECT_EQ(sequential.getVbitangents()[i], parallel.getVbitangents()[i]);
+    }
+}
+
+TEST( VisualModelImpl_test , normalsAreOnlyRecomputedWhenPositionsChange )
+{
+    for (bool useParallel : { false, true })
+    {
+        StubVisualModelImpl visualModel;
+        setupMesh(visualModel);
+        if (useParallel)
+            initParallel(visualModel);
+
+        visualModel.computeNormals();
+        const int counter = visualModel.m_vnormals.getCounter();
+        visualModel.computeNormals();
+        EXPECT_EQ(counter, visualModel.m_vnormals.getCounter());
+
+        const VisualModelImpl::Deriv before = visualModel.getVnormals()[4];
+        {
+            helper::WriteAccessor< Data<VisualModelImpl::VecCoord> > x = visualModel.m_positions;
+            x[4][2] += 1;
+        }
+        visualModel.computeNormals();
+        EXPECT_NE(counter, visualModel.m_vnormals.getCounter());
+        EXPECT_NE(before, visualModel.getVnormals()[4]);
+    }
+}
+
+TEST( VisualModelImpl_test , parallelNormalsWithVertexNormalIndices )
+{
+    StubVisualModelImpl sequential;
+    StubVisualModelImpl parallel;
+    for (StubVisualModelImpl* visualModel : { &sequential, &parallel })
+    {
+        setupMesh(*visualModel);
+        // the vertices of the last row share the normals of the first row
+        helper::vector<VisualModelImpl::visual_index_type> vertNormIdx(nbGridVertices);
+        for (std::size_t i = 0; i < nbGridVertices; ++i)
+            vertNormIdx[i] = (i < nbGridVertices - gridSize) ? i : i - (nbGridVertices - gridSize);
+        visualModel->m_vertNormIdx.setValue(vertNormIdx);
+    }
+    initParallel(parallel);
+
+    sequential.computeNormals();
+    parallel.computeNormals();
+
+    ASSERT_EQ(nbGridVertices, parallel.getVnormals().size());
+    for (std::size_t i = 0; i < nbGridVertices; ++i)
+        EXPECT_EQ(sequential.getVnormals()[i], parallel.getVnormals()[i]);
+    for (std::size_t i = 0; i < gridSize; ++i)
+        EXPECT_EQ(parallel.getVnormals()[i], parallel.getVnormals()[nbGridVertices - gridSize + i]);
+}
+
 } //sofa
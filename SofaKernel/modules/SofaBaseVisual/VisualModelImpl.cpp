@@ -42,6 +42,9 @@
 #include <sofa/helper/io/MeshOBJ.h>
 #include <sofa/helper/rmath.h>
 #include <sofa/helper/accessor.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/simulation/InitTasks.h>
+#include <sofa/simulation/ParallelForEach.h>
 #include <sstream>
 #include <map>
 #include <memory>
@@ -193,6 +196,7 @@ VisualModelImpl::VisualModelImpl() //const std::string &name, std::string filena
     , m_handleDynamicTopology (initData   (&m_handleDynamicTopology, true, "handleDynamicTopology", "True if topological changes should be handled"))
     , m_fixMergedUVSeams (initData   (&m_fixMergedUVSeams, true, "fixMergedUVSeams", "True if UV seams should be handled even when duplicate UVs are merged"))
     , m_keepLines (initData   (&m_keepLines, false, "keepLines", "keep and draw lines (false by default)"))
+    , d_parallel (initData   (&d_parallel, false, "parallel", "Compute the normals and tangents in parallel with the task scheduler, gathering the contributions of the faces around each vertex"))
     , m_vertices2       (initData   (&m_vertices2, "vertices", "vertices of the model (only if vertices have multiple normals/texcoords, otherwise positions are used)"))
     , m_vtexcoords      (initData   (&m_vtexcoords, "texcoords", "coordinates of the texture"))
     , m_vtangents       (initData   (&m_vtangents, "tangents", "tangents for normal mapping"))
@@ -905,21 +909,99 @@ void VisualModelImpl::init()
     m_rotation.setValue(Vec3Real());
     m_scale.setValue(Vec3Real(1,1,1));
 
+    if (d_parallel.getValue())
+    {
+        m_taskScheduler = simulation::TaskScheduler::getInstance();
+        if (m_taskScheduler->getThreadCount() < 1)
+        {
+            m_taskScheduler->init(0);
+            simulation::initThreadLocalData();
+        }
+    }
+
     VisualModel::init();
     updateVisual();
 }
 
+VisualModelImpl::DataCounters VisualModelImpl::getDataCounters(std::initializer_list<const core::objectmodel::BaseData*> datas)
+{
+    DataCounters counters;
+    counters.reserve(datas.size());
+    for (const core::objectmodel::BaseData* data : datas)
+    {
+        data->updateIfDirty();
+        counters.push_back(data->getCounter());
+    }
+    return counters;
+}
+
+void VisualModelImpl::updateVertexFaces(VertexFaces& vertexFaces, std::size_t nbVertices, const Data< helper::vector<visual_index_type> >* keys)
+{
+    DataCounters counters = keys ? getDataCounters({&m_triangles, &m_quads, keys}) : getDataCounters({&m_triangles, &m_quads});
+    if (counters == vertexFaces.counters && vertexFaces.nbVertices == nbVertices)
+        return;
+
+    const VecVisualTriangle& triangles = m_triangles.getValue();
+    const VecVisualQuad& quads = m_quads.getValue();
+    const helper::vector<visual_index_type>* vertexKeys = keys ? &keys->getValue() : nullptr;
+
+    std::size_t nbKeys = nbVertices;
+    if (vertexKeys)
+    {
+        nbKeys = 0;
+        for (visual_index_type k : *vertexKeys)
+            nbKeys = std::max<std::size_t>(nbKeys, k+1);
+    }
+    auto key = [&](visual_index_type v) -> std::size_t { return vertexKeys ? (*vertexKeys)[v] : v; };
+
+    // count the faces of each key, then fill them in face order so that the
+    // contributions are summed in the same order as the sequential loops
+    helper::vector<Size>& begin = vertexFaces.begin;
+    helper::vector<Size>& faces = vertexFaces.faces;
+    begin.assign(nbKeys+1, 0);
+    for (const VisualTriangle& t : triangles)
+        for (visual_index_type v : t)
+            ++begin[key(v)+1];
+    for (const VisualQuad& q : quads)
+        for (visual_index_type v : q)
+            ++begin[key(v)+1];
+    for (std::size_t k = 0; k < nbKeys; ++k)
+        begin[k+1] += begin[k];
+
+    faces.resize(begin[nbKeys]);
+    helper::vector<Size> next(begin.begin(), begin.end()-1);
+    const Size nbTriangles = Size(triangles.size());
+    for (Size i = 0; i < nbTriangles; ++i)
+        for (visual_index_type v : triangles[i])
+            faces[next[key(v)]++] = i;
+    for (Size i = 0; i < Size(quads.size()); ++i)
+        for (Size c = 0; c < 4; ++c)
+            faces[next[key(quads[i][c])]++] = nbTriangles + 4*i + c;
+
+    vertexFaces.counters = counters;
+    vertexFaces.nbVertices = Size(nbVertices);
+}
+
 void VisualModelImpl::computeNormals()
 {
     const VecCoord& vertices = getVertices();
     //const VecCoord& vertices = m_vertices2.getValue();
     if (vertices.empty() || (!m_updateNormals.getValue() && (m_vnormals.getValue()).size() == (vertices).size())) return;
 
+    // nothing to do if neither the positions nor the faces changed since the last computation
+    const DataCounters counters = getDataCounters({&m_positions, &m_vertices2, &m_triangles, &m_quads, &m_vertNormIdx, &m_vnormals});
+    if (counters == m_normalsCounters && m_vnormals.getValue().size() == vertices.size())
+        return;
+
     const VecVisualTriangle& triangles = m_triangles.getValue();
     const VecVisualQuad& quads = m_quads.getValue();
     const helper::vector<visual_index_type> &vertNormIdx = m_vertNormIdx.getValue();
 
-    if (vertNormIdx.empty())
+    if (d_parallel.getValue())
+    {
+        computeNormalsParallel(vertices);
+    }
+    else if (vertNormIdx.empty())
     {
         std::size_t nbn = vertices.size();
 
@@ -1019,6 +1101,75 @@ void VisualModelImpl::computeNormals()
         }
         m_vnormals.endEdit();
     }
+
+    m_normalsCounters = getDataCounters({&m_positions, &m_vertices2, &m_triangles, &m_quads, &m_vertNormIdx, &m_vnormals});
+}
+
+void VisualModelImpl::computeNormalsParallel(const VecCoord& vertices)
+{
+    const VecVisualTriangle& triangles = m_triangles.getValue();
+    const VecVisualQuad& quads = m_quads.getValue();
+    const bool useNormIdx = !m_vertNormIdx.getValue().empty();
+    const std::size_t nbTriangles = triangles.size();
+
+    updateVertexFaces(m_normalFaces, vertices.size(), useNormIdx ? &m_vertNormIdx : nullptr);
+
+    // contribution of each face, in the same order as the triangle and quad corners in m_normalFaces
+    m_faceNormals.resize(nbTriangles + 4*quads.size());
+    simulation::parallelForEachRange(m_taskScheduler, 0, nbTriangles, [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            const Coord& v1 = vertices[triangles[i][0]];
+            const Coord& v2 = vertices[triangles[i][1]];
+            const Coord& v3 = vertices[triangles[i][2]];
+            m_faceNormals[i] = cross(v2-v1, v3-v1);
+        }
+    }, 1024);
+    simulation::parallelForEachRange(m_taskScheduler, 0, quads.size(), [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            const Coord & v1 = vertices[quads[i][0]];
+            const Coord & v2 = vertices[quads[i][1]];
+            const Coord & v3 = vertices[quads[i][2]];
+            const Coord & v4 = vertices[quads[i][3]];
+            Coord* n = &m_faceNormals[nbTriangles + 4*i];
+            n[0] = cross(v2-v1, v4-v1);
+            n[1] = cross(v3-v2, v1-v2);
+            n[2] = cross(v4-v3, v2-v3);
+            n[3] = cross(v1-v4, v3-v4);
+        }
+    }, 1024);
+
+    // gather the contributions of the faces around each vertex, or each normal index
+    const std::size_t nbKeys = m_normalFaces.begin.size() - 1;
+    VecDeriv& vnormals = *(m_vnormals.beginEdit());
+    vnormals.resize(vertices.size());
+    VecCoord& normals = useNormIdx ? m_indexNormals : vnormals;
+    normals.resize(nbKeys);
+    simulation::parallelForEachRange(m_taskScheduler, 0, nbKeys, [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t k = begin; k < end; ++k)
+        {
+            Coord n;
+            for (Size f = m_normalFaces.begin[k]; f < m_normalFaces.begin[k+1]; ++f)
+                n += m_faceNormals[m_normalFaces.faces[f]];
+            n.normalize();
+            normals[k] = n;
+        }
+    }, 1024);
+
+    if (useNormIdx)
+    {
+        const helper::vector<visual_index_type>& vertNormIdx = m_vertNormIdx.getValue();
+        simulation::parallelForEachRange(m_taskScheduler, 0, vertices.size(), [&](std::size_t begin, std::size_t end)
+        {
+            for (std::size_t i = begin; i < end; ++i)
+                vnormals[i] = m_indexNormals[vertNormIdx[i]];
+        }, 1024);
+    }
+    m_vnormals.endEdit();
 }
 
 VisualModelImpl::Coord VisualModelImpl::computeTangent(const Coord &v1, const Coord &v2, const Coord &v3,
@@ -1044,8 +1195,21 @@ void VisualModelImpl::computeTangents()
     const VecVisualTriangle& triangles = m_triangles.getValue();
     const VecVisualQuad& quads = m_quads.getValue();
     const VecCoord& vertices = getVertices();
+
+    // nothing to do if neither the positions, the normals nor the faces changed since the last computation
+    const DataCounters counters = getDataCounters({&m_positions, &m_vertices2, &m_triangles, &m_quads, &m_vnormals, &m_vtexcoords, &m_fixMergedUVSeams, &m_vtangents, &m_vbitangents});
+    if (counters == m_tangentsCounters)
+        return;
+
+    if (d_parallel.getValue())
+    {
+        computeTangentsParallel(vertices);
+        m_tangentsCounters = getDataCounters({&m_positions, &m_vertices2, &m_triangles, &m_quads, &m_vnormals, &m_vtexcoords, &m_fixMergedUVSeams, &m_vtangents, &m_vbitangents});
+        return;
+    }
+
     const VecTexCoord& texcoords = m_vtexcoords.getValue();
-    VecCoord& normals = *(m_vnormals.beginEdit());
+    const VecCoord& normals = m_vnormals.getValue();
     VecCoord& tangents = *(m_vtangents.beginEdit());
     VecCoord& bitangents = *(m_vbitangents.beginEdit());
 
@@ -1129,6 +1293,93 @@ void VisualModelImpl::computeTangents()
     }
     m_vtangents.endEdit();
     m_vbitangents.endEdit();
+
+    m_tangentsCounters = getDataCounters({&m_positions, &m_vertices2, &m_triangles, &m_quads, &m_vnormals, &m_vtexcoords, &m_fixMergedUVSeams, &m_vtangents, &m_vbitangents});
+}
+
+void VisualModelImpl::computeTangentsParallel(const VecCoord& vertices)
+{
+    const VecVisualTriangle& triangles = m_triangles.getValue();
+    const VecVisualQuad& quads = m_quads.getValue();
+    const VecTexCoord& texcoords = m_vtexcoords.getValue();
+    const VecCoord& normals = m_vnormals.getValue();
+    const bool fixMergedUVSeams = m_fixMergedUVSeams.getValue();
+    const std::size_t nbTriangles = triangles.size();
+
+    // without vertNormIdx, the faces around each vertex are the ones used for the normals
+    VertexFaces* vertexFaces = &m_normalFaces;
+    if (!m_vertNormIdx.getValue().empty())
+        vertexFaces = &m_tangentFaces;
+    updateVertexFaces(*vertexFaces, vertices.size(), nullptr);
+
+    // The bitangents are recomputed from the normals and tangents, only the tangents are accumulated
+    m_faceTangents.resize(nbTriangles + 4*quads.size());
+    simulation::parallelForEachRange(m_taskScheduler, 0, nbTriangles, [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            const Coord v1 = vertices[triangles[i][0]];
+            const Coord v2 = vertices[triangles[i][1]];
+            const Coord v3 = vertices[triangles[i][2]];
+            TexCoord t1 = texcoords[triangles[i][0]];
+            TexCoord t2 = texcoords[triangles[i][1]];
+            TexCoord t3 = texcoords[triangles[i][2]];
+            if (fixMergedUVSeams)
+            {
+                for (Size j=0; j<t1.size(); ++j)
+                {
+                    t2[j] += helper::rnear(t1[j]-t2[j]);
+                    t3[j] += helper::rnear(t1[j]-t3[j]);
+                }
+            }
+            m_faceTangents[i] = computeTangent(v1, v2, v3, t1, t2, t3);
+        }
+    }, 1024);
+    simulation::parallelForEachRange(m_taskScheduler, 0, quads.size(), [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            const Coord & v1 = vertices[quads[i][0]];
+            const Coord & v2 = vertices[quads[i][1]];
+            const Coord & v3 = vertices[quads[i][2]];
+            const Coord & v4 = vertices[quads[i][3]];
+            const TexCoord t1 = texcoords[quads[i][0]];
+            const TexCoord t2 = texcoords[quads[i][1]];
+            const TexCoord t3 = texcoords[quads[i][2]];
+            const TexCoord t4 = texcoords[quads[i][3]];
+
+            Coord t123 = computeTangent(v1, v2, v3, t1, t2, t3);
+            Coord t234 = computeTangent(v2, v3, v4, t2, t3, t4);
+            Coord t341 = computeTangent(v3, v4, v1, t3, t4, t1);
+            Coord t412 = computeTangent(v4, v1, v2, t4, t1, t2);
+
+            Coord* t = &m_faceTangents[nbTriangles + 4*i];
+            t[0] = t123        + t341 + t412;
+            t[1] = t123 + t234        + t412;
+            t[2] = t123 + t234 + t341;
+            t[3] =        t234 + t341 + t412;
+        }
+    }, 1024);
+
+    VecCoord& tangents = *(m_vtangents.beginEdit());
+    VecCoord& bitangents = *(m_vbitangents.beginEdit());
+    tangents.resize(vertices.size());
+    bitangents.resize(vertices.size());
+    simulation::parallelForEachRange(m_taskScheduler, 0, vertices.size(), [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            Coord t;
+            for (Size f = vertexFaces->begin[i]; f < vertexFaces->begin[i+1]; ++f)
+                t += m_faceTangents[vertexFaces->faces[f]];
+
+            const Coord& n = normals[i];
+            bitangents[i] = sofa::defaulttype::cross(n, t.normalized());
+            tangents[i] = sofa::defaulttype::cross(bitangents[i], n);
+        }
+    }, 1024);
+    m_vtangents.endEdit();
+    m_vbitangents.endEdit();
 }
 
 void VisualModelImpl::computeBBox(const core::ExecParams*, bool)
@@ -1324,14 +1575,23 @@ void VisualModelImpl::computePositions()
 
     if (!vertPosIdx.empty())
     {
+        // nothing to transfer if the positions did not change since the last transfer
+        const DataCounters counters = getDataCounters({&m_positions, &m_vertPosIdx, &m_vertices2});
+        if (counters == m_positionsCounters)
+            return;
+
         // Need to transfer positions
         VecCoord& vertices = *(m_vertices2.beginEdit());
         const VecCoord& positions = this->m_positions.getValue();
 
-        for (std::size_t i=0 ; i < vertices.size(); ++i)
-            vertices[i] = positions[vertPosIdx[i]];
+        simulation::parallelForEachRange(m_taskScheduler, 0, vertices.size(), [&](std::size_t begin, std::size_t end)
+        {
+            for (std::size_t i = begin; i < end; ++i)
+                vertices[i] = positions[vertPosIdx[i]];
+        }, 1024);
 
         m_vertices2.endEdit();
+        m_positionsCounters = getDataCounters({&m_positions, &m_vertPosIdx, &m_vertices2});
     }
 }
 
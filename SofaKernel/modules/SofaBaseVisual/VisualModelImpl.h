@@ -39,6 +39,11 @@
 namespace sofa
 {
 
+namespace simulation
+{
+    class TaskScheduler;
+}
+
 namespace component
 {
 
@@ -122,6 +127,7 @@ public:
     Data<bool> m_handleDynamicTopology; ///< True if topological changes should be handled
     Data<bool> m_fixMergedUVSeams; ///< True if UV seams should be handled even when duplicate UVs are merged
     Data<bool> m_keepLines; ///< keep and draw lines (false by default)
+    Data<bool> d_parallel; ///< Compute the normals and tangents in parallel, gathering the contributions of the faces around each vertex
 
     Data< VecCoord > m_vertices2; ///< vertices of the model (only if vertices have multiple normals/texcoords, otherwise positions are used)
     topology::PointData< VecTexCoord > m_vtexcoords; ///< coordinates of the texture
@@ -427,6 +433,40 @@ public:
 
     bool insertInNode( core::objectmodel::BaseNode* node ) override { Inherit1::insertInNode(node); Inherit2::insertInNode(node); return true; }
     bool removeInNode( core::objectmodel::BaseNode* node ) override { Inherit1::removeInNode(node); Inherit2::removeInNode(node); return true; }
+
+protected:
+    /// Counters of the Data read and written by a computation, used to skip it when none of them changed
+    typedef helper::vector<int> DataCounters;
+    static DataCounters getDataCounters(std::initializer_list<const core::objectmodel::BaseData*> datas);
+
+    DataCounters m_positionsCounters;
+    DataCounters m_normalsCounters;
+    DataCounters m_tangentsCounters;
+
+    /// Faces around each vertex or normal index, in compressed sparse row format.
+    /// Triangle i is referred to as i, and the corner c of quad i as nbTriangles + 4*i + c,
+    /// which are the indices of their contributions in m_faceNormals and m_faceTangents.
+    struct VertexFaces
+    {
+        helper::vector<Size> begin; ///< first face of each vertex, followed by the total number of faces
+        helper::vector<Size> faces;
+        DataCounters counters; ///< counters of the faces and indices it was built from
+        Size nbVertices {0};
+    };
+
+    /// Update vertexFaces if the faces changed. With keys, the faces of the vertex v are stored for the index keys[v].
+    void updateVertexFaces(VertexFaces& vertexFaces, std::size_t nbVertices, const Data< helper::vector<visual_index_type> >* keys);
+
+    void computeNormalsParallel(const VecCoord& vertices);
+    void computeTangentsParallel(const VecCoord& vertices);
+
+    VertexFaces m_normalFaces; ///< faces around each normal index
+    VertexFaces m_tangentFaces; ///< faces around each vertex, only used with vertNormIdx
+    VecCoord m_faceNormals; ///< contribution of each triangle and quad corner to the normals
+    VecCoord m_faceTangents; ///< contribution of each triangle and quad corner to the tangents
+    VecCoord m_indexNormals; ///< normals of each normal index, with vertNormIdx
+
+    simulation::TaskScheduler* m_taskScheduler {nullptr};
 };
 
 
@@ -21,9 +21,16 @@
 ******************************************************************************/
 #include <sofa/core/loader/MeshLoader.h>
 
+#include <sofa/core/loader/MeshCache.h>
+
 #include <sofa/helper/testing/BaseTest.h>
 using sofa::helper::testing::BaseTest ;
 
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
 namespace sofa {
 
 using namespace core::loader;
@@ -101,4 +108,161 @@ TEST_F(MeshLoader_test, createSubElements)
 
 }
 
+/// Loader generating a mesh from the number of points written in its file, and counting the calls to doLoad
+class MeshCacheTestLoader : public MeshLoader
+{
+public:
+    SOFA_CLASS(MeshCacheTestLoader, MeshLoader);
+
+    Data<SReal> d_offset;
+    int m_nbLoads {0};
+    bool m_throw {false};
+
+    using MeshLoader::getCacheFilename;
+
+    MeshCacheTestLoader()
+        : d_offset(initData(&d_offset, SReal(0), "offset", "Offset of the positions"))
+    {}
+
+    bool doLoad() override
+    {
+        if (m_throw)
+            throw std::runtime_error("cannot load");
+
+        std::ifstream file(m_filename.getFullPath().c_str());
+        unsigned int n = 0;
+        if (!(file >> n))
+            return false;
+        ++m_nbLoads;
+
+        auto positions = getWriteOnlyAccessor(d_positions);
+        auto triangles = getWriteOnlyAccessor(d_triangles);
+        auto polygons = getWriteOnlyAccessor(d_polygons);
+        auto groups = getWriteOnlyAccessor(d_trianglesGroups);
+        for (unsigned int i = 0; i < n; ++i)
+        {
+            positions.push_back(sofa::defaulttype::Vector3(i + d_offset.getValue(), 0.5 * i, 0));
+            if (i + 2 < n)
+                triangles.push_back(Triangle(i, i + 1, i + 2));
+            polygons.push_back(helper::vector<Topology::ElemID>(std::size_t(i % 5), Topology::ElemID(i)));
+        }
+        groups.push_back(PrimitiveGroup(0, 1, "", "first group", -1));
+        groups.push_back(PrimitiveGroup(1, n - 3, "material", "", 2));
+        return true;
+    }
+
+    void doClearBuffers() override {}
+};
+
+class MeshCache_test : public BaseTest
+{
+protected:
+    void SetUp() override
+    {
+        m_directory = boost::filesystem::temp_directory_path().string() + "/MeshCache_test";
+        m_sourceFilename = m_directory + "/mesh.txt";
+        boost::filesystem::create_directories(m_directory);
+        writeSource(10);
+    }
+
+    void TearDown() override
+    {
+        boost::filesystem::remove_all(m_directory);
+    }
+
+    void writeSource(unsigned int n)
+    {
+        std::ofstream file(m_sourceFilename.c_str());
+        file << n << "\n";
+    }
+
+    MeshCacheTestLoader::SPtr createLoader()
+    {
+        MeshCacheTestLoader::SPtr loader = sofa::core::objectmodel::New<MeshCacheTestLoader>();
+        loader->d_useCache.setValue(true);
+        loader->d_cacheDirectory.setValue(m_directory + "/cache");
+        loader->setFilename(m_sourceFilename);
+        return loader;
+    }
+
+    std::string m_directory;
+    std::string m_sourceFilename;
+};
+
+TEST_F(MeshCache_test, writeAndRead)
+{
+    MeshCacheTestLoader::SPtr loader = createLoader();
+    ASSERT_TRUE(loader->load());
+    EXPECT_EQ(1, loader->m_nbLoads);
+    EXPECT_TRUE(boost::filesystem::exists(loader->getCacheFilename()));
+    // no temporary file is left
+    EXPECT_EQ(1, std::distance(boost::filesystem::directory_iterator(m_directory + "/cache"), boost::filesystem::directory_iterator()));
+
+    MeshCache cache;
+    ASSERT_TRUE(cache.open(loader->getCacheFilename()));
+    const helper::vector<std::string>& names = cache.getDataNames();
+    EXPECT_NE(names.end(), std::find(names.begin(), names.end(), "position"));
+    EXPECT_NE(names.end(), std::find(names.begin(), names.end(), "polygons"));
+    EXPECT_EQ(names.end(), std::find(names.begin(), names.end(), "offset"));
+    cache.close();
+
+    MeshCacheTestLoader::SPtr cachedLoader = createLoader();
+    ASSERT_TRUE(cachedLoader->load());
+    EXPECT_EQ(0, cachedLoader->m_nbLoads);
+
+    EXPECT_EQ(loader->d_positions.getValue(), cachedLoader->d_positions.getValue());
+    ASSERT_EQ(8u, cachedLoader->d_triangles.getValue().size());
+    EXPECT_EQ(7u, cachedLoader->d_triangles.getValue()[7][0]);
+    EXPECT_EQ(9u, cachedLoader->d_triangles.getValue()[7][2]);
+    EXPECT_EQ(loader->d_polygons.getValue(), cachedLoader->d_polygons.getValue());
+    const helper::vector<PrimitiveGroup>& groups = cachedLoader->d_trianglesGroups.getValue();
+    ASSERT_EQ(2u, groups.size());
+    EXPECT_EQ("first group", groups[0].groupName);
+    EXPECT_EQ("", groups[0].materialName);
+    EXPECT_EQ("", groups[1].groupName);
+    EXPECT_EQ("material", groups[1].materialName);
+    EXPECT_EQ(7, groups[1].nbp);
+    EXPECT_EQ(2, groups[1].materialId);
+}
+
+TEST_F(MeshCache_test, invalidation)
+{
+    ASSERT_TRUE(createLoader()->load());
+
+    // a parameter of the loader changes
+    MeshCacheTestLoader::SPtr loader = createLoader();
+    loader->d_offset.setValue(2);
+    ASSERT_TRUE(loader->load());
+    EXPECT_EQ(1, loader->m_nbLoads);
+    EXPECT_EQ(2, loader->d_positions.getValue()[0][0]);
+
+    // the transformation is applied after the loading
+    loader = createLoader();
+    loader->d_offset.setValue(2);
+    loader->d_translation.setValue(sofa::defaulttype::Vector3(1, 2, 3));
+    ASSERT_TRUE(loader->load());
+    EXPECT_EQ(0, loader->m_nbLoads);
+
+    // the source file changes, keeping the same size and (probably) the same modification time
+    writeSource(12);
+    loader = createLoader();
+    loader->d_offset.setValue(2);
+    ASSERT_TRUE(loader->load());
+    EXPECT_EQ(1, loader->m_nbLoads);
+    EXPECT_EQ(12u, loader->d_positions.getValue().size());
+}
+
+TEST_F(MeshCache_test, loadAfterException)
+{
+    MeshCacheTestLoader::SPtr loader = createLoader();
+    loader->m_throw = true;
+    EXPECT_THROW(loader->load(), std::runtime_error);
+
+    // the loader is not left in the loading state
+    loader->m_throw = false;
+    ASSERT_TRUE(loader->load());
+    EXPECT_EQ(1, loader->m_nbLoads);
+    EXPECT_EQ(10u, loader->d_positions.getValue().size());
+}
+
 }// namespace sofa
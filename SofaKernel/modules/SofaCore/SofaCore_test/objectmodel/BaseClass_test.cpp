@@ -28,6 +28,11 @@ using sofa::core::objectmodel::BaseObject ;
 #include <sofa/helper/testing/BaseTest.h>
 using sofa::helper::testing::BaseTest ;
 
+#include <sofa/core/objectmodel/NameRegistry.h>
+using sofa::core::objectmodel::NameRegistry ;
+using sofa::core::objectmodel::BaseLink ;
+using sofa::core::objectmodel::Data ;
+
 namespace sofa{
 namespace another_namespace{
 
@@ -85,6 +90,24 @@ public:
 }
 }
 
+class ObjectWithFields : public BaseObject
+{
+public:
+    SOFA_CLASS(ObjectWithFields, BaseObject) ;
+
+    Data<int> d_first;
+    Data<int> d_second;
+    sofa::core::objectmodel::SingleLink<ObjectWithFields, BaseObject, BaseLink::FLAG_NONE> l_target;
+
+    ObjectWithFields()
+        : d_first(initData(&d_first, 1, "first", "first Data"))
+        , d_second(initData(&d_second, 2, "second", "second Data"))
+        , l_target(initLink("target", "a link"))
+    {
+        addAlias(&d_second, "secondAlias");
+    }
+};
+
 class DataOne { public: static std::string Name(){ return "One" ;} };
 class DataTwo { public: static std::string Name(){ return "Two" ;} };
 class NotAType {};
@@ -238,3 +261,32 @@ TEST_F(BaseClass_test, checkStaticGetCustomClassNameOldWay  )
     ASSERT_EQ(sofa::helper::NameDecoder::getClassName<sofa::numbered_namespace_123::CustomNameOldWay>(),"ClassWithACustomNameOldWay") ;
 }
 
+TEST_F(BaseClass_test, findFieldsThroughClassIndex)
+{
+    Data<int> extra;
+    ObjectWithFields a;
+    ObjectWithFields b;
+
+    EXPECT_EQ(a.findData("first"), &a.d_first) ;
+    EXPECT_EQ(a.findData("second"), &a.d_second) ;
+    EXPECT_EQ(a.findData("secondAlias"), &a.d_second) ;
+    EXPECT_EQ(a.findLink("target"), &a.l_target) ;
+    EXPECT_EQ(a.findData("target"), nullptr) ;
+    EXPECT_EQ(a.findData("aNameNoFieldHasEverHad"), nullptr) ;
+    EXPECT_EQ(a.getClass()->getDataIndex().find(NameRegistry::find("second")),
+              unsigned(std::find(a.getDataFields().begin(), a.getDataFields().end(), &a.d_second) - a.getDataFields().begin())) ;
+
+    /// the positions learned with a are used for b
+    EXPECT_EQ(b.findData("first"), &b.d_first) ;
+    EXPECT_EQ(b.findData("second"), &b.d_second) ;
+    EXPECT_EQ(b.findLink("target"), &b.l_target) ;
+
+    /// Data specific to one instance shift the positions
+    b.removeData(&b.d_first) ;
+    b.addData(&extra, "extra") ;
+    EXPECT_EQ(b.findData("first"), nullptr) ;
+    EXPECT_EQ(b.findData("second"), &b.d_second) ;
+    EXPECT_EQ(b.findData("extra"), &extra) ;
+    EXPECT_EQ(a.findData("extra"), nullptr) ;
+    EXPECT_EQ(a.findData("second"), &a.d_second) ;
+}
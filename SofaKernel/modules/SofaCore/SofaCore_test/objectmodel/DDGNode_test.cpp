@@ -183,3 +183,93 @@ TEST_F(DDGNode_test, propagationScenario3)
     EXPECT_EQ(m_ddgnode1.m_cpt, 1);
     EXPECT_EQ(m_ddgnode2.m_cpt, 1);
 }
+
+/// Node counting the notifications and propagating them
+class DDGNodeNotifyTestClass : public DDGNode
+{
+public:
+    int m_cptNotify {0};
+
+    void update() override {}
+    void notifyEndEdit() override
+    {
+        m_cptNotify++;
+        DDGNode::notifyEndEdit();
+    }
+};
+
+class DDGNodeNotify_test: public BaseTest
+{
+public:
+    /// diamond: a -> b -> d, a -> c -> d
+    DDGNodeNotifyTestClass a, b, c, d;
+
+    void SetUp() override
+    {
+        b.addInput(&a);
+        c.addInput(&a);
+        d.addInput(&b);
+        d.addInput(&c);
+        DDGNode::resetPropagationCounters();
+    }
+};
+
+TEST_F(DDGNodeNotify_test, notifyOncePerPath)
+{
+    a.notifyEndEdit();
+    EXPECT_EQ(b.m_cptNotify, 1);
+    EXPECT_EQ(c.m_cptNotify, 1);
+    EXPECT_EQ(d.m_cptNotify, 1);
+
+    EXPECT_EQ(DDGNode::getPropagationCounters().notifyWalks, 1u);
+    EXPECT_EQ(DDGNode::getPropagationCounters().notifyVisits, 3u);
+    EXPECT_EQ(DDGNode::getPropagationCounters().notifySkips, 1u);
+
+    // a new modification notifies again
+    a.notifyEndEdit();
+    EXPECT_EQ(d.m_cptNotify, 2);
+}
+
+TEST_F(DDGNodeNotify_test, editBatch)
+{
+    DDGNode::beginEditBatch();
+    a.notifyEndEdit();
+    DDGNode::beginEditBatch();
+    a.notifyEndEdit();
+    DDGNode::endEditBatch();
+    EXPECT_EQ(b.m_cptNotify, 0);
+    EXPECT_EQ(d.m_cptNotify, 0);
+    DDGNode::endEditBatch();
+
+    EXPECT_EQ(b.m_cptNotify, 1);
+    EXPECT_EQ(c.m_cptNotify, 1);
+    EXPECT_EQ(d.m_cptNotify, 1);
+    EXPECT_EQ(DDGNode::getPropagationCounters().notifyWalks, 1u);
+
+    // b and c are modified (the counters include these calls), d is notified once
+    {
+        sofa::core::objectmodel::ScopedEditBatch batch;
+        b.notifyEndEdit();
+        c.notifyEndEdit();
+    }
+    EXPECT_EQ(b.m_cptNotify, 2);
+    EXPECT_EQ(d.m_cptNotify, 2);
+}
+
+TEST_F(DDGNodeNotify_test, dirtyPropagationCounters)
+{
+    d.cleanDirty();
+    b.cleanDirty();
+    c.cleanDirty();
+    DDGNode::resetPropagationCounters();
+
+    a.setDirtyOutputs();
+    EXPECT_TRUE(d.isDirty());
+    const std::size_t propagations = DDGNode::getPropagationCounters().dirtyPropagations;
+    EXPECT_EQ(propagations, 3u); // a, b and c: d has no output, its flag is never cleaned
+
+    // the propagation stops at the dirty outputs
+    b.setDirtyOutputs();
+    a.setDirtyOutputs();
+    EXPECT_EQ(DDGNode::getPropagationCounters().dirtyPropagations, propagations);
+}
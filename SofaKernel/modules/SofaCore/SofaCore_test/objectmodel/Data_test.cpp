@@ -62,6 +62,64 @@ TEST_F(Data_test, getNameWithValueTypeInfo)
     EXPECT_EQ(dataVectorColor.getValueTypeInfo()->name(), "vector<RGBAColor>");
 }
 
+TEST_F(Data_test, copyOnWriteLink)
+{
+    Data<sofa::helper::vector<sofa::defaulttype::Vec3>> child;
+    dataVectorVec3.setValue(sofa::helper::vector<sofa::defaulttype::Vec3>(1000, sofa::defaulttype::Vec3(1, 2, 3)));
+    child.setParent(&dataVectorVec3);
+
+    // the linked Data share the memory of the parent
+    EXPECT_EQ(&dataVectorVec3.getValue(), &child.getValue());
+
+    // the modified Data gets its own copy
+    child.beginEdit()->front() = sofa::defaulttype::Vec3(4, 5, 6);
+    child.endEdit();
+    EXPECT_NE(&dataVectorVec3.getValue(), &child.getValue());
+    EXPECT_EQ(sofa::defaulttype::Vec3(1, 2, 3), dataVectorVec3.getValue().front());
+    EXPECT_EQ(sofa::defaulttype::Vec3(4, 5, 6), child.getValue().front());
+}
+
+TEST_F(Data_test, setValueOnSharedValue)
+{
+    Data<sofa::helper::vector<sofa::defaulttype::Vec3>> child;
+    dataVectorVec3.setValue(sofa::helper::vector<sofa::defaulttype::Vec3>(1000, sofa::defaulttype::Vec3(1, 2, 3)));
+    child.setParent(&dataVectorVec3);
+    const int counter = child.getCounter();
+    EXPECT_EQ(1000u, child.getValue().size());
+
+    // setting the parent does not modify the value shared by its child until it is updated
+    sofa::helper::vector<sofa::defaulttype::Vec3> value(10, sofa::defaulttype::Vec3(7, 8, 9));
+    dataVectorVec3.setValue(std::move(value));
+    EXPECT_EQ(10u, dataVectorVec3.getValue().size());
+    EXPECT_EQ(10u, child.getValue().size());
+    EXPECT_EQ(&dataVectorVec3.getValue(), &child.getValue());
+    EXPECT_LT(counter, child.getCounter());
+
+    child.setValue(sofa::helper::vector<sofa::defaulttype::Vec3>(3));
+    EXPECT_EQ(10u, dataVectorVec3.getValue().size());
+    EXPECT_EQ(3u, child.getValue().size());
+}
+
+TEST_F(Data_test, getSharedValue)
+{
+    dataVectorVec3.setValue(sofa::helper::vector<sofa::defaulttype::Vec3>(5, sofa::defaulttype::Vec3(1, 2, 3)));
+    std::shared_ptr<const sofa::helper::vector<sofa::defaulttype::Vec3>> view = dataVectorVec3.getSharedValue();
+    EXPECT_EQ(&dataVectorVec3.getValue(), view.get());
+
+    // the view keeps the value it was created with
+    dataVectorVec3.beginEdit()->resize(2);
+    dataVectorVec3.endEdit();
+    EXPECT_EQ(2u, dataVectorVec3.getValue().size());
+    ASSERT_EQ(5u, view->size());
+    EXPECT_EQ(sofa::defaulttype::Vec3(1, 2, 3), view->back());
+
+    // the value is copied for types which are not shared
+    dataInt.setValue(3);
+    std::shared_ptr<const int> intView = dataInt.getSharedValue();
+    dataInt.setValue(4);
+    EXPECT_EQ(3, *intView);
+}
+
 /** Test suite for vectorData
  *
  * @author Thomas Lemaire @date 2014
@@ -0,0 +1,114 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/core/topology/TopologyChange.h>
+using sofa::core::topology::ElementsRemovalRemap;
+
+#include <sofa/helper/testing/BaseTest.h>
+using sofa::helper::testing::BaseTest;
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+namespace
+{
+
+using ElemID = sofa::core::topology::Topology::ElemID;
+
+/// Reference implementation: swap each removed element with the last one, then shrink
+sofa::helper::vector<ElemID> removeBySwaps(std::size_t size, const sofa::helper::vector<ElemID>& removed, sofa::helper::vector<ElemID>& removedElements)
+{
+    sofa::helper::vector<ElemID> data(size);
+    std::iota(data.begin(), data.end(), ElemID(0));
+    std::size_t last = size - 1;
+    for (const ElemID index : removed)
+    {
+        removedElements.push_back(data[index]);
+        std::swap(data[index], data[last]);
+        --last;
+    }
+    data.resize(size - removed.size());
+    return data;
+}
+
+TEST(ElementsRemovalRemap_test, sameResultAsSwapAndPop)
+{
+    std::mt19937 generator(1);
+    for (const std::size_t size : {1u, 2u, 10u, 100u, 1000u})
+    {
+        for (const bool sorted : {true, false})
+        {
+            sofa::helper::vector<ElemID> indices(size);
+            std::iota(indices.begin(), indices.end(), ElemID(0));
+            std::shuffle(indices.begin(), indices.end(), generator);
+            sofa::helper::vector<ElemID> removed(indices.begin(), indices.begin() + (size + 2) / 3);
+            if (sorted)
+                std::sort(removed.begin(), removed.end(), std::greater<ElemID>());
+            else // indices valid at the time of each removal
+                for (std::size_t i = 0; i < removed.size(); ++i)
+                    removed[i] = removed[i] % ElemID(size - i);
+
+            sofa::helper::vector<ElemID> expectedRemovedElements;
+            const sofa::helper::vector<ElemID> expected = removeBySwaps(size, removed, expectedRemovedElements);
+
+            const ElementsRemovalRemap remap(size, removed);
+            sofa::helper::vector<ElemID> data(size);
+            std::iota(data.begin(), data.end(), ElemID(0));
+            remap.apply(data);
+
+            EXPECT_EQ(remap.getNewSize(), expected.size());
+            EXPECT_EQ(data, expected);
+            EXPECT_EQ(remap.getRemovedElements(), expectedRemovedElements);
+        }
+    }
+}
+
+TEST(ElementsRemovalRemap_test, movesOnlyChangedElements)
+{
+    // removing the last elements does not move anything
+    const ElementsRemovalRemap remap(5, sofa::helper::vector<ElemID>{4, 3});
+    EXPECT_EQ(remap.getNewSize(), 3u);
+    EXPECT_TRUE(remap.getMoves().empty());
+
+    // removing the first element moves the last one
+    const ElementsRemovalRemap remap2(5, sofa::helper::vector<ElemID>{0});
+    ASSERT_EQ(remap2.getMoves().size(), 1u);
+    EXPECT_EQ(remap2.getMoves()[0].first, 0u);
+    EXPECT_EQ(remap2.getMoves()[0].second, 4u);
+}
+
+class ElementsRemovalRemapApply_test : public BaseTest {};
+
+TEST_F(ElementsRemovalRemapApply_test, containerTooSmall)
+{
+    const ElementsRemovalRemap remap(5, sofa::helper::vector<ElemID>{0});
+
+    // the move reads the last element, which this container does not have
+    sofa::helper::vector<ElemID> data{0, 1, 2, 3};
+    {
+        EXPECT_MSG_EMIT(Error);
+        remap.apply(data);
+    }
+    EXPECT_EQ(data, (sofa::helper::vector<ElemID>{0, 1, 2, 3}));
+}
+
+} // namespace
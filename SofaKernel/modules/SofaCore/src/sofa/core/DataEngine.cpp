@@ -69,7 +69,11 @@ void DataEngine::update()
 {
     updateAllInputs();
     DDGNode::cleanDirty();
-    doUpdate();
+    {
+        // the outputs written by doUpdate are notified once it is done
+        objectmodel::ScopedEditBatch editBatch;
+        doUpdate();
+    }
     m_dataTracker.clean();
 }
 
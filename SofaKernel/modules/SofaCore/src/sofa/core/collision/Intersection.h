@@ -157,6 +157,9 @@ public:
     /// returns true if algorithm uses continous detection
     virtual bool useContinuous() const { return false; }
 
+    /// returns true if the intersection tests read the free positions of the collision models (when they are set)
+    virtual bool useFreePosition() const { return false; }
+
     /// Return the alarm distance (must return 0 if useProximity() is false)
     virtual SReal getAlarmDistance() const { return (SReal)0.0; }
 
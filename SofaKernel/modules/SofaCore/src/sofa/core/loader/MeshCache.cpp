@@ -0,0 +1,450 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/core/loader/MeshCache.h>
+#include <sofa/core/loader/PrimitiveGroup.h>
+#include <sofa/core/objectmodel/Base.h>
+#include <sofa/core/objectmodel/Data.h>
+#include <sofa/core/topology/Topology.h>
+#include <sofa/helper/SVector.h>
+
+#include <boost/filesystem.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace sofa
+{
+
+namespace core
+{
+
+namespace loader
+{
+
+using objectmodel::BaseData;
+using objectmodel::Data;
+using defaulttype::AbstractTypeInfo;
+
+const std::uint32_t MeshCache::s_version = 2;
+
+namespace
+{
+
+const char s_magic[8] = { 'S', 'O', 'F', 'A', 'M', 'S', 'H', '\0' };
+const std::uint32_t s_byteOrderMark = 0x01020304;
+
+/// How the value of a Data is stored
+enum class Storage : std::uint8_t { RawArray = 0, Lists = 1, Groups = 2, Text = 3 };
+
+template<class T>
+void writeValue(std::ostream& out, const T& v)
+{
+    out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+void writeString(std::ostream& out, const std::string& s)
+{
+    writeValue(out, static_cast<std::uint32_t>(s.size()));
+    out.write(s.data(), static_cast<std::streamsize>(s.size()));
+}
+
+/// Sequential reading of the cache file, checking that the reads stay in the file
+struct Reader
+{
+    const char* p;
+    const char* end;
+
+    template<class T>
+    bool read(T& v)
+    {
+        if (static_cast<std::size_t>(end - p) < sizeof(T))
+            return false;
+        std::memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+
+    bool read(std::string& s)
+    {
+        std::uint32_t size = 0;
+        if (!read(size) || static_cast<std::size_t>(end - p) < size)
+            return false;
+        s.assign(p, size);
+        p += size;
+        return true;
+    }
+
+    bool skip(std::uint64_t size)
+    {
+        if (static_cast<std::uint64_t>(end - p) < size)
+            return false;
+        p += size;
+        return true;
+    }
+};
+
+/// Vectors of fixed size values, which can be copied as a whole
+bool isRawArray(const AbstractTypeInfo* typeinfo)
+{
+    return typeinfo && typeinfo->ValidInfo() && typeinfo->Container() && typeinfo->SimpleLayout()
+            && typeinfo->BaseType() && typeinfo->BaseType()->FixedSize();
+}
+
+/// Vectors of lists of indices
+template<class Lists>
+bool writeLists(std::ostream& out, const BaseData* data)
+{
+    const Data<Lists>* d = dynamic_cast<const Data<Lists>*>(data);
+    if (!d)
+        return false;
+
+    using Value = typename Lists::value_type::value_type;
+    const Lists& lists = d->getValue();
+    std::uint64_t offset = 0;
+    writeValue(out, static_cast<std::uint64_t>(lists.size()));
+    writeValue(out, static_cast<std::uint32_t>(sizeof(Value)));
+    writeValue(out, offset);
+    for (const auto& list : lists)
+    {
+        offset += list.size();
+        writeValue(out, offset);
+    }
+    for (const auto& list : lists)
+    {
+        if (!list.empty())
+            out.write(reinterpret_cast<const char*>(list.data()), static_cast<std::streamsize>(list.size() * sizeof(Value)));
+    }
+    return true;
+}
+
+template<class Lists>
+bool readLists(Reader& in, BaseData* data, bool& isValid)
+{
+    Data<Lists>* d = dynamic_cast<Data<Lists>*>(data);
+    if (!d)
+        return false;
+
+    using Value = typename Lists::value_type::value_type;
+    isValid = false;
+    std::uint64_t nbLists = 0;
+    std::uint32_t valueSize = 0;
+    if (!in.read(nbLists) || !in.read(valueSize) || valueSize != sizeof(Value)
+            || static_cast<std::uint64_t>(in.end - in.p) / sizeof(std::uint64_t) <= nbLists)
+        return true;
+
+    const char* offsets = in.p;
+    in.p += (nbLists + 1) * sizeof(std::uint64_t);
+    std::uint64_t nbValues = 0;
+    std::memcpy(&nbValues, offsets + nbLists * sizeof(std::uint64_t), sizeof(std::uint64_t));
+    const char* values = in.p;
+    if (!in.skip(nbValues * sizeof(Value)))
+        return true;
+
+    auto offset = [offsets](std::uint64_t i)
+    {
+        std::uint64_t o = 0;
+        std::memcpy(&o, offsets + i * sizeof(std::uint64_t), sizeof(std::uint64_t));
+        return o;
+    };
+    for (std::uint64_t i = 0; i < nbLists; ++i)
+    {
+        if (offset(i + 1) < offset(i) || offset(i + 1) > nbValues)
+            return true;
+    }
+
+    Lists& lists = *d->beginEdit();
+    lists.resize(nbLists);
+    for (std::uint64_t i = 0; i < nbLists; ++i)
+    {
+        const std::uint64_t begin = offset(i);
+        const std::uint64_t end = offset(i + 1);
+        lists[i].resize(end - begin);
+        if (end > begin)
+            std::memcpy(lists[i].data(), values + begin * sizeof(Value), (end - begin) * sizeof(Value));
+    }
+    d->endEdit();
+    isValid = true;
+    return true;
+}
+
+bool writeGroups(std::ostream& out, const BaseData* data)
+{
+    const auto* d = dynamic_cast<const Data< helper::vector<PrimitiveGroup> >*>(data);
+    if (!d)
+        return false;
+
+    writeValue(out, static_cast<std::uint64_t>(d->getValue().size()));
+    for (const PrimitiveGroup& g : d->getValue())
+    {
+        writeValue(out, static_cast<std::int32_t>(g.p0));
+        writeValue(out, static_cast<std::int32_t>(g.nbp));
+        writeValue(out, static_cast<std::int32_t>(g.materialId));
+        writeString(out, g.materialName);
+        writeString(out, g.groupName);
+    }
+    return true;
+}
+
+bool readGroups(Reader& in, BaseData* data, bool& isValid)
+{
+    auto* d = dynamic_cast<Data< helper::vector<PrimitiveGroup> >*>(data);
+    if (!d)
+        return false;
+
+    isValid = false;
+    std::uint64_t nbGroups = 0;
+    if (!in.read(nbGroups))
+        return true;
+    helper::vector<PrimitiveGroup> groups;
+    for (std::uint64_t i = 0; i < nbGroups; ++i)
+    {
+        std::int32_t p0, nbp, materialId;
+        PrimitiveGroup g;
+        if (!in.read(p0) || !in.read(nbp) || !in.read(materialId) || !in.read(g.materialName) || !in.read(g.groupName))
+            return true;
+        g.p0 = p0;
+        g.nbp = nbp;
+        g.materialId = materialId;
+        groups.push_back(g);
+    }
+    d->setValue(groups);
+    isValid = true;
+    return true;
+}
+
+using IndexLists = helper::vector< helper::vector<topology::Topology::ElemID> >;
+using IntLists = helper::SVector< helper::SVector<int> >;
+
+void writeData(std::ostream& out, const BaseData* data)
+{
+    std::ostringstream value(std::ios_base::out | std::ios_base::binary);
+    Storage storage;
+    const AbstractTypeInfo* typeinfo = data->getValueTypeInfo();
+    if (writeGroups(value, data))
+    {
+        storage = Storage::Groups;
+    }
+    else if (writeLists<IndexLists>(value, data) || writeLists<IntLists>(value, data))
+    {
+        storage = Storage::Lists;
+    }
+    else if (isRawArray(typeinfo))
+    {
+        storage = Storage::RawArray;
+        const void* ptr = data->getValueVoidPtr();
+        const std::uint64_t nbValues = typeinfo->size(ptr);
+        writeValue(value, static_cast<std::uint32_t>(typeinfo->byteSize()));
+        writeValue(value, nbValues);
+        if (nbValues > 0)
+            value.write(static_cast<const char*>(typeinfo->getValuePtr(ptr)), static_cast<std::streamsize>(nbValues * typeinfo->byteSize()));
+    }
+    else
+    {
+        storage = Storage::Text;
+        value << data->getValueString();
+    }
+
+    const std::string bytes = value.str();
+    writeString(out, data->getName());
+    writeValue(out, storage);
+    writeValue(out, static_cast<std::uint64_t>(bytes.size()));
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+bool readData(const char* begin, const char* end, BaseData* data)
+{
+    Reader in { begin, end };
+    Storage storage;
+    std::uint64_t size = 0;
+    if (!in.read(storage) || !in.read(size) || static_cast<std::uint64_t>(end - in.p) < size)
+        return false;
+    in.end = in.p + size;
+
+    bool isValid = false;
+    switch (storage)
+    {
+    case Storage::Groups:
+        return readGroups(in, data, isValid) && isValid;
+    case Storage::Lists:
+        return (readLists<IndexLists>(in, data, isValid) || readLists<IntLists>(in, data, isValid)) && isValid;
+    case Storage::RawArray:
+    {
+        const AbstractTypeInfo* typeinfo = data->getValueTypeInfo();
+        std::uint32_t byteSize = 0;
+        std::uint64_t nbValues = 0;
+        if (!isRawArray(typeinfo) || !in.read(byteSize) || !in.read(nbValues)
+                || byteSize != typeinfo->byteSize() || static_cast<std::uint64_t>(in.end - in.p) != nbValues * byteSize)
+            return false;
+        void* ptr = data->beginEditVoidPtr();
+        typeinfo->setSize(ptr, static_cast<sofa::Size>(nbValues));
+        isValid = typeinfo->size(ptr) == nbValues;
+        if (isValid && nbValues > 0)
+            std::memcpy(typeinfo->getValuePtr(ptr), in.p, nbValues * byteSize);
+        data->endEditVoidPtr();
+        return isValid;
+    }
+    case Storage::Text:
+        return data->read(std::string(in.p, in.end));
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+bool MeshCache::getSourceKey(const std::string& sourceFilename, Key& key)
+{
+    boost::system::error_code error;
+    if (!boost::filesystem::is_regular_file(sourceFilename, error))
+        return false;
+    helper::io::MappedFile source;
+    if (!source.open(sourceFilename))
+        return false;
+    key.sourceSize = static_cast<std::uint64_t>(source.size());
+    key.sourceHash = hash(source.data(), source.size());
+    return true;
+}
+
+std::uint64_t MeshCache::hash(const std::string& s, std::uint64_t h)
+{
+    return hash(s.data(), s.size(), h);
+}
+
+std::uint64_t MeshCache::hash(const char* data, std::size_t size, std::uint64_t h)
+{
+    // FNV-1a
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        h ^= static_cast<unsigned char>(data[i]);
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+bool MeshCache::write(const std::string& filename, const Key& key, const helper::vector<BaseData*>& data)
+{
+    boost::system::error_code error;
+    const boost::filesystem::path path(filename);
+    if (path.has_parent_path())
+        boost::filesystem::create_directories(path.parent_path(), error);
+
+    // each writer has its own temporary file, the last rename wins
+    const std::string temporaryFilename = (path.parent_path() / boost::filesystem::unique_path(path.filename().string() + ".%%%%-%%%%-%%%%-%%%%.tmp")).string();
+    {
+        std::ofstream out(temporaryFilename.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+        if (!out.good())
+            return false;
+
+        out.write(s_magic, sizeof(s_magic));
+        writeValue(out, s_version);
+        writeValue(out, s_byteOrderMark);
+        writeValue(out, key.sourceSize);
+        writeValue(out, key.sourceHash);
+        writeValue(out, key.parametersHash);
+        writeValue(out, static_cast<std::uint32_t>(data.size()));
+        for (const BaseData* d : data)
+            writeData(out, d);
+
+        if (!out.good())
+        {
+            out.close();
+            boost::filesystem::remove(temporaryFilename, error);
+            return false;
+        }
+    }
+
+    boost::filesystem::rename(temporaryFilename, filename, error);
+    if (error)
+    {
+        boost::filesystem::remove(temporaryFilename, error);
+        return false;
+    }
+    return true;
+}
+
+bool MeshCache::open(const std::string& filename)
+{
+    close();
+    boost::system::error_code error;
+    if (!boost::filesystem::is_regular_file(filename, error) || !m_file.open(filename))
+        return false;
+
+    Reader in { m_file.begin(), m_file.end() };
+    char magic[sizeof(s_magic)];
+    std::uint32_t version = 0, byteOrderMark = 0, nbData = 0;
+    if (!in.read(magic) || std::memcmp(magic, s_magic, sizeof(s_magic)) != 0
+            || !in.read(version) || version != s_version
+            || !in.read(byteOrderMark) || byteOrderMark != s_byteOrderMark
+            || !in.read(m_key.sourceSize) || !in.read(m_key.sourceHash) || !in.read(m_key.parametersHash)
+            || !in.read(nbData))
+    {
+        close();
+        return false;
+    }
+
+    for (std::uint32_t i = 0; i < nbData; ++i)
+    {
+        std::string name;
+        Storage storage;
+        std::uint64_t size = 0;
+        if (!in.read(name))
+        {
+            close();
+            return false;
+        }
+        m_dataNames.push_back(name);
+        m_dataBegins.push_back(in.p);
+        if (!in.read(storage) || !in.read(size) || !in.skip(size))
+        {
+            close();
+            return false;
+        }
+    }
+    m_dataBegins.push_back(in.p);
+    return true;
+}
+
+void MeshCache::close()
+{
+    m_file.close();
+    m_key = Key();
+    m_dataNames.clear();
+    m_dataBegins.clear();
+}
+
+bool MeshCache::read(objectmodel::Base* owner) const
+{
+    for (std::size_t i = 0; i < m_dataNames.size(); ++i)
+    {
+        BaseData* data = owner->findData(m_dataNames[i]);
+        if (!data || !readData(m_dataBegins[i], m_dataBegins[i+1], data))
+            return false;
+    }
+    return true;
+}
+
+} // namespace loader
+
+} // namespace core
+
+} // namespace sofa
@@ -0,0 +1,113 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_CORE_LOADER_MESHCACHE_H
+#define SOFA_CORE_LOADER_MESHCACHE_H
+
+#include <sofa/core/config.h>
+#include <sofa/helper/io/MappedFile.h>
+#include <sofa/helper/vector.h>
+
+#include <cstdint>
+#include <string>
+
+namespace sofa
+{
+
+namespace core
+{
+
+namespace objectmodel
+{
+class Base;
+class BaseData;
+}
+
+namespace loader
+{
+
+/** Binary cache of the Data computed by a loader from a source file.
+ *
+ *  The file starts with a versioned header storing the key of the cache: the size and a hash of the content
+ *  of the source file, and a hash of the loader parameters. The values of the Data follow:
+ *  - vectors of fixed size values (positions, normals, elements...) are stored as raw arrays,
+ *  - vectors of variable size lists of indices (polygons, polylines...) as offsets and raw values,
+ *  - primitive groups with their names,
+ *  - the other Data as their value string.
+ *
+ *  The cache file is memory-mapped when it is read, so that the arrays are copied only once, into the Data.
+ */
+class SOFA_CORE_API MeshCache
+{
+public:
+    static const std::uint32_t s_version;
+
+    /// Identification of the source file and of the parameters used to load it
+    struct Key
+    {
+        std::uint64_t sourceSize {0};
+        std::uint64_t sourceHash {0};
+        std::uint64_t parametersHash {0};
+
+        bool operator==(const Key& k) const
+        {
+            return sourceSize == k.sourceSize && sourceHash == k.sourceHash && parametersHash == k.parametersHash;
+        }
+    };
+
+    /// Fill the key with the current size and content hash of the source file.
+    /// The content is hashed rather than relying on the modification time, whose resolution can hide an edit.
+    static bool getSourceKey(const std::string& sourceFilename, Key& key);
+
+    /// Hash of a string, which does not depend on the platform
+    static std::uint64_t hash(const std::string& s, std::uint64_t h = 14695981039346656037ull);
+    static std::uint64_t hash(const char* data, std::size_t size, std::uint64_t h = 14695981039346656037ull);
+
+    /// Write the values of the Data in the cache file.
+    /// The file is written next to its final location under a unique name and then renamed, so that it is never
+    /// read incomplete, even when several processes write the same cache file.
+    static bool write(const std::string& filename, const Key& key, const helper::vector<objectmodel::BaseData*>& data);
+
+    /// Map the cache file and read its header, returns false if it does not exist or has not a valid format
+    bool open(const std::string& filename);
+    void close();
+
+    const Key& getKey() const { return m_key; }
+    /// Names of the Data stored in the cache
+    const helper::vector<std::string>& getDataNames() const { return m_dataNames; }
+
+    /// Set the values of the Data of owner from the cache, returns false if a Data is missing or does not match
+    bool read(objectmodel::Base* owner) const;
+
+protected:
+    helper::io::MappedFile m_file;
+    Key m_key;
+    helper::vector<std::string> m_dataNames;
+    helper::vector<const char*> m_dataBegins; ///< beginning of the value of each Data in the file, followed by the end of the file
+};
+
+} // namespace loader
+
+} // namespace core
+
+} // namespace sofa
+
+#endif // SOFA_CORE_LOADER_MESHCACHE_H
@@ -20,12 +20,20 @@
 * Contact information: contact@sofa-framework.org                             *
 ******************************************************************************/
 #include <sofa/core/loader/MeshLoader.h>
+#include <sofa/core/loader/MeshCache.h>
 #include <sofa/helper/io/Mesh.h>
 #include <sofa/helper/system/FileRepository.h>
+#include <sofa/helper/system/FileSystem.h>
+#include <boost/filesystem.hpp>
 #include <fstream>
+#include <iomanip>
 
 #include <cstdlib>
 
+#ifndef WIN32
+#include <unistd.h>
+#endif
+
 namespace sofa
 {
 
@@ -37,6 +45,25 @@ namespace loader
 
 using namespace sofa::defaulttype;
 
+namespace
+{
+
+/// Set a flag during its lifetime, it is reset even if an exception is thrown
+class ScopedFlag
+{
+public:
+    explicit ScopedFlag(bool& flag) : m_flag(flag) { m_flag = true; }
+    ~ScopedFlag() { m_flag = false; }
+
+    ScopedFlag(const ScopedFlag&) = delete;
+    ScopedFlag& operator=(const ScopedFlag&) = delete;
+
+private:
+    bool& m_flag;
+};
+
+} // namespace
+
 MeshLoader::MeshLoader() : BaseLoader()
   , d_positions(initData(&d_positions, "position", "Vertices of the mesh loaded"))
   , d_polylines(initData(&d_polylines, "polylines", "Polylines of the mesh loaded"))
@@ -70,6 +97,8 @@ MeshLoader::MeshLoader() : BaseLoader()
   , d_rotation(initData(&d_rotation, Vec3(), "rotation", "Rotation of the DOFs"))
   , d_scale(initData(&d_scale, Vec3(1.0, 1.0, 1.0), "scale3d", "Scale of the DOFs in 3 dimensions"))
   , d_transformation(initData(&d_transformation, Matrix4::s_identity, "transformation", "4x4 Homogeneous matrix to transform the DOFs (when present replace any)"))
+  , d_useCache(initData(&d_useCache, false, "useCache", "Store the loaded mesh in a binary cache file, read instead of the source file as long as it does not change"))
+  , d_cacheDirectory(initData(&d_cacheDirectory, "cacheDirectory", "Directory of the cache files (default: a sofa_mesh_cache directory of the user in the temporary directory)"))
   , d_previousTransformation( Matrix4::s_identity )
 {
     addAlias(&d_tetrahedra, "tetras");
@@ -85,6 +114,8 @@ MeshLoader::MeshLoader() : BaseLoader()
     d_scale.setAutoLink(false);
     d_transformation.setAutoLink(false);
     d_transformation.setDirtyValue();
+    d_useCache.setAutoLink(false);
+    d_cacheDirectory.setAutoLink(false);
 
     d_positions.setGroup("Vectors");
     d_polylines.setGroup("Vectors");
@@ -116,6 +147,9 @@ MeshLoader::MeshLoader() : BaseLoader()
     addUpdateCallback("filename", {&m_filename}, [this](const core::DataTracker& t)
     {
         SOFA_UNUSED(t);
+        // the loaded Data read during load() are updated through this callback: the mesh is already being loaded
+        if (m_isLoading)
+            return d_componentState.getValue();
         if(load()){
             clearLoggedMessages();
             return sofa::core::objectmodel::ComponentState::Valid;
@@ -233,14 +267,29 @@ void MeshLoader::reinit()
 
 bool MeshLoader::load()
 {
+    if (m_isLoading)
+    {
+        msg_error() << "The mesh is already being loaded.";
+        return false;
+    }
+    ScopedFlag loading(m_isLoading);
+
+    // the loaded Data notify their outputs once, at the end of the loading
+    objectmodel::ScopedEditBatch editBatch;
+
     // Clear previously loaded buffers
     clearBuffers();
 
-    bool loaded = doLoad();
+    bool loaded = false;
+    if (d_useCache.getValue())
+        loaded = loadFromCache() || loadAndWriteCache();
+    else
+        loaded = doLoad();
 
     // Clear (potentially) partially filled buffers
     if (!loaded)
         clearBuffers();
+
     return loaded;
 }
 
@@ -251,6 +300,113 @@ bool MeshLoader::canLoad()
     return BaseLoader::canLoad();
 }
 
+std::string MeshLoader::getCacheFilename() const
+{
+    std::string directory = d_cacheDirectory.getValue();
+    if (directory.empty())
+    {
+        std::string name = "sofa_mesh_cache";
+#ifndef WIN32
+        // the temporary directory is shared by all the users (it is per user on Windows)
+        name += "_" + std::to_string(getuid());
+#endif
+        directory = (boost::filesystem::temp_directory_path() / name).string();
+    }
+
+    const std::string source = m_filename.getFullPath();
+    std::ostringstream filename;
+    filename << directory << "/" << helper::system::FileSystem::stripDirectory(source) << "."
+             << std::hex << std::setw(16) << std::setfill('0') << MeshCache::hash(getClassName() + "|" + source)
+             << ".meshcache";
+    return filename.str();
+}
+
+std::uint64_t MeshLoader::getParametersHash(const helper::vector<std::string>& loadedDataNames) const
+{
+    // the transformation is applied after the loading, it does not change the cached Data
+    const objectmodel::BaseData* ignoredData[] = { &d_componentState, &d_useCache, &d_cacheDirectory,
+                                                   &d_translation, &d_rotation, &d_scale, &d_transformation };
+
+    std::uint64_t hash = MeshCache::hash(getClassName());
+    for (const objectmodel::BaseData* data : getDataFields())
+    {
+        if (!data->isSet() || data->getName() == "name"
+                || std::find(std::begin(ignoredData), std::end(ignoredData), data) != std::end(ignoredData)
+                || std::find(loadedDataNames.begin(), loadedDataNames.end(), data->getName()) != loadedDataNames.end())
+            continue;
+        hash = MeshCache::hash(data->getName() + "=" + data->getValueString() + "\n", hash);
+    }
+    return hash;
+}
+
+bool MeshLoader::loadFromCache()
+{
+    const std::string filename = getCacheFilename();
+    MeshCache cache;
+    if (!cache.open(filename))
+        return false;
+
+    MeshCache::Key key;
+    if (!MeshCache::getSourceKey(m_filename.getFullPath(), key))
+        return false;
+    key.parametersHash = getParametersHash(cache.getDataNames());
+    if (!(key == cache.getKey()))
+    {
+        msg_info() << "The cache file '" << filename << "' is out of date.";
+        return false;
+    }
+
+    if (!cache.read(this))
+    {
+        msg_warning() << "Invalid cache file '" << filename << "', the source file is loaded instead.";
+        clearBuffers();
+        return false;
+    }
+
+    msg_info() << "Mesh read from the cache file '" << filename << "'.";
+    return true;
+}
+
+bool MeshLoader::loadAndWriteCache()
+{
+    // the Data modified by doLoad() are the ones to cache
+    const helper::vector<objectmodel::BaseData*> fields = getDataFields();
+    helper::vector<int> counters;
+    for (const objectmodel::BaseData* data : fields)
+        counters.push_back(data->getCounter());
+
+    if (!doLoad())
+        return false;
+
+    if (getDataFields().size() != fields.size())
+    {
+        msg_info() << "The mesh is not cached: Data were created while loading it.";
+        return true;
+    }
+
+    helper::vector<objectmodel::BaseData*> loadedData;
+    helper::vector<std::string> loadedDataNames;
+    for (std::size_t i = 0; i < fields.size(); ++i)
+    {
+        if (fields[i]->getCounter() != counters[i] && fields[i] != &d_componentState)
+        {
+            loadedData.push_back(fields[i]);
+            loadedDataNames.push_back(fields[i]->getName());
+        }
+    }
+
+    MeshCache::Key key;
+    if (!MeshCache::getSourceKey(m_filename.getFullPath(), key))
+        return true;
+    key.parametersHash = getParametersHash(loadedDataNames);
+
+    const std::string filename = getCacheFilename();
+    if (!MeshCache::write(filename, key, loadedData))
+        msg_warning() << "Cannot write the cache file '" << filename << "'.";
+
+    return true;
+}
+
 void MeshLoader::updateMesh()
 {
     updateElements();
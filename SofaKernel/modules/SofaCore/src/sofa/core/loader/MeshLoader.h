@@ -190,6 +190,9 @@ public:
     Data< Vec3 > d_scale; ///< Scale of the DOFs in 3 dimensions
     Data< defaulttype::Matrix4 > d_transformation; ///< 4x4 Homogeneous matrix to transform the DOFs (when present replace any)
 
+    Data< bool > d_useCache; ///< Store the loaded mesh in a binary cache file, read instead of the source file as long as it does not change
+    Data< std::string > d_cacheDirectory; ///< Directory of the cache files (default: a sofa_mesh_cache directory of the user in the temporary directory)
+
 
     virtual void updateMesh();
     virtual void updateElements();
@@ -201,6 +204,9 @@ protected:
     /// to be able to call reinit w/o applying several time the same transform
     defaulttype::Matrix4 d_previousTransformation;
 
+    /// set during load(): reading a loaded Data calls the filename callback, which must not load the mesh again
+    bool m_isLoading {false};
+
 
     void addPosition(helper::vector< sofa::defaulttype::Vec<3, SReal> >* pPositions, const sofa::defaulttype::Vec<3, SReal>& p);
     void addPosition(helper::vector<sofa::defaulttype::Vec<3, SReal> >* pPositions,  SReal x, SReal y, SReal z);
@@ -237,6 +243,20 @@ protected:
 
     /// Temporary method that will copy all buffers from a io::Mesh into the corresponding Data. Will be removed as soon as work on unifying meshloader is finished
     void copyMeshToData(helper::io::Mesh* _mesh);
+
+    /// @name Mesh cache
+    /// The Data modified by doLoad() are stored in a binary cache file (see MeshCache), identified by the
+    /// source file and the loader type. The cache is used as long as the size and the content hash of the
+    /// source file, and the values of the parameters set on the loader, do not change.
+    /// @{
+    std::string getCacheFilename() const;
+    /// Hash of the Data set on the loader, except the Data loaded from the file and the transformation
+    std::uint64_t getParametersHash(const helper::vector<std::string>& loadedDataNames) const;
+    /// Set the loaded Data from the cache file, returns false if it is missing or out of date
+    bool loadFromCache();
+    /// Load the source file and write the Data it modified in the cache file
+    bool loadAndWriteCache();
+    /// @}
 };
 
 
@@ -185,6 +185,7 @@ void Base::addData(BaseData* f, const std::string& name)
                 << " already used in this class or in a parent class !";
     }
     m_vecData.push_back(f);
+    m_vecDataTokens.push_back(NameRegistry::intern(name));
     m_aliasData.insert(std::make_pair(name, f));
     f->setOwner(this);
 }
@@ -192,6 +193,7 @@ void Base::addData(BaseData* f, const std::string& name)
 /// Add an alias to a Data
 void Base::addAlias( BaseData* field, const char* alias)
 {
+    NameRegistry::intern(alias);
     m_aliasData.insert(std::make_pair(std::string(alias),field));
 }
 
@@ -206,12 +208,14 @@ void Base::addLink(BaseLink* l)
                 << "' already used in this class or in a parent class !";
     }
     m_vecLink.push_back(l);
+    m_vecLinkTokens.push_back(NameRegistry::intern(name));
     m_aliasLink.insert(std::make_pair(name, l));
 }
 
 /// Add an alias to a Link
 void Base::addAlias( BaseLink* link, const char* alias)
 {
+    NameRegistry::intern(alias);
     m_aliasLink.insert(std::make_pair(std::string(alias),link));
 }
 
@@ -338,7 +342,9 @@ void Base::removeTag(Tag t)
 
 void Base::removeData(BaseData* d)
 {
-    m_vecData.erase(std::find(m_vecData.begin(), m_vecData.end(), d));
+    const auto it = std::find(m_vecData.begin(), m_vecData.end(), d);
+    m_vecDataTokens.erase(m_vecDataTokens.begin() + (it - m_vecData.begin()));
+    m_vecData.erase(it);
     auto range = m_aliasData.equal_range(d->getName());
     m_aliasData.erase(range.first, range.second);
 }
@@ -347,16 +353,26 @@ void Base::removeData(BaseData* d)
 /// Return nullptr if not found. If more than one field is found (due to aliases), only the first is returned.
 BaseData* Base::findData( const std::string &name ) const
 {
+    const NameRegistry::Token token = NameRegistry::find(name);
+    if (token == NameRegistry::InvalidToken)
+        return nullptr; // no field of any object has this name
+
+    BaseClass::FieldIndex& index = getClass()->getDataIndex();
+    const unsigned int position = index.find(token);
+    if (position < m_vecDataTokens.size() && m_vecDataTokens[position] == token)
+        return m_vecData[position];
+
     //Search in the aliases
-    if(m_aliasData.size())
-    {
-        auto range = m_aliasData.equal_range(name);
-        if (range.first != range.second)
-            return range.first->second;
-        else
-            return nullptr;
-    }
-    else return nullptr;
+    auto range = m_aliasData.equal_range(name);
+    if (range.first == range.second)
+        return nullptr;
+
+    BaseData* data = range.first->second;
+    const auto it = std::find(m_vecData.begin(), m_vecData.end(), data);
+    const std::size_t found = std::size_t(it - m_vecData.begin());
+    if (found < m_vecDataTokens.size() && m_vecDataTokens[found] == token)
+        index.insert(token, unsigned(found));
+    return data;
 }
 
 
@@ -364,6 +380,8 @@ BaseData* Base::findData( const std::string &name ) const
 std::vector< BaseData* > Base::findGlobalField( const std::string &name ) const
 {
     std::vector<BaseData*> result;
+    if (NameRegistry::find(name) == NameRegistry::InvalidToken)
+        return result;
     //Search in the aliases
     auto range = m_aliasData.equal_range(name);
     for (auto itAlias=range.first; itAlias!=range.second; ++itAlias)
@@ -376,18 +394,34 @@ std::vector< BaseData* > Base::findGlobalField( const std::string &name ) const
 /// Return nullptr if not found. If more than one link is found (due to aliases), only the first is returned.
 BaseLink* Base::findLink( const std::string &name ) const
 {
+    const NameRegistry::Token token = NameRegistry::find(name);
+    if (token == NameRegistry::InvalidToken)
+        return nullptr; // no field of any object has this name
+
+    BaseClass::FieldIndex& index = getClass()->getLinkIndex();
+    const unsigned int position = index.find(token);
+    if (position < m_vecLinkTokens.size() && m_vecLinkTokens[position] == token)
+        return m_vecLink[position];
+
     //Search in the aliases
     auto range = m_aliasLink.equal_range(name);
-    if (range.first != range.second)
-        return range.first->second;
-    else
+    if (range.first == range.second)
         return nullptr;
+
+    BaseLink* link = range.first->second;
+    const auto it = std::find(m_vecLink.begin(), m_vecLink.end(), link);
+    const std::size_t found = std::size_t(it - m_vecLink.begin());
+    if (found < m_vecLinkTokens.size() && m_vecLinkTokens[found] == token)
+        index.insert(token, unsigned(found));
+    return link;
 }
 
 /// Find links given a name: several can be found as we look into the alias map
 std::vector< BaseLink* > Base::findLinks( const std::string &name ) const
 {
     std::vector<BaseLink*> result;
+    if (NameRegistry::find(name) == NameRegistry::InvalidToken)
+        return result;
     //Search in the aliases
     auto range = m_aliasLink.equal_range(name);
     for (auto itAlias=range.first; itAlias!=range.second; ++itAlias)
@@ -430,8 +464,8 @@ void* Base::findLinkDestClass(const BaseClass* /*destType*/, const std::string&
 
 bool Base::hasField( const std::string& attribute) const
 {
-    return m_aliasData.find(attribute) != m_aliasData.end()
-            || m_aliasLink.find(attribute) != m_aliasLink.end();
+    return findData(attribute) != nullptr
+            || findLink(attribute) != nullptr;
 }
 
 /// Assign one field value (Data or Link)
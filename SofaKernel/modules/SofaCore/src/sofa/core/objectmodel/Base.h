@@ -274,6 +274,8 @@ public:
 
     /// Find a data field given its name. Return nullptr if not found.
     /// If more than one field is found (due to aliases), only the first is returned.
+    /// Names of the Data registered by the class are found through a hash index
+    /// shared by all its instances (see BaseClass::FieldIndex).
     BaseData* findData( const std::string &name ) const;
 
 
@@ -526,6 +528,11 @@ protected:
     /// name -> Link multi-map (includes names and aliases)
     MapLink m_aliasLink;
 
+    /// Interned name of each Data of m_vecData, used with the index of the class for fast lookups
+    helper::vector<NameRegistry::Token> m_vecDataTokens;
+    /// Interned name of each Link of m_vecLink
+    helper::vector<NameRegistry::Token> m_vecLinkTokens;
+
 public:
     /// Name of the object.
     Data<std::string> name;
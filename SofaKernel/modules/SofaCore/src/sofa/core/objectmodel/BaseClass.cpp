@@ -20,6 +20,8 @@
 * Contact information: contact@sofa-framework.org                             *
 ******************************************************************************/
 #include <sofa/core/objectmodel/BaseClass.h>
+#include <algorithm>
+#include <mutex>
 
 namespace sofa
 {
@@ -53,6 +55,68 @@ DeprecatedBaseClass::DeprecatedBaseClass()
     shortName = "DeprecatedBaseClass::shortname";
 }
 
+namespace
+{
+
+inline std::size_t fieldIndexHash(NameRegistry::Token token)
+{
+    return std::size_t(token * 2654435761u);
+}
+
+} // namespace
+
+unsigned int BaseClass::FieldIndex::find(Token token) const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    if (m_table.empty())
+        return NotFound;
+    const std::size_t mask = m_table.size() - 1;
+    for (std::size_t i = fieldIndexHash(token) & mask; ; i = (i + 1) & mask)
+    {
+        if (m_table[i].first == token)
+            return m_table[i].second;
+        if (m_table[i].first == NameRegistry::InvalidToken)
+            return NotFound;
+    }
+}
+
+void BaseClass::FieldIndex::insert(Token token, unsigned int position)
+{
+    if (token == NameRegistry::InvalidToken)
+        return;
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    if (2 * (m_size + 1) > m_table.size())
+        rehash(std::max<std::size_t>(16, 2 * m_table.size()));
+    const std::size_t mask = m_table.size() - 1;
+    for (std::size_t i = fieldIndexHash(token) & mask; ; i = (i + 1) & mask)
+    {
+        if (m_table[i].first == token)
+            return;
+        if (m_table[i].first == NameRegistry::InvalidToken)
+        {
+            m_table[i] = std::make_pair(token, position);
+            ++m_size;
+            return;
+        }
+    }
+}
+
+void BaseClass::FieldIndex::rehash(std::size_t capacity)
+{
+    std::vector< std::pair<Token, unsigned int> > table(capacity, std::make_pair(NameRegistry::InvalidToken, NotFound));
+    table.swap(m_table);
+    const std::size_t mask = m_table.size() - 1;
+    for (const auto& entry : table)
+    {
+        if (entry.first == NameRegistry::InvalidToken)
+            continue;
+        std::size_t i = fieldIndexHash(entry.first) & mask;
+        while (m_table[i].first != NameRegistry::InvalidToken)
+            i = (i + 1) & mask;
+        m_table[i] = entry;
+    }
+}
+
 std::string BaseClass::decodeFullName(const std::type_info& t)
 {
     return sofa::helper::NameDecoder::decodeFullName(t);
@@ -25,7 +25,9 @@
 #include <sofa/core/config.h>
 #include <sofa/helper/NameDecoder.h>
 #include <sofa/core/objectmodel/SPtr.h>
+#include <sofa/core/objectmodel/NameRegistry.h>
 #include <map>
+#include <shared_mutex>
 
 namespace sofa
 {
@@ -99,6 +101,39 @@ public:
     virtual void* dynamicCast(Base* obj) const = 0;
     virtual bool isInstance(Base* obj) const = 0;
 
+    /**
+     *  \brief Flat hash table giving the position of a field from the token of its name.
+     *
+     *  The instances of a class register their Data and Links in the same order, so the
+     *  position found for one instance is valid for the others. Base fills it while
+     *  looking up fields and checks every position against the instance before using it.
+     */
+    class SOFA_CORE_API FieldIndex
+    {
+    public:
+        typedef NameRegistry::Token Token;
+        static constexpr unsigned int NotFound = ~0u;
+
+        /// Position registered for this token, or NotFound
+        unsigned int find(Token token) const;
+
+        /// Register the position of a field, keeping the first one registered for this token
+        void insert(Token token, unsigned int position);
+
+    private:
+        void rehash(std::size_t capacity);
+
+        mutable std::shared_mutex m_mutex;
+        /// Open addressing with linear probing, InvalidToken marks an empty slot
+        std::vector< std::pair<Token, unsigned int> > m_table;
+        std::size_t m_size {0};
+    };
+
+    /// Index of the Data of the instances of this class
+    FieldIndex& getDataIndex() const { return m_dataIndex; }
+    /// Index of the Links of the instances of this class
+    FieldIndex& getLinkIndex() const { return m_linkIndex; }
+
     ///////////////////////////////// DEPRECATED //////////////////////////////////////////////////
     /// Helper method to decode the type name
     [[deprecated("This function has been deprecated in #PR 1283. The function will be removed "
@@ -133,6 +168,10 @@ public:
     {
         return sofa::helper::NameDecoder::decodeTypeName(typeid(T));
     }
+
+private:
+    mutable FieldIndex m_dataIndex;
+    mutable FieldIndex m_linkIndex;
 };
 
 class SOFA_CORE_API DeprecatedBaseClass : public BaseClass
@@ -24,9 +24,34 @@
 #include <cassert>
 #include <sofa/core/objectmodel/DDGNode.h>
 #include <sofa/helper/BackTrace.h>
+#include <atomic>
+#include <vector>
 namespace sofa::core::objectmodel
 {
 
+namespace
+{
+
+thread_local DDGNode::PropagationCounters t_propagationCounters;
+
+/// Edit batch of the calling thread
+thread_local int t_editBatchDepth = 0;
+thread_local std::vector<DDGNode*> t_editBatchNodes;
+
+std::atomic<unsigned int> s_lastNotificationWalk {0};
+
+/// Identifier of a new notification walk (0 is reserved)
+unsigned int newNotificationWalk()
+{
+    unsigned int walk = ++s_lastNotificationWalk;
+    if (walk == 0)
+        walk = ++s_lastNotificationWalk;
+    ++t_propagationCounters.notifyWalks;
+    return walk;
+}
+
+} // namespace
+
 /// Constructor
 DDGNode::DDGNode()
 {
@@ -34,6 +59,9 @@ DDGNode::DDGNode()
 
 DDGNode::~DDGNode()
 {
+    if (m_isInEditBatch)
+        std::replace(t_editBatchNodes.begin(), t_editBatchNodes.end(), this, static_cast<DDGNode*>(nullptr));
+
     for(auto it : inputs)
     {
         it->doDelOutput(this);
@@ -46,6 +74,7 @@ DDGNode::~DDGNode()
 
 void DDGNode::setDirtyValue()
 {
+    ++t_propagationCounters.setDirtyValueCalls;
     bool& dirtyValue = dirtyFlags.dirtyValue;
     if (!dirtyValue)
     {
@@ -56,9 +85,11 @@ void DDGNode::setDirtyValue()
 
 void DDGNode::setDirtyOutputs()
 {
+    ++t_propagationCounters.setDirtyOutputsCalls;
     bool& dirtyOutputs = dirtyFlags.dirtyOutputs;
     if (!dirtyOutputs)
     {
+        ++t_propagationCounters.dirtyPropagations;
         dirtyOutputs = true;
         for(DDGLinkIterator it=outputs.begin(), itend=outputs.end(); it != itend; ++it)
         {
@@ -78,9 +109,76 @@ void DDGNode::cleanDirty()
 }
 
 void DDGNode::notifyEndEdit()
+{
+    unsigned int walk = m_pendingWalk;
+    m_pendingWalk = 0;
+    if (walk == 0)
+    {
+        // this node has been modified: start a new walk
+        if (t_editBatchDepth > 0)
+        {
+            if (!m_isInEditBatch)
+            {
+                m_isInEditBatch = true;
+                t_editBatchNodes.push_back(this);
+            }
+            return;
+        }
+        walk = newNotificationWalk();
+    }
+    notifyOutputs(walk);
+}
+
+void DDGNode::notifyOutputs(unsigned int walk)
 {
     for(auto it : outputs)
+    {
+        if (it->m_notifiedWalk == walk)
+        {
+            ++t_propagationCounters.notifySkips;
+            continue;
+        }
+        ++t_propagationCounters.notifyVisits;
+        it->m_notifiedWalk = walk;
+        it->m_pendingWalk = walk;
         it->notifyEndEdit();
+        it->m_pendingWalk = 0;
+    }
+}
+
+void DDGNode::beginEditBatch()
+{
+    ++t_editBatchDepth;
+}
+
+void DDGNode::endEditBatch()
+{
+    assert(t_editBatchDepth > 0);
+    if (--t_editBatchDepth > 0)
+        return;
+
+    // nodes modified by the notified outputs start their own walk, as the batch is over
+    const unsigned int walk = newNotificationWalk();
+    for (std::size_t i = 0; i < t_editBatchNodes.size(); ++i)
+    {
+        DDGNode* node = t_editBatchNodes[i];
+        if (!node)
+            continue; // destroyed during the notifications
+        t_editBatchNodes[i] = nullptr;
+        node->m_isInEditBatch = false;
+        node->notifyOutputs(walk);
+    }
+    t_editBatchNodes.clear();
+}
+
+const DDGNode::PropagationCounters& DDGNode::getPropagationCounters()
+{
+    return t_propagationCounters;
+}
+
+void DDGNode::resetPropagationCounters()
+{
+    t_propagationCounters = PropagationCounters();
 }
 
 void DDGNode::cleanDirtyOutputsOfInputs()
@@ -94,10 +94,35 @@ public:
     void cleanDirty();
 
     /// Notify links that the DGNode has been modified
+    /// The outputs are notified once per modification, even if they are reached through several paths.
+    /// Inside an edit batch, the notification is postponed to the end of the batch.
     [[deprecated("2020-03-25: Aspect have been deprecated for complete removal in PR #1269. You can probably update your code by removing aspect related calls. If the feature was important to you contact sofa-dev. ")]]
     virtual void notifyEndEdit(const core::ExecParams*) final { notifyEndEdit(); }
     virtual void notifyEndEdit();
 
+    /// @name Edit batches
+    /// Between beginEditBatch() and endEditBatch(), the notifications of the nodes modified by the
+    /// calling thread are gathered, and sent in a single walk at the end of the batch: an output
+    /// depending on several modified nodes is notified once. Batches can be nested.
+    /// The dirty flags are still propagated immediately.
+    /// @{
+    static void beginEditBatch();
+    static void endEditBatch();
+    /// @}
+
+    /// Counters of the propagation work done by the calling thread, to measure the cost of the updates
+    struct PropagationCounters
+    {
+        std::size_t setDirtyValueCalls {0}; ///< calls to setDirtyValue
+        std::size_t setDirtyOutputsCalls {0}; ///< calls to setDirtyOutputs
+        std::size_t dirtyPropagations {0}; ///< calls which propagated the dirty flag (the other ones stopped at an already dirty node)
+        std::size_t notifyWalks {0}; ///< walks of the end of edit notifications
+        std::size_t notifyVisits {0}; ///< nodes notified by these walks
+        std::size_t notifySkips {0}; ///< nodes skipped by these walks, as already notified through another path
+    };
+    static const PropagationCounters& getPropagationCounters();
+    static void resetPropagationCounters();
+
     /// Utility method to call update if necessary. This method should be called before reading of writing the value of this node.
     [[deprecated("2020-03-25: Aspect have been deprecated for complete removal in PR #1269. You can probably update your code by removing aspect related calls. If the feature was important to you contact sofa-dev. ")]]
     void updateIfDirty(const core::ExecParams*) const { updateIfDirty(); }
@@ -119,12 +144,31 @@ protected:
 
 private:
 
+    /// Notify the outputs which were not already notified during this walk
+    void notifyOutputs(unsigned int walk);
+
     struct DirtyFlags
     {
         bool dirtyValue {false};
         bool dirtyOutputs {false};
     };
     DirtyFlags dirtyFlags;
+
+    bool m_isInEditBatch {false}; ///< whether this node waits for the end of the edit batch to notify its outputs
+    unsigned int m_notifiedWalk {0}; ///< last notification walk which reached this node
+    unsigned int m_pendingWalk {0}; ///< walk calling notifyEndEdit on this node, 0 if this node was modified
+};
+
+/// Edit batch of the calling thread during the lifetime of this object
+class ScopedEditBatch
+{
+public:
+    ScopedEditBatch() { DDGNode::beginEditBatch(); }
+    ~ScopedEditBatch() { DDGNode::endEditBatch(); }
+
+private:
+    ScopedEditBatch(const ScopedEditBatch&) = delete;
+    ScopedEditBatch& operator=(const ScopedEditBatch&) = delete;
 };
 
 } // namespace sofa::core::objectmodel
@@ -243,9 +243,7 @@ public:
     /// regardless of the current status of this value: no dirtiness check
     inline T* beginWriteOnly()
     {
-        m_counter++;
-        m_isSet=true;
-        BaseData::setDirtyOutputs();
+        notifyBeginWrite();
         return m_value.beginEdit();
     }
 
@@ -256,9 +254,19 @@ public:
     }
 
     /// @warning writeOnly (the Data is not updated before being set)
+    /// A value shared with linked Data is replaced, without being copied first.
     inline void setValue(const T& value)
     {
-        *beginWriteOnly()=value;
+        notifyBeginWrite();
+        m_value.setValue(value);
+        endEdit();
+    }
+
+    /// @warning writeOnly (the Data is not updated before being set)
+    inline void setValue(T&& value)
+    {
+        notifyBeginWrite();
+        m_value.setValue(std::move(value));
         endEdit();
     }
 
@@ -268,6 +276,15 @@ public:
         return m_value.getValue();
     }
 
+    /// Read-only view sharing the memory of the current value with this Data and its linked Data,
+    /// for copy-on-write types (large containers). It remains valid and unchanged when the Data is
+    /// modified afterwards, as the modification is then applied to a copy.
+    inline std::shared_ptr<const T> getSharedValue() const
+    {
+        updateIfDirty();
+        return m_value.getSharedValue();
+    }
+
     [[deprecated("2020-03-25: Aspect have been deprecated for complete removal in PR #1269. You can probably update your code by removing aspect related calls. If the feature was important to you contact sofa-dev. ")]]
     inline void endEdit(const core::ExecParams*)
     {
@@ -347,6 +364,14 @@ public:
 
 protected:
 
+    /// Called before any modification of the value
+    inline void notifyBeginWrite()
+    {
+        m_counter++;
+        m_isSet=true;
+        BaseData::setDirtyOutputs();
+    }
+
     typedef DataContentValue<T, sofa::defaulttype::DataTypeInfo<T>::CopyOnWrite> ValueType;
 
     /// Value
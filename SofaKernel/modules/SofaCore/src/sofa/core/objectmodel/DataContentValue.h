@@ -23,6 +23,7 @@
 
 #include <sofa/config.h>
 #include <memory>
+#include <utility>
 
 namespace sofa::core::objectmodel
 {
@@ -67,6 +68,15 @@ public:
     {
         data = value;
     }
+    void setValue(T&& value)
+    {
+        data = std::move(value);
+    }
+    /// The value is copied: it is not shared for this type
+    std::shared_ptr<const T> getSharedValue() const
+    {
+        return std::make_shared<const T>(data);
+    }
     void release()
     {
     }
@@ -111,7 +121,7 @@ public:
 
     T* beginEdit()
     {
-        if(!ptr.unique())
+        if(ptr.use_count() > 1)
         {
             ptr.reset(new T(*ptr)); // a priori the Data will be modified -> copy
         }
@@ -129,7 +139,7 @@ public:
 
     void setValue(const T& value)
     {
-        if(!ptr.unique())
+        if(ptr.use_count() > 1)
         {
             ptr.reset(new T(value)); // the Data is modified -> copy
         }
@@ -139,6 +149,24 @@ public:
         }
     }
 
+    void setValue(T&& value)
+    {
+        if(ptr.use_count() > 1)
+        {
+            ptr = std::make_shared<T>(std::move(value)); // the shared value is left untouched
+        }
+        else
+        {
+            *ptr = std::move(value);
+        }
+    }
+
+    /// The current value, shared until it is modified (the modification then applies to a copy)
+    std::shared_ptr<const T> getSharedValue() const
+    {
+        return ptr;
+    }
+
     void release()
     {
         ptr.reset();
@@ -0,0 +1,104 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/core/objectmodel/NameRegistry.h>
+
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace sofa
+{
+
+namespace core
+{
+
+namespace objectmodel
+{
+
+namespace
+{
+
+struct Registry
+{
+    std::shared_mutex mutex;
+    /// names are stored in a deque so that the views used as keys stay valid
+    std::deque<std::string> names;
+    std::unordered_map<std::string_view, NameRegistry::Token> tokens;
+
+    static Registry& get()
+    {
+        static Registry registry;
+        return registry;
+    }
+};
+
+} // namespace
+
+NameRegistry::Token NameRegistry::intern(std::string_view name)
+{
+    Registry& registry = Registry::get();
+    {
+        std::shared_lock<std::shared_mutex> lock(registry.mutex);
+        const auto it = registry.tokens.find(name);
+        if (it != registry.tokens.end())
+            return it->second;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(registry.mutex);
+    const auto it = registry.tokens.find(name);
+    if (it != registry.tokens.end())
+        return it->second;
+
+    registry.names.emplace_back(name);
+    const Token token = Token(registry.names.size()); // tokens start at 1
+    registry.tokens.emplace(std::string_view(registry.names.back()), token);
+    return token;
+}
+
+NameRegistry::Token NameRegistry::find(std::string_view name)
+{
+    Registry& registry = Registry::get();
+    std::shared_lock<std::shared_mutex> lock(registry.mutex);
+    const auto it = registry.tokens.find(name);
+    return (it != registry.tokens.end()) ? it->second : InvalidToken;
+}
+
+const std::string& NameRegistry::getName(Token token)
+{
+    Registry& registry = Registry::get();
+    std::shared_lock<std::shared_mutex> lock(registry.mutex);
+    return registry.names[token - 1];
+}
+
+std::size_t NameRegistry::size()
+{
+    Registry& registry = Registry::get();
+    std::shared_lock<std::shared_mutex> lock(registry.mutex);
+    return registry.names.size();
+}
+
+} // namespace objectmodel
+
+} // namespace core
+
+} // namespace sofa
@@ -0,0 +1,76 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_CORE_OBJECTMODEL_NAMEREGISTRY_H
+#define SOFA_CORE_OBJECTMODEL_NAMEREGISTRY_H
+
+#include <sofa/core/config.h>
+#include <string>
+#include <string_view>
+
+namespace sofa
+{
+
+namespace core
+{
+
+namespace objectmodel
+{
+
+/**
+ *  \brief Global table of interned Data and Link names.
+ *
+ *  Each distinct name is stored once and identified by a non-zero token, so that
+ *  the field lookups of Base compare integers instead of strings.
+ *  A name that was never interned cannot be the name of any field, which gives
+ *  a fast negative answer to findData/findLink.
+ *
+ *  All methods are thread-safe.
+ */
+class SOFA_CORE_API NameRegistry
+{
+public:
+    typedef unsigned int Token;
+
+    /// Token of no name
+    static constexpr Token InvalidToken = 0;
+
+    /// Return the token of the given name, registering it if needed
+    static Token intern(std::string_view name);
+
+    /// Return the token of the given name, or InvalidToken if it was never registered.
+    /// Does not allocate.
+    static Token find(std::string_view name);
+
+    /// Return the name of a valid token
+    static const std::string& getName(Token token);
+
+    /// Number of registered names
+    static std::size_t size();
+};
+
+} // namespace objectmodel
+
+} // namespace core
+
+} // namespace sofa
+
+#endif
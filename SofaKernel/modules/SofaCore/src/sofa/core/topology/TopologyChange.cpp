@@ -21,6 +21,9 @@
 ******************************************************************************/
 #include <sofa/core/topology/TopologyChange.h>
 
+#include <algorithm>
+#include <unordered_map>
+
 namespace sofa
 {
 
@@ -30,6 +33,41 @@ namespace core
 namespace topology
 {
 
+ElementsRemovalRemap::ElementsRemovalRemap(std::size_t size, const sofa::helper::vector<Topology::ElemID>& removedIndices)
+    : m_size(size)
+    , m_newSize(size >= removedIndices.size() ? size - removedIndices.size() : 0)
+{
+    if (size == 0)
+        return;
+
+    // Original element stored at each position modified by the swaps
+    std::unordered_map<Topology::ElemID, Topology::ElemID> contents;
+    const auto getContent = [&contents](Topology::ElemID position)
+    {
+        const auto it = contents.find(position);
+        return it == contents.end() ? position : it->second;
+    };
+
+    m_removedElements.reserve(removedIndices.size());
+    Topology::ElemID last = Topology::ElemID(size - 1);
+    for (const Topology::ElemID index : removedIndices)
+    {
+        const Topology::ElemID removed = getContent(index);
+        m_removedElements.push_back(removed);
+        contents[index] = getContent(last);
+        contents[last] = removed;
+        --last;
+    }
+
+    for (const auto& content : contents)
+    {
+        if (content.first < m_newSize && content.first != content.second)
+            m_moves.emplace_back(content.first, content.second);
+    }
+    std::sort(m_moves.begin(), m_moves.end());
+}
+
+
 SOFA_CORE_API TopologyObjectType parseTopologyObjectTypeFromString(const std::string& s)
 {
     std::string sUP = s;
@@ -23,6 +23,7 @@
 #define SOFA_CORE_TOPOLOGY_TOPOLOGYCHANGE_H
 
 #include <sofa/core/topology/Topology.h>
+#include <sofa/helper/logging/Messaging.h>
 
 namespace sofa
 {
@@ -128,6 +129,55 @@ class SOFA_CORE_API HexahedraRenumbering;
 
 
 
+/** Moves of the values of a topology data when elements are removed.
+ *
+ * Elements are removed one after the other by swapping each of them with the last element of the
+ * container, which is then shrinked. This class computes the result of the whole sequence at once,
+ * so that the data can be updated in a single pass instead of one swap per removed element.
+ */
+class SOFA_CORE_API ElementsRemovalRemap
+{
+public:
+    /// Compute the moves of the removal of the given indices (in removal order) from a container of the given size
+    ElementsRemovalRemap(std::size_t size, const sofa::helper::vector<Topology::ElemID>& removedIndices);
+
+    /// Size of the container after the removal
+    std::size_t getNewSize() const { return m_newSize; }
+
+    /// Original index of the element removed at each step, in removal order
+    const sofa::helper::vector<Topology::ElemID>& getRemovedElements() const { return m_removedElements; }
+
+    /// Pairs (new index, original index) of the remaining elements whose index changes, by increasing new index
+    const sofa::helper::vector< std::pair<Topology::ElemID, Topology::ElemID> >& getMoves() const { return m_moves; }
+
+    /// Apply the moves and shrink the container
+    template<class Container>
+    void apply(Container& data) const
+    {
+        if (data.size() < m_size)
+        {
+            msg_error("ElementsRemovalRemap") << "The removal was computed for " << m_size << " elements, but the container only has "
+                                              << data.size() << ": it is left unchanged.";
+            return;
+        }
+
+        // Values are read before being written, as a moved value can be the destination of another move
+        sofa::helper::vector<typename Container::value_type> movedValues;
+        movedValues.reserve(m_moves.size());
+        for (const auto& move : m_moves)
+            movedValues.push_back(data[move.second]);
+        for (std::size_t i = 0; i < m_moves.size(); ++i)
+            data[m_moves[i].first] = movedValues[i];
+        data.resize(m_newSize);
+    }
+
+protected:
+    std::size_t m_size;
+    std::size_t m_newSize;
+    sofa::helper::vector<Topology::ElemID> m_removedElements;
+    sofa::helper::vector< std::pair<Topology::ElemID, Topology::ElemID> > m_moves;
+};
+
 /// Topology identification of a primitive element
 struct TopologyElemID
 {
@@ -33,6 +33,7 @@
 #include <sofa/core/loader/MeshLoader.h>
 #include <sofa/defaulttype/RigidTypes.h>
 #include <sofa/core/visual/VisualParams.h>
+#include <SofaEngine/ROISpatialIndex.h>
 
 namespace sofa
 {
@@ -180,10 +181,30 @@ protected:
         Vec3 normal;
         Vec3 plane0, plane1, plane2, plane3;
         double width, length, depth;
+        Vec3 minBBox, maxBBox; ///< axis-aligned bounding box, slightly inflated
     };
 
     vector<OrientedBox> m_orientedBoxes;
 
+    /// Spatial index of a kind of element, rebuilt only when the rest positions or the elements change
+    struct ElementIndex
+    {
+        ROIPointGrid centers; ///< used when the selection is not strict
+        ROIElementsByVertex byFirstVertex; ///< used when the selection is strict
+        void clear() { centers.clear(); byFirstVertex.clear(); }
+    };
+
+    /// Spatial indices, so that moving the boxes does not require a scan of the whole mesh
+    ROIPointGrid m_pointGrid;
+    ElementIndex m_edgeIndex;
+    ElementIndex m_triangleIndex;
+    ElementIndex m_tetrahedronIndex;
+    ElementIndex m_hexahedronIndex;
+    ElementIndex m_quadIndex;
+    vector<defaulttype::BoundingBox> m_boxesBBoxes;
+    vector<bool> m_isPointInROI;
+    vector<sofa::Index> m_candidates;
+
     BoxROI();
     ~BoxROI() override {}
 
@@ -204,6 +225,20 @@ protected:
     bool isQuadInBoxes(const Quad& q);
     bool isQuadInBoxesStrict(const Quad& q);
 
+    template<class Element>
+    CPos getElementCenter(const Element& e);
+
+    /// Select the elements in the boxes among the candidates given by the spatial index
+    /// @param pointIndices indices of the points in the boxes, which must be flagged in m_isPointInROI
+    template<class Element>
+    void selectElements(const vector<Element>& elements, bool strict, const SetIndex& pointIndices, ElementIndex& index,
+                        SetIndex& elementIndices, vector<Element>& elementsInROI);
+
+    /// Axis-aligned bounding boxes of all the boxes, to query the spatial indices
+    void computeBoxesBBoxes();
+
+    static defaulttype::Vector3 toVector3(const CPos& p);
+
     void getPointsFromOrientedBox(const Vec10& box, vector<Vec3> &points);
 };
 
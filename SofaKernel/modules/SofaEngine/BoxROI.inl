@@ -380,6 +380,28 @@ void BoxROI<DataTypes>::computeOrientedBoxes()
         m_orientedBoxes[i].width = fabs(dot((p2-p0),plane0));
         m_orientedBoxes[i].length = fabs(dot((p2-p0),plane2));
         m_orientedBoxes[i].depth = depth;
+
+        Vec3& minBBox = m_orientedBoxes[i].minBBox;
+        Vec3& maxBBox = m_orientedBoxes[i].maxBBox;
+        minBBox = maxBBox = p0;
+        for (const Vec3& corner : {p0, p1, p2, p3})
+        {
+            for (const Vec3& p : {corner + normal * (depth/2), corner - normal * (depth/2)})
+            {
+                for (unsigned int k=0; k<3; ++k)
+                {
+                    minBBox[k] = std::min(minBBox[k], p[k]);
+                    maxBBox[k] = std::max(maxBBox[k], p[k]);
+                }
+            }
+        }
+        // rounding margin, as the inclusion test is made with the planes and not the corners
+        for (unsigned int k=0; k<3; ++k)
+        {
+            const Real margin = (fabs(minBBox[k]) + fabs(maxBBox[k])) * 1.0e-8;
+            minBBox[k] -= margin;
+            maxBBox[k] += margin;
+        }
     }
 }
 
@@ -440,12 +462,7 @@ bool BoxROI<DataTypes>::isPointInBoxes(const PointID& pid)
 template <class DataTypes>
 bool BoxROI<DataTypes>::isEdgeInBoxes(const Edge& e)
 {
-    const VecCoord& x0 = d_X0.getValue();
-    CPos p0 =  DataTypes::getCPos(x0[e[0]]);
-    CPos p1 =  DataTypes::getCPos(x0[e[1]]);
-    CPos c = (p1+p0)*0.5;
-
-    return isPointInBoxes(c);
+    return isPointInBoxes(getElementCenter(e));
 }
 
 template <class DataTypes>
@@ -461,13 +478,7 @@ bool BoxROI<DataTypes>::isEdgeInBoxesStrict(const Edge& e)
 template <class DataTypes>
 bool BoxROI<DataTypes>::isTriangleInBoxes(const Triangle& t)
 {
-    const VecCoord& x0 = d_X0.getValue();
-    CPos p0 =  DataTypes::getCPos(x0[t[0]]);
-    CPos p1 =  DataTypes::getCPos(x0[t[1]]);
-    CPos p2 =  DataTypes::getCPos(x0[t[2]]);
-    CPos c = (p2+p1+p0)/3.0;
-
-    return (isPointInBoxes(c));
+    return isPointInBoxes(getElementCenter(t));
 }
 
 template <class DataTypes>
@@ -484,14 +495,7 @@ bool BoxROI<DataTypes>::isTriangleInBoxesStrict(const Triangle& t)
 template <class DataTypes>
 bool BoxROI<DataTypes>::isTetrahedronInBoxes(const Tetra &t)
 {
-    const VecCoord& x0 = d_X0.getValue();
-    CPos p0 =  DataTypes::getCPos(x0[t[0]]);
-    CPos p1 =  DataTypes::getCPos(x0[t[1]]);
-    CPos p2 =  DataTypes::getCPos(x0[t[2]]);
-    CPos p3 =  DataTypes::getCPos(x0[t[3]]);
-    CPos c = (p3+p2+p1+p0)/4.0;
-
-    return (isPointInBoxes(c));
+    return isPointInBoxes(getElementCenter(t));
 }
 
 template <class DataTypes>
@@ -509,18 +513,7 @@ bool BoxROI<DataTypes>::isTetrahedronInBoxesStrict(const Tetra &t)
 template <class DataTypes>
 bool BoxROI<DataTypes>::isHexahedronInBoxes(const Hexa &t)
 {
-    const VecCoord& x0 = d_X0.getValue();
-    CPos p0 =  DataTypes::getCPos(x0[t[0]]);
-    CPos p1 =  DataTypes::getCPos(x0[t[1]]);
-    CPos p2 =  DataTypes::getCPos(x0[t[2]]);
-    CPos p3 =  DataTypes::getCPos(x0[t[3]]);
-    CPos p4 =  DataTypes::getCPos(x0[t[4]]);
-    CPos p5 =  DataTypes::getCPos(x0[t[5]]);
-    CPos p6 =  DataTypes::getCPos(x0[t[6]]);
-    CPos p7 =  DataTypes::getCPos(x0[t[7]]);
-    CPos c = (p7+p6+p5+p4+p3+p2+p1+p0)/8.0;
-
-    return (isPointInBoxes(c));
+    return isPointInBoxes(getElementCenter(t));
 }
 
 template <class DataTypes>
@@ -543,14 +536,7 @@ bool BoxROI<DataTypes>::isHexahedronInBoxesStrict(const Hexa &t)
 template <class DataTypes>
 bool BoxROI<DataTypes>::isQuadInBoxes(const Quad& q)
 {
-    const VecCoord& x0 = d_X0.getValue();
-    CPos p0 =  DataTypes::getCPos(x0[q[0]]);
-    CPos p1 =  DataTypes::getCPos(x0[q[1]]);
-    CPos p2 =  DataTypes::getCPos(x0[q[2]]);
-    CPos p3 =  DataTypes::getCPos(x0[q[3]]);
-    CPos c = (p3+p2+p1+p0)/4.0;
-
-    return (isPointInBoxes(c));
+    return isPointInBoxes(getElementCenter(q));
 }
 
 template <class DataTypes>
@@ -569,6 +555,29 @@ bool BoxROI<DataTypes>::isQuadInBoxesStrict(const Quad& q)
 template <class DataTypes>
 void BoxROI<DataTypes>::doUpdate()
 {
+    // The spatial indices only depend on the rest positions and the topology: they are kept
+    // when only the boxes move
+    if (m_dataTracker.hasChanged(d_X0))
+    {
+        m_pointGrid.clear();
+        m_isPointInROI.clear();
+        m_edgeIndex.clear();
+        m_triangleIndex.clear();
+        m_tetrahedronIndex.clear();
+        m_hexahedronIndex.clear();
+        m_quadIndex.clear();
+    }
+    if (m_dataTracker.hasChanged(d_edges))
+        m_edgeIndex.clear();
+    if (m_dataTracker.hasChanged(d_triangles))
+        m_triangleIndex.clear();
+    if (m_dataTracker.hasChanged(d_tetrahedra))
+        m_tetrahedronIndex.clear();
+    if (m_dataTracker.hasChanged(d_hexahedra))
+        m_hexahedronIndex.clear();
+    if (m_dataTracker.hasChanged(d_quad))
+        m_quadIndex.clear();
+
     if(d_componentState.getValue() == ComponentState::Invalid){
         return ;
     }
@@ -635,97 +644,130 @@ void BoxROI<DataTypes>::doUpdate()
 
         const VecCoord& x0 = d_X0.getValue();
 
+        computeBoxesBBoxes();
 
         //Points
-        for( unsigned i=0; i<x0.size(); ++i )
+        if (!m_pointGrid.isBuilt())
+        {
+            vector<defaulttype::Vector3> positions(x0.size());
+            for (unsigned int i=0; i<x0.size(); ++i)
+                positions[i] = toVector3(DataTypes::getCPos(x0[i]));
+            m_pointGrid.build(positions);
+        }
+        m_pointGrid.findCandidates(m_boxesBBoxes, m_candidates);
+        m_isPointInROI.resize(x0.size(), false);
+        for (const sofa::Index i : m_candidates)
         {
             if (isPointInBoxes(i))
             {
                 indices.push_back(i);
                 pointsInROI.push_back(x0[i]);
+                m_isPointInROI[i] = true;
             }
         }
 
-        //Edges
         if (d_computeEdges.getValue())
-        {
-            for(unsigned int i=0 ; i<edges.size() ; i++)
-            {
-                Edge e = edges[i];
-                bool is_in_box = (strict) ? isEdgeInBoxesStrict(e) : isEdgeInBoxes(e);
-                if (is_in_box)
-                {
-                    edgeIndices.push_back(i);
-                    edgesInROI.push_back(e);
-                }
-            }
-        }
+            selectElements(edges.ref(), strict, indices, m_edgeIndex, edgeIndices, edgesInROI.wref());
 
-        //Triangles
         if (d_computeTriangles.getValue())
-        {
-            for(unsigned int i=0 ; i<triangles.size() ; i++)
-            {
-                Triangle t = triangles[i];
-                bool is_in_box = (strict) ? isTriangleInBoxesStrict(t) : isTriangleInBoxes(t);
-                if (is_in_box)
-                {
-                    triangleIndices.push_back(i);
-                    trianglesInROI.push_back(t);
-                }
-            }
-        }
+            selectElements(triangles.ref(), strict, indices, m_triangleIndex, triangleIndices, trianglesInROI.wref());
 
-        //Tetrahedra
         if (d_computeTetrahedra.getValue())
-        {
-            for(unsigned int i=0 ; i<tetrahedra.size() ; i++)
-            {
-                Tetra t = tetrahedra[i];
-                bool is_in_box = (strict) ? isTetrahedronInBoxesStrict(t) : isTetrahedronInBoxes(t);
-                if (is_in_box)
-                {
-                    tetrahedronIndices.push_back(i);
-                    tetrahedraInROI.push_back(t);
-                }
-            }
-        }
+            selectElements(tetrahedra.ref(), strict, indices, m_tetrahedronIndex, tetrahedronIndices, tetrahedraInROI.wref());
 
-        //Hexahedra
         if (d_computeHexahedra.getValue())
-        {
-            for(unsigned int i=0 ; i<hexahedra.size() ; i++)
-            {
-                Hexa t = hexahedra[i];
-                bool is_in_box = (strict) ? isHexahedronInBoxesStrict(t) : isHexahedronInBoxes(t);
-                if (is_in_box)
-                {
-                    hexahedronIndices.push_back(i);
-                    hexahedraInROI.push_back(t);
-                }
-            }
-        }
+            selectElements(hexahedra.ref(), strict, indices, m_hexahedronIndex, hexahedronIndices, hexahedraInROI.wref());
 
-        //Quads
         if (d_computeQuad.getValue())
+            selectElements(quad.ref(), strict, indices, m_quadIndex, quadIndices, quadInROI.wref());
+
+        // only the flags of the selected points are reset, to keep the update independent of the mesh size
+        for (const sofa::Index i : indices)
+            m_isPointInROI[i] = false;
+
+        d_nbIndices.setValue(indices.size());
+    }
+}
+
+
+template <class DataTypes>
+template <class Element>
+typename BoxROI<DataTypes>::CPos BoxROI<DataTypes>::getElementCenter(const Element& e)
+{
+    const VecCoord& x0 = d_X0.getValue();
+    const std::size_t n = e.size();
+    CPos c = DataTypes::getCPos(x0[e[n-1]]);
+    for (std::size_t i=n-1; i-- > 0; )
+        c += DataTypes::getCPos(x0[e[i]]);
+    return c / Real(n);
+}
+
+template <class DataTypes>
+template <class Element>
+void BoxROI<DataTypes>::selectElements(const vector<Element>& elements, bool strict, const SetIndex& pointIndices, ElementIndex& index,
+                                       SetIndex& elementIndices, vector<Element>& elementsInROI)
+{
+    const VecCoord& x0 = d_X0.getValue();
+
+    if (strict)
+    {
+        // all the vertices are in the boxes, the first one in particular
+        if (!index.byFirstVertex.isBuilt())
+            index.byFirstVertex.build(x0.size(), elements);
+        index.byFirstVertex.findCandidates(pointIndices, m_candidates);
+    }
+    else
+    {
+        if (!index.centers.isBuilt())
         {
-            for(unsigned int i=0 ; i<quad.size() ; i++)
-            {
-                Quad q = quad[i];
-                bool is_in_box = (strict) ? isQuadInBoxesStrict(q) : isQuadInBoxes(q);
-                if (is_in_box)
-                {
-                    quadIndices.push_back(i);
-                    quadInROI.push_back(q);
-                }
-            }
+            vector<defaulttype::Vector3> centers(elements.size());
+            for (unsigned int i=0; i<elements.size(); ++i)
+                centers[i] = toVector3(getElementCenter(elements[i]));
+            index.centers.build(centers);
         }
+        index.centers.findCandidates(m_boxesBBoxes, m_candidates);
+    }
 
+    for (const sofa::Index i : m_candidates)
+    {
+        const Element& e = elements[i];
+        bool isInBoxes = true;
+        if (strict)
+        {
+            for (std::size_t j=0; j<e.size() && isInBoxes; ++j)
+                isInBoxes = e[j] < x0.size() && m_isPointInROI[e[j]];
+        }
+        else
+        {
+            isInBoxes = isPointInBoxes(getElementCenter(e));
+        }
 
-        d_nbIndices.setValue(indices.size());
+        if (isInBoxes)
+        {
+            elementIndices.push_back(i);
+            elementsInROI.push_back(e);
+        }
     }
 }
 
+template <class DataTypes>
+void BoxROI<DataTypes>::computeBoxesBBoxes()
+{
+    m_boxesBBoxes.clear();
+    for (const Vec6& box : d_alignedBoxes.getValue())
+        m_boxesBBoxes.push_back(defaulttype::BoundingBox(Vector3(box[0], box[1], box[2]), Vector3(box[3], box[4], box[5])));
+    for (const OrientedBox& box : m_orientedBoxes)
+        m_boxesBBoxes.push_back(defaulttype::BoundingBox(box.minBBox, box.maxBBox));
+}
+
+template <class DataTypes>
+defaulttype::Vector3 BoxROI<DataTypes>::toVector3(const CPos& p)
+{
+    Vector3 v;
+    for (std::size_t k=0; k<std::min<std::size_t>(3, p.size()); ++k)
+        v[k] = p[k];
+    return v;
+}
 
 template <class DataTypes>
 void BoxROI<DataTypes>::draw(const core::visual::VisualParams* vparams)
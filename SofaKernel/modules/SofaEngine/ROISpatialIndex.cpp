@@ -0,0 +1,215 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaEngine/ROISpatialIndex.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace sofa
+{
+
+namespace component
+{
+
+namespace engine
+{
+
+namespace
+{
+
+bool isFinite(const defaulttype::Vector3& p)
+{
+    return std::isfinite(p[0]) && std::isfinite(p[1]) && std::isfinite(p[2]);
+}
+
+} // namespace
+
+void ROIPointGrid::build(const helper::vector<Vec3>& points)
+{
+    clear();
+    m_isBuilt = true;
+
+    bool isEmpty = true;
+    for (const Vec3& p : points)
+    {
+        if (!isFinite(p))
+            continue;
+        if (isEmpty)
+        {
+            m_minBBox = m_maxBBox = p;
+            isEmpty = false;
+        }
+        for (unsigned int k = 0; k < 3; ++k)
+        {
+            m_minBBox[k] = std::min(m_minBBox[k], p[k]);
+            m_maxBBox[k] = std::max(m_maxBBox[k], p[k]);
+        }
+    }
+    if (isEmpty)
+        return;
+
+    // About one point per cell, over the dimensions along which the points are spread
+    const Vec3 extent = m_maxBBox - m_minBBox;
+    const SReal maxExtent = std::max(extent[0], std::max(extent[1], extent[2]));
+    const std::size_t maxNbCells = 4 * points.size() + 8;
+    if (maxExtent > 0)
+    {
+        SReal volume = 1;
+        int nbDimensions = 0;
+        for (unsigned int k = 0; k < 3; ++k)
+        {
+            if (extent[k] > maxExtent * 1.0e-3)
+            {
+                volume *= extent[k];
+                ++nbDimensions;
+            }
+        }
+        m_cellSize = std::pow(volume / SReal(points.size()), SReal(1) / SReal(nbDimensions));
+        if (!(m_cellSize > 0))
+            m_cellSize = maxExtent;
+
+        std::size_t nbCells;
+        do
+        {
+            nbCells = 1;
+            for (unsigned int k = 0; k < 3; ++k)
+            {
+                m_nbCells[k] = int(std::min(std::floor(extent[k] / m_cellSize), SReal(maxNbCells))) + 1;
+                nbCells *= std::size_t(m_nbCells[k]);
+            }
+            if (nbCells > maxNbCells)
+                m_cellSize *= 1.25;
+        } while (nbCells > maxNbCells);
+    }
+    else
+    {
+        m_nbCells[0] = m_nbCells[1] = m_nbCells[2] = 1;
+    }
+
+    // Counting sort of the points by cell, which keeps the points of a cell in increasing order
+    const std::size_t nbCells = std::size_t(m_nbCells[0]) * std::size_t(m_nbCells[1]) * std::size_t(m_nbCells[2]);
+    helper::vector<Index> pointCells(points.size(), Index(nbCells));
+    m_cellBegin.assign(nbCells + 1, 0);
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        const Vec3& p = points[i];
+        if (!isFinite(p))
+            continue;
+        pointCells[i] = Index(getCellCoordinate(p[0], 0)
+                + m_nbCells[0] * (getCellCoordinate(p[1], 1) + m_nbCells[1] * getCellCoordinate(p[2], 2)));
+        ++m_cellBegin[pointCells[i] + 1];
+    }
+    for (std::size_t c = 0; c < nbCells; ++c)
+        m_cellBegin[c + 1] += m_cellBegin[c];
+
+    m_cellPoints.resize(m_cellBegin[nbCells]);
+    helper::vector<Index> insert(m_cellBegin.begin(), m_cellBegin.end() - 1);
+    for (std::size_t i = 0; i < points.size(); ++i)
+        if (pointCells[i] < nbCells)
+            m_cellPoints[insert[pointCells[i]]++] = Index(i);
+}
+
+void ROIPointGrid::clear()
+{
+    m_isBuilt = false;
+    m_nbCells[0] = m_nbCells[1] = m_nbCells[2] = 0;
+    m_cellSize = 1;
+    m_cellBegin.clear();
+    m_cellPoints.clear();
+}
+
+int ROIPointGrid::getCellCoordinate(SReal x, unsigned int axis) const
+{
+    const SReal c = std::floor((x - m_minBBox[axis]) / m_cellSize);
+    return int(std::max(SReal(0), std::min(c, SReal(m_nbCells[axis] - 1))));
+}
+
+void ROIPointGrid::findCandidates(const helper::vector<BoundingBox>& boxes, helper::vector<Index>& candidates) const
+{
+    candidates.clear();
+    if (m_cellPoints.empty())
+        return;
+
+    for (const BoundingBox& box : boxes)
+    {
+        const Vec3& minBBox = box.minBBox();
+        const Vec3& maxBBox = box.maxBBox();
+
+        bool overlaps = true;
+        for (unsigned int k = 0; k < 3; ++k)
+        {
+            // also rejects NaN bounds
+            if (!(minBBox[k] <= maxBBox[k]) || !(minBBox[k] <= m_maxBBox[k]) || !(maxBBox[k] >= m_minBBox[k]))
+                overlaps = false;
+        }
+        if (!overlaps)
+            continue;
+
+        int begin[3], end[3];
+        for (unsigned int k = 0; k < 3; ++k)
+        {
+            begin[k] = getCellCoordinate(minBBox[k], k);
+            end[k] = getCellCoordinate(maxBBox[k], k);
+        }
+        for (int z = begin[2]; z <= end[2]; ++z)
+        {
+            for (int y = begin[1]; y <= end[1]; ++y)
+            {
+                const std::size_t row = std::size_t(m_nbCells[0]) * (std::size_t(y) + std::size_t(m_nbCells[1]) * std::size_t(z));
+                candidates.insert(candidates.end(),
+                                  m_cellPoints.begin() + m_cellBegin[row + begin[0]],
+                                  m_cellPoints.begin() + m_cellBegin[row + end[0] + 1]);
+            }
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    if (boxes.size() > 1)
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+}
+
+void ROIElementsByVertex::clear()
+{
+    m_isBuilt = false;
+    m_elementBegin.clear();
+    m_elements.clear();
+}
+
+void ROIElementsByVertex::findCandidates(const helper::vector<Index>& points, helper::vector<Index>& candidates) const
+{
+    candidates.clear();
+    if (m_elementBegin.empty())
+        return;
+
+    const std::size_t nbPoints = m_elementBegin.size() - 1;
+    for (const Index p : points)
+        if (p < nbPoints)
+            candidates.insert(candidates.end(), m_elements.begin() + m_elementBegin[p], m_elements.begin() + m_elementBegin[p + 1]);
+
+    std::sort(candidates.begin(), candidates.end());
+}
+
+} // namespace engine
+
+} // namespace component
+
+} // namespace sofa
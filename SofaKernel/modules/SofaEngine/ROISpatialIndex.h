@@ -0,0 +1,127 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_COMPONENT_ENGINE_ROISPATIALINDEX_H
+#define SOFA_COMPONENT_ENGINE_ROISPATIALINDEX_H
+#include "config.h"
+
+#include <sofa/defaulttype/Vec.h>
+#include <sofa/defaulttype/BoundingBox.h>
+#include <sofa/helper/vector.h>
+
+namespace sofa
+{
+
+namespace component
+{
+
+namespace engine
+{
+
+/**
+ * Uniform grid over a fixed set of points, typically the rest positions given to a ROI engine.
+ *
+ * It returns the points lying in the cells overlapping some bounding boxes, so that a ROI only
+ * tests the points near its regions instead of the whole mesh. The grid depends only on the
+ * points: it is built once and queried again each time the regions move.
+ */
+class SOFA_ENGINE_API ROIPointGrid
+{
+public:
+    typedef defaulttype::Vector3 Vec3;
+    typedef defaulttype::BoundingBox BoundingBox;
+    typedef sofa::Index Index;
+
+    /// Build the grid with about one point per cell. Points with non-finite coordinates are ignored.
+    void build(const helper::vector<Vec3>& points);
+
+    void clear();
+
+    bool isBuilt() const { return m_isBuilt; }
+
+    /// Indices of the points in the cells overlapping at least one of the boxes, sorted and without duplicates.
+    /// The caller is responsible for the exact inclusion test. Empty or invalid boxes are skipped.
+    void findCandidates(const helper::vector<BoundingBox>& boxes, helper::vector<Index>& candidates) const;
+
+protected:
+    /// Cell coordinate of x along an axis, clamped to the grid
+    int getCellCoordinate(SReal x, unsigned int axis) const;
+
+    bool m_isBuilt {false};
+    Vec3 m_minBBox;
+    Vec3 m_maxBBox;
+    SReal m_cellSize {1};
+    int m_nbCells[3] {0, 0, 0};
+
+    /// Points sorted by cell: the points of cell c are m_cellPoints[m_cellBegin[c]..m_cellBegin[c+1]]
+    helper::vector<Index> m_cellBegin;
+    helper::vector<Index> m_cellPoints;
+};
+
+/**
+ * Elements of a mesh listed by their first vertex.
+ *
+ * An element whose vertices are all in a region is found from the vertices of this region,
+ * without scanning the whole element list.
+ */
+class SOFA_ENGINE_API ROIElementsByVertex
+{
+public:
+    typedef sofa::Index Index;
+
+    template<class Element>
+    void build(std::size_t nbPoints, const helper::vector<Element>& elements)
+    {
+        m_elementBegin.assign(nbPoints + 1, 0);
+        for (const Element& e : elements)
+            if (e[0] < nbPoints)
+                ++m_elementBegin[e[0] + 1];
+        for (std::size_t p = 0; p < nbPoints; ++p)
+            m_elementBegin[p + 1] += m_elementBegin[p];
+
+        m_elements.resize(m_elementBegin[nbPoints]);
+        helper::vector<Index> insert(m_elementBegin.begin(), m_elementBegin.end() - 1);
+        for (std::size_t i = 0; i < elements.size(); ++i)
+            if (elements[i][0] < nbPoints)
+                m_elements[insert[elements[i][0]]++] = Index(i);
+        m_isBuilt = true;
+    }
+
+    void clear();
+
+    bool isBuilt() const { return m_isBuilt; }
+
+    /// Indices of the elements whose first vertex is one of the given points, sorted
+    void findCandidates(const helper::vector<Index>& points, helper::vector<Index>& candidates) const;
+
+protected:
+    bool m_isBuilt {false};
+    helper::vector<Index> m_elementBegin;
+    helper::vector<Index> m_elements;
+};
+
+} // namespace engine
+
+} // namespace component
+
+} // namespace sofa
+
+#endif
@@ -328,6 +328,74 @@ struct BoxROITest :  public ::testing::Test
     }
 
 
+    /// Test that the selection follows a moving box, and the rest positions when they change
+    void movingBoxTest()
+    {
+        typedef typename TheBoxROI::Vec6 Vec6;
+        typedef typename TheBoxROI::SetIndex SetIndex;
+        typedef typename TheBoxROI::Edge Edge;
+
+        // 10x10 grid of points in the plane z=0, with edges along x
+        typename TheBoxROI::VecCoord positions;
+        sofa::helper::vector<Edge> edges;
+        for (unsigned int j=0; j<10; ++j)
+        {
+            for (unsigned int i=0; i<10; ++i)
+            {
+                typename TheBoxROI::Coord p;
+                TDataType::set(p, SReal(i), SReal(j), SReal(0));
+                positions.push_back(p);
+                if (i > 0)
+                    edges.push_back(Edge(10*j+i-1, 10*j+i));
+            }
+        }
+
+        m_boxroi->d_X0.setValue(positions);
+        m_boxroi->d_edges.setValue(edges);
+
+        for (const bool strict : {true, false})
+        {
+            m_boxroi->d_strict.setValue(strict);
+            for (unsigned int step=0; step<16; ++step)
+            {
+                const SReal shift = (step < 8) ? 0 : 1;
+                if (step == 8)
+                {
+                    for (auto& p : positions)
+                        TDataType::add(p, SReal(1), SReal(0), SReal(0));
+                    m_boxroi->d_X0.setValue(positions);
+                }
+
+                const SReal xmin = 0.25 * step - 0.5;
+                const Vec6 box(xmin, 1.5, -1, xmin + 2.5, 6, 1);
+                m_boxroi->d_alignedBoxes.setValue({box});
+                m_boxroi->update();
+
+                SetIndex expectedIndices, expectedEdgeIndices;
+                auto isInBox = [&](SReal x, SReal y) { return x >= box[0] && x <= box[3] && y >= box[1] && y <= box[4]; };
+                for (unsigned int k=0; k<positions.size(); ++k)
+                    if (isInBox(k%10 + shift, k/10))
+                        expectedIndices.push_back(k);
+                for (unsigned int k=0; k<edges.size(); ++k)
+                {
+                    const SReal x0 = edges[k][0]%10 + shift, x1 = edges[k][1]%10 + shift, y = edges[k][0]/10;
+                    if (strict ? (isInBox(x0, y) && isInBox(x1, y)) : isInBox((x0 + x1) * 0.5, y))
+                        expectedEdgeIndices.push_back(k);
+                }
+
+                EXPECT_EQ(m_boxroi->d_indices.getValue(), expectedIndices) << "step " << step;
+                EXPECT_EQ(m_boxroi->d_edgeIndices.getValue(), expectedEdgeIndices) << "step " << step;
+                EXPECT_EQ(m_boxroi->d_pointsInROI.getValue().size(), expectedIndices.size());
+            }
+
+            // restore the rest positions for the next pass
+            for (auto& p : positions)
+                TDataType::add(p, SReal(-1), SReal(0), SReal(0));
+            m_boxroi->d_X0.setValue(positions);
+        }
+    }
+
+
     /// Test computeBBox computation with a simple example
     void computeBBoxTest()
     {
@@ -417,6 +485,10 @@ TYPED_TEST(BoxROITest, isPointInBoxesTest) {
     ASSERT_NO_THROW(this->isPointInBoxesTest());
 }
 
+TYPED_TEST(BoxROITest, movingBoxTest) {
+    ASSERT_NO_THROW(this->movingBoxTest());
+}
+
 TYPED_TEST(BoxROITest, computeBBoxTest) {
     ASSERT_NO_THROW(this->computeBBoxTest());
 }
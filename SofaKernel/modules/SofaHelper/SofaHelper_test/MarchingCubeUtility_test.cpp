@@ -0,0 +1,107 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/helper/MarchingCubeUtility.h>
+
+#include <sofa/helper/testing/BaseTest.h>
+using sofa::helper::testing::BaseTest ;
+
+#include <map>
+
+namespace sofa {
+
+using helper::MarchingCubeUtility;
+using defaulttype::Vector3;
+
+/// The slab extraction gives a watertight mesh, identical whatever the number of threads,
+/// and the same surface as the sequential run
+struct MarchingCubeUtilityTest: public BaseTest
+{
+    typedef MarchingCubeUtility::PointID PointID;
+    typedef MarchingCubeUtility::Vec3i Vec3i;
+
+    std::vector<unsigned char> data;
+    const Vec3i resolution {21,18,16};
+
+    void SetUp() override
+    {
+        // two overlapping balls
+        data.resize(resolution[0]*resolution[1]*resolution[2]);
+        for(int k=0; k<resolution[2]; k++) for(int j=0; j<resolution[1]; j++) for(int i=0; i<resolution[0]; i++)
+        {
+            const double d1 = (Vector3(i,j,k)-Vector3(7,8,7.5)).norm(), d2 = (Vector3(i,j,k)-Vector3(13,9,8)).norm();
+            const double v = 255.0*std::max(1.0-d1/6.0, 1.0-d2/5.0);
+            data[i+j*resolution[0]+k*resolution[0]*resolution[1]] = (unsigned char)std::max(0.0,std::min(255.0,v));
+        }
+    }
+
+    void run(unsigned int nbThreads, helper::vector<PointID>& triangles, helper::vector<Vector3>& vertices)
+    {
+        MarchingCubeUtility mc;
+        mc.setDataResolution(resolution);
+        mc.setDataVoxelSize(Vector3(0.5,0.5,0.5));
+        mc.setConvolutionSize(0);
+        mc.setNbThreads(nbThreads);
+        mc.run(data.data(), 100.5f, triangles, vertices);
+    }
+
+    /// each edge is shared by two triangles, with opposite orientations
+    void checkWatertight(const helper::vector<PointID>& triangles, size_t nbVertices)
+    {
+        std::map< std::pair<PointID,PointID>, int > edges;
+        for(size_t t=0; t<triangles.size(); t+=3)
+            for(int e=0; e<3; e++)
+            {
+                const PointID a = triangles[t+e], b = triangles[t+(e+1)%3];
+                ASSERT_LT(a, nbVertices);
+                ASSERT_NE(a, b);
+                edges[std::make_pair(a,b)]++;
+            }
+        for(const auto& e : edges)
+        {
+            EXPECT_EQ(e.second, 1);
+            EXPECT_EQ(edges.count(std::make_pair(e.first.second,e.first.first)), 1u);
+        }
+    }
+};
+
+TEST_F(MarchingCubeUtilityTest, slabs)
+{
+    helper::vector<PointID> triangles, triangles2, triangles3;
+    helper::vector<Vector3> vertices, vertices2, vertices3;
+    run(1, triangles, vertices);
+    run(2, triangles2, vertices2);
+    run(3, triangles3, vertices3);
+
+    ASSERT_FALSE(triangles2.empty());
+    checkWatertight(triangles2, vertices2.size());
+
+    EXPECT_EQ(triangles2, triangles3);
+    EXPECT_EQ(vertices2, vertices3);
+
+    // same triangles as the sequential run, with another vertex numbering
+    ASSERT_EQ(triangles.size(), triangles2.size());
+    ASSERT_EQ(vertices.size(), vertices2.size());
+    for(size_t i=0; i<triangles.size(); i++)
+        EXPECT_LT((vertices[triangles[i]]-vertices2[triangles2[i]]).norm(), 1e-3);
+}
+
+} // namespace sofa
@@ -0,0 +1,128 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/helper/io/MeshGmsh.h>
+
+#include <sofa/helper/testing/BaseTest.h>
+using sofa::helper::testing::BaseTest ;
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+namespace sofa {
+
+class MeshGmsh_test : public BaseTest
+{
+protected:
+    std::string m_filename;
+
+    void SetUp() override
+    {
+        m_filename = boost::filesystem::temp_directory_path().string() + "/MeshGmsh_test.msh";
+    }
+    void TearDown() override
+    {
+        boost::filesystem::remove(m_filename);
+    }
+
+    void write(const std::string& content)
+    {
+        std::ofstream file(m_filename.c_str(), std::ios::binary);
+        file << content;
+    }
+};
+
+TEST_F(MeshGmsh_test, version1)
+{
+    write("$NOD\n"
+          "5\n"
+          "1 0 0 0\n"
+          "2 1 0 0\n"
+          "3 0 1 0\n"
+          "4 0 0 1\n"
+          "5 1 1 1\n"
+          "$ENDNOD\n"
+          "$ELM\n"
+          "3\n"
+          "1 4 1 1 4 1 2 3 4\n"
+          "2 2 1 1 3 2 3 5\n"
+          "3 1 1 1 2 4 5\n"
+          "$ENDELM\n");
+
+    sofa::helper::io::MeshGmsh mesh(m_filename);
+    ASSERT_EQ(5u, mesh.getVertices().size());
+    EXPECT_EQ(1.0, mesh.getVertices()[4][2]);
+    ASSERT_EQ(1u, mesh.getTetrahedra().size());
+    EXPECT_EQ(3u, mesh.getTetrahedra()[0][3]);
+    ASSERT_EQ(1u, mesh.getTriangles().size());
+    EXPECT_EQ(4u, mesh.getTriangles()[0][2]);
+    ASSERT_EQ(1u, mesh.getEdges().size());
+    EXPECT_EQ(3u, mesh.getEdges()[0][0]);
+}
+
+TEST_F(MeshGmsh_test, version2)
+{
+    // unsorted node numbers, Windows end of lines, tags and an element type which is not supported
+    write("$MeshFormat\r\n"
+          "2.2 0 8\r\n"
+          "$EndMeshFormat\r\n"
+          "$Nodes\r\n"
+          "4\r\n"
+          "10 0 0 0\r\n"
+          "20 1.5e0 0 0\r\n"
+          "30 0 1 0\r\n"
+          "40 0 0 -1\r\n"
+          "$EndNodes\r\n"
+          "$Elements\r\n"
+          "4\r\n"
+          "1 15 2 0 1 10\r\n"
+          "2 4 2 7 1 10 20 30 40\r\n"
+          "3 2 2 8 2 10 20 30\r\n"
+          "4 2 2 8 2 20 30 40\r\n"
+          "$EndElements\r\n");
+
+    sofa::helper::io::MeshGmsh mesh(m_filename);
+    ASSERT_EQ(4u, mesh.getVertices().size());
+    EXPECT_EQ(1.5, mesh.getVertices()[1][0]);
+    EXPECT_EQ(-1.0, mesh.getVertices()[3][2]);
+    ASSERT_EQ(1u, mesh.getTetrahedra().size());
+    EXPECT_EQ(0u, mesh.getTetrahedra()[0][0]);
+    EXPECT_EQ(3u, mesh.getTetrahedra()[0][3]);
+    ASSERT_EQ(2u, mesh.getTriangles().size());
+    EXPECT_EQ(3u, mesh.getTriangles()[1][2]);
+    ASSERT_EQ(1u, mesh.getTrianglesGroups().size());
+    EXPECT_EQ(2, mesh.getTrianglesGroups()[0].nbp);
+}
+
+TEST_F(MeshGmsh_test, invalidNumber)
+{
+    write("$NOD\n"
+          "2\n"
+          "1 0 0 0\n"
+          "2 x 0 0\n"
+          "$ENDNOD\n");
+
+    EXPECT_MSG_EMIT(Error);
+    sofa::helper::io::MeshGmsh mesh(m_filename);
+    EXPECT_EQ(1u, mesh.getVertices().size());
+}
+
+}// namespace sofa
@@ -0,0 +1,190 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_HELPER_MARCHINGCUBESLABS_H
+#define SOFA_HELPER_MARCHINGCUBESLABS_H
+
+#include <sofa/helper/MarchingCubeUtility.h>
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+
+namespace sofa
+{
+namespace helper
+{
+
+/// Vertex of an isosurface extracted on a regular grid, identified by a grid edge:
+/// it lies on the edge from the grid point p to p + e_axis, at the parameter mu in [0,1].
+struct MarchingCubeEdgeVertex
+{
+    Vec<3,int> p;
+    int axis;
+    float mu;
+};
+
+/// @brief Marching cubes over the cells [cellMin,cellMax) of a regular grid, processed by slabs of cells along z.
+///
+/// value(i,j,k) returns the field at the grid point (i,j,k), which is inside the surface when its value is lower than isolevel.
+/// forEachSlab(nbSlabs,slabTask) must call slabTask(s) once for each slab s in [0,nbSlabs), concurrently or not.
+/// Each slab is polygonized on its own and welds its vertices by grid edge. The slabs are then merged in order and the vertices
+/// of the plane between two slabs are welded by grid edge too, so the indexed mesh is watertight and does not depend on the
+/// number of slabs nor on the execution order: vertices and triangles are numbered as in a single sweep over k, j, i,
+/// the vertices of a cell being created in the order of its edges.
+///
+/// With weldGridPoints, a vertex lying on a grid point (mu = 0 or 1) is shared by all the edges of this point,
+/// and the triangles whose vertices are not distinct are discarded. Otherwise each edge has its own vertex, as in CImg::isosurface3d.
+/// Triangles follow the vertex order of MarchingCubeTriTable.
+/// triangleCells, if not null, receives the cell of each triangle.
+template<class ValueFunctor, class ForEachSlab>
+void marchingCubeSlabs(const ValueFunctor& value, const Vec<3,int>& cellMin, const Vec<3,int>& cellMax, const float isolevel,
+                       const bool weldGridPoints, const unsigned int nbSlabs, const ForEachSlab& forEachSlab,
+                       vector<MarchingCubeEdgeVertex>& vertices, vector< Vec<3,unsigned int> >& triangles,
+                       vector< Vec<3,int> >* triangleCells = nullptr)
+{
+    typedef Vec<3,int> Vec3i;
+    typedef std::uint64_t Key;
+
+    vertices.clear();
+    triangles.clear();
+    if(triangleCells) triangleCells->clear();
+    if(cellMax[0]<=cellMin[0] || cellMax[1]<=cellMin[1] || cellMax[2]<=cellMin[2]) return;
+
+    // cube corners and edges, with the conventions of MarchingCubeEdgeTable
+    static const int corner[8][3] = { {0,0,0}, {1,0,0}, {1,1,0}, {0,1,0}, {0,0,1}, {1,0,1}, {1,1,1}, {0,1,1} };
+    // edges, oriented from their lower grid point
+    static const int edgeFrom[12] = { 0, 1, 3, 0, 4, 5, 7, 4, 0, 1, 2, 3 };
+    static const int edgeTo[12] = { 1, 2, 2, 3, 5, 6, 6, 7, 4, 5, 6, 7 };
+    static const int edgeAxis[12] = { 0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2 };
+
+    // key of a vertex: grid point (within the points of the cells) and axis, axis 3 standing for the grid point itself
+    const Vec3i nbPoints = cellMax - cellMin + Vec3i(1,1,1);
+    auto key = [&](const Vec3i& p, int axis) -> Key
+    {
+        const Vec3i q = p - cellMin;
+        return ( ( (Key)q[2]*(Key)nbPoints[1] + (Key)q[1] ) * (Key)nbPoints[0] + (Key)q[0] ) * 4 + (Key)axis;
+    };
+
+    const int nbLayers = cellMax[2]-cellMin[2];
+    const int slabCount = std::max(1, std::min((int)nbSlabs, nbLayers));
+
+    struct Slab
+    {
+        int k0,k1;
+        vector<Key> keys;
+        vector<MarchingCubeEdgeVertex> vertices;
+        vector< Vec<3,unsigned int> > triangles;
+        vector<Vec3i> cells;
+    };
+    std::vector<Slab> slabs(slabCount);
+    for(int s=0; s<slabCount; ++s)
+    {
+        slabs[s].k0 = cellMin[2] + (int)((long long)nbLayers*s/slabCount);
+        slabs[s].k1 = cellMin[2] + (int)((long long)nbLayers*(s+1)/slabCount);
+    }
+
+    auto slabTask = [&](std::size_t s)
+    {
+        Slab& slab = slabs[s];
+        std::unordered_map<Key,unsigned int> localIds;
+        float val[8];
+        unsigned int vertexId[12];
+        Vec3i cell;
+        for(cell[2]=slab.k0; cell[2]<slab.k1; ++cell[2])
+            for(cell[1]=cellMin[1]; cell[1]<cellMax[1]; ++cell[1])
+                for(cell[0]=cellMin[0]; cell[0]<cellMax[0]; ++cell[0])
+                {
+                    int cubeConf = 0;
+                    for(int c=0; c<8; ++c)
+                    {
+                        val[c] = (float)value(cell[0]+corner[c][0], cell[1]+corner[c][1], cell[2]+corner[c][2]);
+                        if(val[c]<isolevel) cubeConf |= 1<<c;
+                    }
+                    const int edges = MarchingCubeEdgeTable[cubeConf];
+                    if(!edges) continue;
+
+                    for(int e=0; e<12; ++e) if(edges & (1<<e))
+                    {
+                        const int a = edgeFrom[e], b = edgeTo[e];
+                        MarchingCubeEdgeVertex v;
+                        v.p = Vec3i(cell[0]+corner[a][0], cell[1]+corner[a][1], cell[2]+corner[a][2]);
+                        v.axis = edgeAxis[e];
+                        v.mu = (isolevel-val[a])/(val[b]-val[a]);
+                        Key k;
+                        if(weldGridPoints && v.mu==0.f) { v.axis=3; k=key(v.p,3); }
+                        else if(weldGridPoints && v.mu==1.f) { v.p[edgeAxis[e]]+=1; v.axis=3; v.mu=0.f; k=key(v.p,3); }
+                        else k = key(v.p,v.axis);
+
+                        auto it = localIds.find(k);
+                        if(it!=localIds.end()) vertexId[e] = it->second;
+                        else
+                        {
+                            vertexId[e] = (unsigned int)slab.vertices.size();
+                            localIds.emplace(k,vertexId[e]);
+                            slab.keys.push_back(k);
+                            slab.vertices.push_back(v);
+                        }
+                    }
+
+                    for(const int* t=MarchingCubeTriTable[cubeConf]; *t!=-1; t+=3)
+                    {
+                        const Vec<3,unsigned int> tri(vertexId[t[0]], vertexId[t[1]], vertexId[t[2]]);
+                        if(tri[0]==tri[1] || tri[1]==tri[2] || tri[2]==tri[0]) continue;
+                        slab.triangles.push_back(tri);
+                        if(triangleCells) slab.cells.push_back(cell);
+                    }
+                }
+    };
+    forEachSlab((std::size_t)slabCount, slabTask);
+
+    // merge the slabs in order, welding the vertices of the plane shared with the previous slab
+    std::unordered_map<Key,unsigned int> previousPlane, plane;
+    std::vector<unsigned int> globalIds;
+    for(int s=0; s<slabCount; ++s)
+    {
+        Slab& slab = slabs[s];
+        globalIds.resize(slab.vertices.size());
+        plane.clear();
+        for(std::size_t i=0; i<slab.vertices.size(); ++i)
+        {
+            const MarchingCubeEdgeVertex& v = slab.vertices[i];
+            auto it = previousPlane.end();
+            if(v.p[2]==slab.k0 && v.axis!=2) it = previousPlane.find(slab.keys[i]);
+            if(it!=previousPlane.end()) globalIds[i] = it->second;
+            else
+            {
+                globalIds[i] = (unsigned int)vertices.size();
+                vertices.push_back(v);
+            }
+            if(v.p[2]==slab.k1 && v.axis!=2) plane.emplace(slab.keys[i],globalIds[i]);
+        }
+        for(const auto& t : slab.triangles) triangles.push_back(Vec<3,unsigned int>(globalIds[t[0]], globalIds[t[1]], globalIds[t[2]]));
+        if(triangleCells) triangleCells->insert(triangleCells->end(), slab.cells.begin(), slab.cells.end());
+        previousPlane.swap(plane);
+        vector<Key>().swap(slab.keys);
+        vector<MarchingCubeEdgeVertex>().swap(slab.vertices);
+    }
+}
+
+} // namespace helper
+} // namespace sofa
+
+#endif
@@ -27,8 +27,11 @@
 ****/
 
 #include <sofa/helper/MarchingCubeUtility.h>
+#include <sofa/helper/MarchingCubeSlabs.h>
 #include <sofa/helper/logging/Messaging.h>
 #include <stack>
+#include <atomic>
+#include <thread>
 
 #define PRECISION 16384.0
 
@@ -372,7 +375,7 @@ const int MarchingCubeTriTable[256][16] =
 
 
 MarchingCubeUtility::MarchingCubeUtility()
-    : cubeStep ( 1 ), convolutionSize ( 1 ),
+    : cubeStep ( 1 ), convolutionSize ( 1 ), nbThreads ( 1 ),
       dataResolution ( 0,0,0 ), dataVoxelSize ( 1.0f,1.0f,1.0f ),
       verticesIndexOffset( 0), verticesTranslation( 0,0,0)
 {
@@ -412,7 +415,12 @@ void MarchingCubeUtility::vertexInterp ( Vector3 &p, const float isolevel,
         const Vector3 &p1, const Vector3 &p2,
         const float valp1, const float valp2 ) const
 {
-    float mu = ( isolevel - valp1 ) / ( valp2 - valp1 );
+    vertexPosition ( p, p1, p2, ( isolevel - valp1 ) / ( valp2 - valp1 ) );
+}
+
+
+void MarchingCubeUtility::vertexPosition ( Vector3 &p, const Vector3 &p1, const Vector3 &p2, const float mu ) const
+{
     p = p1 + ( p2 - p1 ) * mu;
     p = ( ( p + Vector3 ( 1.0f, 1.0f, 1.0f ) ) *0.5f ).linearProduct ( dataVoxelSize.linearProduct ( dataResolution ) ) + dataVoxelSize/2.0;
     p += verticesTranslation;
@@ -699,6 +707,14 @@ void MarchingCubeUtility::run ( unsigned char *_data, const float isolevel,
         data = _data;
     }
 
+    if ( nbThreads != 1 )
+    {
+        runSlabs ( data, isolevel, mesh, vertices, triangleIndexInRegularGrid );
+        if (smooth)
+            delete [] data;
+        return;
+    }
+
     std::map< Vector3, PointID> map_vertices;
     for ( size_t i = 0; i < vertices.size(); i++ )
         map_vertices.insert ( std::make_pair ( vertices[i], i ) );
@@ -731,6 +747,97 @@ void MarchingCubeUtility::run ( unsigned char *_data, const float isolevel,
 
 
 
+void MarchingCubeUtility::runSlabs ( const unsigned char *data, const float isolevel,
+        sofa::helper::vector< PointID >& mesh,
+        sofa::helper::vector< Vector3 >& vertices,
+        helper::vector< helper::vector<unsigned int> >* triangleIndexInRegularGrid ) const
+{
+    Vec3i bboxMin = Vec3i ( bbox.min / cubeStep );
+    Vec3i bboxMax = Vec3i ( bbox.max / cubeStep );
+    Vec3i gridSize = Vec3i ( dataResolution /cubeStep );
+
+    Vector3 gridStep = Vector3 ( 2.0f/ ( ( float ) gridSize[0] ), 2.0f/ ( ( float ) gridSize[1] ), 2.0f/ ( ( float ) gridSize[2] ) );
+
+    Vec3i dataGridStep ( dataResolution[0]/gridSize[0],dataResolution[1]/gridSize[1],dataResolution[2]/gridSize[2] );
+
+    // Value of a grid point, 0 outside of the ROI (as in initCell).
+    auto value = [&] ( int i, int j, int k ) -> float
+    {
+        const Vec3i valPos = Vec3i ( i, j, k ).linearProduct ( dataGridStep );
+        if ( ( valPos[0] < roi.min[0] ) || ( valPos[1] < roi.min[1] ) || ( valPos[2] < roi.min[2] ) ||
+             ( valPos[0] >= roi.max[0] ) || ( valPos[1] >= roi.max[1] ) || ( valPos[2] >= roi.max[2] ) )
+            return 0.0f;
+        return ( float ) data[valPos[0] + valPos[1]*dataResolution[0] + valPos[2]*dataResolution[0]*dataResolution[1]];
+    };
+
+    // Thin slabs are shared dynamically between the threads to balance the load.
+    const unsigned int threads = std::max ( nbThreads ? nbThreads : std::thread::hardware_concurrency(), 1u );
+    auto forEachSlab = [threads] ( std::size_t nbSlabs, const auto& slabTask )
+    {
+        std::atomic<std::size_t> next ( 0 );
+        auto worker = [&] ()
+        {
+            for ( std::size_t s = next++; s < nbSlabs; s = next++ )
+                slabTask ( s );
+        };
+        std::vector<std::thread> pool;
+        for ( std::size_t t = 1; t < std::min<std::size_t> ( threads, nbSlabs ); ++t )
+            pool.emplace_back ( worker );
+        worker();
+        for ( std::thread& t : pool )
+            t.join();
+    };
+
+    vector< MarchingCubeEdgeVertex > edgeVertices;
+    vector< Vec<3,unsigned int> > triangles;
+    vector< Vec3i > cells;
+    marchingCubeSlabs ( value, bboxMin, bboxMax - Vec3i ( 1, 1, 1 ), isolevel, true, 4*threads, forEachSlab,
+                        edgeVertices, triangles, triangleIndexInRegularGrid ? &cells : nullptr );
+
+    // New vertices at the position of a given one are merged with it, as in the sequential run.
+    std::map< Vector3, PointID> map_vertices;
+    for ( size_t i = 0; i < vertices.size(); i++ )
+        map_vertices.insert ( std::make_pair ( vertices[i], i ) );
+
+    vector< PointID > ids ( edgeVertices.size() );
+    for ( size_t i = 0; i < edgeVertices.size(); i++ )
+    {
+        const MarchingCubeEdgeVertex& v = edgeVertices[i];
+        const Vector3 p1 = Vector3 ( ( float ) v.p[0], ( float ) v.p[1], ( float ) v.p[2] ).linearProduct ( gridStep ) - Vector3 ( 1.0f, 1.0f, 1.0f );
+        Vector3 p2 = p1;
+        if ( v.axis < 3 ) p2[v.axis] += gridStep[v.axis];
+
+        Vector3 p;
+        vertexPosition ( p, p1, p2, v.mu );
+
+        std::map< Vector3, PointID>::const_iterator iter = map_vertices.find ( p );
+        if ( iter != map_vertices.end() ) ids[i] = iter->second;
+        else
+        {
+            ids[i] = static_cast<PointID>(vertices.size()) + verticesIndexOffset;
+            vertices.push_back ( p );
+        }
+    }
+
+    for ( size_t t = 0; t < triangles.size(); t++ )
+    {
+        const PointID a = ids[triangles[t][0]], b = ids[triangles[t][1]], c = ids[triangles[t][2]];
+        if ( a == b || a == c || b == c ) continue;
+        mesh.push_back ( a );
+        mesh.push_back ( b );
+        mesh.push_back ( c );
+
+        if ( triangleIndexInRegularGrid )
+        {
+            GridCell cell;
+            initCell ( cell, cells[t], data, gridStep, dataGridStep );
+            updateTriangleInRegularGridVector ( *triangleIndexInRegularGrid, cells[t], cell, 1 );
+        }
+    }
+}
+
+
+
 void MarchingCubeUtility::run ( unsigned char *data, const float isolevel,
         sofa::helper::io::Mesh &m ) const
 {
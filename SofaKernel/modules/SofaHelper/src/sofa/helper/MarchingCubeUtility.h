@@ -72,6 +72,13 @@ public:
         this->convolutionSize = convolutionSize;
     }
 
+    /// Set the number of threads of the run over the whole bounding box (1 by default, 0 for the hardware concurrency).
+    /// With several threads, the cells are polygonized by slabs along z and the vertices are welded by grid edge (see marchingCubeSlabs).
+    void setNbThreads ( const unsigned int nbThreads )
+    {
+        this->nbThreads = nbThreads;
+    }
+
     /// Set the bounding box from real coords to apply mCube localy.
     void setBoundingBoxFromRealCoords ( const Vector3& min, const Vector3& max )
     {
@@ -179,6 +186,8 @@ private:
 
     inline void vertexInterp ( Vector3 &p, const float isolevel, const Vector3 &p1, const Vector3 &p2, const float valp1, const float valp2 ) const ;
 
+    inline void vertexPosition ( Vector3 &p, const Vector3 &p1, const Vector3 &p2, const float mu ) const ;
+
     inline bool testGrid ( const float v, const float isolevel ) const;
 
     inline void updateTriangleInRegularGridVector ( helper::vector< helper::vector<unsigned int /*regular grid space index*/> >& triangleIndexInRegularGrid, const Vec3i& coord, const GridCell& cell, unsigned int nbTriangles ) const;
@@ -205,6 +214,12 @@ private:
 
     void smoothData ( unsigned char *data ) const;
 
+    /// Polygonize the whole bounding box by slabs, on nbThreads threads.
+    void runSlabs ( const unsigned char *data, const float isolevel,
+            sofa::helper::vector< PointID >& triangles,
+            sofa::helper::vector< Vector3 >& vertices,
+            helper::vector< helper::vector<unsigned int> >* triangleIndexInRegularGrid ) const;
+
     /// Propagate the triangulation surface creation from a cell.
     void propagateFrom ( const sofa::helper::vector<Vec3i>& coord,
             unsigned char* data, const float isolevel,
@@ -218,6 +233,7 @@ private:
 private:
     unsigned int  cubeStep;
     unsigned int  convolutionSize;
+    unsigned int  nbThreads;
     Vec3i     dataResolution;
     Vector3     dataVoxelSize;
     BoundingBox bbox; //bbox used to remesh
@@ -153,16 +153,21 @@ void VideoRecorderFFMPEG::addFrame()
 
     glReadPixels(0, 0, m_viewportWidth, m_viewportHeight, GL_RGBA, GL_UNSIGNED_BYTE, (void*)m_viewportBuffer);
 
+    addFrame(m_viewportBuffer);
+}
+
+void VideoRecorderFFMPEG::addFrame(const unsigned char* rgbaPixels)
+{
     // set ffmpeg buffer: initialize to 0 (black) 
     memset(m_ffmpegBuffer, 0, m_ffmpegBufferSize);
 
     if (m_viewportWidth == m_ffmpegWidth)
     {
-        memcpy(m_ffmpegBuffer, m_viewportBuffer, m_viewportBufferSize);
+        memcpy(m_ffmpegBuffer, rgbaPixels, m_viewportBufferSize);
     }
     else
     {
-        const unsigned char* viewportBufferIter = m_viewportBuffer;
+        const unsigned char* viewportBufferIter = rgbaPixels;
         const size_t viewportRowSizeInBytes = m_pixelFormatSize * m_viewportWidth;
 
         unsigned char* ffmpegBufferIter = m_ffmpegBuffer;
@@ -71,7 +71,11 @@ public:
 
     bool init(const std::string& ffmpeg_exec_filepath, const std::string& filename, int width, int height, unsigned int framerate, unsigned int bitrate, const std::string& codec="");
 
+    /// Reads the pixels of the current viewport and sends them to ffmpeg
     void addFrame();
+    /// Sends a frame already read back (RGBA, viewport size, bottom-up rows) to ffmpeg.
+    /// Does not make any OpenGL call, so it can be called from another thread than the rendering one.
+    void addFrame(const unsigned char* rgbaPixels);
     void saveVideo();
     void finishVideo();
 
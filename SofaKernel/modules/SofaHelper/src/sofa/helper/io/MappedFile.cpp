@@ -0,0 +1,227 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/helper/io/MappedFile.h>
+
+#include <fstream>
+#include <iterator>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace sofa
+{
+
+namespace helper
+{
+
+namespace io
+{
+
+MappedFile::MappedFile()
+    : m_data(nullptr)
+    , m_size(0)
+    , m_isOpen(false)
+    , m_mapping(nullptr)
+#ifdef WIN32
+    , m_fileHandle(nullptr)
+    , m_mappingHandle(nullptr)
+#endif
+{
+}
+
+MappedFile::MappedFile(const std::string& filename)
+    : MappedFile()
+{
+    open(filename);
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const std::string& filename)
+{
+    close();
+    m_isOpen = map(filename) || readAll(filename);
+    return m_isOpen;
+}
+
+#ifdef WIN32
+
+bool MappedFile::map(const std::string& filename)
+{
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    void* address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (address == nullptr)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_fileHandle = file;
+    m_mappingHandle = mapping;
+    m_mapping = address;
+    m_data = static_cast<const char*>(address);
+    m_size = static_cast<std::size_t>(size.QuadPart);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_mapping)
+        UnmapViewOfFile(m_mapping);
+    if (m_mappingHandle)
+        CloseHandle(m_mappingHandle);
+    if (m_fileHandle)
+        CloseHandle(m_fileHandle);
+    m_mapping = nullptr;
+    m_mappingHandle = nullptr;
+    m_fileHandle = nullptr;
+
+    m_buffer.clear();
+    m_buffer.shrink_to_fit();
+    m_data = nullptr;
+    m_size = 0;
+    m_isOpen = false;
+}
+
+#else
+
+bool MappedFile::map(const std::string& filename)
+{
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat status;
+    if (fstat(fd, &status) != 0 || !S_ISREG(status.st_mode) || status.st_size == 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    const std::size_t size = static_cast<std::size_t>(status.st_size);
+    void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping stays valid once the descriptor is closed
+    ::close(fd);
+    if (address == MAP_FAILED)
+        return false;
+
+    // the file is parsed from the beginning to the end
+    madvise(address, size, MADV_SEQUENTIAL);
+
+    m_mapping = address;
+    m_data = static_cast<const char*>(address);
+    m_size = size;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_mapping)
+        munmap(m_mapping, m_size);
+    m_mapping = nullptr;
+
+    m_buffer.clear();
+    m_buffer.shrink_to_fit();
+    m_data = nullptr;
+    m_size = 0;
+    m_isOpen = false;
+}
+
+#endif
+
+bool MappedFile::readAll(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios_base::in | std::ios_base::binary);
+    if (!file.good())
+        return false;
+
+    m_buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+    return !file.bad();
+}
+
+
+MemoryStreamBuf::MemoryStreamBuf(const char* begin, const char* end)
+{
+    char* b = const_cast<char*>(begin);
+    setg(b, b, b + (end - begin));
+}
+
+void MemoryStreamBuf::advance(const char* p)
+{
+    setg(eback(), const_cast<char*>(p), std::streambuf::egptr());
+}
+
+MemoryStreamBuf::pos_type MemoryStreamBuf::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+    if (!(which & std::ios_base::in))
+        return pos_type(off_type(-1));
+
+    const char* base = dir == std::ios_base::beg ? eback()
+                     : dir == std::ios_base::cur ? gptr()
+                     : egptr();
+    const off_type target = (base - eback()) + off;
+    if (target < 0 || target > egptr() - eback())
+        return pos_type(off_type(-1));
+
+    advance(eback() + target);
+    return pos_type(target);
+}
+
+MemoryStreamBuf::pos_type MemoryStreamBuf::seekpos(pos_type pos, std::ios_base::openmode which)
+{
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+}
+
+} // namespace io
+
+} // namespace helper
+
+} // namespace sofa
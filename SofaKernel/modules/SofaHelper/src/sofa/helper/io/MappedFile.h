@@ -0,0 +1,112 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_HELPER_IO_MAPPEDFILE_H
+#define SOFA_HELPER_IO_MAPPEDFILE_H
+
+#include <sofa/helper/config.h>
+
+#include <cstddef>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace sofa
+{
+
+namespace helper
+{
+
+namespace io
+{
+
+/// Read-only view on the whole content of a file.
+///
+/// The file is memory-mapped when the platform allows it, so that the parsers can work on its bytes
+/// without copying them into stream buffers. Otherwise (or for empty files) the content is read into
+/// an owned buffer, and the same interface is provided.
+class SOFA_HELPER_API MappedFile
+{
+public:
+    MappedFile();
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& filename);
+    void close();
+
+    bool isOpen() const { return m_isOpen; }
+    /// True if the content is mapped from the file, false if it has been copied in memory
+    bool isMapped() const { return m_mapping != nullptr; }
+
+    const char* data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+    const char* begin() const { return m_data; }
+    const char* end() const { return m_data + m_size; }
+
+protected:
+    bool map(const std::string& filename);
+    bool readAll(const std::string& filename);
+
+    const char* m_data;
+    std::size_t m_size;
+    bool m_isOpen;
+
+    void* m_mapping; ///< address of the mapping, nullptr if the content is in m_buffer
+#ifdef WIN32
+    void* m_fileHandle;
+    void* m_mappingHandle;
+#endif
+    std::vector<char> m_buffer;
+};
+
+/// Input stream buffer reading from a memory range without copying it, for instance the content of a MappedFile.
+///
+/// The range can be accessed directly through gptr() and egptr(), which allows parsers to process large blocks
+/// of text themselves and then skip them with advance().
+class SOFA_HELPER_API MemoryStreamBuf : public std::streambuf
+{
+public:
+    MemoryStreamBuf(const char* begin, const char* end);
+
+    /// Current read position
+    const char* gptr() const { return std::streambuf::gptr(); }
+    /// End of the range
+    const char* egptr() const { return std::streambuf::egptr(); }
+
+    /// Move the read position to p, which must be in the range
+    void advance(const char* p);
+
+protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+};
+
+} // namespace io
+
+} // namespace helper
+
+} // namespace sofa
+
+#endif // SOFA_HELPER_IO_MAPPEDFILE_H
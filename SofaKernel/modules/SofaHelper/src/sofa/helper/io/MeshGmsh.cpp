@@ -23,11 +23,12 @@
 #include <sofa/helper/io/MeshGmsh.h>
 #include <sofa/helper/system/FileRepository.h>
 #include <sofa/helper/system/SetDirectory.h>
-#include <sofa/helper/system/Locale.h>
+#include <sofa/helper/io/MappedFile.h>
+#include <sofa/helper/io/TextParser.h>
 #include <sofa/helper/logging/Messaging.h>
-#include <istream>
-#include <fstream>
+#include <sstream>
 #include <string>
+#include <string_view>
 
 namespace sofa
 {
@@ -52,44 +53,34 @@ void MeshGmsh::init (std::string filename)
     }
     loaderType = "gmsh";
 
-    std::ifstream file(filename);
-    if (!file.good()) return;
+    MappedFile file;
+    if (!file.open(filename))
+        return;
 
+    const char* p = file.begin();
+    const char* end = file.end();
     unsigned int gmshFormat = 0;
-    std::string cmd;
 
     // -- Looking for Gmsh version of this file.
-    std::getline(file, cmd); //Version
-    std::istringstream versionReader(cmd);
-    std::string version;
-    versionReader >> version;
-    if (version == "$MeshFormat") // Reading gmsh 2.0 file
+    const char* line = p;
+    p = text::nextLine(p, end); // Version
+    if (text::nextToken(line, end) == "$MeshFormat") // Reading gmsh 2.0 file
     {
         gmshFormat = 2;
-        std::string line;
-        std::getline(file, line); // we don't nedd this line
-        std::getline(file, cmd);
-        std::istringstream endMeshReader(cmd);
-        std::string endMesh;
-        endMeshReader >> endMesh;
-
-        if (endMesh != std::string("$EndMeshFormat")) // it should end with $EndMeshFormat
-        {
-            file.close();
+        p = text::nextLine(p, end); // we don't need this line
+        line = p;
+        p = text::nextLine(p, end);
+        if (text::nextToken(line, end) != "$EndMeshFormat") // it should end with $EndMeshFormat
             return;
-        }
-        else
-        {
-            std::getline(file, cmd); // First Command
-        }
+
+        p = text::nextLine(p, end); // First Command
     }
     else
     {
         gmshFormat = 1;
     }
 
-    readGmsh(file, gmshFormat);
-    file.close();
+    readGmsh(p, end, gmshFormat);
 }
 
 
@@ -119,8 +110,21 @@ void MeshGmsh::normalizeGroup(helper::vector< sofa::core::loader::PrimitiveGroup
 }
 
 
-bool MeshGmsh::readGmsh(std::ifstream &file, const unsigned int gmshFormat)
+bool MeshGmsh::readGmsh(const char*& p, const char* end, const unsigned int gmshFormat)
 {
+    const auto readInt = [&p, end](int& value)
+    {
+        if (text::readNumber(p, end, value))
+            return true;
+        msg_error("MeshGmsh") << "Number expected, found '" << text::nextToken(p, end) << "'";
+        return false;
+    };
+    const auto readCommand = [&p, end]()
+    {
+        p = text::skipSpaces(p, end);
+        return text::nextToken(p, end);
+    };
+
     int npoints = 0;
     int nlines = 0;
     int ntris = 0;
@@ -128,23 +132,30 @@ bool MeshGmsh::readGmsh(std::ifstream &file, const unsigned int gmshFormat)
     int ntetrahedra = 0;
     int ncubes = 0;
 
-    std::string cmd;
+    std::string_view cmd;
 
     // --- Loading Vertices ---
-    file >> npoints; //nb points
+    if (!readInt(npoints)) //nb points
+        return false;
 
     std::vector<int> pmap; // map for reordering vertices possibly not well sorted
     for (int i = 0; i<npoints; ++i)
     {
         int index = i;
         double x, y, z;
-        file >> index >> x >> y >> z;
+        if (!readInt(index))
+            return false;
+        if (!text::readNumber(p, end, x) || !text::readNumber(p, end, y) || !text::readNumber(p, end, z))
+        {
+            msg_error("MeshGmsh") << "Invalid coordinates for the vertex " << index;
+            return false;
+        }
         m_vertices.push_back(sofa::defaulttype::Vector3(x, y, z));
         if ((int)pmap.size() <= index) pmap.resize(index + 1);
         pmap[index] = i; // In case of hole or swit
     }
     
-    file >> cmd;
+    cmd = readCommand();
     if (cmd != "$ENDNOD" && cmd != "$EndNodes")
     {
         msg_error("MeshGmsh") << "'$ENDNOD' or '$EndNodes' expected, found '" << cmd << "'";
@@ -152,7 +163,7 @@ bool MeshGmsh::readGmsh(std::ifstream &file, const unsigned int gmshFormat)
     }
 
     // --- Loading Elements ---
-    file >> cmd;
+    cmd = readCommand();
     if (cmd != "$ELM" && cmd != "$Elements")
     {
         msg_error("MeshGmsh") << "'$ELM' or '$Elements' expected, found '" << cmd << "'";
@@ -160,7 +171,8 @@ bool MeshGmsh::readGmsh(std::ifstream &file, const unsigned int gmshFormat)
     }
 
     int nelems = 0;
-    file >> nelems;
+    if (!readInt(nelems))
+        return false;
 
     for (int i = 0; i<nelems; ++i) // for each elem
     {
@@ -170,17 +182,20 @@ bool MeshGmsh::readGmsh(std::ifstream &file, const unsigned int gmshFormat)
             // version 1.0 format is
             // elm-number elm-type reg-phys reg-elem number-of-nodes <node-number-list ...>
             int rphys = -1, relem = -1;
-            file >> index >> etype >> rphys >> relem >> nnodes;
+            if (!readInt(index) || !readInt(etype) || !readInt(rphys) || !readInt(relem) || !readInt(nnodes))
+                return false;
         }
         else /*if (gmshFormat == 2)*/
         {
             // version 2.0 format is
             // elm-number elm-type number-of-tags < tag > ... node-number-list
-            file >> index >> etype >> ntags;
+            if (!readInt(index) || !readInt(etype) || !readInt(ntags))
+                return false;
 
             for (int t = 0; t<ntags; t++)
             {
-                file >> tag;
+                if (!readInt(tag))
+                    return false;
                 // read the tag but don't use it
             }
 
@@ -228,7 +243,8 @@ bool MeshGmsh::readGmsh(std::ifstream &file, const unsigned int gmshFormat)
         for (int n = 0; n<nnodes; ++n)
         {
             int t = 0;
-            file >> t;
+            if (!readInt(t))
+                return false;
             nodes[n] = (((unsigned int)t)<pmap.size()) ? pmap[t] : 0;
         }
 
@@ -322,8 +338,7 @@ bool MeshGmsh::readGmsh(std::ifstream &file, const unsigned int gmshFormat)
             break;
         default:
             //if the type is not handled, skip rest of the line
-            std::string tmp;
-            std::getline(file, tmp);
+            p = text::nextLine(p, end);
         }
     }
 
@@ -332,7 +347,7 @@ bool MeshGmsh::readGmsh(std::ifstream &file, const unsigned int gmshFormat)
     normalizeGroup(m_tetrahedraGroups);
     normalizeGroup(m_hexahedraGroups);
 
-    file >> cmd;
+    cmd = readCommand();
     if (cmd != "$ENDELM" && cmd != "$EndElements")
     {
         msg_error("MeshGmsh") << "'$ENDELM' or '$EndElements' expected, found '" << cmd << "'";
@@ -23,7 +23,6 @@
 #define SOFA_HELPER_IO_MESHGMSH_H
 
 #include <sofa/helper/io/Mesh.h>
-#include <istream>
 
 namespace sofa
 {
@@ -47,7 +46,8 @@ public:
 
 protected:
 
-    bool readGmsh(std::ifstream &file, const unsigned int gmshFormat);
+    /// Read the nodes and elements sections from the text [p, end) of the file
+    bool readGmsh(const char*& p, const char* end, const unsigned int gmshFormat);
 
     void addInGroup(helper::vector< sofa::core::loader::PrimitiveGroup>& group, int tag, std::size_t eid);
 
@@ -0,0 +1,181 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_HELPER_IO_TEXTPARSER_H
+#define SOFA_HELPER_IO_TEXTPARSER_H
+
+#include <sofa/helper/config.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <locale>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace sofa
+{
+
+namespace helper
+{
+
+namespace io
+{
+
+/// Tokenizer functions working directly on a range of characters (typically the content of a MappedFile).
+///
+/// They replace the usual std::getline + std::istringstream parsing in the mesh loaders: no copy of the lines
+/// and no stream state, and the numbers are converted with std::from_chars, which does not depend on the locale.
+/// All the functions take the current position and the end of the range, and never read beyond the end.
+namespace text
+{
+
+/// White space, including the end of lines
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/// White space, excluding the end of lines
+inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+inline const char* skipSpaces(const char* p, const char* end)
+{
+    while (p != end && isSpace(*p)) ++p;
+    return p;
+}
+
+inline const char* skipBlanks(const char* p, const char* end)
+{
+    while (p != end && isBlank(*p)) ++p;
+    return p;
+}
+
+/// Position of the '\n' ending the line starting at p, or end
+inline const char* findLineEnd(const char* p, const char* end)
+{
+    const void* eol = p != end ? std::memchr(p, '\n', static_cast<std::size_t>(end - p)) : nullptr;
+    return eol ? static_cast<const char*>(eol) : end;
+}
+
+/// Position of the beginning of the line following the one containing p, or end
+inline const char* nextLine(const char* p, const char* end)
+{
+    p = findLineEnd(p, end);
+    return p != end ? p + 1 : end;
+}
+
+/// Read the next token of the line, i.e. the next sequence of non-space characters.
+/// Returns an empty token at the end of the line, p is then left on the '\n'.
+inline std::string_view nextToken(const char*& p, const char* end)
+{
+    p = skipBlanks(p, end);
+    const char* begin = p;
+    while (p != end && !isSpace(*p)) ++p;
+    return std::string_view(begin, static_cast<std::size_t>(p - begin));
+}
+
+/// Convert the number starting exactly at p.
+/// Returns the position following the number, or nullptr if there is no valid number at p.
+template<class T>
+const char* parseNumber(const char* p, const char* end, T& value)
+{
+    static_assert(std::is_arithmetic<T>::value, "parseNumber only converts arithmetic types");
+
+    // from_chars does not accept the explicit positive sign that operator>> does
+    if (p != end && *p == '+' && end - p > 1 && *(p+1) != '-')
+        ++p;
+
+    if constexpr (std::is_floating_point<T>::value)
+    {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+        const std::from_chars_result result = std::from_chars(p, end, value, std::chars_format::general);
+        return result.ec == std::errc() ? result.ptr : nullptr;
+#else
+        // floating point from_chars is not available with this standard library: the token is read
+        // by a stream using the classic locale, so that the decimal separator is always '.'
+        const char* tokenEnd = p;
+        while (tokenEnd != end && !isSpace(*tokenEnd)) ++tokenEnd;
+        std::istringstream in(std::string(p, tokenEnd));
+        in.imbue(std::locale::classic());
+        T v;
+        if (!(in >> v))
+            return nullptr;
+        value = v;
+        const std::istringstream::pos_type parsed = in.tellg();
+        return parsed == std::istringstream::pos_type(-1) ? tokenEnd : p + static_cast<std::ptrdiff_t>(parsed);
+#endif
+    }
+    else
+    {
+        const std::from_chars_result result = std::from_chars(p, end, value);
+        return result.ec == std::errc() ? result.ptr : nullptr;
+    }
+}
+
+/// Skip the white spaces (including the end of lines) and convert the following number.
+/// Returns false if there is no valid number, p is then left at the beginning of the invalid token.
+template<class T>
+bool readNumber(const char*& p, const char* end, T& value)
+{
+    p = skipSpaces(p, end);
+    const char* next = parseNumber(p, end, value);
+    if (!next)
+        return false;
+    p = next;
+    return true;
+}
+
+/// Split [begin, end) in at most nbChunks ranges of similar sizes, each ending at the end of a line,
+/// so that they can be parsed independently. chunkBegins receives the beginning of each range, followed by end.
+template<class Container>
+void splitLines(const char* begin, const char* end, std::size_t nbChunks, Container& chunkBegins)
+{
+    chunkBegins.clear();
+    chunkBegins.push_back(begin);
+    const std::size_t size = static_cast<std::size_t>(end - begin);
+    nbChunks = std::max<std::size_t>(nbChunks, 1);
+    for (std::size_t i = 1; i < nbChunks; ++i)
+    {
+        const char* p = std::max(begin + size * i / nbChunks, chunkBegins.back());
+        p = nextLine(p, end);
+        if (p == end)
+            break;
+        if (p != chunkBegins.back())
+            chunkBegins.push_back(p);
+    }
+    chunkBegins.push_back(end);
+}
+
+} // namespace text
+
+} // namespace io
+
+} // namespace helper
+
+} // namespace sofa
+
+#endif // SOFA_HELPER_IO_TEXTPARSER_H
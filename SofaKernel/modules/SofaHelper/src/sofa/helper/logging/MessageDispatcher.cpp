@@ -129,6 +129,9 @@ public:
 
 MessageDispatcherImpl* s_messagedispatcher = nullptr ;
 
+/// Messages of the current thread are stored there instead of being dispatched, when set
+thread_local std::vector<Message>* t_threadBuffer = nullptr;
+
 MessageDispatcherImpl* getMainInstance(){
     if(s_messagedispatcher==nullptr){
         s_messagedispatcher = new MessageDispatcherImpl();
@@ -157,7 +160,18 @@ void MessageDispatcher::clearHandlers(){
     getMainInstance()->clearHandlers();
 }
 
+std::vector<Message>* MessageDispatcher::setThreadBuffer(std::vector<Message>* buffer){
+    std::vector<Message>* previous = t_threadBuffer;
+    t_threadBuffer = buffer;
+    return previous;
+}
+
 void MessageDispatcher::process(sofa::helper::logging::Message& m){
+    if(t_threadBuffer)
+    {
+        t_threadBuffer->push_back(m);
+        return;
+    }
     MUTEX_IF_THREADING ;
     getMainInstance()->process(m);
 }
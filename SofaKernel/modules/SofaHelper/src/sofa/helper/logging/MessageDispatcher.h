@@ -117,6 +117,11 @@ public:
         /// and can be called manually on a hand-made (possibly predefined) Message
         static void process(sofa::helper::logging::Message& m);
 
+        /// Store the Messages processed by the calling thread in buffer instead of
+        /// dispatching them (nullptr restores the dispatching). Returns the previous buffer.
+        /// Used to emit the Messages of concurrent tasks in a deterministic order.
+        static std::vector<Message>* setThreadBuffer(std::vector<Message>* buffer);
+
     private:
 
         // static interface
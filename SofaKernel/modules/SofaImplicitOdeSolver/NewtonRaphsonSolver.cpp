@@ -0,0 +1,317 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaImplicitOdeSolver/NewtonRaphsonSolver.h>
+#include <sofa/simulation/MechanicalOperations.h>
+#include <sofa/simulation/VectorOperations.h>
+#include <sofa/core/ObjectFactory.h>
+#include <sofa/helper/AdvancedTimer.h>
+
+
+namespace sofa
+{
+
+namespace component
+{
+
+namespace odesolver
+{
+using namespace sofa::defaulttype;
+using namespace core::behavior;
+
+NewtonRaphsonSolver::NewtonRaphsonSolver()
+    : d_static(initData(&d_static, false, "static", "Solve the static equilibrium f(x) = 0 instead of the backward Euler dynamics"))
+    , d_maxNbIterations(initData(&d_maxNbIterations, (unsigned int)10, "maxNbIterations", "Maximum number of Newton iterations per time step"))
+    , d_absoluteResidualTolerance(initData(&d_absoluteResidualTolerance, (SReal)1e-10, "absoluteResidualTolerance", "Convergence criterion: the iterations stop when the norm of the residual is smaller than this threshold"))
+    , d_relativeResidualTolerance(initData(&d_relativeResidualTolerance, (SReal)1e-5, "relativeResidualTolerance", "Convergence criterion: the iterations stop when the norm of the residual, relative to the residual at the beginning of the time step, is smaller than this threshold"))
+    , d_correctionTolerance(initData(&d_correctionTolerance, (SReal)1e-8, "correctionTolerance", "Convergence criterion: the iterations stop when the norm of the position increment is smaller than this threshold"))
+    , d_maxNbLineSearchIterations(initData(&d_maxNbLineSearchIterations, (unsigned int)5, "maxNbLineSearchIterations", "Maximum number of backtracking steps of the line search (0 disables the line search)"))
+    , d_lineSearchCoefficient(initData(&d_lineSearchCoefficient, (SReal)0.5, "lineSearchCoefficient", "Factor applied to the correction at each backtracking step of the line search, in ]0,1["))
+    , d_modifiedNewton(initData(&d_modifiedNewton, false, "modifiedNewton", "Reuse the system matrix (and its factorization) of a previous iteration or time step while the convergence is good"))
+    , d_refactorizationRatio(initData(&d_refactorizationRatio, (SReal)0.25, "refactorizationRatio", "With modifiedNewton, the system matrix is assembled again when an iteration does not reduce the residual norm below this ratio of the previous one"))
+    , f_rayleighStiffness(initData(&f_rayleighStiffness, (SReal)0.0, "rayleighStiffness", "Rayleigh damping coefficient related to stiffness, > 0"))
+    , f_rayleighMass(initData(&f_rayleighMass, (SReal)0.0, "rayleighMass", "Rayleigh damping coefficient related to mass, > 0"))
+    , d_threadSafeVisitor(initData(&d_threadSafeVisitor, false, "threadSafeVisitor", "If true, do not use realloc and free visitors in fwdInteractionForceField."))
+    , d_currentIterations(initData(&d_currentIterations, (unsigned int)0, "currentIterations", "OUTPUT: number of Newton iterations of the last time step"))
+    , d_currentResidual(initData(&d_currentResidual, (SReal)0.0, "currentResidual", "OUTPUT: norm of the residual at the end of the last time step"))
+    , d_nbMatrixAssemblies(initData(&d_nbMatrixAssemblies, (unsigned int)0, "nbMatrixAssemblies", "OUTPUT: number of system matrix assemblies since the beginning of the simulation"))
+    , m_matrixIsValid(false)
+    , m_matrixDt(0)
+    , m_matrixSize(0)
+{
+    d_currentIterations.setReadOnly(true);
+    d_currentIterations.setGroup("Stats");
+    d_currentResidual.setReadOnly(true);
+    d_currentResidual.setGroup("Stats");
+    d_nbMatrixAssemblies.setReadOnly(true);
+    d_nbMatrixAssemblies.setGroup("Stats");
+}
+
+void NewtonRaphsonSolver::init()
+{
+    if (d_lineSearchCoefficient.getValue() <= 0 || d_lineSearchCoefficient.getValue() >= 1)
+    {
+        msg_warning() << "lineSearchCoefficient must be in ]0,1[, using 0.5";
+        d_lineSearchCoefficient.setValue(0.5);
+    }
+    m_matrixIsValid = false;
+    sofa::core::behavior::OdeSolver::init();
+}
+
+void NewtonRaphsonSolver::reset()
+{
+    m_matrixIsValid = false;
+}
+
+void NewtonRaphsonSolver::cleanup()
+{
+    // free the locally created vector (including eventual external mechanical states linked by an InteractionForceField)
+    sofa::simulation::common::VectorOperations vop( core::ExecParams::defaultInstance(), this->getContext() );
+    vop.v_free(m_correction.id(), !d_threadSafeVisitor.getValue(), true);
+}
+
+bool NewtonRaphsonSolver::needMatrixAssembly(SReal dt, sofa::Size systemSize) const
+{
+    return !d_modifiedNewton.getValue()
+            || !m_matrixIsValid
+            || (!d_static.getValue() && m_matrixDt != dt)
+            || m_matrixSize != systemSize;
+}
+
+void NewtonRaphsonSolver::solve(const core::ExecParams* params, SReal dt, sofa::core::MultiVecCoordId xResult, sofa::core::MultiVecDerivId vResult)
+{
+    sofa::simulation::common::VectorOperations vop( params, this->getContext() );
+    sofa::simulation::common::MechanicalOperations mop( params, this->getContext() );
+    MultiVecCoord pos(&vop, core::VecCoordId::position() );
+    MultiVecDeriv vel(&vop, core::VecDerivId::velocity() );
+    MultiVecDeriv f(&vop, core::VecDerivId::force() );
+    MultiVecCoord newPos(&vop, xResult );
+    MultiVecDeriv newVel(&vop, vResult );
+
+    /// inform the constraint parameters about the position and velocity id
+    mop.cparams.setX(xResult);
+    mop.cparams.setV(vResult);
+
+    // dx is no longer allocated by default (but it will be deleted automatically by the mechanical objects)
+    MultiVecDeriv dx(&vop, core::VecDerivId::dx());
+    dx.realloc(&vop, !d_threadSafeVisitor.getValue(), true);
+
+    m_correction.realloc(&vop, !d_threadSafeVisitor.getValue(), true);
+
+    // state at the beginning of the time step, and at the beginning of the current iteration
+    MultiVecCoord x0(&vop);
+    MultiVecDeriv v0(&vop);
+    MultiVecCoord xk(&vop);
+    MultiVecDeriv vk(&vop);
+    MultiVecDeriv residual(&vop);
+    MultiVecDeriv velocityIncrement(&vop);
+    x0.eq(pos);
+    v0.eq(vel);
+    newPos.eq(x0);
+    newVel.eq(v0);
+
+    const SReal h = dt;
+    const bool isStatic = d_static.getValue();
+    const SReal rm = f_rayleighMass.getValue();
+    const SReal rk = f_rayleighStiffness.getValue();
+    const SReal time = this->getContext()->getTime() + (isStatic ? 0 : h);
+
+    sofa::Size nbRow = 0, nbCol = 0;
+    mop.getMatrixDimension(&nbRow, &nbCol);
+
+    mop->setImplicit(true); // this solver is implicit
+
+    // r(x) = f(x) in statics, r(v) = h f(x0 + h v, v) - M (v - v0) + h (-rm M + rk K) v in dynamics
+    auto computeResidual = [&]() -> SReal
+    {
+        if (isStatic)
+        {
+            mop.computeForce(time, f, newPos, newVel);
+            residual.eq(f);
+            mop.projectResponse(residual);
+        }
+        else
+        {
+            newPos.eq(x0, newVel, h);
+            mop.computeForce(time, f, newPos, newVel);
+            residual.eq(f, h);
+            velocityIncrement.eq(newVel, v0, -1.0);
+            mop.addMdx(residual, velocityIncrement, -1.0);
+            if (rm != 0.0 || rk != 0.0)
+                mop.addMBKv(residual, -h*rm, 0, h*rk);
+            mop.projectResponse(residual);
+        }
+        return residual.norm();
+    };
+
+    sofa::helper::AdvancedTimer::stepBegin("NewtonRaphsonSolver::Solve");
+
+    SReal residualNorm = computeResidual();
+    const SReal initialResidualNorm = residualNorm;
+    const SReal absoluteTolerance = d_absoluteResidualTolerance.getValue();
+    const SReal relativeTolerance = d_relativeResidualTolerance.getValue() * initialResidualNorm;
+
+    unsigned int nbIterations = 0;
+    bool converged = residualNorm <= absoluteTolerance;
+
+    if (converged)
+    {
+        msg_info() << "The system has already reached an equilibrium state";
+    }
+
+    while (!converged && nbIterations < d_maxNbIterations.getValue())
+    {
+        core::behavior::MultiMatrix<simulation::common::MechanicalOperations> matrix(&mop);
+
+        if (needMatrixAssembly(h, nbRow))
+        {
+            sofa::helper::AdvancedTimer::stepBegin("MBKBuild");
+            if (isStatic)
+                matrix = MechanicalMatrix::K * -1.0;
+            else
+                matrix = MechanicalMatrix(1+h*rm, -h, -h*(h+rk));
+            sofa::helper::AdvancedTimer::stepEnd("MBKBuild");
+
+            m_matrixIsValid = true;
+            m_matrixDt = h;
+            m_matrixSize = nbRow;
+            d_nbMatrixAssemblies.setValue(d_nbMatrixAssemblies.getValue() + 1);
+        }
+
+        sofa::helper::AdvancedTimer::stepBegin("MBKSolve");
+        matrix.solve(m_correction, residual);
+        sofa::helper::AdvancedTimer::stepEnd("MBKSolve");
+
+        if (isStatic)
+            xk.eq(newPos);
+        else
+            vk.eq(newVel);
+
+        // backtracking line search on the residual norm
+        sofa::helper::AdvancedTimer::stepBegin("LineSearch");
+        SReal alpha = 1.0;
+        SReal newResidualNorm = 0.0;
+        for (unsigned int lineSearchIteration = 0; ; ++lineSearchIteration)
+        {
+            if (isStatic)
+                newPos.eq(xk, m_correction, alpha);
+            else
+                newVel.eq(vk, m_correction, alpha);
+
+            newResidualNorm = computeResidual();
+
+            if (newResidualNorm <= (1.0 - 1e-4 * alpha) * residualNorm
+                    || lineSearchIteration >= d_maxNbLineSearchIterations.getValue())
+                break;
+
+            alpha *= d_lineSearchCoefficient.getValue();
+        }
+        sofa::helper::AdvancedTimer::stepEnd("LineSearch");
+
+        const SReal correctionNorm = alpha * (isStatic ? 1.0 : h) * m_correction.norm();
+
+        msg_info() << "Newton iteration #" << nbIterations << ": |r| = " << newResidualNorm
+                   << " |dx| = " << correctionNorm << " (line search step " << alpha << ")";
+
+        // the convergence is too slow with the current matrix: assemble it again at the next iteration
+        if (newResidualNorm > d_refactorizationRatio.getValue() * residualNorm)
+            m_matrixIsValid = false;
+
+        residualNorm = newResidualNorm;
+        ++nbIterations;
+
+        if (residualNorm <= absoluteTolerance || residualNorm <= relativeTolerance)
+        {
+            msg_info() << "[CONVERGED] The residual's norm |r| = " << residualNorm << " is smaller than the threshold";
+            converged = true;
+        }
+        else if (correctionNorm <= d_correctionTolerance.getValue())
+        {
+            msg_info() << "[CONVERGED] The correction's norm |dx| = " << correctionNorm << " is smaller than the threshold of " << d_correctionTolerance.getValue();
+            converged = true;
+        }
+    }
+
+    if (!converged)
+    {
+        msg_info() << "[DIVERGED] The number of Newton iterations reached the threshold of " << d_maxNbIterations.getValue() << " iterations";
+    }
+
+    sofa::helper::AdvancedTimer::valSet("nb_iterations", nbIterations);
+    sofa::helper::AdvancedTimer::valSet("residual", residualNorm);
+    sofa::helper::AdvancedTimer::stepEnd("NewtonRaphsonSolver::Solve");
+
+    d_currentIterations.setValue(nbIterations);
+    d_currentResidual.setValue(residualNorm);
+
+    if (!isStatic)
+        mop.addSeparateGravity(dt, newVel); // v += dt*g . Used if mass wants to add G separately from the other forces to v
+}
+
+
+double NewtonRaphsonSolver::getPositionIntegrationFactor() const
+{
+    return getPositionIntegrationFactor(getContext()->getDt());
+}
+
+double NewtonRaphsonSolver::getIntegrationFactor(int inputDerivative, int outputDerivative) const
+{
+    return getIntegrationFactor(inputDerivative, outputDerivative, getContext()->getDt());
+}
+
+double NewtonRaphsonSolver::getIntegrationFactor(int inputDerivative, int outputDerivative, double dt) const
+{
+    double matrix[3][3] =
+    {
+        { 1, dt, 0},
+        { 0, 1, 0},
+        { 0, 0, 0}
+    };
+    if (inputDerivative >= 3 || outputDerivative >= 3)
+        return 0;
+    else
+        return matrix[outputDerivative][inputDerivative];
+}
+
+double NewtonRaphsonSolver::getSolutionIntegrationFactor(int outputDerivative) const
+{
+    return getSolutionIntegrationFactor(outputDerivative, getContext()->getDt());
+}
+
+double NewtonRaphsonSolver::getSolutionIntegrationFactor(int outputDerivative, double dt) const
+{
+    double vect[3] = { dt, 1, 1/dt};
+    if (outputDerivative >= 3)
+        return 0;
+    else
+        return vect[outputDerivative];
+}
+
+
+int NewtonRaphsonSolverClass = core::RegisterObject("Implicit time integrator solving each time step with Newton-Raphson iterations, with line search and optional reuse of the system matrix")
+        .add< NewtonRaphsonSolver >()
+        ;
+
+} // namespace odesolver
+
+} // namespace component
+
+} // namespace sofa
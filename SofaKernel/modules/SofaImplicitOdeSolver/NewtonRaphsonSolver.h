@@ -0,0 +1,132 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_COMPONENT_ODESOLVER_NEWTONRAPHSONSOLVER_H
+#define SOFA_COMPONENT_ODESOLVER_NEWTONRAPHSONSOLVER_H
+#include "config.h"
+
+#include <sofa/core/behavior/OdeSolver.h>
+#include <sofa/core/behavior/MultiVec.h>
+
+namespace sofa
+{
+
+namespace component
+{
+
+namespace odesolver
+{
+
+/** Fully implicit time integrator solving the nonlinear equations of each time step with Newton-Raphson iterations.
+ *
+ *** Dynamic ***
+ *
+ * The backward Euler scheme is used:
+ *
+ *   \f$x_{t+h} = x_t + h v_{t+h}\f$
+ *
+ * and the unknown \f$ v = v_{t+h} \f$ is the root of the residual
+ *
+ *   \f$ r(v) = h f(x_t + h v, v) - M (v - v_t) + h ( - r_M M + r_K K ) v \f$
+ *
+ * Each Newton iteration solves
+ *
+ *   \f$ ( (1+h r_M) M - h B - h(h + r_K) K ) dv = r(v) \f$
+ *
+ *** Static ***
+ *
+ * The unknown is the position, root of \f$ r(x) = f(x) \f$, and each iteration solves \f$ -K dx = r(x) \f$.
+ *
+ *** Line search and modified Newton ***
+ *
+ * The correction is scaled by a backtracking line search until the residual norm decreases enough.
+ * With modifiedNewton, the system matrix assembled (and factorized by direct linear solvers) at a
+ * previous iteration or time step is kept as long as each iteration reduces the residual by at least
+ * refactorizationRatio. Otherwise, it is assembled again at the next iteration.
+ */
+class SOFA_IMPLICIT_ODE_SOLVER_API NewtonRaphsonSolver : public sofa::core::behavior::OdeSolver
+{
+public:
+    SOFA_CLASS(NewtonRaphsonSolver, sofa::core::behavior::OdeSolver);
+
+    Data<bool> d_static; ///< Solve the static equilibrium f(x) = 0 instead of the backward Euler dynamics
+    Data<unsigned int> d_maxNbIterations; ///< Maximum number of Newton iterations per time step
+    Data<SReal> d_absoluteResidualTolerance; ///< Convergence criterion on the norm of the residual
+    Data<SReal> d_relativeResidualTolerance; ///< Convergence criterion on the norm of the residual, relative to the residual at the beginning of the time step
+    Data<SReal> d_correctionTolerance; ///< Convergence criterion on the norm of the position increment
+    Data<unsigned int> d_maxNbLineSearchIterations; ///< Maximum number of backtracking steps of the line search (0 disables the line search)
+    Data<SReal> d_lineSearchCoefficient; ///< Factor applied to the correction at each backtracking step
+    Data<bool> d_modifiedNewton; ///< Reuse the system matrix of a previous iteration or time step while the convergence is good
+    Data<SReal> d_refactorizationRatio; ///< With modifiedNewton, the matrix is assembled again when |r_k+1| / |r_k| is larger than this ratio
+    Data<SReal> f_rayleighStiffness; ///< Rayleigh damping coefficient related to stiffness, > 0
+    Data<SReal> f_rayleighMass; ///< Rayleigh damping coefficient related to mass, > 0
+    Data<bool> d_threadSafeVisitor;
+
+    Data<unsigned int> d_currentIterations; ///< OUTPUT: number of Newton iterations of the last time step
+    Data<SReal> d_currentResidual; ///< OUTPUT: norm of the residual at the end of the last time step
+    Data<unsigned int> d_nbMatrixAssemblies; ///< OUTPUT: number of system matrix assemblies since the beginning of the simulation
+
+protected:
+    NewtonRaphsonSolver();
+public:
+    void init() override;
+
+    void reset() override;
+
+    void cleanup() override;
+
+    void solve (const core::ExecParams* params, SReal dt, sofa::core::MultiVecCoordId xResult, sofa::core::MultiVecDerivId vResult) override;
+
+    double getVelocityIntegrationFactor() const override { return 1.0; }
+
+    double getPositionIntegrationFactor() const override ;
+
+    virtual double getPositionIntegrationFactor(double dt ) const { return dt; }
+
+    double getIntegrationFactor(int inputDerivative, int outputDerivative) const override ;
+
+    double getIntegrationFactor(int inputDerivative, int outputDerivative, double dt) const ;
+
+    double getSolutionIntegrationFactor(int outputDerivative) const override ;
+
+    double getSolutionIntegrationFactor(int outputDerivative, double dt) const ;
+
+protected:
+
+    /// Whether the system matrix must be assembled before the next linear solve
+    bool needMatrixAssembly(SReal dt, sofa::Size systemSize) const;
+
+    /// solution of the linear system
+    core::behavior::MultiVecDeriv m_correction;
+
+    /// State of the last assembled system matrix, used by the modified Newton method
+    bool m_matrixIsValid;
+    SReal m_matrixDt;
+    sofa::Size m_matrixSize;
+};
+
+} // namespace odesolver
+
+} // namespace component
+
+} // namespace sofa
+
+#endif
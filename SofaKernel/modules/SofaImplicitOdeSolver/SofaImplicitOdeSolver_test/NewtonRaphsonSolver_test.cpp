@@ -0,0 +1,170 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaTest/Sofa_test.h>
+#include <SceneCreator/SceneCreator.h>
+#include <SceneCreator/SceneUtils.h>
+#include <SofaImplicitOdeSolver/NewtonRaphsonSolver.h>
+#include <SofaBaseLinearSolver/CGLinearSolver.h>
+#include <SofaGeneralLinearSolver/CholeskySolver.h>
+#include <SofaBoundaryCondition/FixedConstraint.h>
+
+#include <sofa/simulation/Simulation.h>
+
+#include <SofaTest/TestMessageHandler.h>
+
+
+namespace sofa {
+
+using namespace modeling;
+using namespace defaulttype;
+
+using sofa::component::projectiveconstraintset::FixedConstraint;
+using sofa::component::odesolver::NewtonRaphsonSolver;
+typedef component::linearsolver::CGLinearSolver<component::linearsolver::GraphScatteredMatrix, component::linearsolver::GraphScatteredVector> CGLinearSolver;
+typedef component::linearsolver::CholeskySolver<component::linearsolver::SparseMatrix<double>, component::linearsolver::FullVector<double> > CholeskySolver;
+
+/// Direct solver counting its factorizations
+class FactorizationCounter : public CholeskySolver
+{
+public:
+    SOFA_CLASS(FactorizationCounter, CholeskySolver);
+
+    unsigned int m_nbFactorizations {0};
+
+    void invert(Matrix& M) override
+    {
+        ++m_nbFactorizations;
+        CholeskySolver::invert(M);
+    }
+};
+
+
+/** Mass-spring string composed of two particles in gravity, one is fixed.
+ * The static Newton solver must reach the equilibrium in one time step,
+ * the dynamic one must converge to it.
+ */
+struct NewtonRaphsonSolver_test : public Sofa_test<>
+{
+    simulation::Node::SPtr root;
+    NewtonRaphsonSolver::SPtr newtonSolver;
+    FactorizationCounter::SPtr directSolver;
+
+    void createScene(bool isStatic, bool modifiedNewton, bool useDirectSolver = false)
+    {
+        root = modeling::initSofa();
+
+        newtonSolver = addNew<NewtonRaphsonSolver>(root);
+        newtonSolver->d_static.setValue(isStatic);
+        newtonSolver->d_modifiedNewton.setValue(modifiedNewton);
+        if (useDirectSolver)
+        {
+            directSolver = addNew<FactorizationCounter>(root);
+        }
+        else
+        {
+            CGLinearSolver::SPtr linearSolver = addNew<CGLinearSolver>(root);
+            linearSolver->f_maxIter.setValue(25);
+            linearSolver->f_tolerance.setValue(1e-10);
+            linearSolver->f_smallDenominatorThreshold.setValue(1e-10);
+        }
+
+        simulation::Node::SPtr string = massSpringString(
+                    root, // attached to root node
+                    0,1,0,     // first particle position
+                    0,0,0,     // last  particle position
+                    2,      // number of particles
+                    2.0,    // total mass
+                    1000.0, // stiffness
+                    0.1     // damping ratio
+                    );
+        FixedConstraint<Vec3Types>::SPtr fixed = modeling::addNew<FixedConstraint<Vec3Types> >(string,"fixedConstraint");
+        fixed->addConstraint(0);      // attach first particle
+
+        initScene(root);
+    }
+
+    void checkSecondParticle(const Vec3d& expected, double precision)
+    {
+        Vector x = getVector( core::VecId::position() );
+        Vec3d actual( x[3],x[4],x[5]); // position of second particle
+        if( vectorMaxDiff(expected,actual)>precision )
+            ADD_FAILURE() << "Solver test has not converged to the expected position" <<
+                             " expected: " << expected << std::endl <<
+                             " actual " << actual << std::endl;
+    }
+};
+
+TEST_F( NewtonRaphsonSolver_test, staticEquilibriumInOneStep )
+{
+    EXPECT_MSG_NOEMIT(Error) ;
+    createScene(true, false);
+
+    sofa::simulation::getSimulation()->animate(root.get(),1.0);
+
+    checkSecondParticle(Vec3d(0,-0.00981,0), 1e-6);
+    // the residual does not include the reaction of the fixed particle: it vanishes at the equilibrium,
+    // which the problem being linear reaches in a single iteration
+    EXPECT_LT(newtonSolver->d_currentResidual.getValue(), 1e-8);
+    EXPECT_EQ(1u, newtonSolver->d_currentIterations.getValue());
+}
+
+TEST_F( NewtonRaphsonSolver_test, dynamicModifiedNewtonToEquilibrium )
+{
+    EXPECT_MSG_NOEMIT(Error) ;
+    createScene(false, true);
+
+    unsigned int nbIterations = 0;
+    for (unsigned int i = 0; i < 100; ++i)
+    {
+        sofa::simulation::getSimulation()->animate(root.get(),1.0);
+        nbIterations += newtonSolver->d_currentIterations.getValue();
+    }
+
+    checkSecondParticle(Vec3d(0,-0.00981,0), 1e-4);
+
+    // the time step is constant: the matrix is reused by the iterations which converge fast enough,
+    // so that it is assembled strictly less often than the system is solved
+    EXPECT_LT(newtonSolver->d_nbMatrixAssemblies.getValue(), nbIterations);
+}
+
+TEST_F( NewtonRaphsonSolver_test, dynamicModifiedNewtonReusesFactorization )
+{
+    EXPECT_MSG_NOEMIT(Error) ;
+    createScene(false, true, true);
+
+    unsigned int nbIterations = 0;
+    for (unsigned int i = 0; i < 100; ++i)
+    {
+        sofa::simulation::getSimulation()->animate(root.get(),1.0);
+        nbIterations += newtonSolver->d_currentIterations.getValue();
+    }
+
+    checkSecondParticle(Vec3d(0,-0.00981,0), 1e-4);
+
+    // the problem is linear, the time step is constant and the direct solver is exact: the matrix
+    // assembled and factorized at the first iteration is reused by all the following ones
+    EXPECT_LT(1u, nbIterations);
+    EXPECT_EQ(1u, newtonSolver->d_nbMatrixAssemblies.getValue());
+    EXPECT_EQ(1u, directSolver->m_nbFactorizations);
+}
+
+}// namespace sofa
@@ -45,9 +45,15 @@ namespace basevtkreader
 
 BaseVTKReader::BaseVTKReader(): inputPoints (nullptr), inputNormals (nullptr), inputPolygons(nullptr), inputCells(nullptr),
     inputCellOffsets(nullptr), inputCellTypes(nullptr),
-    numberOfPoints(0), numberOfCells(0)
+    numberOfPoints(0), numberOfCells(0), taskScheduler(nullptr)
 {}
 
+bool BaseVTKReader::readData(BaseVTKDataIO* data, istream& in, int n, int binary)
+{
+    data->taskScheduler = taskScheduler;
+    return data->read(in, n, binary);
+}
+
 BaseVTKReader::BaseVTKDataIO* BaseVTKReader::newVTKDataIO(const string& typestr)
 {
     if  (!strcasecmp(typestr.c_str(), "char") || !strcasecmp(typestr.c_str(), "Int8"))
@@ -30,6 +30,11 @@
 #include <sofa/core/objectmodel/BaseData.h>
 #include <sofa/core/objectmodel/BaseObject.h>
 
+namespace sofa::simulation
+{
+    class TaskScheduler;
+}
+
 namespace sofa
 {
 
@@ -68,7 +73,9 @@ public:
         string name;
         int dataSize;
         int nestedDataSize;
-        BaseVTKDataIO() : dataSize(0), nestedDataSize(1) {}
+        /// If set, large ASCII arrays are converted in parallel
+        sofa::simulation::TaskScheduler* taskScheduler;
+        BaseVTKDataIO() : dataSize(0), nestedDataSize(1), taskScheduler(nullptr) {}
         ~BaseVTKDataIO() override {}
         virtual void resize(int n) = 0;
         virtual bool read(istream& f, int n, int binary) = 0;
@@ -103,6 +110,11 @@ public:
         virtual bool read(istream& in, int n, int binary) override;
         virtual bool write(ofstream& out, int n, int groups, int binary) override;
         BaseData* createSofaData() override ;
+
+    protected:
+        /// Convert n ASCII values from [begin, end), returns the position following the line of the last value,
+        /// or nullptr if there are not enough values
+        const char* readText(const char* begin, const char* end, int n);
     };
 
     BaseVTKDataIO* newVTKDataIO(const string& typestr) ;
@@ -120,8 +132,14 @@ public:
 
     int numberOfPoints, numberOfCells, numberOfLines;
 
+    /// If set, large ASCII arrays are converted in parallel
+    sofa::simulation::TaskScheduler* taskScheduler;
+
     BaseVTKReader() ;
 
+    /// Read n values of the array data from the stream, in parallel if there is a task scheduler
+    bool readData(BaseVTKDataIO* data, istream& in, int n, int binary);
+
     bool readVTK(const char* filename) ;
 
     virtual bool readFile(const char* filename) = 0;
@@ -23,9 +23,14 @@
 #define SOFA_COMPONENT_LOADER_BASEVTKREADER_INL
 #include <SofaLoader/BaseVTKReader.h>
 
+#include <sofa/helper/io/MappedFile.h>
+#include <sofa/helper/io/TextParser.h>
+#include <sofa/simulation/ParallelForEach.h>
+
 #include <string>
 #include <istream>
 #include <fstream>
+#include <type_traits>
 
 
 namespace sofa
@@ -43,6 +48,68 @@ namespace basevtkreader
 using std::istringstream ;
 using sofa::defaulttype::Vec ;
 
+/// Conversion of one value of a VTK ASCII array with the text tokenizer.
+/// The characters are not supported: operator>> reads them one by one and not as numbers, so they keep using it.
+template<class T>
+struct VTKTextValue
+{
+    static constexpr bool supported = std::is_arithmetic<T>::value && sizeof(T) > 1;
+    static constexpr int nbTokens = 1;
+
+    static const char* read(const char* p, const char* end, T& value)
+    {
+        return helper::io::text::parseNumber(p, end, value);
+    }
+};
+
+template<sofa::Size N, class Real>
+struct VTKTextValue< Vec<N, Real> >
+{
+    static constexpr bool supported = VTKTextValue<Real>::supported;
+    static constexpr int nbTokens = N;
+
+    static const char* read(const char* p, const char* end, Vec<N, Real>& value)
+    {
+        p = helper::io::text::parseNumber(p, end, value[0]);
+        for (sofa::Size i = 1; p && i < N; ++i)
+        {
+            if (!helper::io::text::readNumber(p, end, value[i]))
+                return nullptr;
+        }
+        return p;
+    }
+};
+
+/// Convert n values from p, line by line as operator>> does: the rest of a line is ignored after an invalid token.
+/// Returns the position following the last value, or nullptr if there are not enough values.
+template<class T>
+const char* readVTKTextValues(const char* p, const char* end, T* values, int n)
+{
+    int i = 0;
+    while (i < n)
+    {
+        p = helper::io::text::skipBlanks(p, end);
+        if (p == end)
+            return nullptr;
+        if (*p == '\n')
+        {
+            ++p;
+            continue;
+        }
+        const char* next = VTKTextValue<T>::read(p, end, values[i]);
+        if (next)
+        {
+            p = next;
+            ++i;
+        }
+        else
+        {
+            p = helper::io::text::findLineEnd(p, end);
+        }
+    }
+    return p;
+}
+
 template<class T>
 const void* BaseVTKReader::VTKDataIO<T>::getData()
 {
@@ -97,6 +164,16 @@ void BaseVTKReader::VTKDataIO<T>::swap()
 template<class T>
 bool BaseVTKReader::VTKDataIO<T>::read(const string& s, int n, int binary)
 {
+    if (binary == 0 && VTKTextValue<T>::supported)
+    {
+        resize(n);
+        if (!readText(s.data(), s.data() + s.size(), n))
+        {
+            resize(0);
+            return false;
+        }
+        return true;
+    }
     istringstream iss(s);
     return read(iss, n, binary);
 }
@@ -149,6 +226,20 @@ bool BaseVTKReader::VTKDataIO<T>::read(istream& in, int n, int binary)
             }
         }
     }
+    else if (VTKTextValue<T>::supported && dynamic_cast<helper::io::MemoryStreamBuf*>(in.rdbuf()))
+    {
+        // the stream reads from memory (typically a MappedFile): the values are converted in place
+        helper::io::MemoryStreamBuf* buffer = static_cast<helper::io::MemoryStreamBuf*>(in.rdbuf());
+        const char* next = readText(buffer->gptr(), buffer->egptr(), n);
+        if (!next)
+        {
+            buffer->advance(buffer->egptr());
+            in.setstate(std::ios_base::eofbit);
+            resize(0);
+            return false;
+        }
+        buffer->advance(next);
+    }
     else
     {
         int i = 0;
@@ -169,6 +260,63 @@ bool BaseVTKReader::VTKDataIO<T>::read(istream& in, int n, int binary)
     return true;
 }
 
+template<class T>
+const char* BaseVTKReader::VTKDataIO<T>::readText(const char* begin, const char* end, int n)
+{
+    const std::size_t nbChunks = taskScheduler ? taskScheduler->getThreadCount() : 1;
+    const int minChunkSize = 1 << 14;
+
+    const char* last = nullptr;
+    if (nbChunks <= 1 || n < 2 * minChunkSize)
+    {
+        last = readVTKTextValues(begin, end, data, n);
+    }
+    else
+    {
+        // A first pass only looks for the white spaces to find the first token of each chunk, which
+        // is much cheaper than the conversions. The chunks are then converted in parallel.
+        const std::size_t nbValues = static_cast<std::size_t>(n);
+        const std::size_t chunkCount = std::min(nbChunks, nbValues / minChunkSize);
+        std::vector<const char*> chunkBegins(chunkCount, nullptr);
+        std::size_t nbTokens = 0;
+        std::size_t chunk = 0;
+        const std::size_t totalTokens = nbValues * VTKTextValue<T>::nbTokens;
+        const char* p = begin;
+        while (nbTokens < totalTokens)
+        {
+            p = helper::io::text::skipSpaces(p, end);
+            if (p == end)
+                return nullptr;
+            if (chunk < chunkCount && nbTokens == (nbValues * chunk / chunkCount) * VTKTextValue<T>::nbTokens)
+                chunkBegins[chunk++] = p;
+            while (p != end && !helper::io::text::isSpace(*p)) ++p;
+            ++nbTokens;
+        }
+
+        std::vector<char> chunkIsValid(chunkCount, 0);
+        simulation::parallelForEachRange(taskScheduler, 0, chunkCount, [&](std::size_t first, std::size_t lastChunk)
+        {
+            for (std::size_t c = first; c < lastChunk; ++c)
+            {
+                const std::size_t v0 = nbValues * c / chunkCount;
+                const std::size_t v1 = nbValues * (c + 1) / chunkCount;
+                chunkIsValid[c] = readVTKTextValues(chunkBegins[c], end, data + v0, static_cast<int>(v1 - v0)) != nullptr;
+            }
+        });
+
+        if (std::find(chunkIsValid.begin(), chunkIsValid.end(), 0) == chunkIsValid.end())
+            last = p;
+        else // invalid tokens: the chunks are not aligned on the values, they are converted again in order
+            last = readVTKTextValues(begin, end, data, n);
+    }
+
+    if (!last)
+        return nullptr;
+
+    // as with std::getline, the end of the line of the last value is consumed
+    return helper::io::text::nextLine(last, end);
+}
+
 template<class T>
 bool BaseVTKReader::VTKDataIO<T>::write(ofstream& out, int n, int groups, int binary)
 {
@@ -23,7 +23,13 @@
 #include <SofaLoader/MeshObjLoader.h>
 #include <sofa/core/visual/VisualParams.h>
 #include <sofa/helper/system/SetDirectory.h>
+#include <sofa/helper/io/MappedFile.h>
+#include <sofa/helper/io/TextParser.h>
+#include <sofa/simulation/ParallelForEach.h>
+#include <sofa/simulation/InitTasks.h>
 #include <fstream>
+#include <array>
+#include <string_view>
 #include <sofa/helper/accessor.h>
 
 namespace sofa::component::loader
@@ -55,6 +61,7 @@ MeshObjLoader::MeshObjLoader()
     , d_computeMaterialFaces(initData(&d_computeMaterialFaces, false, "computeMaterialFaces", "True to activate export of Data instances containing list of face indices for each material"))
     , d_vertPosIdx      (initData   (&d_vertPosIdx, "vertPosIdx", "If vertices have multiple normals/texcoords stores vertices position indices"))
     , d_vertNormIdx     (initData   (&d_vertNormIdx, "vertNormIdx", "If vertices have multiple normals/texcoords stores vertices normal indices"))
+    , d_parallel(initData(&d_parallel, false, "parallel", "Parse the large files by chunks of lines processed in parallel"))
 {
     addAlias(&d_material, "material");
 
@@ -90,16 +97,16 @@ bool MeshObjLoader::doLoad()
 
     // -- Loading file
     const char* filename = m_filename.getFullPath().c_str();
-    std::ifstream file(filename);
+    helper::io::MappedFile file;
 
-    if (!file.good())
+    if (!file.open(filename))
     {
         msg_error() << "Cannot read file '" << m_filename << "'.";
         return false;
     }
 
     // -- Reading file
-    fileRead = readOBJ (file,filename);
+    fileRead = readOBJ (file.begin(), file.end(), filename);
     file.close();
 
     return fileRead;
@@ -145,7 +152,122 @@ void MeshObjLoader::addGroup (const PrimitiveGroup& g)
     }
 }
 
-bool MeshObjLoader::readOBJ (std::ifstream &file, const char* filename)
+namespace
+{
+
+/// Content of a range of lines of an OBJ file, parsed independently of the other ranges
+struct ObjChunk
+{
+    helper::vector<Vector3> positions;
+    helper::vector<Vector3> normals;
+    helper::vector<Vector2> texCoords;
+
+    /// position, texcoord and normal indices of the face corners, -1 if not defined
+    std::vector< std::array<int, 3> > corners;
+    /// first corner of each face, followed by the number of corners
+    std::vector<std::size_t> faceBegins;
+    /// corners with a negative (relative) index, stored as 3 * corner + component. Their index is relative
+    /// to the beginning of the chunk until the number of elements defined in the previous chunks is known.
+    std::vector<std::size_t> relativeCorners;
+
+    /// Statements changing the current group or material, with the number of faces preceding them
+    struct Statement
+    {
+        std::size_t face;
+        std::string_view keyword;
+        std::string_view arguments;
+    };
+    std::vector<Statement> statements;
+
+    std::vector<std::string> invalidIndices;
+
+    void parse(const char* begin, const char* end);
+};
+
+template<class VecType>
+VecType readVector(const char*& p, const char* lineEnd)
+{
+    VecType v;
+    for (sofa::Size i = 0; i < VecType::total_size; ++i)
+    {
+        if (!helper::io::text::readNumber(p, lineEnd, v[i]))
+            break;
+    }
+    return v;
+}
+
+void ObjChunk::parse(const char* begin, const char* end)
+{
+    namespace text = helper::io::text;
+
+    for (const char* line = begin; line != end; line = text::nextLine(line, end))
+    {
+        const char* lineEnd = text::findLineEnd(line, end);
+        const char* p = line;
+        const std::string_view token = text::nextToken(p, lineEnd);
+
+        if (token == "v")
+        {
+            positions.push_back(readVector<Vector3>(p, lineEnd));
+        }
+        else if (token == "vn")
+        {
+            normals.push_back(readVector<Vector3>(p, lineEnd));
+        }
+        else if (token == "vt")
+        {
+            texCoords.push_back(readVector<Vector2>(p, lineEnd));
+        }
+        else if (token == "l" || token == "f")
+        {
+            faceBegins.push_back(corners.size());
+            const std::size_t nbDefined[3] = { positions.size(), texCoords.size(), normals.size() };
+            for (std::string_view face = text::nextToken(p, lineEnd); !face.empty(); face = text::nextToken(p, lineEnd))
+            {
+                std::array<int, 3> vtn = {-1, -1, -1};
+                const char* q = face.data();
+                const char* faceEnd = q + face.size();
+                for (int j = 0; j < 3; ++j)
+                {
+                    const char* slash = std::find(q, faceEnd, '/');
+                    if (slash != q)
+                    {
+                        int index = 0; // as atoi, 0 if the index is not a number
+                        text::parseNumber(q, slash, index);
+                        if (index >= 1)
+                        {
+                            vtn[j] = index - 1; // -1 because the numerotation begins at 1 and a vector begins at 0
+                        }
+                        else if (index < 0)
+                        {
+                            vtn[j] = static_cast<int>(nbDefined[j]) + index;
+                            relativeCorners.push_back(3 * corners.size() + j);
+                        }
+                        else
+                        {
+                            invalidIndices.emplace_back(q, slash);
+                        }
+                    }
+                    if (slash == faceEnd)
+                        break;
+                    q = slash + 1;
+                }
+                corners.push_back(vtn);
+            }
+        }
+        else if (token == "g" || token == "usemtl" || token == "mtllib")
+        {
+            p = text::skipBlanks(p, lineEnd);
+            statements.push_back({faceBegins.size(), token, std::string_view(p, static_cast<std::size_t>(lineEnd - p))});
+        }
+        // comments and other statements are ignored
+    }
+    faceBegins.push_back(corners.size());
+}
+
+} // namespace
+
+bool MeshObjLoader::readOBJ (const char* begin, const char* end, const char* filename)
 {
     const bool handleSeams = d_handleSeams.getValue();
     auto my_positions = getWriteOnlyAccessor(d_positions);
@@ -180,8 +302,6 @@ bool MeshObjLoader::readOBJ (std::ifstream &file, const char* filename)
     getWriteOnlyAccessor(d_trianglesGroups).clear();
     getWriteOnlyAccessor(d_quadsGroups).clear();
 
-    int vtn[3];
-    Vector3 result;
     helper::WriteAccessor<Data<helper::vector< PrimitiveGroup> > > my_faceGroups[NBFACETYPE] =
     {
         d_edgesGroups,
@@ -193,129 +313,118 @@ bool MeshObjLoader::readOBJ (std::ifstream &file, const char* filename)
     int curMaterialId = -1;
     int nbFaces[NBFACETYPE] = {0}; // number of edges, triangles, quads
     int groupF0[NBFACETYPE] = {0}; // first primitives indices in current group for edges, triangles, quads
-    std::string line;
-    while( std::getline(file,line) )
-    {
-        if (line.empty()) continue;
-        std::istringstream values(line);
-        std::string token;
-        values >> token;
 
-        if (token == "#")
-        {
-            // comment
-        }
-        else if (token == "v")
-        {
-            // vertex
-            values >> result[0] >> result[1] >> result[2];
-            my_positions.push_back(Vector3(result[0],result[1], result[2]));
-        }
-        else if (token == "vn")
-        {
-            // normal
-            values >> result[0] >> result[1] >> result[2];
-            my_normals.push_back(Vector3(result[0],result[1], result[2]));
-        }
-        else if (token == "vt")
+    // The lines are parsed by chunks, in parallel if a task scheduler is available. The chunks are then
+    // processed in order, which resolves the relative indices and the group and material statements.
+    simulation::TaskScheduler* taskScheduler = nullptr;
+    if (d_parallel.getValue())
+    {
+        taskScheduler = simulation::TaskScheduler::getInstance();
+        if (taskScheduler->getThreadCount() < 1)
         {
-            // texcoord
-            values >> result[0] >> result[1];
-            my_texCoords.push_back(Vector2(result[0],result[1]));
+            taskScheduler->init(0);
+            simulation::initThreadLocalData();
         }
-        else if ((token == "mtllib") && d_loadMaterial.getValue())
+    }
+    const std::size_t minChunkSize = 1 << 20;
+    const std::size_t nbThreads = taskScheduler ? taskScheduler->getThreadCount() : 1;
+    std::vector<const char*> chunkBegins;
+    helper::io::text::splitLines(begin, end, std::min(nbThreads, std::size_t(end - begin) / minChunkSize + 1), chunkBegins);
+
+    std::vector<ObjChunk> chunks(chunkBegins.size() - 1);
+    simulation::parallelForEachRange(taskScheduler, 0, chunks.size(), [&](std::size_t first, std::size_t last)
+    {
+        for (std::size_t c = first; c < last; ++c)
+            chunks[c].parse(chunkBegins[c], chunkBegins[c+1]);
+    });
+
+    for (ObjChunk& chunk : chunks)
+    {
+        for (const std::string& index : chunk.invalidIndices)
+            msg_error() << "Invalid index " << index;
+
+        const int nbPreviouslyDefined[3] = { int(my_positions.size()), int(my_texCoords.size()), int(my_normals.size()) };
+        for (std::size_t relativeCorner : chunk.relativeCorners)
+            chunk.corners[relativeCorner / 3][relativeCorner % 3] += nbPreviouslyDefined[relativeCorner % 3];
+
+        my_positions.wref().insert(my_positions.end(), chunk.positions.begin(), chunk.positions.end());
+        my_normals.wref().insert(my_normals.end(), chunk.normals.begin(), chunk.normals.end());
+        my_texCoords.wref().insert(my_texCoords.end(), chunk.texCoords.begin(), chunk.texCoords.end());
+
+        const std::size_t nbChunkFaces = chunk.faceBegins.size() - 1;
+        std::size_t statement = 0;
+        for (std::size_t face = 0; face <= nbChunkFaces; ++face)
         {
-            while (!values.eof())
+            for (; statement < chunk.statements.size() && chunk.statements[statement].face == face; ++statement)
             {
-                std::string materialLibaryName;
-                values >> materialLibaryName;
-                std::string mtlfile = sofa::helper::system::SetDirectory::GetRelativeFromFile(materialLibaryName.c_str(), filename);
-                this->readMTL(mtlfile.c_str(), my_materials.wref());
-            }
-        }
-        else if (token == "usemtl" || token == "g")
-        {
-            // end of current group
-            //curGroup.nbp = nbf - curGroup.p0;
-            for (int ft = 0; ft < NBFACETYPE; ++ft)
-                if (nbFaces[ft] > groupF0[ft])
+                const std::string_view token = chunk.statements[statement].keyword;
+                const std::string arguments(chunk.statements[statement].arguments);
+                std::istringstream values(arguments);
+
+                if (token == "mtllib")
                 {
-                    my_faceGroups[ft].push_back(PrimitiveGroup(groupF0[ft], nbFaces[ft]-groupF0[ft], curMaterialName, curGroupName, curMaterialId));
-                    groupF0[ft] = nbFaces[ft];
+                    if (!d_loadMaterial.getValue())
+                        continue;
+                    std::string materialLibaryName;
+                    while (values >> materialLibaryName)
+                    {
+                        std::string mtlfile = sofa::helper::system::SetDirectory::GetRelativeFromFile(materialLibaryName.c_str(), filename);
+                        this->readMTL(mtlfile.c_str(), my_materials.wref());
+                    }
+                    continue;
                 }
-            if (token == "usemtl")
-            {
-                values >> curMaterialName;
-                curMaterialId = -1;
-                helper::vector<Material>::iterator it = my_materials.begin();
-                helper::vector<Material>::iterator itEnd = my_materials.end();
-                for (; it != itEnd; ++it)
+
+                // end of current group
+                //curGroup.nbp = nbf - curGroup.p0;
+                for (int ft = 0; ft < NBFACETYPE; ++ft)
+                    if (nbFaces[ft] > groupF0[ft])
+                    {
+                        my_faceGroups[ft].push_back(PrimitiveGroup(groupF0[ft], nbFaces[ft]-groupF0[ft], curMaterialName, curGroupName, curMaterialId));
+                        groupF0[ft] = nbFaces[ft];
+                    }
+                if (token == "usemtl")
                 {
-                    if (it->name == curMaterialName)
+                    values >> curMaterialName;
+                    curMaterialId = -1;
+                    helper::vector<Material>::iterator it = my_materials.begin();
+                    helper::vector<Material>::iterator itEnd = my_materials.end();
+                    for (; it != itEnd; ++it)
                     {
-                        (*it).activated = true;
-                        if (!material->activated)
-                            material.wref() = *it;
-                        curMaterialId = it - my_materials.begin();
-                        break;
+                        if (it->name == curMaterialName)
+                        {
+                            (*it).activated = true;
+                            if (!material->activated)
+                                material.wref() = *it;
+                            curMaterialId = it - my_materials.begin();
+                            break;
+                        }
                     }
                 }
-            }
-            else if (token == "g")
-            {
-                curGroupName.clear();
-                while (!values.eof())
+                else if (token == "g")
                 {
+                    curGroupName.clear();
                     std::string g;
-                    values >> g;
-                    if (!curGroupName.empty())
-                        curGroupName += " ";
-                    curGroupName += g;
+                    while (values >> g)
+                    {
+                        if (!curGroupName.empty())
+                            curGroupName += " ";
+                        curGroupName += g;
+                    }
                 }
             }
-        }
-        else if (token == "l" || token == "f")
-        {
+
+            if (face == nbChunkFaces)
+                break;
+
             // face
             nodes.clear();
             nIndices.clear();
             tIndices.clear();
-
-            while (!values.eof())
+            for (std::size_t corner = chunk.faceBegins[face]; corner < chunk.faceBegins[face+1]; ++corner)
             {
-                std::string face;
-                values >> face;
-                if (face.empty()) continue;
-                for (int j = 0; j < 3; j++)
-                {
-                    vtn[j] = -1;
-                    std::string::size_type pos = face.find('/');
-                    std::string tmp = face.substr(0, pos);
-                    if (pos == std::string::npos)
-                        face = "";
-                    else
-                    {
-                        face = face.substr(pos + 1);
-                    }
-
-                    if (!tmp.empty())
-                    {
-                        vtn[j] = atoi(tmp.c_str());
-                        if (vtn[j] >= 1)
-                            vtn[j] -=1; // -1 because the numerotation begins at 1 and a vector begins at 0
-                        else if (vtn[j] < 0)
-                            vtn[j] += (j==0) ? my_positions.size() : (j==1) ? my_texCoords.size() : my_normals.size();
-                        else
-                        {
-                            msg_error() << "Invalid index " << tmp;
-                            vtn[j] = -1;
-                        }
-                    }
-                }
-
-                nodes.push_back(vtn[0]);
-                tIndices.push_back(vtn[1]);
-                nIndices.push_back(vtn[2]);
+                nodes.push_back(chunk.corners[corner][0]);
+                tIndices.push_back(chunk.corners[corner][1]);
+                nIndices.push_back(chunk.corners[corner][2]);
             }
 
             my_faceList->push_back(nodes);
@@ -353,12 +462,10 @@ bool MeshObjLoader::readOBJ (std::ifstream &file, const char* filename)
                 ++nbFaces[MeshObjLoader::TRIANGLE];
                 faceType = MeshObjLoader::TRIANGLE;
             }
-
         }
-        else
-        {
 
-        }
+        // the chunk is not needed anymore
+        chunk = ObjChunk();
     }
 
     // end of current group
@@ -43,7 +43,7 @@ public:
     bool doLoad() override;
 
 protected:
-    bool readOBJ (std::ifstream &file, const char* filename);
+    bool readOBJ (const char* begin, const char* end, const char* filename);
     bool readMTL (const char* filename, helper::vector <sofa::helper::types::Material>& d_materials);
     void addGroup (const sofa::core::loader::PrimitiveGroup& g);
     void doClearBuffers() override;
@@ -75,6 +75,8 @@ public:
     /// If it is empty then each vertex correspond to one normal
     Data< helper::vector<int> > d_vertNormIdx;
 
+    Data<bool> d_parallel; ///< Parse the large files by chunks of lines processed in parallel
+
     virtual std::string type() { return "The format of this mesh is OBJ."; }
 };
 
@@ -33,6 +33,10 @@ using sofa::component::loader::BaseVTKReader ;
 /// This is needed for template specialization.
 #include <SofaLoader/BaseVTKReader.inl>
 
+#include <sofa/helper/io/MappedFile.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/simulation/InitTasks.h>
+
 #include <tinyxml.h>
 
 //XML VTK Loader
@@ -80,6 +84,7 @@ protected:
 ////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////// MeshVTKLoader IMPLEMENTATION //////////////////////////////////
 MeshVTKLoader::MeshVTKLoader() : MeshLoader()
+  , d_parallel(initData(&d_parallel, false, "parallel", "Convert the large ASCII data arrays in parallel"))
   , reader(nullptr)
 {
 }
@@ -159,6 +164,17 @@ bool MeshVTKLoader::doLoad()
         return false;
     }
 
+    if (d_parallel.getValue())
+    {
+        simulation::TaskScheduler* taskScheduler = simulation::TaskScheduler::getInstance();
+        if (taskScheduler->getThreadCount() < 1)
+        {
+            taskScheduler->init(0);
+            simulation::initThreadLocalData();
+        }
+        reader->taskScheduler = taskScheduler;
+    }
+
     fileRead = reader->readVTK (filename);
     this->setInputsMesh();
     this->setInputsData();
@@ -558,11 +574,14 @@ void MeshVTKLoader::doClearBuffers()
 //Legacy VTK Loader
 bool LegacyVTKReader::readFile(const char* filename)
 {
-    std::ifstream inVTKFile(filename, std::ifstream::in | std::ifstream::binary);
-    if( !inVTKFile.is_open() )
+    // the file is mapped in memory: the data arrays are parsed directly from its content
+    helper::io::MappedFile file;
+    if( !file.open(filename) )
     {
         return false;
     }
+    helper::io::MemoryStreamBuf fileBuffer(file.begin(), file.end());
+    std::istream inVTKFile(&fileBuffer);
 
     string line;
 
@@ -644,7 +663,7 @@ bool LegacyVTKReader::readFile(const char* filename)
             {
                 return false;
             }
-            if (!inputPoints->read(inVTKFile, 3 * n, binary))
+            if (!readData(inputPoints, inVTKFile, 3 * n, binary))
             {
                 return false;
             }
@@ -657,7 +676,7 @@ bool LegacyVTKReader::readFile(const char* filename)
             msg_info() << n << " polygons ( " << (ni - 3 * n) << " triangles )" ;
             inputPolygons = new VTKDataIO<int>;
             inputPolygonsInt = dynamic_cast<VTKDataIO<int>* > (inputPolygons);
-            if (!inputPolygons->read(inVTKFile, ni, binary))
+            if (!readData(inputPolygons, inVTKFile, ni, binary))
             {
                 return false;
             }
@@ -669,7 +688,7 @@ bool LegacyVTKReader::readFile(const char* filename)
             msg_info() << "Found " << n << " cells" ;
             inputCells = new VTKDataIO<int>;
             inputCellsInt = dynamic_cast<VTKDataIO<int>* > (inputCells);
-            if (!inputCells->read(inVTKFile, ni, binary))
+            if (!readData(inputCells, inVTKFile, ni, binary))
             {
                 return false;
             }
@@ -682,7 +701,7 @@ bool LegacyVTKReader::readFile(const char* filename)
             msg_info() << "Found " << n << " lines" ;
             inputCells = new VTKDataIO<int>;
             inputCellsInt = dynamic_cast<VTKDataIO<int>* > (inputCellsInt);
-            if (!inputCells->read(inVTKFile, ni, binary))
+            if (!readData(inputCells, inVTKFile, ni, binary))
             {
                 return false;
             }
@@ -702,7 +721,7 @@ bool LegacyVTKReader::readFile(const char* filename)
             ln >> n;
             inputCellTypes = new VTKDataIO<int>;
             inputCellTypesInt = dynamic_cast<VTKDataIO<int>* > (inputCellTypes);
-            if (!inputCellTypes->read(inVTKFile, n, binary))
+            if (!readData(inputCellTypes, inVTKFile, n, binary))
             {
                 return false;
             }
@@ -757,7 +776,7 @@ bool LegacyVTKReader::readFile(const char* filename)
                                 inVTKFile.seekg(positionBeforeLookupTable);
                             }
                         }
-                        if (data->read(inVTKFile, nb_ele, binary))
+                        if (readData(data, inVTKFile, nb_ele, binary))
                         {
                             inputDataVector.push_back(data);
                             data->name = dataName;
@@ -787,7 +806,7 @@ bool LegacyVTKReader::readFile(const char* filename)
                     {
                         return false;
                     }
-                    if (!inputNormals->read(inVTKFile, 3 * nb_ele, binary))
+                    if (!readData(inputNormals, inVTKFile, 3 * nb_ele, binary))
                     {
                         return false;
                     }
@@ -799,7 +818,7 @@ bool LegacyVTKReader::readFile(const char* filename)
                     BaseVTKDataIO*  data = newVTKDataIO(dataType, 3);
                     if (data != nullptr)
                     {
-                        if (data->read(inVTKFile, nb_ele, binary))
+                        if (readData(data, inVTKFile, nb_ele, binary))
                         {
                             inputDataVector.push_back(data);
                             data->name = dataName;
@@ -841,7 +860,7 @@ bool LegacyVTKReader::readFile(const char* filename)
                         BaseVTKDataIO*  data = newVTKDataIO(dataType, nbComponents);
                         if (data != nullptr)
                         {
-                            if (data->read(inVTKFile, nbData, binary))
+                            if (readData(data, inVTKFile, nbData, binary))
                             {
                                 inputDataVector.push_back(data);
                                 data->name = dataName;
@@ -863,7 +882,7 @@ bool LegacyVTKReader::readFile(const char* filename)
                         BaseVTKDataIO* data = newVTKDataIO("UInt8", 4); // in the binary case there will be 4 unsigned chars per table entry
                         if (data)
                         {
-                            data->read(inVTKFile, nb_ele, binary);
+                            readData(data, inVTKFile, nb_ele, binary);
                         }
                         delete data;
                     }
@@ -872,7 +891,7 @@ bool LegacyVTKReader::readFile(const char* filename)
                         BaseVTKDataIO* data = newVTKDataIO("Float32", 4);
                         if (data)
                         {
-                            data->read(inVTKFile, nb_ele, binary);    // in the ascii case there will be 4 float32 per table entry
+                            readData(data, inVTKFile, nb_ele, binary);    // in the ascii case there will be 4 float32 per table entry
                         }
                         delete data;
                     }
@@ -1107,6 +1126,7 @@ BaseVTKReader::BaseVTKDataIO* XMLVTKReader::loadDataArray(TiXmlElement* dataArra
     {
         return nullptr;
     }
+    d->taskScheduler = taskScheduler;
 
     if (size > 0)
     {
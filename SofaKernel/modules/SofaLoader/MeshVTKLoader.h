@@ -50,6 +50,8 @@ public:
     core::objectmodel::BaseData* tetrasData;
     core::objectmodel::BaseData* hexasData;
 
+    Data<bool> d_parallel; ///< Convert the large ASCII data arrays in parallel
+
     bool doLoad() override;
 
 protected:
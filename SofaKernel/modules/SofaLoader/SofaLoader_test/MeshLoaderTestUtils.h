@@ -0,0 +1,54 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFALOADER_TEST_MESHLOADERTESTUTILS_H
+#define SOFALOADER_TEST_MESHLOADERTESTUTILS_H
+
+#include <cstddef>
+
+namespace sofa
+{
+namespace meshloader_test
+{
+
+/// Number of different elements (or vertices) in two lists of the same size
+template<class Elements>
+std::size_t countDifferences(const Elements& a, const Elements& b)
+{
+    std::size_t nbDifferences = 0;
+    for (std::size_t i = 0; i < a.size() && i < b.size(); ++i)
+    {
+        for (std::size_t k = 0; k < a[i].size(); ++k)
+        {
+            if (a[i][k] != b[i][k])
+            {
+                ++nbDifferences;
+                break;
+            }
+        }
+    }
+    return nbDifferences;
+}
+
+} // namespace meshloader_test
+} // namespace sofa
+
+#endif // SOFALOADER_TEST_MESHLOADERTESTUTILS_H
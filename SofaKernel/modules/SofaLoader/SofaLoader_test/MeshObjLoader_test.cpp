@@ -28,6 +28,14 @@
 #include <sofa/helper/BackTrace.h>
 using sofa::helper::BackTrace ;
 
+#include <sofa/simulation/TaskScheduler.h>
+
+#include "MeshLoaderTestUtils.h"
+using sofa::meshloader_test::countDifferences;
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+
 using namespace sofa::component::loader;
 
 namespace sofa
@@ -97,5 +105,85 @@ TEST_F(MeshObjLoader_test, LoadCall)
     loadTest("mesh/torus.obj", 800, 0, 1600,  0, 0, 0, 0, 0, 0, 861, 0);
 }
 
+/** Generate a file larger than the parsing chunks, using relative indices and groups defined in
+ * different chunks, and check that the parallel parsing gives the same mesh as the sequential one.
+ */
+TEST_F(MeshObjLoader_test, ParallelParsing)
+{
+    const std::string filename = boost::filesystem::temp_directory_path().string() + "/MeshObjLoader_test_parallel.obj";
+    const int n = 320;
+    {
+        std::ofstream file(filename.c_str());
+        file << "# generated grid\nvn 0 0 1\n";
+        for (int j = 0; j < n; ++j)
+        {
+            if (j % 64 == 0)
+                file << "g row " << j << "\n";
+            for (int i = 0; i < n; ++i)
+                file << "v " << i * 0.25 << " " << j * 0.5 << " " << (i + j) * 1e-3 << "\n";
+            file << "vt " << j << " 0.5\n";
+            if (j == 0) continue;
+            for (int i = 0; i + 1 < n; ++i)
+            {
+                // previous row with absolute indices, current row with relative ones
+                if (i % 2)
+                    file << "f " << (j - 1) * n + i + 1 << "/1/1 " << (j - 1) * n + i + 2 << "/1/1 " << i + 1 - n << "/-1/-1 " << i - n << "/-1/-1\n";
+                else
+                    file << "f " << (j - 1) * n + i + 1 << " " << (j - 1) * n + i + 2 << " " << i + 1 - n << "\n";
+            }
+        }
+    }
+
+    this->setFilename(filename);
+    this->d_parallel.setValue(false);
+    ASSERT_TRUE(this->load());
+    const auto positions = this->d_positions.getValue();
+    const auto triangles = this->d_triangles.getValue();
+    const auto quads = this->d_quads.getValue();
+    const auto faces = this->d_faceList.getValue();
+    const auto texIndices = this->d_texIndexList.getValue();
+    const auto normalIndices = this->d_normalsIndexList.getValue();
+    const auto triangleGroups = this->d_trianglesGroups.getValue();
+    const auto quadGroups = this->d_quadsGroups.getValue();
+    EXPECT_EQ((size_t)(n * n), positions.size());
+    EXPECT_EQ((size_t)((n - 1) * (n / 2)), triangles.size());
+    EXPECT_EQ((size_t)((n - 1) * (n / 2 - 1)), quads.size());
+    EXPECT_EQ(1u, quads[0][0]);
+    EXPECT_EQ(2u, quads[0][1]);
+    EXPECT_EQ((unsigned)n + 2, quads[0][2]);
+    EXPECT_EQ((unsigned)n + 1, quads[0][3]);
+    EXPECT_EQ(texIndices[1][2], 1);
+    EXPECT_EQ(normalIndices[1][2], 0);
+    EXPECT_EQ(5u, triangleGroups.size());
+
+    sofa::simulation::TaskScheduler* taskScheduler = sofa::simulation::TaskScheduler::getInstance();
+    taskScheduler->init(4);
+    this->d_parallel.setValue(true);
+    ASSERT_TRUE(this->load());
+
+    ASSERT_EQ(positions.size(), this->d_positions.getValue().size());
+    EXPECT_EQ(0u, countDifferences(positions, this->d_positions.getValue()));
+    ASSERT_EQ(triangles.size(), this->d_triangles.getValue().size());
+    EXPECT_EQ(0u, countDifferences(triangles, this->d_triangles.getValue()));
+    ASSERT_EQ(quads.size(), this->d_quads.getValue().size());
+    EXPECT_EQ(0u, countDifferences(quads, this->d_quads.getValue()));
+    ASSERT_EQ(faces.size(), this->d_faceList.getValue().size());
+    EXPECT_EQ(0u, countDifferences(faces, this->d_faceList.getValue()));
+    ASSERT_EQ(texIndices.size(), this->d_texIndexList.getValue().size());
+    EXPECT_EQ(0u, countDifferences(texIndices, this->d_texIndexList.getValue()));
+    ASSERT_EQ(normalIndices.size(), this->d_normalsIndexList.getValue().size());
+    EXPECT_EQ(0u, countDifferences(normalIndices, this->d_normalsIndexList.getValue()));
+    ASSERT_EQ(triangleGroups.size(), this->d_trianglesGroups.getValue().size());
+    ASSERT_EQ(quadGroups.size(), this->d_quadsGroups.getValue().size());
+    for (size_t g = 0; g < triangleGroups.size(); ++g)
+    {
+        EXPECT_EQ(triangleGroups[g].groupName, this->d_trianglesGroups.getValue()[g].groupName);
+        EXPECT_EQ(triangleGroups[g].p0, this->d_trianglesGroups.getValue()[g].p0);
+        EXPECT_EQ(triangleGroups[g].nbp, this->d_trianglesGroups.getValue()[g].nbp);
+    }
+
+    boost::filesystem::remove(filename);
+}
+
 } // namespace meshobjloader_test
 } // namespace sofa
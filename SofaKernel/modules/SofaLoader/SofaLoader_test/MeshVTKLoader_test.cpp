@@ -32,6 +32,14 @@ using sofa::helper::BackTrace ;
 #include <sofa/helper/testing/BaseTest.h>
 using sofa::helper::testing::BaseTest ;
 
+#include <sofa/simulation/TaskScheduler.h>
+
+#include "MeshLoaderTestUtils.h"
+using sofa::meshloader_test::countDifferences;
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+
 namespace sofa
 {
 namespace meshvtkloader_test
@@ -125,6 +133,43 @@ TEST_F(MeshVTKLoaderTest, loadLegacy_binary)
     EXPECT_TRUE(dynamic_cast<Data<helper::vector<defaulttype::Vec3f>>*>(vect2) != nullptr);
 }
 
+TEST_F(MeshVTKLoaderTest, loadLegacy_parallel)
+{
+    // large enough for the ASCII arrays to be converted by several chunks
+    const std::string filename = boost::filesystem::temp_directory_path().string() + "/MeshVTKLoader_test_parallel.vtk";
+    const unsigned nbPoints = 40000;
+    const unsigned nbTetrahedra = nbPoints - 3;
+    {
+        std::ofstream file(filename.c_str());
+        file.precision(10);
+        file << "# vtk DataFile Version 2.0\ngenerated\nASCII\nDATASET UNSTRUCTURED_GRID\n";
+        file << "POINTS " << nbPoints << " float\n";
+        for (unsigned i = 0; i < nbPoints; ++i)
+            file << i * 0.5 << " " << -1.0 * i << " " << 0.125 * i << ((i % 3 == 2) ? "\n" : " ");
+        file << "\nCELLS " << nbTetrahedra << " " << 5 * nbTetrahedra << "\n";
+        for (unsigned i = 0; i < nbTetrahedra; ++i)
+            file << "4 " << i << " " << i + 1 << " " << i + 2 << " " << i + 3 << "\n";
+        file << "CELL_TYPES " << nbTetrahedra << "\n";
+        for (unsigned i = 0; i < nbTetrahedra; ++i)
+            file << "10\n";
+    }
+
+    testLoad(filename, nbPoints, 0, 0, 0, 0, nbTetrahedra, 0);
+    const auto positions = d_positions.getValue();
+    const auto tetrahedra = d_tetrahedra.getValue();
+    EXPECT_EQ(defaulttype::Vector3(0.5 * 12345, -12345., 0.125 * 12345), positions[12345]);
+    for (unsigned k = 0; k < 4; ++k)
+        EXPECT_EQ(777 + k, tetrahedra[777][k]);
+
+    simulation::TaskScheduler::getInstance()->init(4);
+    d_parallel.setValue(true);
+    testLoad(filename, nbPoints, 0, 0, 0, 0, nbTetrahedra, 0);
+    EXPECT_EQ(0u, countDifferences(positions, d_positions.getValue()));
+    EXPECT_EQ(0u, countDifferences(tetrahedra, d_tetrahedra.getValue()));
+
+    boost::filesystem::remove(filename);
+}
+
 TEST_F(MeshVTKLoaderTest, loadInvalidFilenames)
 {
     EXPECT_MSG_EMIT(Error) ;
@@ -1,4 +1,6 @@
 #include <sofa/simulation/InitTasks.h>
+#include <sofa/simulation/InitVisitor.h>
+#include <sofa/simulation/Node.h>
 
 #include <sofa/core/behavior/BaseAnimationLoop.h>
 #include <sofa/core/ExecParams.h>
@@ -6,6 +8,7 @@
 #include <sofa/core/MechanicalParams.h>
 #include <sofa/core/visual/VisualParams.h>
 #include <sofa/helper/AdvancedTimer.h>
+#include <sofa/helper/logging/MessageDispatcher.h>
 
 
 namespace sofa
@@ -54,6 +57,39 @@ namespace sofa
         }
         
         
+        InitSubtreesTask::InitSubtreesTask(CpuTask::Status* status, const core::ExecParams* params)
+        : CpuTask(status)
+        , m_params(params)
+        {
+        }
+
+        InitSubtreesTask::~InitSubtreesTask()
+        {
+        }
+
+        void InitSubtreesTask::addSubtree(Node* node, std::vector<helper::logging::Message>* messages)
+        {
+            m_subtrees.emplace_back(node, messages);
+        }
+
+        Task::MemoryAlloc InitSubtreesTask::run()
+        {
+            using helper::logging::MessageDispatcher;
+
+            for (auto& subtree : m_subtrees)
+            {
+                std::vector<helper::logging::Message>* previousBuffer = MessageDispatcher::setThreadBuffer(subtree.second);
+
+                InitVisitor initVisitor(m_params);
+                initVisitor.setParallel(true);
+                subtree.first->executeVisitor(&initVisitor);
+
+                MessageDispatcher::setThreadBuffer(previousBuffer);
+            }
+            return MemoryAlloc::Stack;
+        }
+
+
         // temp remove this function to use the global one
         void initThreadLocalData()
         {
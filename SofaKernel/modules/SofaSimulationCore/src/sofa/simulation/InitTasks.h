@@ -23,6 +23,9 @@
 #define InitTasks_h__
 
 #include <sofa/simulation/TaskScheduler.h>
+#include <sofa/core/ExecParams.h>
+#include <sofa/helper/logging/Message.h>
+#include <vector>
 
 namespace sofa
 {
@@ -51,6 +54,32 @@ namespace sofa
         };
         
         
+        class Node;
+
+        /// Initialize sibling subtrees one after the other with an InitVisitor.
+        /// The messages emitted during the initialization of each subtree are stored in its own buffer,
+        /// to be dispatched once all the concurrent tasks are done.
+        class SOFA_SIMULATION_CORE_API InitSubtreesTask : public CpuTask
+        {
+
+        public:
+
+            InitSubtreesTask(CpuTask::Status* status, const core::ExecParams* params);
+
+            ~InitSubtreesTask() override;
+
+            /// Add a subtree to initialize, and the buffer receiving its messages
+            void addSubtree(Node* node, std::vector<helper::logging::Message>* messages);
+
+            MemoryAlloc run() override;
+
+        private:
+
+            const core::ExecParams* m_params;
+            std::vector< std::pair<Node*, std::vector<helper::logging::Message>*> > m_subtrees;
+        };
+
+
         // thread storage initialization
         SOFA_SIMULATION_CORE_API void initThreadLocalData();
         
@@ -25,6 +25,13 @@
 #include <sofa/core/BaseMapping.h>
 #include <sofa/core/visual/VisualModel.h>
 #include <sofa/defaulttype/BoundingBox.h>
+#include <sofa/simulation/InitTasks.h>
+#include <sofa/helper/cast.h>
+#include <sofa/helper/logging/MessageDispatcher.h>
+
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
 
 //#include "MechanicalIntegration.h"
 
@@ -34,6 +41,51 @@ namespace sofa
 namespace simulation
 {
 
+namespace
+{
+
+/// Node of a component, or the node itself
+Node* getNode(core::objectmodel::Base* base)
+{
+    if (!base)
+        return nullptr;
+    if (core::objectmodel::BaseNode* node = base->toBaseNode())
+        return down_cast<Node>(node);
+    if (core::objectmodel::BaseObject* object = base->toBaseObject())
+        return dynamic_cast<Node*>(object->getContext());
+    return nullptr;
+}
+
+/// Union-find structure merging the children of a node into groups of dependent subtrees
+struct SubtreeGroups
+{
+    std::vector<std::size_t> m_parent;
+
+    explicit SubtreeGroups(std::size_t nbSubtrees) : m_parent(nbSubtrees)
+    {
+        for (std::size_t i = 0; i < nbSubtrees; ++i)
+            m_parent[i] = i;
+    }
+
+    std::size_t find(std::size_t i)
+    {
+        while (m_parent[i] != i)
+            i = m_parent[i] = m_parent[m_parent[i]];
+        return i;
+    }
+
+    /// The group of the merged subtrees is the one of the first subtree in the graph order
+    void merge(std::size_t i, std::size_t j)
+    {
+        i = find(i);
+        j = find(j);
+        if (i != j)
+            m_parent[std::max(i, j)] = std::min(i, j);
+    }
+};
+
+} // namespace
+
 
 Visitor::Result InitVisitor::processNodeTopDown(simulation::Node* node)
 {
@@ -52,10 +104,178 @@ Visitor::Result InitVisitor::processNodeTopDown(simulation::Node* node)
         nodeBBox->include(node->object[i]->f_bbox.getValue());
     }
     node->f_bbox.endEdit();
+
+    // the children have been visited by the tasks
+    if (m_parallel && initChildrenInParallel(node))
+        return RESULT_PRUNE;
+
     return RESULT_CONTINUE;
 }
 
 
+bool InitVisitor::initChildrenInParallel(simulation::Node* node)
+{
+    const std::size_t nbChildren = node->child.size();
+    if (nbChildren < 2)
+        return false;
+
+    TaskScheduler* scheduler = TaskScheduler::getInstance();
+    if (scheduler->getThreadCount() < 1)
+    {
+        scheduler->init(0);
+        initThreadLocalData();
+    }
+    if (scheduler->getThreadCount() < 2)
+        return false;
+
+    // index of the child whose subtree contains each node
+    std::unordered_map<Node*, std::size_t> subtreeOf;
+    std::vector< std::vector<Node*> > subtreeNodes(nbChildren);
+    SubtreeGroups groups(nbChildren);
+
+    for (std::size_t i = 0; i < nbChildren; ++i)
+    {
+        std::vector<Node*> stack(1, node->child[i].get());
+        while (!stack.empty())
+        {
+            Node* n = stack.back();
+            stack.pop_back();
+
+            auto it = subtreeOf.find(n);
+            if (it != subtreeOf.end())
+            {
+                // node shared by several subtrees
+                groups.merge(i, it->second);
+                continue;
+            }
+            subtreeOf.emplace(n, i);
+            subtreeNodes[i].push_back(n);
+            for (const auto& c : n->child)
+                stack.push_back(c.get());
+        }
+    }
+
+    // Data owned outside of the subtrees (e.g. the outputs of an engine of an ancestor) and read by
+    // the subtrees, with the subtrees whose Data are upstream of them in the data graph
+    std::unordered_map<core::objectmodel::BaseData*, std::vector<std::size_t> > outsideParents;
+    const auto upstreamSubtrees = [&](core::objectmodel::BaseData* data) -> const std::vector<std::size_t>&
+    {
+        auto inserted = outsideParents.emplace(data, std::vector<std::size_t>());
+        std::vector<std::size_t>& subtrees = inserted.first->second;
+        if (!inserted.second)
+            return subtrees;
+
+        std::unordered_set<core::objectmodel::DDGNode*> visited;
+        std::vector<core::objectmodel::DDGNode*> stack(1, data);
+        while (!stack.empty())
+        {
+            core::objectmodel::DDGNode* ddgNode = stack.back();
+            stack.pop_back();
+            if (!visited.insert(ddgNode).second)
+                continue;
+            if (auto* upstreamData = dynamic_cast<core::objectmodel::BaseData*>(ddgNode))
+            {
+                auto it = subtreeOf.find(getNode(upstreamData->getOwner()));
+                if (it != subtreeOf.end())
+                    subtrees.push_back(it->second);
+            }
+            for (core::objectmodel::DDGNode* input : ddgNode->getInputs())
+                stack.push_back(input);
+        }
+        return subtrees;
+    };
+
+    for (std::size_t i = 0; i < nbChildren; ++i)
+    {
+        const auto dependsOn = [&](core::objectmodel::Base* base)
+        {
+            auto it = subtreeOf.find(getNode(base));
+            if (it != subtreeOf.end())
+                groups.merge(i, it->second);
+        };
+        const auto dependsOnDataParents = [&](core::objectmodel::Base* base)
+        {
+            for (core::objectmodel::BaseData* data : base->getDataFields())
+            {
+                core::objectmodel::BaseData* parent = data->getParent();
+                if (!parent)
+                    continue;
+                if (subtreeOf.find(getNode(parent->getOwner())) != subtreeOf.end())
+                {
+                    dependsOn(parent->getOwner());
+                    continue;
+                }
+                // an init in another subtree can make this value dirty: both subtrees are initialized by the
+                // same task, so that the value is not updated concurrently
+                for (std::size_t k : upstreamSubtrees(parent))
+                    groups.merge(i, k);
+            }
+        };
+
+        for (Node* n : subtreeNodes[i])
+        {
+            for (core::objectmodel::BaseNode* parent : n->getParents())
+            {
+                if (parent == node)
+                    continue;
+                // a parent outside of the subtrees is traversed later by the sequential order
+                if (subtreeOf.find(down_cast<Node>(parent)) == subtreeOf.end())
+                    return false;
+                dependsOn(parent);
+            }
+
+            dependsOnDataParents(n);
+            for (const auto& object : n->object)
+            {
+                dependsOnDataParents(object.get());
+                for (core::objectmodel::BaseLink* link : object->getLinks())
+                {
+                    for (std::size_t k = 0; k < link->getSize(); ++k)
+                        dependsOn(link->getLinkedBase(k));
+                }
+            }
+        }
+    }
+
+    // one task per group, initializing its subtrees in the graph order
+    CpuTask::Status status;
+    std::list<InitSubtreesTask> tasks; // referenced by the scheduler, must not be relocated
+    std::vector<InitSubtreesTask*> groupTasks(nbChildren, nullptr);
+    std::vector< std::vector<helper::logging::Message> > messages(nbChildren);
+    for (std::size_t i = 0; i < nbChildren; ++i)
+    {
+        InitSubtreesTask*& task = groupTasks[groups.find(i)];
+        if (!task)
+        {
+            tasks.emplace_back(&status, params);
+            task = &tasks.back();
+        }
+        task->addSubtree(node->child[i].get(), &messages[i]);
+    }
+    if (tasks.size() < 2)
+        return false;
+
+    // The other values read from outside are updated now, so that the tasks find them clean instead
+    // of updating them (and running the engines computing them) concurrently
+    for (const auto& outsideParent : outsideParents)
+    {
+        if (outsideParent.second.empty())
+            outsideParent.first->updateIfDirty();
+    }
+
+    for (InitSubtreesTask& task : tasks)
+        scheduler->addTask(&task);
+    scheduler->workUntilDone(&status);
+
+    for (auto& childMessages : messages)
+    {
+        for (helper::logging::Message& message : childMessages)
+            helper::logging::MessageDispatcher::process(message);
+    }
+    return true;
+}
+
+
 void InitVisitor::processNodeBottomUp(simulation::Node* node)
 {
     // init all the components in reverse order
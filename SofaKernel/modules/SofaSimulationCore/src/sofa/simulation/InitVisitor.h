@@ -38,6 +38,13 @@ namespace simulation
 
     Backward: OdeSolver::bwdInit()
 
+    In parallel mode, the children of each node are split in groups of subtrees which are not connected
+    by Data or Links (nor share a child node), and the groups are initialized concurrently on the task scheduler.
+    The Data of the ancestors read by the subtrees (e.g. outputs of lazily updated engines) are updated before
+    the tasks start, unless they depend on Data of the subtrees: their readers are then in the same group.
+    The subtrees of a group are initialized in the order of the graph, and the messages they emit are
+    dispatched in that order once all the groups are done.
+
     */
 class SOFA_SIMULATION_CORE_API InitVisitor : public Visitor
 {
@@ -45,6 +52,10 @@ class SOFA_SIMULATION_CORE_API InitVisitor : public Visitor
 public:
     InitVisitor(const core::ExecParams* params):Visitor(params),rootNode(nullptr) {}
 
+    /// Initialize the independent subtrees concurrently
+    void setParallel(bool parallel) { m_parallel = parallel; }
+    bool isParallel() const { return m_parallel; }
+
 
     Result processNodeTopDown(simulation::Node* node) override;
     void processNodeBottomUp(simulation::Node* node) override;
@@ -58,7 +69,12 @@ public:
     const char* getClassName() const override { return "InitVisitor"; }
 
 protected:
+    /// Initialize the children of node in concurrent tasks.
+    /// Returns false if they cannot be split in independent groups, and must be visited sequentially.
+    bool initChildrenInParallel(simulation::Node* node);
+
     Node *rootNode;
+    bool m_parallel {false};
 };
 
 } // namespace simulation
@@ -0,0 +1,110 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_SIMULATION_PARALLELFOREACH_H
+#define SOFA_SIMULATION_PARALLELFOREACH_H
+
+#include <sofa/simulation/TaskScheduler.h>
+
+#include <algorithm>
+#include <list>
+
+namespace sofa
+{
+
+namespace simulation
+{
+
+/// Task calling a function on a range of indices
+template<class F>
+class RangeTask : public CpuTask
+{
+public:
+    RangeTask(CpuTask::Status* status, const F& f, std::size_t begin, std::size_t end)
+        : CpuTask(status)
+        , m_f(f)
+        , m_begin(begin)
+        , m_end(end)
+    {}
+
+    ~RangeTask() override {}
+
+    MemoryAlloc run() final
+    {
+        m_f(m_begin, m_end);
+        return MemoryAlloc::Stack;
+    }
+
+private:
+    const F& m_f;
+    std::size_t m_begin;
+    std::size_t m_end;
+};
+
+/** Split [begin, end) in contiguous ranges of at least grainSize indices, one per thread of the scheduler,
+ *  and call f(rangeBegin, rangeEnd) on each of them. The calling thread processes the last range and
+ *  waits for the others to be done.
+ *
+ *  f is called directly on the whole range when there is no scheduler, a single thread or a single range.
+ *  The ranges are disjoint: f can write to the elements of its range without synchronization.
+ */
+template<class F>
+void parallelForEachRange(TaskScheduler* scheduler, std::size_t begin, std::size_t end, const F& f, std::size_t grainSize = 1)
+{
+    if (end <= begin)
+        return;
+
+    const std::size_t size = end - begin;
+    const std::size_t nbThreads = scheduler ? scheduler->getThreadCount() : 1;
+    grainSize = std::max<std::size_t>(grainSize, 1);
+    const std::size_t nbRanges = std::min(nbThreads, (size + grainSize - 1) / grainSize);
+
+    if (nbRanges <= 1)
+    {
+        f(begin, end);
+        return;
+    }
+
+    const std::size_t rangeSize = (size + nbRanges - 1) / nbRanges;
+
+    CpuTask::Status status;
+    // std::list: the tasks are referenced by the scheduler and must not be relocated
+    std::list< RangeTask<F> > tasks;
+    std::size_t rangeBegin = begin;
+    for (std::size_t i = 0; i + 1 < nbRanges && rangeBegin < end; ++i)
+    {
+        const std::size_t rangeEnd = std::min(rangeBegin + rangeSize, end);
+        tasks.emplace_back(&status, f, rangeBegin, rangeEnd);
+        scheduler->addTask(&tasks.back());
+        rangeBegin = rangeEnd;
+    }
+
+    if (rangeBegin < end)
+        f(rangeBegin, end);
+
+    scheduler->workUntilDone(&status);
+}
+
+} // namespace simulation
+
+} // namespace sofa
+
+#endif // SOFA_SIMULATION_PARALLELFOREACH_H
@@ -76,6 +76,7 @@ using namespace sofa::defaulttype;
 using namespace sofa;
 
 Simulation::Simulation()
+    : d_parallelInit(initData(&d_parallelInit, false, "parallelInit", "Initialize the independent subtrees of the scene concurrently on the task scheduler"))
 {
     // Safety check; it could be elsewhere, but here is a good place, I guess.
     if (!sofa::simulation::core::isInitialized())
@@ -205,7 +206,9 @@ void Simulation::initNode( Node* node)
 
     // apply the init() and bwdInit() methods to all the components.
     // and put the VisualModels in a separate graph, rooted at getVisualRoot()
-    node->execute<InitVisitor>(params);
+    InitVisitor initVisitor(params);
+    initVisitor.setParallel(d_parallelInit.getValue());
+    node->execute(initVisitor);
 
     SimulationInitDoneEvent endInit;
     PropagateEventVisitor pe {params, &endInit};
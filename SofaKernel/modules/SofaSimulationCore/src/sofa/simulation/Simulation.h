@@ -43,6 +43,9 @@ public:
     SOFA_CLASS(Simulation, sofa::core::objectmodel::Base);
 
     typedef sofa::core::visual::DisplayFlags DisplayFlags;
+
+    Data<bool> d_parallelInit; ///< Initialize the independent subtrees of the scene concurrently on the task scheduler
+
     Simulation();
     ~Simulation() override;
 	
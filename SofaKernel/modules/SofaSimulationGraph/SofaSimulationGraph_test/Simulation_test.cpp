@@ -36,6 +36,14 @@ typedef sofa::component::container::MechanicalObject<Vec3Types> MechanicalObject
 #include <SofaBaseMechanics/UniformMass.h>
 
 #include <sofa/simulation/DefaultAnimationLoop.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/helper/logging/MessageHandler.h>
+#include <sofa/core/DataEngine.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
 
 namespace sofa {
 using namespace modeling;
@@ -59,7 +67,74 @@ struct ParentObject : public O1
     ParentObject()  { o2 = core::objectmodel::New<O2>(); }
 };
 
+/// Component recording the order of the calls to init(), and emitting a message in init()
+struct InitRecorder : public core::objectmodel::BaseObject
+{
+    SOFA_CLASS(InitRecorder, core::objectmodel::BaseObject);
+
+    Data<int> d_input;
+    Data<int> d_output;
+    int m_initInput {0};
+
+    static std::mutex s_mutex;
+    static std::vector<std::string> s_initOrder;
+
+    InitRecorder()
+        : d_input(initData(&d_input, 0, "input", "input"))
+        , d_output(initData(&d_output, 0, "output", "output"))
+    {}
+
+    void init() override
+    {
+        m_initInput = d_input.getValue();
+        msg_warning() << "init " << getName();
+        std::lock_guard<std::mutex> lock(s_mutex);
+        s_initOrder.push_back(getName());
+    }
+};
+std::mutex InitRecorder::s_mutex;
+std::vector<std::string> InitRecorder::s_initOrder;
+
+/// Engine updated lazily (its init does not update it, as TransformEngine), counting its updates
+struct CountingEngine : public core::DataEngine
+{
+    SOFA_CLASS(CountingEngine, core::DataEngine);
+
+    Data<int> d_input;
+    Data<int> d_output;
+    std::atomic<int> m_nbUpdates {0};
+
+    CountingEngine()
+        : d_input(initData(&d_input, 0, "input", "input"))
+        , d_output(initData(&d_output, 0, "output", "output"))
+    {
+        addInput(&d_input);
+        addOutput(&d_output);
+    }
+
+    void init() override {}
+
+    void doUpdate() override
+    {
+        ++m_nbUpdates;
+        // leave time to a concurrent reader to update the engine too
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        d_output.setValue(d_input.getValue() + 1);
+    }
+};
+
+/// Handler storing the texts of the init messages
+struct InitMessageRecorder : public helper::logging::MessageHandler
+{
+    std::vector<std::string> m_messages;
 
+    void process(helper::logging::Message& m) override
+    {
+        const std::string text = m.messageAsString();
+        if (text.compare(0, 5, "init ") == 0)
+            m_messages.push_back(text);
+    }
+};
 
 
 /** Test the Simulation class
@@ -217,6 +292,113 @@ struct Scene_test: public NumericTest<SReal>
         checkDeletions();
     }
 
+    /// init the independent subtrees concurrently, and check the order of the dependent ones and of the messages
+    void parallelInit()
+    {
+        simulation::TaskScheduler::getInstance()->init(4);
+
+        root = simulation::getSimulation()->createNewGraph("root");
+        std::vector<InitRecorder::SPtr> recorders;
+        for (int i = 0; i < 6; ++i)
+        {
+            simulation::Node::SPtr child = root->createChild("child" + std::to_string(i));
+            recorders.push_back(core::objectmodel::New<InitRecorder>());
+            recorders.back()->setName("recorder" + std::to_string(i));
+            child->addObject(recorders.back());
+            if (i == 2)
+            {
+                for (int j = 0; j < 3; ++j)
+                {
+                    InitRecorder::SPtr recorder = core::objectmodel::New<InitRecorder>();
+                    recorder->setName("recorder2_" + std::to_string(j));
+                    child->createChild("subchild" + std::to_string(j))->addObject(recorder);
+                }
+            }
+        }
+        // child1 and child4 are in the same group
+        recorders[1]->d_input.setParent(&recorders[4]->d_output);
+
+        InitMessageRecorder messageRecorder;
+        helper::logging::MessageDispatcher::addHandler(&messageRecorder);
+        InitRecorder::s_initOrder.clear();
+
+        simulation->d_parallelInit.setValue(true);
+        simulation->init(root.get());
+        simulation->d_parallelInit.setValue(false);
+
+        helper::logging::MessageDispatcher::rmHandler(&messageRecorder);
+
+        const std::vector<std::string> expectedOrder = {
+            "recorder0", "recorder1", "recorder2", "recorder2_0", "recorder2_1", "recorder2_2", "recorder3", "recorder4", "recorder5" };
+
+        // all the components are initialized once, child4 after child1
+        std::vector<std::string> initOrder = InitRecorder::s_initOrder;
+        ASSERT_EQ(expectedOrder.size(), initOrder.size());
+        const auto position = [&](const std::string& name) { return std::find(initOrder.begin(), initOrder.end(), name) - initOrder.begin(); };
+        EXPECT_LT(position("recorder1"), position("recorder4"));
+        EXPECT_LT(position("recorder2"), position("recorder2_0"));
+        std::sort(initOrder.begin(), initOrder.end());
+        EXPECT_EQ(expectedOrder, initOrder);
+
+        // the messages are dispatched in the order of the graph
+        ASSERT_EQ(expectedOrder.size(), messageRecorder.m_messages.size());
+        for (std::size_t i = 0; i < expectedOrder.size(); ++i)
+            EXPECT_EQ("init " + expectedOrder[i], messageRecorder.m_messages[i]);
+
+        simulation->unload(root);
+    }
+
+    /// init children reading the outputs of engines of the root
+    void parallelInitWithRootEngine()
+    {
+        simulation::TaskScheduler::getInstance()->init(4);
+
+        root = simulation::getSimulation()->createNewGraph("root");
+        CountingEngine::SPtr engine = core::objectmodel::New<CountingEngine>();
+        root->addObject(engine);
+        CountingEngine::SPtr dependentEngine = core::objectmodel::New<CountingEngine>();
+        root->addObject(dependentEngine);
+
+        std::vector<InitRecorder::SPtr> recorders;
+        for (int i = 0; i < 4; ++i)
+        {
+            recorders.push_back(core::objectmodel::New<InitRecorder>());
+            recorders.back()->setName("recorder" + std::to_string(i));
+            root->createChild("child" + std::to_string(i))->addObject(recorders.back());
+        }
+
+        // child0 and child1 read the dirty output of the engine
+        engine->d_input.setValue(1);
+        recorders[0]->d_input.setParent(&engine->d_output);
+        recorders[1]->d_input.setParent(&engine->d_output);
+
+        // child3 reads an output depending on child2, through the second engine
+        recorders[2]->d_output.setValue(10);
+        dependentEngine->d_input.setParent(&recorders[2]->d_output);
+        recorders[3]->d_input.setParent(&dependentEngine->d_output);
+
+        InitRecorder::s_initOrder.clear();
+
+        simulation->d_parallelInit.setValue(true);
+        simulation->init(root.get());
+        simulation->d_parallelInit.setValue(false);
+
+        // the engine is updated once, before the tasks start
+        EXPECT_EQ(1, engine->m_nbUpdates);
+        EXPECT_EQ(2, recorders[0]->m_initInput);
+        EXPECT_EQ(2, recorders[1]->m_initInput);
+
+        // child2 and child3 are in the same group
+        EXPECT_EQ(1, dependentEngine->m_nbUpdates);
+        EXPECT_EQ(11, recorders[3]->m_initInput);
+        const std::vector<std::string>& initOrder = InitRecorder::s_initOrder;
+        ASSERT_EQ(4u, initOrder.size());
+        const auto position = [&](const std::string& name) { return std::find(initOrder.begin(), initOrder.end(), name) - initOrder.begin(); };
+        EXPECT_LT(position("recorder2"), position("recorder3"));
+
+        simulation->unload(root);
+    }
+
 protected:
     void createScene()
     {
@@ -286,6 +468,16 @@ TEST_F( Scene_test,sceneDestruction_createnewgraph) {
     this->sceneDestruction_createnewgraph();
 }
 
+TEST_F( Scene_test,parallelInit) {
+    EXPECT_MSG_NOEMIT(Error) ;
+    this->parallelInit();
+}
+
+TEST_F( Scene_test,parallelInitWithRootEngine) {
+    EXPECT_MSG_NOEMIT(Error) ;
+    this->parallelInitWithRootEngine();
+}
+
 }// namespace sofa
 
 
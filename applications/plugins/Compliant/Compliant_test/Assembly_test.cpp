@@ -1173,6 +1173,38 @@ TEST_F( Assembly_test, testDecomposedString )
     testDecomposedString();
 }
 
+TEST_F( Assembly_test, testCachedAssembly )
+{
+    ::testing::Message() << "Assembly_test: assembly products kept between time steps";
+    testRigidConnectedToString(3);
+    simulation::Node* root = down_cast<simulation::Node>( complianceSolver->getContext() );
+
+    core::MechanicalParams mparams = *core::MechanicalParams::defaultInstance();
+    mparams.setMFactor( 1 );
+    mparams.setKFactor( 1 );
+
+    simulation::AssemblyCache cache;
+    for( unsigned step=0; step<3; ++step )
+    {
+        const SparseMatrix expectedH = getAssembledImplicitMatrix( root, &mparams );
+
+        for( unsigned pass=0; pass<2; ++pass )
+        {
+            simulation::AssemblyVisitor assemblyVisitor(&mparams);
+            assemblyVisitor.setCache( &cache );
+            root->executeVisitor( &assemblyVisitor );
+            component::linearsolver::AssembledSystem sys;
+            assemblyVisitor.assemble(sys);
+
+            // unchanged patterns: only values are recomputed
+            if( pass>0 ) ASSERT_TRUE( cache.H.pattern_reused() );
+            ASSERT_TRUE(matricesAreEqual( expectedH, sys.H ));
+        }
+
+        sofa::simulation::getSimulation()->animate(root,1.0);
+    }
+}
+
 } // sofa
 
 
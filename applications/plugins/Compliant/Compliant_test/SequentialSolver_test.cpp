@@ -0,0 +1,112 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include "Compliant_test.h"
+#include "../numericalsolver/SequentialSolver.h"
+#include "../assembly/AssemblyVisitor.h"
+
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/simulation/InitTasks.h>
+
+using namespace sofa::modeling;
+using namespace sofa::component;
+using namespace sofa::simulation;
+
+namespace sofa
+{
+
+/// The blocks relaxed concurrently (parallel option) must give the same lambdas as the
+/// sequential relaxation.
+struct SequentialSolver_test : public CompliantSolver_test
+{
+    typedef linearsolver::AssembledSystem::vec vec;
+
+    /// enough strings for the blocks of a color to be split in several ranges of the parallel
+    /// loop (grain size 16), and an odd number so that a range boundary falls inside a string
+    /// if coupled blocks ever end up in the same color
+    static constexpr unsigned nbStrings = 65;
+
+    /// Relax the compliant springs of independent particle strings and return the lambdas
+    void solveStrings(bool parallel, vec& lambda)
+    {
+        Node::SPtr root = clearScene();
+        root->setGravity( Vec3(0,-10,0) );
+        root->setDt(0.1);
+
+        linearsolver::LDLTResponse::SPtr response = addNew<linearsolver::LDLTResponse>(root);
+        (void) response;
+        linearsolver::SequentialSolver::SPtr solver = addNew<linearsolver::SequentialSolver>(root);
+        solver->d_parallel.setValue(parallel);
+        solver->iterations.setValue(20);
+        solver->precision.setValue(0);
+
+        // the springs of a string share particles, the strings are independent: each color holds one block per string
+        for( unsigned i=0; i<nbStrings; ++i )
+        {
+            ParticleString string( root, Vec3(0,i,0), Vec3(2,i+0.5,0), 12, 12 );
+            string.compliance->isCompliance.setValue(true);
+            string.compliance->compliance.setValue(1.0e-3);
+        }
+
+        sofa::simulation::getSimulation()->init(root.get());
+
+        // the compliance is scaled by 1/dt^2 in the assembled system
+        core::MechanicalParams mparams;
+        mparams.setDt( root->getDt() );
+        mparams.setMFactor( 1 );
+        mparams.setKFactor( 1 );
+        AssemblyVisitor assemblyVisitor(&mparams);
+        root->executeVisitor( &assemblyVisitor );
+        linearsolver::AssembledSystem sys;
+        assemblyVisitor.assemble(sys);
+        ASSERT_EQ( nbStrings*11u, sys.n );
+
+        vec rhs( sys.size() );
+        for( unsigned i=0; i<sys.size(); ++i ) rhs(i) = std::sin( SReal(i+1) );
+
+        solver->factor(sys);
+        vec x = vec::Zero( sys.size() );
+        solver->solve(x, sys, rhs);
+        lambda = x.tail(sys.n);
+    }
+};
+
+TEST_F(SequentialSolver_test, parallelRelaxationMatchesSequential)
+{
+    TaskScheduler* taskScheduler = TaskScheduler::getInstance();
+    if( taskScheduler->getThreadCount() < 2 )
+    {
+        taskScheduler->init(4);
+        initThreadLocalData();
+    }
+
+    vec sequential, parallel;
+    solveStrings(false, sequential);
+    solveStrings(true, parallel);
+
+    ASSERT_EQ( sequential.size(), parallel.size() );
+    ASSERT_LT( 0, sequential.lpNorm<Eigen::Infinity>() );
+    // same relaxation order for the coupled blocks: the lambdas are identical
+    for( unsigned i=0; i<sequential.size(); ++i )
+        EXPECT_EQ( sequential(i), parallel(i) ) << "lambda " << i;
+}
+
+} // sofa
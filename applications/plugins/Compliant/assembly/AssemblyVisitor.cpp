@@ -26,7 +26,8 @@ AssemblyVisitor::AssemblyVisitor(const core::MechanicalParams* mparams)
 	: base( mparams ),
       mparams( mparams ),
 	  start_node(nullptr),
-	  _processed(nullptr)
+	  _processed(nullptr),
+	  cache(nullptr)
 {
     mparamsWithoutStiffness = *mparams;
     mparamsWithoutStiffness.setKFactor(0);
@@ -39,6 +40,29 @@ AssemblyVisitor::~AssemblyVisitor()
 }
 
 
+AssemblyCache::products_type& AssemblyCache::get(const dofs_type* dofs) {
+    products_type& res = products[dofs];
+    res.used = true;
+    return res;
+}
+
+void AssemblyCache::prune() {
+    for(products_map_type::iterator it = products.begin(); it != products.end(); ) {
+        if( it->second.used ) {
+            it->second.used = false;
+            ++it;
+        } else {
+            it = products.erase(it);
+        }
+    }
+}
+
+void AssemblyCache::clear() {
+    products.clear();
+    H = sparse::cached_sum<rmat>();
+}
+
+
 AssemblyVisitor::chunk::chunk()
 	: offset(0),
 	  size(0),
@@ -511,7 +535,7 @@ AssemblyVisitor::process_type* AssemblyVisitor::process() const {
 	size_c = off_c;
 
     // prefix mapping concatenation and stuff
-    std::for_each(prefix.begin(), prefix.end(), process_helper(*res, graph) ); 	// TODO merge with offsets computation ?
+    std::for_each(prefix.begin(), prefix.end(), process_helper(*res, graph, cache) ); 	// TODO merge with offsets computation ?
 
 
     // special treatment for interaction forcefields
@@ -559,17 +583,6 @@ inline const AssemblyVisitor::rmat& AssemblyVisitor::ltdl(const rmat& l, const r
 }
 
 
-inline void AssemblyVisitor::add_ltdl(rmat& res, const rmat& l, const rmat& d)  const
-{
-    scoped::timer advancedTimer("assembly: ltdl");
-
-    sparse::fast_prod(tmp1, d, l);
-    tmp3 = l.transpose();
-    sparse::fast_add_prod(res, tmp3, tmp1);
-}
-
-
-
 enum {
     METHOD_DEFAULT,
     METHOD_TRIPLETS,            // triplets seems fastest (for me) but
@@ -695,6 +708,11 @@ void AssemblyVisitor::assemble(system_type& res) const {
 
 	// assert( !_processed );
 
+    // without cache, products are still computed through a temporary
+    // one (their symbolic structure is simply not reused)
+    AssemblyCache localCache;
+    AssemblyCache* const products = cache ? cache : &localCache;
+
 	// concatenate mappings and obtain sizes
     _processed = process();
 
@@ -705,6 +723,22 @@ void AssemblyVisitor::assemble(system_type& res) const {
     res.isPIdentity = isPIdentity;
 
 
+    // J^T H J products, independent from each other, computed in
+    // parallel once all the local matrices are known
+    struct ltdl_task {
+        sparse::cached_ltdl<rmat>* ltdl;
+        const rmat* J;
+        const rmat* H;
+        const rmat* result;
+    };
+    std::vector<ltdl_task> tasks;
+
+    // tasks for geometric stiffness of multimappings, in summation order
+    std::vector<unsigned> geometric_stiffness_tasks;
+
+    // task for the local matrix of each mapped dof (by prefix index)
+    std::vector<int> local_tasks(prefix.size(), -1);
+
 
     // Geometric Stiffness must be processed first, from mapped dofs to master dofs
     // warning, inverse order is important, to treat mapped dofs before master dofs
@@ -724,43 +758,63 @@ void AssemblyVisitor::assemble(system_type& res) const {
 
         if( boost::out_degree(prefix[i],graph) == 1 ) // simple mapping
         {
-//            std::cerr<<"simple mapping "<<c.dofs->getName()<<std::endl;
             // add the geometric stiffness to its only parent that will map it to the master level
             graph_type::out_edge_iterator parentIterator = boost::out_edges(prefix[i],graph).first;
             chunk* p = graph[ boost::target(*parentIterator, graph) ].data;
             add(p->H, mparams->kFactor() * *Ktilde ); // todo how to include rayleigh damping for geometric stiffness?
-
-//            std::cerr<<"Assembly: "<<c.Ktilde<<std::endl;
         }
         else // multimapping
         {
             // directly add the geometric stiffness to the assembled level
             // by mapping with the specific jacobian from master to the (current-1) level
-
-
-//            std::cerr<<"multimapping "<<c.dofs->getName()<<std::endl;
+            AssemblyCache::products_type& p = products->get(c.dofs);
+            p.scaled_geometric_stiffness = mparams->kFactor() * *Ktilde;
 
             // full mapping chunk for geometric stiffness
-            const rmat& geometricStiffnessJc = _processed->fullmappinggeometricstiffness[ c.dofs ];
+            const ltdl_task task = { &p.geometric_stiffness, &_processed->fullmappinggeometricstiffness[ c.dofs ], &p.scaled_geometric_stiffness, nullptr };
+            geometric_stiffness_tasks.push_back( tasks.size() );
+            tasks.push_back( task );
+        }
+
+    }
 
+    for( unsigned i = 0, n = prefix.size() ; i < n ; ++i ) {
+        const chunk& c = *graph[ prefix[i] ].data;
+        if( !c.mechanical || c.master() || zero(c.H) ) continue;
 
+        const rmat& Jc = _processed->fullmapping[ c.dofs ];
+        if( zero(Jc) ) continue;
 
-            //std::cerr<<geometricStiffnessJc<<std::endl;
-//            std::cerr<<*Ktilde<<std::endl;
-//            std::cerr<<Ktilde->nonZeros()<<std::endl;
+        assert( Jc.cols() == int(_processed->size_m) );
 
-//            std::cerr<<res.H.rows()<<" "<<geometricStiffnessJc.rows()<<std::endl;
+        const ltdl_task task = { &products->get(c.dofs).local, &Jc, &c.H, nullptr };
+        local_tasks[i] = tasks.size();
+        tasks.push_back( task );
+    }
 
-            add_ltdl(res.H, geometricStiffnessJc, mparams->kFactor() * *Ktilde);
+    {
+        scoped::timer step("assembly: ltdl");
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for( int i = 0 ; i < (int)tasks.size() ; ++i ) {
+            ltdl_task& task = tasks[i];
+            task.result = &(*task.ltdl)( *task.J, *task.H );
         }
+    }
 
+    const unsigned size_m = _processed->size_m;
+    products->H.begin( size_m, size_m );
+
+    for( unsigned i = 0, n = geometric_stiffness_tasks.size() ; i < n ; ++i ) {
+        products->H.add( *tasks[ geometric_stiffness_tasks[i] ].result, 0 );
     }
 
 
     // Then add interaction forcefields
     for( InteractionForceFieldList::iterator it=interactionForceFieldList.begin(),itend=interactionForceFieldList.end();it!=itend;++it)
     {
-        add_ltdl(res.H, it->J, it->H);
+        products->H.add( ltdl(it->J, it->H), 0 );
     }
 
 
@@ -772,7 +826,7 @@ void AssemblyVisitor::assemble(system_type& res) const {
 
     typedef add_shifted<> add_type;
 
-    add_type add_H(res.H), add_P(res.P), add_C(res.C);
+    add_type add_P(res.P), add_C(res.C);
 
     const SReal c_factor = 1.0 /
         ( res.dt * res.dt * mparams->implicitVelocity() * mparams->implicitPosition() );
@@ -790,7 +844,7 @@ void AssemblyVisitor::assemble(system_type& res) const {
         if( c.master() ) {
             res.master.push_back( c.dofs );
 
-            if( !zero(c.H) ) add_H(c.H, off_m);
+            if( !zero(c.H) ) products->H.add(c.H, off_m);
             if( !zero(c.P) ) add_P(c.P, off_m);
             
             off_m += c.size;
@@ -802,12 +856,8 @@ void AssemblyVisitor::assemble(system_type& res) const {
             // full mapping chunk
             const rmat& Jc = _processed->fullmapping[ c.dofs ];
 
-			if( !zero(Jc) ) {
-                assert( Jc.cols() == int(_processed->size_m) );
-
-                // actual response matrix mapping
-                if( !zero(c.H) ) add_H(ltdl(Jc, c.H), 0);
-            }
+            // actual response matrix mapping
+            if( local_tasks[i] >= 0 ) products->H.add( *tasks[ local_tasks[i] ].result, 0 );
 
 
 			// compliant dofs: fill compliance/phi/lambda
@@ -856,6 +906,9 @@ void AssemblyVisitor::assemble(system_type& res) const {
     assert( off_m == _processed->size_m );
     assert( off_c == _processed->size_c );
 
+    res.H = products->H.end();
+
+    products->prune();
 }
 
 // TODO redo
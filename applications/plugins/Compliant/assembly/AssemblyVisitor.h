@@ -8,6 +8,7 @@
 
 #include "../utils/graph.h"
 #include "../utils/find.h"
+#include "../utils/sparse.h"
 
 #include "AssembledSystem.h"
 #include "AssemblyHelper.h"
@@ -27,6 +28,53 @@ namespace simulation {
 // chunks/global, in case the scene really has a large number of
 // mstates
 
+
+// sparse products of the assembly kept from one time step to the
+// next. a new visitor is sent at each step, so the cache is owned by
+// the solver (see AssemblyVisitor::setCache).
+//
+// as long as the patterns of the mapping jacobians and of the local
+// matrices do not change, the symbolic structure of the mapping
+// concatenations, of the J^T H J products and of the global H matrix
+// is reused and only values are recomputed. patterns are compared at
+// each step, so the cache never needs to be invalidated.
+struct SOFA_Compliant_API AssemblyCache {
+
+    typedef Eigen::SparseMatrix<SReal, Eigen::RowMajor> rmat;
+    typedef core::behavior::BaseMechanicalState dofs_type;
+
+    struct products_type {
+        products_type() : used(false) { }
+
+        // mapping jacobian times the full mapping of each parent
+        std::map<const dofs_type*, sparse::cached_prod<rmat> > mapping;
+
+        // J^T H J with J the full mapping and H the local matrix
+        sparse::cached_ltdl<rmat> local;
+
+        // same for the geometric stiffness of multimappings
+        sparse::cached_ltdl<rmat> geometric_stiffness;
+        rmat scaled_geometric_stiffness;
+
+        bool used;
+    };
+
+    typedef std::map<const dofs_type*, products_type> products_map_type;
+    products_map_type products;
+
+    // global H matrix
+    sparse::cached_sum<rmat> H;
+
+    // products for a dof, marked as used by the current assembly
+    products_type& get(const dofs_type* dofs);
+
+    // forget the products of the dofs that were not part of the
+    // current assembly
+    void prune();
+
+    void clear();
+};
+
 class SOFA_Compliant_API AssemblyVisitor : public simulation::MechanicalVisitor {
 protected:
     typedef simulation::MechanicalVisitor base;
@@ -178,6 +226,11 @@ public:
 
 	// builds global mapping / full stiffness matrices + sizes
     virtual process_type* process() const;
+
+    // products kept between assemblies, or nullptr
+    AssemblyCache* cache;
+
+    void setCache(AssemblyCache* c) { cache = c; }
 			
 	// helper functors
 	struct process_helper;
@@ -235,7 +288,6 @@ private:
 
     // this is meant to optimize L^T D L products
     const rmat& ltdl(const rmat& l, const rmat& d) const;
-    void add_ltdl(rmat& res, const rmat& l, const rmat& d) const;
 
 };
 
@@ -253,9 +305,10 @@ struct AssemblyVisitor::process_helper {
 
     process_type& res;
     const graph_type& g;
+    AssemblyCache* cache;
 
-    process_helper(process_type& res, const graph_type& g)
-        : res(res), g(g)  {
+    process_helper(process_type& res, const graph_type& g, AssemblyCache* cache = nullptr)
+        : res(res), g(g), cache(cache)  {
 
     }
 
@@ -319,7 +372,11 @@ struct AssemblyVisitor::process_helper {
                     // scoped::timer step("mapping matrix product");
 
                     // TODO optimize this, it is the most costly part
-                    add_prod(Jc, *jc, Jp ); // full mapping
+                    if( cache ) {
+                        add(Jc, cache->get(curr).mapping[pdofs](*jc, Jp)); // full mapping
+                    } else {
+                        add_prod(Jc, *jc, Jp ); // full mapping
+                    }
 
                     if( geometricStiffnessJc )
                     {
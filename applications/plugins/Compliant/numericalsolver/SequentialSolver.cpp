@@ -1,6 +1,8 @@
 #include "SequentialSolver.h"
 
 #include <sofa/core/ObjectFactory.h>
+#include <sofa/simulation/ParallelForEach.h>
+#include <sofa/simulation/InitTasks.h>
 
 #include "EigenSparseResponse.h"
 #include "SubKKT.inl"
@@ -17,6 +19,8 @@ namespace linearsolver {
 
 BaseSequentialSolver::BaseSequentialSolver()
 	: omega(initData(&omega, (SReal)1.0, "omega", "SOR parameter:  omega < 1 : better, slower convergence, omega = 1 : vanilla gauss-seidel, 2 > omega > 1 : faster convergence, ok for SPD systems, omega > 2 : will probably explode" ))
+    , d_parallel(initData(&d_parallel, false, "parallel", "Relax the constraint blocks not coupled through the Schur complement concurrently with the task scheduler (same result as the sequential relaxation)"))
+    , m_taskScheduler(nullptr)
 {}
 
 
@@ -87,6 +91,8 @@ void BaseSequentialSolver::factor_impl(const system_type& system) {
     SubKKT::projected_primal(sub, system);
 
     sub.factor(*response);
+
+    colors.clear();
 	
 	// compute block responses
 	const unsigned n = blocks.size();
@@ -139,6 +145,50 @@ void BaseSequentialSolver::factor_impl(const system_type& system) {
         factor_block( blocks_inv[i], schur );
     }
 
+    if( d_parallel.getValue() ) color_blocks( system );
+}
+
+
+void BaseSequentialSolver::color_blocks(const system_type& system) {
+
+    // first color each dof can still receive: a block gets a color after
+    // the colors of all the blocks sharing one of its dofs, so that
+    // coupled blocks are relaxed in their original order
+    std::vector<unsigned> next;
+    next.assign( JP.cols(), 0 );
+
+    // same for the lambdas, coupled through the compliance
+    std::vector<unsigned> next_lambda;
+    next_lambda.assign( system.C.cols(), 0 );
+
+    std::vector<unsigned> footprint, footprint_lambda;
+
+    for(unsigned i = 0, n = blocks.size(); i < n; ++i) {
+        const block& b = blocks[i];
+
+        // dofs read (JP rows) and written (mapping_response columns) by the block
+        footprint.clear();
+        // lambdas written (the block) and read (C rows) by the block
+        footprint_lambda.clear();
+        for( unsigned r = b.offset, re = b.offset + b.size; r < re; ++r) {
+            for(rmat::InnerIterator it(JP, r); it; ++it) footprint.push_back( it.col() );
+            for(cmat::InnerIterator it(mapping_response, r); it; ++it) footprint.push_back( it.row() );
+            footprint_lambda.push_back( r );
+            for(rmat::InnerIterator it(system.C, r); it; ++it) footprint_lambda.push_back( it.col() );
+        }
+
+        unsigned color = 0;
+        for( unsigned dof : footprint ) color = std::max( color, next[dof] );
+        for( unsigned l : footprint_lambda ) color = std::max( color, next_lambda[l] );
+        for( unsigned dof : footprint ) next[dof] = color + 1;
+        for( unsigned l : footprint_lambda ) next_lambda[l] = color + 1;
+
+        if( color >= colors.size() ) colors.resize( color + 1 );
+        colors[color].push_back( i );
+    }
+
+    if( this->f_printLog.getValue() )
+        sout << "blocks: " << blocks.size() << ", colors: " << colors.size() << sendl;
 }
 
 // TODO make sure this does not cause any alloc
@@ -172,6 +222,79 @@ void BaseSequentialSolver::init() {
                   << " added to the scene" << sendl;
 	}
 
+    if( d_parallel.getValue() ) {
+        m_taskScheduler = simulation::TaskScheduler::getInstance();
+        if( m_taskScheduler->getThreadCount() < 1 ) {
+            m_taskScheduler->init(0);
+            simulation::initThreadLocalData();
+        }
+    }
+
+}
+
+
+// relaxes a single block
+SReal BaseSequentialSolver::relax_block(unsigned i,
+                                        vec& lambda,
+                                        vec& net,
+                                        const system_type& sys,
+                                        const vec& rhs,
+                                        vec& error, vec& delta,
+                                        bool correct,
+                                        real omega) const {
+
+    const block& b = blocks[i];
+
+    // data chunks
+    chunk_type lambda_chunk(&lambda(b.offset), b.size);
+    chunk_type delta_chunk(&delta(b.offset), b.size);
+
+    // if the constraint is activated, solve it
+    if( b.activated )
+    {
+        chunk_type error_chunk(&error(b.offset), b.size);
+
+        // update rhs TODO track and remove possible allocs
+        error_chunk.noalias() = rhs.segment(b.offset, b.size);
+        error_chunk.noalias() -= JP.middleRows(b.offset, b.size) * net;
+        error_chunk.noalias() -= sys.C.middleRows(b.offset, b.size) * lambda;
+
+        // error estimate update, we sum current chunk errors
+        // estimate += error_chunk.squaredNorm();
+
+        // solve for lambda changes
+        solve_block(delta_chunk, blocks_inv[i], error_chunk);
+
+        // backup old lambdas
+        error_chunk = lambda_chunk;
+
+        // update lambdas
+        lambda_chunk = lambda_chunk + omega * delta_chunk;
+
+        // project new lambdas if needed
+        if( b.projector ) {
+            b.projector->project( lambda_chunk.data(), lambda_chunk.size(), i, correct );
+            assert( !has_nan(lambda_chunk.eval()) );
+        }
+
+        // correct lambda differences based on projection
+        delta_chunk = lambda_chunk - error_chunk;
+    }
+    else // deactivated constraint
+    {
+        // force lambda to be 0
+        delta_chunk = -lambda_chunk;
+        lambda_chunk.setZero();
+    }
+
+    // incrementally update net forces, we only do fresh
+    // computation after the loop to keep perfs decent
+    net.noalias() += mapping_response.middleCols(b.offset, b.size) * delta_chunk;
+    // net.noalias() = mapping_response * lambda;
+
+    // fix net to avoid error accumulations ?
+
+    return delta_chunk.squaredNorm();
 }
 
 
@@ -191,65 +314,31 @@ SReal BaseSequentialSolver::step(vec& lambda,
 	real estimate = 0;
 
     SReal omega = this->omega.getValue();
-		
-	// inner loop
-	for(unsigned i = 0, n = blocks.size(); i < n; ++i) {
-			
-		const block& b = blocks[i];
-			 
-        // data chunks
-        chunk_type lambda_chunk(&lambda(b.offset), b.size);
-        chunk_type delta_chunk(&delta(b.offset), b.size);
-
-        // if the constraint is activated, solve it
-        if( b.activated )
-        {
-            chunk_type error_chunk(&error(b.offset), b.size);
 
-            // update rhs TODO track and remove possible allocs
-            error_chunk.noalias() = rhs.segment(b.offset, b.size);
-            error_chunk.noalias() -= JP.middleRows(b.offset, b.size) * net;
-            error_chunk.noalias() -= sys.C.middleRows(b.offset, b.size) * lambda;
+    // we estimate the total lambda change. since GS convergence
+    // is linear, this can give an idea about current precision.
+    if( !colors.empty() && colors.size() < blocks.size() ) {
 
-            // error estimate update, we sum current chunk errors
-            // estimate += error_chunk.squaredNorm();
+        block_estimates.resize( blocks.size() );
 
-            // solve for lambda changes
-            solve_block(delta_chunk, blocks_inv[i], error_chunk);
-
-            // backup old lambdas
-            error_chunk = lambda_chunk;
-
-            // update lambdas
-            lambda_chunk = lambda_chunk + omega * delta_chunk;
-
-            // project new lambdas if needed
-            if( b.projector ) {
-                b.projector->project( lambda_chunk.data(), lambda_chunk.size(), i, correct );
-                assert( !has_nan(lambda_chunk.eval()) );
-            }
-
-            // correct lambda differences based on projection
-            delta_chunk = lambda_chunk - error_chunk;
-        }
-        else // deactivated constraint
-        {
-            // force lambda to be 0
-            delta_chunk = -lambda_chunk;
-            lambda_chunk.setZero();
+        // colors in order, blocks of a color concurrently
+        for(const std::vector<unsigned>& color : colors) {
+            simulation::parallelForEachRange(m_taskScheduler, 0, color.size(), [&](std::size_t begin, std::size_t end) {
+                for(std::size_t k = begin; k < end; ++k) {
+                    const unsigned i = color[k];
+                    block_estimates[i] = relax_block( i, lambda, net, sys, rhs, error, delta, correct, omega );
+                }
+            }, 16);
         }
 
-		// we estimate the total lambda change. since GS convergence
-		// is linear, this can give an idea about current precision.
-		estimate += delta_chunk.squaredNorm();
-
-		// incrementally update net forces, we only do fresh
-		// computation after the loop to keep perfs decent
-        net.noalias() += mapping_response.middleCols(b.offset, b.size) * delta_chunk;
-		// net.noalias() = mapping_response * lambda;
-
-        // fix net to avoid error accumulations ?
-	}
+        for( real e : block_estimates ) estimate += e;
+    }
+    else {
+        // inner loop
+        for(unsigned i = 0, n = blocks.size(); i < n; ++i) {
+            estimate += relax_block( i, lambda, net, sys, rhs, error, delta, correct, omega );
+        }
+    }
 
 	// std::cerr << "sanity check: " << (net - mapping_response * lambda).norm() << std::endl;
 
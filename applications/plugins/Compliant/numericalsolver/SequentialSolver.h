@@ -14,6 +14,9 @@
 #include <Eigen/Cholesky>
 
 namespace sofa {
+namespace simulation {
+class TaskScheduler;
+}
 namespace component {
 namespace linearsolver {
 
@@ -39,6 +42,7 @@ class SOFA_Compliant_API BaseSequentialSolver : public IterativeSolver {
 	void init() override;
 
     Data<SReal> omega; ///< SOR parameter:  omega < 1 : better, slower convergence, omega = 1 : vanilla gauss-seidel, 2 > omega > 1 : faster convergence, ok for SPD systems, omega > 2 : will probably explode
+    Data<bool> d_parallel; ///< Relax the constraint blocks not coupled through the Schur complement concurrently with the task scheduler
 
   protected:
 
@@ -59,6 +63,16 @@ class SOFA_Compliant_API BaseSequentialSolver : public IterativeSolver {
 	           vec& tmp1, vec& tmp2,
 			   bool correct = false,
                real damping = 0) const;
+
+    // relaxes block i, returns the squared norm of its lambda change
+    SReal relax_block(unsigned i,
+                      vec& lambda,
+                      vec& net,
+                      const system_type& sys,
+                      const vec& rhs,
+                      vec& error, vec& delta,
+                      bool correct,
+                      real omega) const;
 	
 	// response matrix
 	typedef Response response_type;
@@ -98,6 +112,21 @@ class SOFA_Compliant_API BaseSequentialSolver : public IterativeSolver {
 	typedef Eigen::Map< vec > chunk_type;
     void solve_block(chunk_type result, const inverse_type& inv, chunk_type rhs) const;
 
+    // blocks colors: the blocks of a color share no primal dof through
+    // the Schur complement pattern (rows of JP, columns of
+    // mapping_response) nor lambda through the compliance (columns of C),
+    // and can be relaxed concurrently. Coupled blocks keep their relative
+    // order, so the result is the same as the sequential relaxation.
+    typedef std::vector< std::vector<unsigned> > colors_type;
+    colors_type colors;
+
+    void color_blocks(const system_type& system);
+
+    // per-block lambda change estimates, summed in block order
+    mutable std::vector<real> block_estimates;
+
+    simulation::TaskScheduler* m_taskScheduler;
+
 
 
 };
@@ -63,6 +63,7 @@ using namespace core::behavior;
     {
         storeDSol = false;
         assemblyVisitor = NULL;
+        assemblyCache = new simulation::AssemblyCache();
 
         helper::OptionsGroup stabilizationOptions;
         stabilizationOptions.setNbItems( NB_STABILIZATION );
@@ -140,6 +141,7 @@ using namespace core::behavior;
 
     CompliantImplicitSolver::~CompliantImplicitSolver() {
         if( assemblyVisitor ) delete assemblyVisitor;
+        delete assemblyCache;
     }
 
     void CompliantImplicitSolver::reset() {
@@ -505,6 +507,7 @@ using namespace core::behavior;
         // max: il ya des smart ptr pour ca.
         if( assemblyVisitor ) delete assemblyVisitor;
         assemblyVisitor = new simulation::AssemblyVisitor(mparams);
+        assemblyVisitor->setCache( assemblyCache );
 
         // fetch nodes/data
         {
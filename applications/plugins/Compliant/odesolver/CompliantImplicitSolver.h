@@ -21,6 +21,7 @@ namespace sofa {
 
 namespace simulation {
 class AssemblyVisitor;
+struct AssemblyCache;
 
 namespace common {
 class MechanicalOperations;
@@ -192,6 +193,9 @@ class SOFA_Compliant_API CompliantImplicitSolver : public sofa::core::behavior::
     // keep a pointer on the visitor used to assemble
     simulation::AssemblyVisitor *assemblyVisitor;
 
+    // assembly products reused from one step to the next
+    simulation::AssemblyCache *assemblyCache;
+
     /// a derivable function creating and calling the assembly visitor to create an AssembledSystem
     virtual void perform_assembly( const core::MechanicalParams *mparams, system_type& sys );
 				
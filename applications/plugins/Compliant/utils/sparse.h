@@ -3,6 +3,9 @@
 
 #include <Eigen/Sparse>
 
+#include <algorithm>
+#include <vector>
+
 
 // easily restore default behavior
 #define SPARSE_USE_DEFAULT_PRODUCT 0
@@ -195,6 +198,247 @@ static void fast_add_prod(ResultType& res, const Lhs& lhs, const Rhs& rhs) {
 }
 
 
+// sparsity pattern of a compressed sparse matrix, to detect when it
+// changes. an uncompressed matrix never has the same pattern.
+template<class Matrix>
+struct pattern {
+    typedef typename Matrix::Index index_type;
+
+    index_type rows, cols;
+    std::vector<index_type> outer, inner;
+
+    pattern() : rows(-1), cols(-1) { }
+
+    void clear() {
+        rows = cols = -1;
+        outer.clear();
+        inner.clear();
+    }
+
+    void assign(const Matrix& m) {
+        if( !m.isCompressed() ) {
+            clear();
+            return;
+        }
+
+        rows = m.rows();
+        cols = m.cols();
+        outer.assign(m.outerIndexPtr(), m.outerIndexPtr() + m.outerSize() + 1);
+        inner.assign(m.innerIndexPtr(), m.innerIndexPtr() + m.nonZeros());
+    }
+
+    bool same(const Matrix& m) const {
+        return rows >= 0 && m.isCompressed() &&
+            m.rows() == rows && m.cols() == cols &&
+            index_type(inner.size()) == m.nonZeros() &&
+            std::equal(outer.begin(), outer.end(), m.outerIndexPtr()) &&
+            std::equal(inner.begin(), inner.end(), m.innerIndexPtr());
+    }
+};
+
+
+// row-major product res = lhs * rhs keeping its symbolic structure
+// between calls: as long as the patterns of lhs and rhs are
+// unchanged, the values of res are recomputed in place, without
+// allocation nor sorting.
+template<class Matrix>
+class cached_prod {
+    typedef typename Matrix::Scalar scalar_type;
+    typedef typename Matrix::Index index_type;
+
+    pattern<Matrix> lhs_pattern, rhs_pattern;
+    Matrix res;
+
+    // column -> position in the current row of res
+    std::vector<index_type> position;
+
+    bool reused;
+    
+public:
+
+    cached_prod() : reused(false) {
+        static_assert( Matrix::IsRowMajor, "cached_prod needs row-major matrices" );
+    }
+
+    // did the last product reuse the symbolic structure ?
+    bool pattern_reused() const { return reused; }
+
+    const Matrix& result() const { return res; }
+    
+    const Matrix& operator()(const Matrix& lhs, const Matrix& rhs) {
+        reused = lhs_pattern.same(lhs) && rhs_pattern.same(rhs);
+
+        if( !reused ) {
+            fast_prod(res, lhs, rhs);
+            res.makeCompressed();
+
+            lhs_pattern.assign(lhs);
+            rhs_pattern.assign(rhs);
+            position.assign(res.cols(), -1);
+            return res;
+        }
+
+        const auto* res_outer = res.outerIndexPtr();
+        const auto* res_inner = res.innerIndexPtr();
+        scalar_type* res_values = res.valuePtr();
+        
+        for(index_type i = 0, m = res.rows(); i < m; ++i) {
+            for(index_type p = res_outer[i], e = res_outer[i + 1]; p < e; ++p) {
+                position[ res_inner[p] ] = p;
+                res_values[p] = 0;
+            }
+
+            for(typename Matrix::InnerIterator lhsIt(lhs, i); lhsIt; ++lhsIt) {
+                const scalar_type x = lhsIt.value();
+                for(typename Matrix::InnerIterator rhsIt(rhs, lhsIt.index()); rhsIt; ++rhsIt) {
+                    res_values[ position[rhsIt.index()] ] += x * rhsIt.value();
+                }
+            }
+        }
+
+        return res;
+    }
+    
+};
+
+
+// l^T d l product, both products keeping their symbolic structure
+template<class Matrix>
+class cached_ltdl {
+    cached_prod<Matrix> dl, ltdl;
+    Matrix lt;
+public:
+
+    bool pattern_reused() const { return dl.pattern_reused() && ltdl.pattern_reused(); }
+
+    const Matrix& operator()(const Matrix& l, const Matrix& d) {
+        const Matrix& prod = dl(d, l);
+        lt = l.transpose();
+        return ltdl(lt, prod);
+    }
+};
+
+
+// sum of blocks shifted along the diagonal (block coefficient (i, j)
+// goes to (off + i, off + j)), keeping its symbolic structure between
+// calls: when the same blocks, with the same patterns and offsets,
+// are added in the same order, their values are scattered to
+// positions computed during the previous sum. otherwise the sum falls
+// back on triplets.
+//
+// usage: begin(rows, cols); add(block, off); ... ; end();
+template<class Matrix>
+class cached_sum {
+    typedef typename Matrix::Scalar scalar_type;
+    typedef typename Matrix::Index index_type;
+    typedef Eigen::Triplet<scalar_type> triplet_type;
+
+    struct block_type {
+        index_type off;
+        pattern<Matrix> pat;
+        std::vector<index_type> position; // block value -> res value
+    };
+
+    std::vector<block_type> blocks;
+    std::vector<triplet_type> triplets;
+
+    Matrix res;
+    index_type rows, cols;
+    unsigned current;
+    bool reuse;
+
+    void push(const Matrix& m, index_type off, scalar_type factor) {
+        for(index_type k = 0, n = m.outerSize(); k < n; ++k) {
+            for(typename Matrix::InnerIterator it(m, k); it; ++it) {
+                triplets.push_back( triplet_type(off + it.row(), off + it.col(), factor * it.value()) );
+            }
+        }
+    }
+
+    // stop scattering: what has been summed so far goes to the triplets
+    void fallback() {
+        reuse = false;
+        triplets.clear();
+        push(res, 0, 1);
+    }
+
+public:
+
+    cached_sum() : rows(-1), cols(-1), current(0), reuse(false) { }
+
+    // did the last sum reuse the symbolic structure ?
+    bool pattern_reused() const { return reuse; }
+
+    void begin(index_type r, index_type c) {
+        reuse = !blocks.empty() && r == rows && c == cols;
+        rows = r;
+        cols = c;
+        current = 0;
+        triplets.clear();
+
+        if( reuse ) {
+            std::fill(res.valuePtr(), res.valuePtr() + res.nonZeros(), scalar_type(0));
+        }
+    }
+
+    void add(const Matrix& block, index_type off, scalar_type factor = 1) {
+        if( current == blocks.size() ) {
+            if( reuse ) fallback();
+            blocks.push_back( block_type() );
+        }
+
+        block_type& b = blocks[current++];
+
+        if( reuse && b.off == off && b.pat.same(block) ) {
+            const scalar_type* values = block.valuePtr();
+            scalar_type* res_values = res.valuePtr();
+            
+            for(std::size_t k = 0, n = b.position.size(); k < n; ++k) {
+                res_values[ b.position[k] ] += factor * values[k];
+            }
+        } else {
+            if( reuse ) fallback();
+
+            b.off = off;
+            b.pat.assign(block);
+            push(block, off, factor);
+        }
+    }
+
+    const Matrix& end() {
+        if( reuse && current != blocks.size() ) fallback();
+        blocks.resize(current);
+
+        if( !reuse ) {
+            res.resize(rows, cols);
+            res.setFromTriplets(triplets.begin(), triplets.end());
+            res.makeCompressed();
+            triplets.clear();
+
+            // positions of the block values in the new pattern
+            const auto* res_outer = res.outerIndexPtr();
+            const auto* res_inner = res.innerIndexPtr();
+
+            for(block_type& b : blocks) {
+                b.position.resize(b.pat.inner.size());
+
+                for(index_type k = 0, n = index_type(b.pat.outer.size()) - 1; k < n; ++k) {
+                    const auto* first = res_inner + res_outer[b.off + k];
+                    const auto* last = res_inner + res_outer[b.off + k + 1];
+
+                    for(index_type p = b.pat.outer[k], e = b.pat.outer[k + 1]; p < e; ++p) {
+                        b.position[p] = std::lower_bound(first, last, b.off + b.pat.inner[p]) - res_inner;
+                    }
+                }
+            }
+        }
+
+        return res;
+    }
+
+};
+
+
 }
 
 
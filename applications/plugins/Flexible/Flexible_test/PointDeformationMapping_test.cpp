@@ -208,4 +208,11 @@ namespace sofa {
         ASSERT_TRUE( this->runTest(1e-10));
     }
 
+    // test case: same test with the parallel applyJ/applyJT/applyDJT
+    TYPED_TEST( PointsDeformationMapping_test , ParallelVecDeformationMappingTest)
+    {
+        this->mapping->findData("parallel")->read("1");
+        ASSERT_TRUE( this->runTest(1e-10));
+    }
+
 } // namespace sofa
@@ -335,6 +335,13 @@ protected :
     bool KdTreeDirty;              ///< tells if kdtree need to be updated (to speed up closest point search)
 
     SparseMatrix jacobian;   ///< Jacobian of the mapping
+
+    /// Transposed index map: jacobian blocks ( child, position in jacobian[child] ) of each parent, stored contiguously from transposedBegin[parent] to transposedBegin[parent+1], by increasing child.
+    /// Used to accumulate applyJT/applyDJT in parallel without scatter conflicts.
+    helper::vector<unsigned int> transposedBegin;
+    helper::vector<std::pair<unsigned int,unsigned int> > transposedBlocks;
+    int transposedIndexCounter;
+    void updateTransposedIndex(size_t parentSize); ///< rebuilds the transposed index map when the indices or the number of parents changed
     virtual void initJacobianBlocks()=0;
     virtual void initJacobianBlocks(const InVecCoord& /*inCoord*/, const OutVecCoord& /*outCoord*/){ std::cout << "Only implemented in LinearMapping for now." << std::endl;}
 
@@ -61,6 +61,7 @@ BaseDeformationMappingT<JacobianBlockType>::BaseDeformationMappingT (core::State
     , f_pos0 ( initData ( &f_pos0,"restPosition","initial spatial positions of children" ) )
     , missingInformationDirty(true)
     , KdTreeDirty(true)
+    , transposedIndexCounter(-1)
     , triangles(0)
     , extTriangles(0)
     , extvertPosIdx(0)
@@ -222,6 +223,7 @@ void BaseDeformationMappingT<JacobianBlockType>::resizeOut()
 
     // init jacobians
     initJacobianBlocks();
+    transposedIndexCounter=-1;
 
     // clear forces
     if(this->toModel->write(core::VecDerivId::force())) { helper::WriteOnlyAccessor<Data< OutVecDeriv > >  f(*this->toModel->write(core::VecDerivId::force())); for(size_t i=0;i<f.size();i++) f[i].clear(); }
@@ -276,6 +278,7 @@ void BaseDeformationMappingT<JacobianBlockType>::resizeOut(const helper::vector<
 
     // init jacobians
     initJacobianBlocks();
+    transposedIndexCounter=-1;
 
     // clear forces
     if(this->toModel->write(core::VecDerivId::force())) { helper::WriteOnlyAccessor<Data< OutVecDeriv > >  f(*this->toModel->write(core::VecDerivId::force())); for(size_t i=0;i<f.size();i++) f[i].clear(); }
@@ -411,7 +414,10 @@ void BaseDeformationMappingT<JacobianBlockType>::applyJ(OutVecDeriv& out, const
     {
         const VecVRef& indices = this->f_index.getValue();
 
-        for( size_t i=0 ; i<this->maskTo->size() ; ++i)
+#ifdef _OPENMP
+#pragma omp parallel for if (this->d_parallel.getValue())
+#endif
+        for(helper::IndexOpenMP<unsigned int>::type i=0 ; i<this->maskTo->size() ; ++i)
         {
             if( !this->maskTo->isActivated() || this->maskTo->getEntry(i) )
             {
@@ -475,7 +481,10 @@ void BaseDeformationMappingT<JacobianBlockType>::applyJ(const core::MechanicalPa
         const InVecDeriv& in = dIn.getValue();
         const VecVRef& indices = this->f_index.getValue();
 
-        for( size_t i=0 ; i<this->maskTo->size() ; ++i)
+#ifdef _OPENMP
+#pragma omp parallel for if (this->d_parallel.getValue())
+#endif
+        for(helper::IndexOpenMP<unsigned int>::type i=0 ; i<this->maskTo->size() ; ++i)
         {
             if( !this->maskTo->isActivated() || this->maskTo->getEntry(i) )
             {
@@ -492,6 +501,30 @@ void BaseDeformationMappingT<JacobianBlockType>::applyJ(const core::MechanicalPa
     }
 }
 
+template <class JacobianBlockType>
+void BaseDeformationMappingT<JacobianBlockType>::updateTransposedIndex(size_t parentSize)
+{
+    const int counter = this->f_index.getCounter();
+    if( counter == transposedIndexCounter && transposedBegin.size() == parentSize+1 ) return;
+    transposedIndexCounter = counter;
+
+    const VecVRef& indices = this->f_index.getValue();
+
+    // count the blocks of each parent
+    transposedBegin.assign(parentSize+1,0);
+    for(size_t i=0; i<jacobian.size(); i++)
+        for(size_t j=0; j<jacobian[i].size(); j++)
+            transposedBegin[indices[i][j]+1]++;
+    for(size_t index=0; index<parentSize; index++) transposedBegin[index+1]+=transposedBegin[index];
+
+    // fill them by increasing child, as in the sequential accumulation
+    transposedBlocks.resize(transposedBegin.back());
+    helper::vector<unsigned int> position(transposedBegin.begin(),transposedBegin.end()-1);
+    for(size_t i=0; i<jacobian.size(); i++)
+        for(size_t j=0; j<jacobian[i].size(); j++)
+            transposedBlocks[position[indices[i][j]]++] = std::make_pair((unsigned int)i,(unsigned int)j);
+}
+
 template <class JacobianBlockType>
 void BaseDeformationMappingT<JacobianBlockType>::applyJT(const core::MechanicalParams * /*mparams*/ , Data<InVecDeriv>& dIn, const Data<OutVecDeriv>& dOut)
 {
@@ -506,14 +539,35 @@ void BaseDeformationMappingT<JacobianBlockType>::applyJT(const core::MechanicalP
         const OutVecDeriv& out = dOut.getValue();
         const VecVRef& indices = this->f_index.getValue();
 
-        for( size_t i=0 ; i<this->maskTo->size() ; ++i)
+        if( this->d_parallel.getValue() )
         {
-            if( this->maskTo->getEntry(i) )
+            // gather the contributions of the children of each parent, so that parents can be processed concurrently
+            updateTransposedIndex(in.size());
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for(helper::IndexOpenMP<unsigned int>::type index=0 ; index<transposedBegin.size()-1 ; ++index)
             {
-                for(size_t j=0; j<jacobian[i].size(); j++)
+                for(size_t k=transposedBegin[index]; k<transposedBegin[index+1]; k++)
                 {
-                    size_t index=indices[i][j];
-                    jacobian[i][j].addMultTranspose(in[index],out[i]);
+                    const size_t i=transposedBlocks[k].first;
+                    if( this->maskTo->getEntry(i) )
+                        jacobian[i][transposedBlocks[k].second].addMultTranspose(in[index],out[i]);
+                }
+            }
+        }
+        else
+        {
+            for( size_t i=0 ; i<this->maskTo->size() ; ++i)
+            {
+                if( this->maskTo->getEntry(i) )
+                {
+                    for(size_t j=0; j<jacobian[i].size(); j++)
+                    {
+                        size_t index=indices[i][j];
+                        jacobian[i][j].addMultTranspose(in[index],out[i]);
+                    }
                 }
             }
         }
@@ -552,15 +606,35 @@ void BaseDeformationMappingT<JacobianBlockType>::applyDJT(const core::Mechanical
         else
         {
 
-            const VecVRef& indices = this->f_index.getValue();
-            for( size_t i=0 ; i<this->maskTo->size() ; ++i)
+            if( this->d_parallel.getValue() )
             {
-                if( this->maskTo->getEntry(i) )
+                updateTransposedIndex(parentForce.size());
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+                for(helper::IndexOpenMP<unsigned int>::type index=0 ; index<transposedBegin.size()-1 ; ++index)
                 {
-                    for(size_t j=0; j<jacobian[i].size(); j++)
+                    for(size_t k=transposedBegin[index]; k<transposedBegin[index+1]; k++)
                     {
-                        size_t index=indices[i][j];
-                        jacobian[i][j].addDForce(parentForce[index],parentDisplacement[index],childForce[i], mparams->kFactor());
+                        const size_t i=transposedBlocks[k].first;
+                        if( this->maskTo->getEntry(i) )
+                            jacobian[i][transposedBlocks[k].second].addDForce(parentForce[index],parentDisplacement[index],childForce[i], mparams->kFactor());
+                    }
+                }
+            }
+            else
+            {
+                const VecVRef& indices = this->f_index.getValue();
+                for( size_t i=0 ; i<this->maskTo->size() ; ++i)
+                {
+                    if( this->maskTo->getEntry(i) )
+                    {
+                        for(size_t j=0; j<jacobian[i].size(); j++)
+                        {
+                            size_t index=indices[i][j];
+                            jacobian[i][j].addDForce(parentForce[index],parentDisplacement[index],childForce[i], mparams->kFactor());
+                        }
                     }
                 }
             }
@@ -82,6 +82,7 @@ void bindSofaPythonModule(PyObject * module)
 
     /// non Base-Inherited types
     SP_ADD_CLASS_IN_SOFAMODULE(Data)
+    SP_ADD_CLASS_IN_SOFAMODULE(DataWritableView)
 
     /// special Data cases
     SP_ADD_CLASS_IN_FACTORY(DisplayFlagsData,sofa::core::objectmodel::Data<sofa::core::visual::DisplayFlags>)
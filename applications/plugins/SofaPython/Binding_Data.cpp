@@ -20,6 +20,8 @@
 * Contact information: contact@sofa-framework.org                             *
 ******************************************************************************/
 #include <sstream>
+#include <cstring>
+#include <map>
 
 #include "Binding_Data.h"
 #include "Binding_LinearSpring.h"
@@ -46,6 +48,214 @@ static BaseData* get_basedata(PyObject* self) {
 }
 
 
+namespace
+{
+
+/// Layout of a Data value stored as one contiguous array of scalars or integers
+/// (e.g. VecCoord, VecDeriv or the topology arrays), that can be shared with python without copy.
+struct DataBufferLayout
+{
+    const char* format {nullptr}; ///< struct module format of the values
+    Py_ssize_t itemsize {0};
+    Py_ssize_t size {0};          ///< total number of values
+    Py_ssize_t rowWidth {1};      ///< number of values per element
+    bool resizable {false};
+};
+
+/// Shape and strides of a buffer exported by a Data, owned by the Py_buffer
+struct DataBufferView
+{
+    Py_ssize_t shape[2];
+    Py_ssize_t strides[2];
+    bool writable;
+    const BaseData* data;
+};
+
+/// Number of read-only buffers currently exported by each Data
+std::map<const BaseData*, unsigned int>& getReadOnlyExports()
+{
+    static std::map<const BaseData*, unsigned int> exports;
+    return exports;
+}
+
+/// A read-only buffer points into the storage of the Data: as for a python bytearray, the
+/// value cannot be replaced or resized from python while such a buffer is exported.
+/// Returns false and sets a BufferError if the Data has live read-only exports.
+bool checkNoReadOnlyExport(const BaseData* data)
+{
+    if (getReadOnlyExports().count(data) == 0)
+        return true;
+    PyErr_Format(PyExc_BufferError, "Data '%s' cannot be modified while a read-only buffer of its value is exported "
+                 "(release the memoryview or numpy array first, or use getWritableView())", data->getName().c_str());
+    return false;
+}
+
+const char* getBufferFormat(const AbstractTypeInfo* valueinfo)
+{
+    /// the names of the integer and scalar types are already the struct format characters
+    static const char* const formats[] = { "b", "B", "h", "H", "i", "I", "l", "L", "q", "Q", "f", "d" };
+    const std::string name = valueinfo->name();
+    if (name == "bool")
+        return "?";
+    for (const char* format : formats)
+    {
+        if (name == format)
+            return format;
+    }
+    return nullptr;
+}
+
+bool getDataBufferLayout(BaseData* data, const void* value, DataBufferLayout& layout)
+{
+    const AbstractTypeInfo* typeinfo = data->getValueTypeInfo();
+    if (!typeinfo || !typeinfo->ValidInfo() || !typeinfo->SimpleLayout() || typeinfo->Text())
+        return false;
+
+    const AbstractTypeInfo* valueinfo = typeinfo;
+    while (valueinfo->Container())
+        valueinfo = valueinfo->ValueType();
+    if (!valueinfo->Scalar() && !valueinfo->Integer())
+        return false;
+
+    layout.format = getBufferFormat(valueinfo);
+    if (!layout.format)
+        return false;
+
+    layout.itemsize = Py_ssize_t(valueinfo->byteSize());
+    layout.size = Py_ssize_t(typeinfo->size(value));
+    layout.resizable = !typeinfo->FixedSize();
+    layout.rowWidth = layout.resizable ? Py_ssize_t(typeinfo->size()) : layout.size;
+    return layout.rowWidth > 0;
+}
+
+/// bf_getbuffer: exports the value of the Data, without copy.
+/// memoryview(data) and numpy.asarray(data) only ask for a read-only view: writable views are
+/// exported by the DataWritableView returned by Data.getWritableView().
+/// A read-only view is not a copy: it is counted until released and the python setters refuse
+/// to modify the Data meanwhile. The C++ side is not aware of it though: if the value is
+/// resized by the simulation (e.g. an engine update or a topological change) or if the Data
+/// is destroyed, the view is left dangling, so it must not be kept across simulation steps.
+/// A writable view calls beginEditVoidPtr and the matching endEditVoidPtr is called when the
+/// view is released, so that the modification is propagated once the python object is freed.
+int Data_getBuffer(PyObject* self, Py_buffer* view, int flags)
+{
+    view->obj = nullptr;
+    BaseData* data = get_basedata(self);
+    if (!data)
+    {
+        PyErr_SetString(PyExc_BufferError, "invalid Data");
+        return -1;
+    }
+
+    DataBufferLayout layout;
+    if (!getDataBufferLayout(data, data->getValueVoidPtr(), layout))
+    {
+        PyErr_Format(PyExc_BufferError, "Data '%s' of type '%s' is not a contiguous array of numbers",
+                     data->getName().c_str(), data->getValueTypeString().c_str());
+        return -1;
+    }
+
+    const AbstractTypeInfo* typeinfo = data->getValueTypeInfo();
+    DataBufferView* bufferView = new DataBufferView;
+    bufferView->writable = (flags & PyBUF_WRITABLE) != 0;
+    bufferView->data = data;
+
+    static char empty = 0;
+    void* value = bufferView->writable ? data->beginEditVoidPtr() : const_cast<void*>(data->getValueVoidPtr());
+    void* buffer = layout.size ? typeinfo->getValuePtr(value) : &empty;
+
+    const bool is2D = layout.resizable && layout.rowWidth > 1;
+    bufferView->shape[0] = is2D ? layout.size / layout.rowWidth : layout.size;
+    bufferView->shape[1] = layout.rowWidth;
+    bufferView->strides[0] = is2D ? layout.rowWidth * layout.itemsize : layout.itemsize;
+    bufferView->strides[1] = layout.itemsize;
+
+    view->obj = self;
+    Py_INCREF(self);
+    view->buf = buffer;
+    view->len = layout.size * layout.itemsize;
+    view->readonly = bufferView->writable ? 0 : 1;
+    view->itemsize = layout.itemsize;
+    view->format = (flags & PyBUF_FORMAT) ? const_cast<char*>(layout.format) : nullptr;
+    view->ndim = is2D ? 2 : 1;
+    view->shape = (flags & PyBUF_ND) ? bufferView->shape : nullptr;
+    view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? bufferView->strides : nullptr;
+    view->suboffsets = nullptr;
+    view->internal = bufferView;
+    if (!bufferView->writable)
+        ++getReadOnlyExports()[data];
+    return 0;
+}
+
+void Data_releaseBuffer(PyObject* self, Py_buffer* view)
+{
+    DataBufferView* bufferView = static_cast<DataBufferView*>(view->internal);
+    if (bufferView->writable)
+    {
+        if (BaseData* data = get_basedata(self))
+            data->endEditVoidPtr();
+    }
+    else
+    {
+        std::map<const BaseData*, unsigned int>& exports = getReadOnlyExports();
+        auto exported = exports.find(bufferView->data);
+        if (exported != exports.end() && --exported->second == 0)
+            exports.erase(exported);
+    }
+    delete bufferView;
+}
+
+/// Copy the content of a python buffer (e.g. a numpy array) with the same value type into the Data.
+/// Returns 1 when copied, 0 when the buffer cannot be copied directly and -1 on error.
+int SetDataValueBuffer(BaseData* data, PyObject* args)
+{
+    DataBufferLayout layout;
+    if (!getDataBufferLayout(data, data->getValueVoidPtr(), layout))
+        return 0;
+
+    Py_buffer source;
+    if (PyObject_GetBuffer(args, &source, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) < 0)
+    {
+        PyErr_Clear();
+        return 0;
+    }
+
+    /// only native formats of the same type are copied as raw memory
+    const char* format = source.format ? source.format : "B";
+    if (format[0] == '@' || format[0] == '=')
+        ++format;
+    const Py_ssize_t count = source.itemsize ? source.len / source.itemsize : 0;
+    if (source.itemsize != layout.itemsize || std::strcmp(format, layout.format) != 0
+            || count % layout.rowWidth != 0 || (!layout.resizable && count != layout.size))
+    {
+        PyBuffer_Release(&source);
+        return 0;
+    }
+
+    const AbstractTypeInfo* typeinfo = data->getValueTypeInfo();
+    void* value = data->beginEditVoidPtr();
+    if (count != layout.size)
+    {
+        typeinfo->setSize(value, sofa::Size(count));
+        if (Py_ssize_t(typeinfo->size(value)) != count)
+        {
+            data->endEditVoidPtr();
+            PyBuffer_Release(&source);
+            PyErr_Format(PyExc_ValueError, "unable to resize Data '%s' to %zd values",
+                         data->getName().c_str(), count);
+            return -1;
+        }
+    }
+    if (count)
+        std::memcpy(typeinfo->getValuePtr(value), source.buf, std::size_t(source.len));
+    data->endEditVoidPtr();
+    PyBuffer_Release(&source);
+    return 1;
+}
+
+} // anonymous namespace
+
+
 SP_CLASS_ATTR_GET(Data,name)(PyObject *self, void*)
 {
     BaseData* data = get_basedata( self );
@@ -344,6 +554,9 @@ static int SetDataValuePythonList(BaseData* data, PyObject* args,
 
 int SetDataValuePython(BaseData* data, PyObject* args)
 {
+    if (!checkNoReadOnlyExport(data))
+        return -1;
+
     if (PyString_Check(args))
     {
         char *str = PyString_AsString(args); /// for setters, only one object and not a tuple....
@@ -425,15 +638,25 @@ int SetDataValuePython(BaseData* data, PyObject* args)
         return SetDataValuePythonList(data, args, rowWidth, nbRows);
     }
 
-    /// BaseData
+    /// BaseData: typed copy, the values are converted through the type infos if the types differ
     if( BaseData* targetData = get_basedata(args) )
     {
-        // TODO improve data to data copy
-        SP_MESSAGE_WARNING( "Data to Data copy is using string serialization for now. This may results in poor performances." );
-        data->read( targetData->getValueString() );
+        if( !data->copyValue(targetData) )
+        {
+            SP_MESSAGE_WARNING( "Data to Data copy between types "<<data->getValueTypeString()<<" and "<<targetData->getValueTypeString()<<" is using string serialization. This may results in poor performances." );
+            data->read( targetData->getValueString() );
+        }
         return 0;
     }
 
+    /// python buffer with the same value type (e.g. numpy arrays): raw copy
+    if( PyObject_CheckBuffer(args) )
+    {
+        const int copied = SetDataValueBuffer(data, args);
+        if( copied != 0 )
+            return copied < 0 ? -1 : 0;
+    }
+
     PyErr_BadArgument();
     return -1;
 }
@@ -582,6 +805,8 @@ static PyObject * Data_setSize(PyObject *self, PyObject * args)
     {
         return nullptr;
     }
+    if (!checkNoReadOnlyExport(data))
+        return nullptr;
     const AbstractTypeInfo *typeinfo = data->getValueTypeInfo();
     WriteAccessWithRawPtr access {data};
     typeinfo->setSize(access.ptr,size);
@@ -667,6 +892,9 @@ static PyObject * Data_read(PyObject *self, PyObject * args)
         return nullptr;
     }
 
+    if (!checkNoReadOnlyExport(data))
+        return nullptr;
+
     if (PyString_Check(value))
     {
         data->read(PyString_AsString(value));
@@ -691,6 +919,9 @@ static PyObject * Data_setParent(PyObject *self, PyObject * args)
         return nullptr;
     }
 
+    if (!checkNoReadOnlyExport(data))
+        return nullptr;
+
     typedef PyPtr<BaseData> PyBaseData;
 
     if (PyString_Check(value))
@@ -803,6 +1034,20 @@ static PyObject * Data_getValueVoidPtr(PyObject * self, PyObject * /*args*/)
 }
 
 
+/// returns the same Data, wrapped in a DataWritableView which exports writable buffers,
+/// e.g. numpy.asarray(data.getWritableView())
+static PyObject * Data_getWritableView(PyObject * self, PyObject * args)
+{
+    const size_t argSize = PyTuple_Size(args);
+    if( argSize != 0 ) {
+        PyErr_SetString(PyExc_RuntimeError, "This function does not accept any argument.") ;
+        return nullptr;
+    }
+
+    BaseData* data = get_basedata( self );
+    return SP_BUILD_PYPTR(DataWritableView, BaseData, data, false);
+}
+
 /// returns the number of times the Data was modified
 static PyObject * Data_getCounter(PyObject * self, PyObject * args)
 {
@@ -917,6 +1162,8 @@ SP_CLASS_METHOD_DOC(Data,getParentPath, "Returns the string containing the path
 SP_CLASS_METHOD_DOC(Data,hasParent, "Indicate if the string is linked to an other data field (its parent).")
 SP_CLASS_METHOD(Data,getLinkPath)
 SP_CLASS_METHOD(Data,getValueVoidPtr)
+SP_CLASS_METHOD_DOC(Data,getWritableView, "Returns the field as an object exporting a writable buffer, e.g. numpy.asarray(field.getWritableView()).\n"
+                                           "The field is modified when the buffer is released.")
 SP_CLASS_METHOD(Data,getCounter)
 SP_CLASS_METHOD(Data,isDirty)
 SP_CLASS_METHOD(Data,getAsACreateObjectParameter)
@@ -929,11 +1176,49 @@ SP_CLASS_ATTR(Data,value)
 SP_CLASS_ATTRS_END
 
 namespace {
+static PyBufferProcs Data_bufferProcs;
+
 static struct patch {
     patch() {
         SP_SOFAPYTYPEOBJECT(Data).tp_str = Data_str; /// adding __str__ function
+
+        /// buffer protocol, e.g. numpy.asarray(data) or memoryview(data)
+        Data_bufferProcs.bf_getbuffer = Data_getBuffer;
+        Data_bufferProcs.bf_releasebuffer = Data_releaseBuffer;
+        SP_SOFAPYTYPEOBJECT(Data).tp_as_buffer = &Data_bufferProcs;
+#ifdef Py_TPFLAGS_HAVE_NEWBUFFER
+        SP_SOFAPYTYPEOBJECT(Data).tp_flags |= Py_TPFLAGS_HAVE_NEWBUFFER;
+#endif
     }
 } patcher;
 }
 
 SP_CLASS_TYPE_BASE_PTR_ATTR(Data, BaseData);
+
+
+namespace {
+/// a writable view is exported whatever the flags of the request: memoryview and numpy only
+/// ask for read-only buffers
+int DataWritableView_getBuffer(PyObject* self, Py_buffer* view, int flags)
+{
+    return Data_getBuffer(self, view, flags | PyBUF_WRITABLE);
+}
+
+static PyBufferProcs DataWritableView_bufferProcs;
+
+static struct writableViewPatch {
+    writableViewPatch() {
+        DataWritableView_bufferProcs.bf_getbuffer = DataWritableView_getBuffer;
+        DataWritableView_bufferProcs.bf_releasebuffer = Data_releaseBuffer;
+        SP_SOFAPYTYPEOBJECT(DataWritableView).tp_as_buffer = &DataWritableView_bufferProcs;
+#ifdef Py_TPFLAGS_HAVE_NEWBUFFER
+        SP_SOFAPYTYPEOBJECT(DataWritableView).tp_flags |= Py_TPFLAGS_HAVE_NEWBUFFER;
+#endif
+    }
+} writableViewPatcher;
+}
+
+SP_CLASS_METHODS_BEGIN(DataWritableView)
+SP_CLASS_METHODS_END
+
+SP_CLASS_TYPE_PTR(DataWritableView, BaseData, Data);
@@ -25,6 +25,8 @@
 #include "PythonMacros.h"
 
 SP_DECLARE_CLASS_TYPE(Data)
+/// the same Data, exporting writable buffers (see Data.getWritableView)
+SP_DECLARE_CLASS_TYPE(DataWritableView)
 
 PyObject *GetDataValuePython(sofa::core::objectmodel::BaseData* data);
 int SetDataValuePython(sofa::core::objectmodel::BaseData* data, PyObject* value);
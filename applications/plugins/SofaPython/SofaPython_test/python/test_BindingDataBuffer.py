@@ -0,0 +1,81 @@
+# -*- coding: utf-8 -*-
+
+import Sofa
+from SofaTest import *
+import numpy
+
+
+def createScene(rootNode):
+    dof = rootNode.createObject("MechanicalObject", template="Vec3d", name="dof",
+                                position="0 0 0  1 1 1  2 2 2  3 3 3")
+    topology = rootNode.createObject("MeshTopology", name="topology", triangles="0 1 2  1 2 3")
+    positions = dof.findData("position")
+    triangles = topology.findData("triangles")
+
+    ### read-only view, without copy
+    view = memoryview(positions)
+    ASSERT_TRUE( view.readonly )
+    ASSERT_EQ( view.format, "d" )
+    ASSERT_EQ( view.shape, (4, 3) )
+    del view
+    view = memoryview(positions.getWritableView())
+    ASSERT_FALSE( view.readonly )
+    del view
+
+    ### numpy arrays share the memory of the Data
+    array = numpy.asarray(triangles)
+    ASSERT_EQ( array.shape, (2, 3) )
+    ASSERT_EQ( array.dtype, numpy.uint32 )
+    ASSERT_EQ( array[1][2], 3 )
+    del array
+
+    ### numpy.asarray only asks for read-only views
+    array = numpy.asarray(positions)
+    ASSERT_FALSE( array.flags.writeable )
+    del array
+
+    ### writable view: the Data is modified when the view is released
+    t = positions.getCounter()
+    array = numpy.asarray(positions.getWritableView())
+    ASSERT_TRUE( array.flags.writeable )
+    array[2] = [5., 6., 7.]
+    del array
+    ASSERT_NEQ( positions.getCounter(), t )
+    ASSERT_EQ( dof.position[2], [5., 6., 7.] )
+
+    ### the value cannot be replaced from python while a read-only view points into it
+    array = numpy.asarray(positions)
+    ASSERT_TRUE( raisesBufferErrorOnSet(dof, [[0., 0., 0.]]) )
+    ASSERT_EQ( len(dof.position), 4 )
+    del array
+    ASSERT_FALSE( raisesBufferErrorOnSet(dof, [[0., 0., 0.]]*4) )
+
+    ### raw copy from a numpy array, with resize
+    dof.position = numpy.arange(15, dtype=numpy.float64).reshape(5, 3)
+    ASSERT_EQ( len(dof.position), 5 )
+    ASSERT_EQ( dof.position[4], [12., 13., 14.] )
+
+    ### typed Data to Data copy
+    other = rootNode.createObject("MechanicalObject", template="Vec3d", name="other")
+    other.findData("position").value = positions
+    ASSERT_EQ( len(other.position), 5 )
+    ASSERT_EQ( other.position[3], [9., 10., 11.] )
+
+    ### values that are not numbers cannot be viewed
+    ASSERT_TRUE( raisesBufferError(dof.findData("name")) )
+
+
+def raisesBufferError(data):
+    try:
+        memoryview(data)
+    except BufferError:
+        return True
+    return False
+
+
+def raisesBufferErrorOnSet(dof, position):
+    try:
+        dof.position = position
+    except BufferError:
+        return True
+    return False
@@ -0,0 +1,204 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/helper/testing/BaseTest.h>
+using sofa::helper::testing::BaseTest ;
+
+#include <SofaSimulationGraph/DAGSimulation.h>
+#include <sofa/simulation/Node.h>
+#include <sofa/core/MechanicalParams.h>
+#include <SofaBaseMechanics/MechanicalObject.h>
+
+#include <SofaSphFluid/SPHFluidForceField.h>
+#include <SofaSphFluid/SPHKernel.h>
+using sofa::component::forcefield::SPHFluidForceField ;
+using sofa::component::forcefield::SPHKernel ;
+
+#include <random>
+
+namespace sofa
+{
+
+/// Compares the densities and forces computed by SPHFluidForceField, which searches the
+/// neighbors in a grid, to a brute force computation over all the pairs of particles.
+struct SPHFluidForceField_test : public BaseTest
+{
+    typedef defaulttype::Vec3Types DataTypes;
+    typedef DataTypes::Real Real;
+    typedef DataTypes::Coord Coord;
+    typedef DataTypes::Deriv Deriv;
+    typedef DataTypes::VecCoord VecCoord;
+    typedef DataTypes::VecDeriv VecDeriv;
+    typedef SPHFluidForceField<DataTypes> ForceField;
+    typedef component::container::MechanicalObject<DataTypes> MechanicalObject;
+
+    const Real h = 1;
+    const Real m = 1;
+    const Real d0 = 1;
+    const Real k = 100;
+    const Real viscosity = 0.1;
+    const Real surfaceTension = 0.5;
+
+    simulation::Node::SPtr m_root;
+    MechanicalObject::SPtr m_dofs;
+    ForceField::SPtr m_forceField;
+
+    /// jittered lattice of particles, with random velocities
+    void createScene(Real surfaceTensionValue)
+    {
+        simulation::setSimulation(new simulation::graph::DAGSimulation());
+        m_root = simulation::getSimulation()->createNewGraph("root");
+
+        std::mt19937 random(42);
+        std::uniform_real_distribution<Real> jitter(-0.1, 0.1);
+        const int n = 6;
+        VecCoord x;
+        VecDeriv v;
+        for (int i = 0; i < n*n*n; ++i)
+        {
+            x.push_back(Coord(0.45*(i%n) + jitter(random), 0.45*(i/n%n) + jitter(random), 0.45*(i/n/n) + jitter(random)));
+            v.push_back(Deriv(jitter(random), jitter(random), jitter(random)));
+        }
+
+        m_dofs = core::objectmodel::New<MechanicalObject>();
+        m_dofs->resize(int(x.size()));
+        m_dofs->x.setValue(x);
+        m_dofs->v.setValue(v);
+        m_root->addObject(m_dofs);
+
+        m_forceField = core::objectmodel::New<ForceField>();
+        m_forceField->setParticleRadius(h);
+        m_forceField->setParticleMass(m);
+        m_forceField->setDensity0(d0);
+        m_forceField->setPressureStiffness(k);
+        m_forceField->setViscosity(viscosity);
+        m_forceField->setSurfaceTension(surfaceTensionValue);
+        m_root->addObject(m_forceField);
+
+        simulation::getSimulation()->init(m_root.get());
+    }
+
+    void onTearDown() override
+    {
+        if (m_root)
+            simulation::getSimulation()->unload(m_root);
+    }
+
+    VecDeriv computeForces()
+    {
+        core::objectmodel::Data<VecDeriv> f;
+        m_forceField->addForce(core::MechanicalParams::defaultInstance(), f, m_dofs->x, m_dofs->v);
+        return f.getValue();
+    }
+
+    /// brute force computation of the densities and forces, with the default kernels
+    void computeReference(helper::vector<Real>& density, VecDeriv& f, Real surfaceTensionValue)
+    {
+        SPHKernel<component::forcefield::SPH_KERNEL_DEFAULT_DENSITY,Deriv> Kd(h);
+        SPHKernel<component::forcefield::SPH_KERNEL_DEFAULT_PRESSURE,Deriv> Kp(h);
+        SPHKernel<component::forcefield::SPH_KERNEL_DEFAULT_VISCOSITY,Deriv> Kv(h);
+        SPHKernel<component::forcefield::SPH_KERNEL_DEFAULT_DENSITY,Deriv> Kc(h);
+
+        const VecCoord& x = m_dofs->x.getValue();
+        const VecDeriv& v = m_dofs->v.getValue();
+        const std::size_t n = x.size();
+        auto r_h = [&](std::size_t i, std::size_t j) { return (x[i] - x[j]).norm() / h; };
+        auto neighbors = [&](std::size_t i, std::size_t j) { return i != j && (x[i] - x[j]).norm2() < h*h; };
+
+        density.assign(n, m*Kd.W(0));
+        for (std::size_t i = 0; i < n; ++i)
+            for (std::size_t j = 0; j < n; ++j)
+                if (neighbors(i, j))
+                    density[i] += m*Kd.W(r_h(i, j));
+
+        f.assign(n, Deriv());
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            const Real pi = k*(density[i] - d0);
+            Deriv normal;
+            Real curvature = 0;
+            for (std::size_t j = 0; j < n; ++j)
+            {
+                if (!neighbors(i, j))
+                    continue;
+                const Real pj = k*(density[j] - d0);
+                const Real q = r_h(i, j);
+                f[i] += Kp.gradW(x[i] - x[j], q) * (-m*m*(pi/(density[i]*density[i]) + pj/(density[j]*density[j])));
+                f[i] += (v[j] - v[i]) * (m*m*viscosity/(density[i]*density[j]) * Kv.laplacianW(q));
+                normal += Kc.gradW(x[i] - x[j], q) * (m/density[j] - m/density[i]);
+                curvature += Kc.laplacianW(q) * (m/density[j] - m/density[i]);
+            }
+            if (surfaceTensionValue > 0 && normal.norm() > 0.000001)
+                f[i] += normal * (-m*surfaceTensionValue*curvature/normal.norm());
+        }
+    }
+
+    void checkForces(Real surfaceTensionValue)
+    {
+        createScene(surfaceTensionValue);
+        const VecDeriv f = computeForces();
+
+        helper::vector<Real> density;
+        VecDeriv reference;
+        computeReference(density, reference, surfaceTensionValue);
+
+        ASSERT_EQ(reference.size(), f.size());
+        Real maxForce = 0;
+        for (const Deriv& fi : reference)
+            maxForce = std::max(maxForce, fi.norm());
+        ASSERT_LT(0, maxForce);
+
+        for (std::size_t i = 0; i < f.size(); ++i)
+        {
+            /// getParticleField(i,0) is the inverse of the density of the particle
+            EXPECT_NEAR(density[i], 1 / m_forceField->getParticleField(int(i), 0), 1e-10*density[i]) << "particle " << i;
+            EXPECT_LT((f[i] - reference[i]).norm(), 1e-10*maxForce) << "particle " << i;
+        }
+    }
+};
+
+TEST_F(SPHFluidForceField_test, densityAndForcesMatchBruteForce)
+{
+    checkForces(0);
+}
+
+TEST_F(SPHFluidForceField_test, surfaceTensionMatchesBruteForce)
+{
+    checkForces(surfaceTension);
+}
+
+/// pressure and viscosity are pairwise opposite forces
+TEST_F(SPHFluidForceField_test, momentumConservation)
+{
+    createScene(0);
+    const VecDeriv f = computeForces();
+    Deriv total;
+    Real maxForce = 0;
+    for (const Deriv& fi : f)
+    {
+        total += fi;
+        maxForce = std::max(maxForce, fi.norm());
+    }
+    ASSERT_LT(0, maxForce);
+    EXPECT_LT(total.norm(), 1e-10*maxForce*f.size());
+}
+
+} // namespace sofa
@@ -0,0 +1,149 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/helper/testing/BaseTest.h>
+using sofa::helper::testing::BaseTest ;
+
+#include <sofa/defaulttype/VecTypes.h>
+
+#include <SofaSphFluid/SortedCellGrid.h>
+using sofa::component::container::SortedCellGrid ;
+
+#include <algorithm>
+#include <random>
+
+namespace sofa
+{
+
+template<class DataTypes>
+struct SortedCellGrid_test : public BaseTest
+{
+    typedef SortedCellGrid<DataTypes> Grid;
+    typedef typename DataTypes::Real Real;
+    typedef typename DataTypes::Coord Coord;
+    typedef typename DataTypes::VecCoord VecCoord;
+    using Index = sofa::Index;
+
+    std::mt19937 m_random {42};
+
+    /// n random points in [origin, origin+width]^N
+    void addRandomPoints(VecCoord& x, std::size_t n, Real origin, Real width)
+    {
+        std::uniform_real_distribution<Real> distribution(origin, origin + width);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            Coord p;
+            for (int d = 0; d < Grid::N; ++d)
+                p[d] = distribution(m_random);
+            x.push_back(p);
+        }
+    }
+
+    /// Compare the neighbors found with the grid to a brute force search
+    void checkNeighbors(const VecCoord& x, Real h, bool hashed)
+    {
+        Grid grid;
+        grid.build(x, h);
+        EXPECT_EQ(hashed, grid.isHashed());
+
+        /// the sorted indices are a permutation of the particles
+        const helper::vector<Index>& sorted = grid.getSortedIndices();
+        ASSERT_EQ(x.size(), sorted.size());
+        std::vector<bool> found(x.size(), false);
+        for (Index i : sorted)
+        {
+            ASSERT_LT(i, x.size());
+            EXPECT_FALSE(found[i]);
+            found[i] = true;
+        }
+
+        const Real h2 = h*h;
+        std::size_t nbNeighbors = 0;
+        for (std::size_t s = 0; s < sorted.size(); ++s)
+        {
+            const Index i = sorted[s];
+            std::vector<Index> neighbors;
+            grid.forEachNeighbor(s, h2, [&](Index j, Real r2)
+            {
+                neighbors.push_back(j);
+                EXPECT_EQ((x[j] - x[i]).norm2(), r2);
+            });
+
+            std::vector<Index> expected;
+            for (std::size_t j = 0; j < x.size(); ++j)
+            {
+                if (j != i && (x[j] - x[i]).norm2() < h2)
+                    expected.push_back(Index(j));
+            }
+
+            std::sort(neighbors.begin(), neighbors.end());
+            EXPECT_EQ(expected, neighbors) << "particle " << i;
+            nbNeighbors += expected.size();
+        }
+        /// the configurations must not be trivial
+        EXPECT_LT(x.size(), nbNeighbors);
+    }
+};
+
+typedef ::testing::Types< defaulttype::Vec2Types, defaulttype::Vec3Types > DataTypes;
+TYPED_TEST_CASE(SortedCellGrid_test, DataTypes);
+
+TYPED_TEST(SortedCellGrid_test, empty)
+{
+    typename TestFixture::Grid grid;
+    grid.build(typename TestFixture::VecCoord(), 1);
+    EXPECT_TRUE(grid.getSortedIndices().empty());
+}
+
+TYPED_TEST(SortedCellGrid_test, randomPoints)
+{
+    typename TestFixture::VecCoord x;
+    this->addRandomPoints(x, 500, -2, 4);
+    this->checkNeighbors(x, 0.5, false);
+}
+
+/// points on the boundaries of the cells
+TYPED_TEST(SortedCellGrid_test, lattice)
+{
+    typedef typename TestFixture::Coord Coord;
+    typename TestFixture::VecCoord x;
+    const int n = TestFixture::Grid::N == 2 ? 20 : 8;
+    for (int i = 0; i < n*n*(TestFixture::Grid::N == 2 ? 1 : n); ++i)
+    {
+        Coord p;
+        for (int d = 0, code = i; d < TestFixture::Grid::N; ++d, code /= n)
+            p[d] = 0.25 * (code % n - n/2);
+        x.push_back(p);
+    }
+    this->checkNeighbors(x, 0.5, false);
+}
+
+/// clusters far apart: the cells are indexed with the spatial hash
+TYPED_TEST(SortedCellGrid_test, hashedCells)
+{
+    typename TestFixture::VecCoord x;
+    this->addRandomPoints(x, 200, -1, 2);
+    this->addRandomPoints(x, 200, 1000, 2);
+    this->addRandomPoints(x, 200, -5000, 2);
+    this->checkNeighbors(x, 0.5, true);
+}
+
+} // namespace sofa
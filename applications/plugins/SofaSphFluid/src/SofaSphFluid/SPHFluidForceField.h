@@ -26,6 +26,7 @@
 #include <sofa/core/behavior/ForceField.h>
 #include <sofa/core/behavior/MechanicalState.h>
 #include <SofaSphFluid/SpatialGridContainer.h>
+#include <SofaSphFluid/SortedCellGrid.h>
 #include <SofaSphFluid/SPHKernel.h>
 #include <sofa/helper/rmath.h>
 #include <vector>
@@ -84,7 +85,7 @@ protected:
         Real pressure;
         Deriv normal;
         Real curvature;
-        sofa::helper::vector< std::pair<int,Real> > neighbors; ///< indice + r/h
+        sofa::helper::vector< std::pair<int,Real> > neighbors; ///< indice + r/h, of all the neighbors of the particle
         sofa::helper::vector< std::pair<int,Real> > neighbors2; ///< indice + r/h
     };
 
@@ -93,8 +94,12 @@ protected:
 
     typedef sofa::component::container::SpatialGridContainer<DataTypes> Grid;
 
+    /// Optional container, only used to renumber the particles in cell order (see SpatialGridContainer::sortPoints)
     Grid* m_grid;
 
+    /// Particles sorted by cell, rebuilt at each neighbor search
+    sofa::component::container::SortedCellGrid<DataTypes> m_sortedGrid;
+
     SPHFluidForceFieldInternalData<DataTypes> data;
     friend class SPHFluidForceFieldInternalData<DataTypes>;
 
@@ -103,10 +108,8 @@ public:
     void addNeighbor(int i1, int i2, Real r2, Real h2)
     {
         Real r_h = (Real)sqrt(r2/h2);
-        if (i1<i2)
-            m_particles[i1].neighbors.push_back(std::make_pair(i2,r_h));
-        else
-            m_particles[i2].neighbors.push_back(std::make_pair(i1,r_h));
+        m_particles[i1].neighbors.push_back(std::make_pair(i2,r_h));
+        m_particles[i2].neighbors.push_back(std::make_pair(i1,r_h));
     }
 
 protected:
@@ -189,6 +192,11 @@ protected:
     void computeNeighbors(const core::MechanicalParams* mparams, const DataVecCoord& d_x, const DataVecDeriv& d_v);
     template<class Kd, class Kp, class Kv, class Kc>
     void computeForce(const core::MechanicalParams* mparams, DataVecDeriv& d_f, const DataVecCoord& d_x, const DataVecDeriv& d_v);
+
+    /// Call f on each element of the container, in parallel when the standard parallel algorithms are available.
+    /// f must only write data owned by its element.
+    template<class Container, class F>
+    static void parallelForEach(Container& c, F f);
 };
 
 #if  !defined(SOFA_COMPONENT_FORCEFIELD_SPHFLUIDFORCEFIELD_CPP)
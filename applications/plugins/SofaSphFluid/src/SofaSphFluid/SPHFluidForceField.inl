@@ -76,7 +76,7 @@ void SPHFluidForceField<DataTypes>::init()
 
     this->getContext()->get(m_grid); //new Grid(d_particleRadius.getValue());
     if (m_grid==nullptr)
-        msg_error() << "SpatialGridContainer not found by SPHFluidForceField, slow O(n2) method will be used !!!";
+        msg_info() << "No SpatialGridContainer found, the particles will not be renumbered in cell order.";
 
     size_t n = this->mstate->getSize();
     m_particles.resize(n);
@@ -134,6 +134,17 @@ void SPHFluidForceField<DataTypes>::addForce(const core::MechanicalParams* mpara
 }
 
 
+template<class DataTypes> template<class Container, class F>
+void SPHFluidForceField<DataTypes>::parallelForEach(Container& c, F f)
+{
+#if __has_include(<execution>) && !defined(__APPLE__)
+    std::for_each(std::execution::par, c.begin(), c.end(), f);
+#else
+    std::for_each(c.begin(), c.end(), f);
+#endif
+}
+
+
 template<class DataTypes>
 void SPHFluidForceField<DataTypes>::computeNeighbors(const core::MechanicalParams* /*mparams*/, const DataVecCoord& d_x, const DataVecDeriv& /*d_v*/)
 {
@@ -144,106 +155,74 @@ void SPHFluidForceField<DataTypes>::computeNeighbors(const core::MechanicalParam
 
     size_t n = x.size();
     m_particles.resize(n);
-    for (size_t i=0; i<n; i++) {
-        m_particles[i].neighbors.clear();
-    }
 
     // First compute the neighbors
-    // This is an O(n2) step, except if a hash-grid is used to optimize it
-    if (m_grid == nullptr)
+    // The particles are sorted by cell of size h, so that only the 3^d cells around each
+    // particle are scanned. Each particle stores all its neighbors, and the particles are
+    // processed in cell order so that concurrent tasks read neighboring memory.
+    m_sortedGrid.build(x.ref(), h);
+    const helper::vector<sofa::Index>& sorted = m_sortedGrid.getSortedIndices();
+    parallelForEach(sorted, [&](const sofa::Index& i)
     {
-#if __has_include(<execution>) && !defined(__APPLE__)
-        std::for_each(std::execution::par, x.begin(), x.end(), [&](const auto& ri)
+        const size_t s = &i - &sorted[0]; // only possible with vector, etc.
+        auto& neighbors = m_particles[i].neighbors;
+        neighbors.clear();
+        m_sortedGrid.forEachNeighbor(s, h2, [&](sofa::Index j, Real r2)
         {
-            auto i = &ri - &x[0]; // only possible with vector, etc.
+            neighbors.push_back(std::make_pair(int(j), (Real)sqrt(r2 / h2)));
+        });
+    });
 
-            for (size_t j = i + 1; j<n; j++)
-            {
-                const Coord& rj = x[j];
-                Real r2 = (rj - ri).norm2();
-                if (r2 < h2)
-                {
-                    Real r_h = (Real)sqrt(r2 / h2);
-                    m_particles[i].neighbors.push_back(std::make_pair(j, r_h));
-                }
-            }
+    if (!d_debugGrid.getValue())
+        return;
 
-        });
-#else
-        for (size_t i = 0; i<n; i++)
+    // Check grid info
+    parallelForEach(m_particles, [&](Particle& Pi)
+    {
+        const size_t i = &Pi - &m_particles[0];
+        const Coord& ri = x[i];
+        Pi.neighbors2.clear();
+        for (size_t j=0; j<n; j++)
         {
-            const Coord& ri = x[i];
-            for (size_t j = i + 1; j<n; j++)
+            if (j == i)
+                continue;
+            const Coord& rj = x[j];
+            Real r2 = (rj-ri).norm2();
+            if (r2 < h2)
             {
-                const Coord& rj = x[j];
-                Real r2 = (rj - ri).norm2();
-                if (r2 < h2)
-                {
-                    Real r_h = (Real)sqrt(r2 / h2);
-                    m_particles[i].neighbors.push_back(std::make_pair(j, r_h));
-                    //m_particles[j].neighbors.push_back(std::make_pair(i,r_h));
-                }
+                Real r_h = (Real)sqrt(r2/h2);
+                Pi.neighbors2.push_back(std::make_pair(int(j),r_h));
             }
         }
-#endif
-    }
-    else
+    });
+    for (size_t i=0; i<n; i++)
     {
-        m_grid->updateGrid(x.ref());
-        m_grid->findNeighbors(this, h);
-
-        if (!d_debugGrid.getValue())
-            return;
-
-        for (size_t i = 0; i < n; i++) {
-            m_particles[i].neighbors2.clear();
-        }
-
-        // Check grid info
-        for (size_t i=0; i<n; i++)
+        if (m_particles[i].neighbors.size() != m_particles[i].neighbors2.size())
         {
-            const Coord& ri = x[i];
-            for (size_t j=i+1; j<n; j++)
+            msg_error() << "particle "<<i<<" "<< x[i] <<" : "<<m_particles[i].neighbors.size()<<" neighbors on grid, "<< m_particles[i].neighbors2.size() << " neighbors on bruteforce.";
+            msg_error() << "grid-only neighbors:";
+            for (unsigned int j=0; j<m_particles[i].neighbors.size(); j++)
             {
-                const Coord& rj = x[j];
-                Real r2 = (rj-ri).norm2();
-                if (r2 < h2)
-                {
-                    Real r_h = (Real)sqrt(r2/h2);
-                    m_particles[i].neighbors2.push_back(std::make_pair(j,r_h));
-                }
+                int index = m_particles[i].neighbors[j].first;
+                unsigned int j2 = 0;
+                while (j2 < m_particles[i].neighbors2.size() && m_particles[i].neighbors2[j2].first != index)
+                    ++j2;
+                if (j2 == m_particles[i].neighbors2.size())
+                    msg_error() << " "<< x[index] << "<"<< m_particles[i].neighbors[j].first<<","<<m_particles[i].neighbors[j].second<<">";
             }
-        }
-        for (size_t i=0; i<n; i++)
-        {
-            if (m_particles[i].neighbors.size() != m_particles[i].neighbors2.size())
+            msg_error() << "";
+            msg_error() << "bruteforce-only neighbors:";
+            for (unsigned int j=0; j<m_particles[i].neighbors2.size(); j++)
             {
-                msg_error() << "particle "<<i<<" "<< x[i] <<" : "<<m_particles[i].neighbors.size()<<" neighbors on grid, "<< m_particles[i].neighbors2.size() << " neighbors on bruteforce.";
-                msg_error() << "grid-only neighbors:";
-                for (unsigned int j=0; j<m_particles[i].neighbors.size(); j++)
-                {
-                    int index = m_particles[i].neighbors[j].first;
-                    unsigned int j2 = 0;
-                    while (j2 < m_particles[i].neighbors2.size() && m_particles[i].neighbors2[j2].first != index)
-                        ++j2;
-                    if (j2 == m_particles[i].neighbors2.size())
-                        msg_error() << " "<< x[index] << "<"<< m_particles[i].neighbors[j].first<<","<<m_particles[i].neighbors[j].second<<">";
-                }
-                msg_error() << "";
-                msg_error() << "bruteforce-only neighbors:";
-                for (unsigned int j=0; j<m_particles[i].neighbors2.size(); j++)
-                {
-                    int index = m_particles[i].neighbors2[j].first;
-                    unsigned int j2 = 0;
-                    while (j2 < m_particles[i].neighbors.size() && m_particles[i].neighbors[j2].first != index)
-                        ++j2;
-                    if (j2 == m_particles[i].neighbors.size())
-                        msg_error() << " "<< x[index] << "<"<< m_particles[i].neighbors2[j].first<<","<<m_particles[i].neighbors2[j].second<<">";
-                }
-                msg_error() << "";
+                int index = m_particles[i].neighbors2[j].first;
+                unsigned int j2 = 0;
+                while (j2 < m_particles[i].neighbors.size() && m_particles[i].neighbors[j2].first != index)
+                    ++j2;
+                if (j2 == m_particles[i].neighbors.size())
+                    msg_error() << " "<< x[index] << "<"<< m_particles[i].neighbors2[j].first<<","<<m_particles[i].neighbors2[j].second<<">";
             }
+            msg_error() << "";
         }
-
     }
 }
 
@@ -276,73 +255,69 @@ void SPHFluidForceField<DataTypes>::computeForce(const core::MechanicalParams* /
     dforces.clear();
     //int n0 = m_particles.size();
     m_particles.resize(n);
-    for (size_t i=0; i<n; i++)
-    {
-        m_particles[i].density = 0;
-        m_particles[i].pressure = 0;
-        m_particles[i].normal.clear();
-        m_particles[i].curvature = 0;
-    }
 
     TKd Kd(h);
     TKp Kp(h);
     TKv Kv(h);
     TKc Kc(h);
 
+    // Each particle stores all its neighbors, so every pass below only writes the
+    // values of its own particle and runs in parallel.
+
     // Compute density and pressure
-    for (size_t i=0; i<n; i++)
+    parallelForEach(m_particles, [&](Particle& Pi)
     {
-        Particle& Pi = m_particles[i];
-        Real density = Pi.density;
+        Real density = m*Kd.W(0); // density from current particle
 
-        density += m*Kd.W(0); // density from current particle
-
-        for (typename std::vector< std::pair<int,Real> >::const_iterator it = Pi.neighbors.begin(); it != Pi.neighbors.end(); ++it)
+        for (const auto& neighbor : Pi.neighbors)
         {
-            const int j = it->first;
-            const Real r_h = it->second;
-            Particle& Pj = m_particles[j];
-            Real d = m*Kd.W(r_h);
-            density += d;
-            Pj.density += d;
-
+            density += m*Kd.W(neighbor.second);
         }
         Pi.density = density;
         Pi.pressure = k*(density - d0);
-    }
+    });
 
     // Compute surface normal and curvature
     if (surfaceTensionT == 1)
     {
-        for (size_t i=0; i<n; i++)
+        parallelForEach(m_particles, [&](Particle& Pi)
         {
-            Particle& Pi = m_particles[i];
-            for (typename std::vector< std::pair<int,Real> >::const_iterator it = Pi.neighbors.begin(); it != Pi.neighbors.end(); ++it)
+            const size_t i = &Pi - &m_particles[0];
+            Deriv normal;
+            Real curvature = 0;
+            for (const auto& neighbor : Pi.neighbors)
             {
-                const int j = it->first;
-                const Real r_h = it->second;
-                Particle& Pj = m_particles[j];
-                Deriv n = Kc.gradW(x[i]-x[j],r_h) * (m / Pj.density - m / Pi.density);
-                Pi.normal += n;
-                Pj.normal -= n;
-                Real c = Kc.laplacianW(r_h) * (m / Pj.density - m / Pi.density);
-                Pi.curvature += c;
-                Pj.curvature -= c;
+                const int j = neighbor.first;
+                const Real r_h = neighbor.second;
+                const Particle& Pj = m_particles[j];
+                normal += Kc.gradW(x[i]-x[j],r_h) * (m / Pj.density - m / Pi.density);
+                curvature += Kc.laplacianW(r_h) * (m / Pj.density - m / Pi.density);
             }
+            Pi.normal = normal;
+            Pi.curvature = curvature;
+        });
+    }
+    else
+    {
+        for (Particle& Pi : m_particles)
+        {
+            Pi.normal.clear();
+            Pi.curvature = 0;
         }
     }
 
     // Compute the forces
-    for (size_t i = 0; i < n; i++)
+    parallelForEach(m_particles, [&](const Particle& Pi)
     {
-        const Particle& Pi = m_particles[i];
+        const size_t i = &Pi - &m_particles[0];
+        Deriv fi;
         // Gravity
-        //f[i] += g*(m*Pi.density);
-        
-        for (auto it = Pi.neighbors.begin(); it != Pi.neighbors.end(); ++it)
+        //fi += g*(m*Pi.density);
+
+        for (const auto& neighbor : Pi.neighbors)
         {
-            const int j = it->first;
-            const Real r_h = it->second;
+            const int j = neighbor.first;
+            const Real r_h = neighbor.second;
             const Particle& Pj = m_particles[j];
             // Pressure
 
@@ -354,9 +329,7 @@ void SPHFluidForceField<DataTypes>::computeForce(const core::MechanicalParams* /
             case 0: break;
             case 1:
             {
-                Deriv fd_viscosity = ( v[j] - v[i] ) * ( m2 * viscosity / (Pi.density * Pj.density) * Kv.laplacianW(r_h) );
-                f[i] += fd_viscosity;
-                f[j] -= fd_viscosity;
+                fi += ( v[j] - v[i] ) * ( m2 * viscosity / (Pi.density * Pj.density) * Kv.laplacianW(r_h) );
                 break;
             }
             case 2:
@@ -372,10 +345,7 @@ void SPHFluidForceField<DataTypes>::computeForce(const core::MechanicalParams* /
                 break;
             }
 
-            Deriv fpressure = Kp.gradW(x[i]-x[j],r_h) * pressureFV;
-            f[i] += fpressure;
-            f[j] -= fpressure;
-
+            fi += Kp.gradW(x[i]-x[j],r_h) * pressureFV;
         }
 
         switch(surfaceTensionT)
@@ -383,11 +353,10 @@ void SPHFluidForceField<DataTypes>::computeForce(const core::MechanicalParams* /
         case 0: break;
         case 1:
         {
-            Real n = Pi.normal.norm();
-            if (n > 0.000001)
+            Real nn = Pi.normal.norm();
+            if (nn > 0.000001)
             {
-                Deriv fsurface = Pi.normal * ( - m * surfaceTension * Pi.curvature / n );
-                f[i] += fsurface;
+                fi += Pi.normal * ( - m * surfaceTension * Pi.curvature / nn );
             }
             break;
         }
@@ -398,7 +367,9 @@ void SPHFluidForceField<DataTypes>::computeForce(const core::MechanicalParams* /
         default:
             break;
         }
-    }
+
+        f[i] += fi;
+    });
 }
 
 
@@ -500,6 +471,8 @@ void SPHFluidForceField<DataTypes>::draw(const core::visual::VisualParams* vpara
             for (typename std::vector< std::pair<int, Real> >::const_iterator it = Pi.neighbors.begin(); it != Pi.neighbors.end(); ++it)
             {
                 const int j = it->first;
+                if (j < (int)i) // each pair is stored by both particles
+                    continue;
                 const float r_h = (float)it->second;
                 float f = r_h * 2;
                 if (f < 1)
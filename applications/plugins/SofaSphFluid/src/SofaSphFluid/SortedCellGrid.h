@@ -0,0 +1,215 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_COMPONENT_CONTAINER_SORTEDCELLGRID_H
+#define SOFA_COMPONENT_CONTAINER_SORTEDCELLGRID_H
+#include <SofaSphFluid/config.h>
+
+#include <sofa/defaulttype/Vec.h>
+#include <sofa/helper/vector.h>
+#include <sofa/helper/rmath.h>
+#include <algorithm>
+#include <cstdint>
+
+namespace sofa
+{
+
+namespace component
+{
+
+namespace container
+{
+
+/**
+ *  \brief Compact uniform grid storing the particles sorted by cell.
+ *
+ *  The particles are sorted by cell with a counting sort, and their positions are copied in
+ *  this order so that the particles of a cell, and of neighbor cells, are contiguous in memory.
+ *  Cells are indexed linearly over the bounding box of the particles, or with a spatial hash
+ *  when the bounding box is large compared to the number of particles, so that the memory
+ *  stays proportional to the number of particles.
+ *
+ *  Once built, the grid is read-only and the neighbors of different particles can be
+ *  searched concurrently.
+ */
+template<class DataTypes>
+class SortedCellGrid
+{
+public:
+    typedef typename DataTypes::Real Real;
+    typedef typename DataTypes::Coord Coord;
+    typedef typename DataTypes::VecCoord VecCoord;
+    using Index = sofa::Index;
+
+    enum { N = DataTypes::spatial_dimensions };
+    typedef sofa::defaulttype::Vec<N,int> CellCoord;
+
+    /// Sort the particles by cell. Neighbors can then be searched up to a distance of cellWidth.
+    void build(const VecCoord& x, Real cellWidth)
+    {
+        const std::size_t n = x.size();
+        m_sortedIndices.resize(n);
+        m_sortedPositions.resize(n);
+        m_sortedCells.resize(n);
+        m_cells.resize(n);
+        m_buckets.resize(n);
+        if (n == 0)
+        {
+            m_cellStart.assign(1, 0);
+            return;
+        }
+
+        const Real invCellWidth = 1 / cellWidth;
+        CellCoord cmin, cmax;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            CellCoord& c = m_cells[i];
+            for (int d = 0; d < N; ++d)
+                c[d] = sofa::helper::rfloor(x[i][d] * invCellWidth);
+            if (i == 0)
+            {
+                cmin = c;
+                cmax = c;
+            }
+            for (int d = 0; d < N; ++d)
+            {
+                cmin[d] = std::min(cmin[d], c[d]);
+                cmax[d] = std::max(cmax[d], c[d]);
+            }
+        }
+
+        /// one more cell on each side, so that the neighbors of all the cells are in the box
+        double nbCells = 1;
+        for (int d = 0; d < N; ++d)
+        {
+            m_min[d] = cmin[d] - 1;
+            m_dims[d] = cmax[d] - cmin[d] + 3;
+            nbCells *= m_dims[d];
+        }
+        m_hashed = nbCells > double(8 * n + 64);
+        std::size_t nbBuckets = std::size_t(nbCells);
+        if (m_hashed)
+        {
+            nbBuckets = 64;
+            while (nbBuckets < 2 * n)
+                nbBuckets *= 2;
+        }
+
+        /// counting sort
+        m_cellStart.assign(nbBuckets + 1, 0);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            m_buckets[i] = Index(bucket(m_cells[i]));
+            ++m_cellStart[m_buckets[i] + 1];
+        }
+        for (std::size_t b = 0; b < nbBuckets; ++b)
+            m_cellStart[b + 1] += m_cellStart[b];
+
+        m_cursor.assign(m_cellStart.begin(), m_cellStart.end() - 1);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            const Index s = m_cursor[m_buckets[i]]++;
+            m_sortedIndices[s] = Index(i);
+            m_sortedPositions[s] = x[i];
+            m_sortedCells[s] = m_cells[i];
+        }
+    }
+
+    /// Particle indices, in cell order
+    const helper::vector<Index>& getSortedIndices() const { return m_sortedIndices; }
+
+    /// True if the cells are indexed with the spatial hash instead of the bounding box
+    bool isHashed() const { return m_hashed; }
+
+    /// Call f(j, r2) for every particle j, other than the particle at the given position in the
+    /// sorted order, whose squared distance r2 is lower than dist2. dist2 must not be larger
+    /// than the squared cell width.
+    template<class F>
+    void forEachNeighbor(std::size_t sorted, Real dist2, F f) const
+    {
+        const Coord& p = m_sortedPositions[sorted];
+        const CellCoord& c = m_sortedCells[sorted];
+
+        int nbOffsets = 1;
+        for (int d = 0; d < N; ++d)
+            nbOffsets *= 3;
+
+        for (int o = 0; o < nbOffsets; ++o)
+        {
+            CellCoord cn = c;
+            for (int d = 0, code = o; d < N; ++d, code /= 3)
+                cn[d] += code % 3 - 1;
+
+            const std::size_t b = bucket(cn);
+            for (Index k = m_cellStart[b], end = m_cellStart[b + 1]; k < end; ++k)
+            {
+                if (k == sorted)
+                    continue;
+                /// different cells share the same bucket with the spatial hash
+                if (m_hashed && !(m_sortedCells[k] == cn))
+                    continue;
+                const Real r2 = (m_sortedPositions[k] - p).norm2();
+                if (r2 < dist2)
+                    f(m_sortedIndices[k], r2);
+            }
+        }
+    }
+
+protected:
+    std::size_t bucket(const CellCoord& c) const
+    {
+        if (m_hashed)
+        {
+            static const std::uint32_t primes[3] = { 73856093u, 19349663u, 83492791u };
+            std::uint32_t h = 0;
+            for (int d = 0; d < N; ++d)
+                h ^= std::uint32_t(c[d]) * primes[d % 3];
+            return std::size_t(h) & (m_cellStart.size() - 2);
+        }
+        std::size_t b = 0;
+        for (int d = N - 1; d >= 0; --d)
+            b = b * std::size_t(m_dims[d]) + std::size_t(c[d] - m_min[d]);
+        return b;
+    }
+
+    helper::vector<Index> m_sortedIndices;
+    helper::vector<Coord> m_sortedPositions;
+    helper::vector<CellCoord> m_sortedCells;
+    /// first sorted particle of each bucket, followed by the total number of particles
+    helper::vector<Index> m_cellStart;
+
+    /// temporaries of build()
+    helper::vector<CellCoord> m_cells;
+    helper::vector<Index> m_buckets;
+    helper::vector<Index> m_cursor;
+
+    CellCoord m_min;
+    CellCoord m_dims;
+    bool m_hashed {false};
+};
+
+} // namespace container
+
+} // namespace component
+
+} // namespace sofa
+
+#endif
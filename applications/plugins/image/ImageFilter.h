@@ -24,11 +24,14 @@
 
 #include <image/config.h>
 #include "ImageTypes.h"
+#include "ImageTiling.h"
 #include <sofa/core/DataEngine.h>
 #include <sofa/core/objectmodel/BaseObject.h>
 #include <sofa/defaulttype/Vec.h>
 #include <sofa/helper/rmath.h>
 #include <sofa/helper/OptionsGroup.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/simulation/InitTasks.h>
 
 #define NONE 0
 #define BLURDERICHE 1
@@ -111,6 +114,9 @@ public:
     Data< OutImageTypes > outputImage;
     Data< TransformType > outputTransform;
 
+    Data< bool > d_parallel; ///< Process the image in bricks concurrently with the task scheduler
+    Data< unsigned int > d_tileSize; ///< Size of the bricks in voxels
+
     ImageFilter()    :   Inherited()
       , filter ( initData ( &filter,"filter","Filter" ) )
       , param ( initData ( &param,"param","Parameters" ) )
@@ -118,6 +124,9 @@ public:
       , inputTransform(initData(&inputTransform,TransformType(),"inputTransform",""))
       , outputImage(initData(&outputImage,OutImageTypes(),"outputImage",""))
       , outputTransform(initData(&outputTransform,TransformType(),"outputTransform",""))
+      , d_parallel(initData(&d_parallel,false,"parallel","Process the image in bricks concurrently with the task scheduler (Dilate, Erode, Threshold, Laplacian, Gradient, Hessian, Resample). Same result as the whole image processing"))
+      , d_tileSize(initData(&d_tileSize,(unsigned int)32,"tileSize","Size of the bricks in voxels, in parallel mode"))
+      , m_taskScheduler(NULL)
     {
         inputImage.setReadOnly(true);
         inputTransform.setReadOnly(true);
@@ -166,6 +175,17 @@ public:
         addInput(&inputTransform);
         addOutput(&outputImage);
         addOutput(&outputTransform);
+
+        if(d_parallel.getValue())
+        {
+            m_taskScheduler = simulation::TaskScheduler::getInstance();
+            if(m_taskScheduler->getThreadCount() < 1)
+            {
+                m_taskScheduler->init(0);
+                simulation::initThreadLocalData();
+            }
+        }
+
         setDirtyValue();
     }
 
@@ -173,6 +193,8 @@ public:
 
 protected:
 
+    simulation::TaskScheduler* m_taskScheduler;
+
     void doUpdate() override
     {
         bool updateImage = m_dataTracker.hasChanged(this->inputImage);	// change of input image -> update output image
@@ -193,6 +215,10 @@ protected:
         if(updateImage) img.assign(inimg);	// copy
         if(updateTransform) outT->operator=(inT);	// copy
 
+        // brick processing
+        const bool tiled = this->d_parallel.getValue();
+        const unsigned int tileSize = this->d_tileSize.getValue();
+
         switch(this->filter.getValue().getSelectedId())
         {
         case BLURDERICHE:
@@ -303,14 +329,16 @@ protected:
             if(updateImage)
             {
                 unsigned int size=0; if(p.size()) size=(unsigned int)p[0];
-                cimglist_for(img,l) img(l)=inimg(l).get_dilate (size);
+                if(tiled) cimglist_for(img,l) tiledFilter(img(l),inimg(l),tileSize,size,m_taskScheduler,[size](const cimg_library::CImg<Ti>& im) { return im.get_dilate (size); });
+                else cimglist_for(img,l) img(l)=inimg(l).get_dilate (size);
             }
             break;
         case ERODE:
             if(updateImage)
             {
                 unsigned int size=0; if(p.size()) size=(unsigned int)p[0];
-                cimglist_for(img,l) img(l)=inimg(l).get_erode (size);
+                if(tiled) cimglist_for(img,l) tiledFilter(img(l),inimg(l),tileSize,size,m_taskScheduler,[size](const cimg_library::CImg<Ti>& im) { return im.get_erode (size); });
+                else cimglist_for(img,l) img(l)=inimg(l).get_erode (size);
             }
             break;
         case NOISE:
@@ -335,17 +363,27 @@ protected:
                 Ti valuemax=cimg_library::cimg::type<Ti>::max(); if(p.size()>1) valuemax=(Ti)p[1];
 
                 cimglist_for(img,l)
-                        cimg_forXYZ(img(l),x,y,z)
                 {
-                    if(inimg(l)(x,y,z)>=valuemin && inimg(l)(x,y,z)<=valuemax) img(l)(x,y,z)=(To)1;
-                    else img(l)(x,y,z)=(To)0;
+                    const cimg_library::CImg<Ti>& im = inimg(l);
+                    cimg_library::CImg<To>& res = img(l);
+                    auto threshold = [&](const ImageTile& t)
+                    {
+                        for(int z=t.z0; z<=t.z1; ++z) for(int y=t.y0; y<=t.y1; ++y) for(int x=t.x0; x<=t.x1; ++x)
+                        {
+                            if(im(x,y,z)>=valuemin && im(x,y,z)<=valuemax) res(x,y,z)=(To)1;
+                            else res(x,y,z)=(To)0;
+                        }
+                    };
+                    if(tiled) forEachImageTile(res,tileSize,m_taskScheduler,threshold);
+                    else threshold(ImageTile{0,0,0,res.width()-1,res.height()-1,res.depth()-1});
                 }
             }
             break;
         case LAPLACIAN:
             if(updateImage)
             {
-                cimglist_for(img,l) img(l)=inimg(l).get_laplacian ();
+                if(tiled) cimglist_for(img,l) tiledFilter(img(l),inimg(l),tileSize,1,m_taskScheduler,[](const cimg_library::CImg<Ti>& im) { return im.get_laplacian (); });
+                else cimglist_for(img,l) img(l)=inimg(l).get_laplacian ();
             }
             break;
         case STENSOR:
@@ -379,22 +417,26 @@ protected:
             {
                 char axis='a';  if(p.size()) { if((int)p[0]==0) axis='x'; else if((int)p[0]==1) axis='y'; else if((int)p[0]==2) axis='z'; }
 
-                CImg_3x3x3(I,To);
-                cimglist_for(img,l)
+                auto gradient = [&](const cimg_library::CImg<Ti>& im)
                 {
-                    To *ptrd = img(l)._data;
+                    cimg_library::CImg<To> res(im.width(),im.height(),im.depth(),im.spectrum());
+                    CImg_3x3x3(I,To);
+                    To *ptrd = res._data;
                     // Central finite differences.
-                    if(axis=='x') cimg_forC(inimg(l),c) cimg_for3x3x3(inimg(l),x,y,z,c,I,To)      *(ptrd++) = (Incc - Ipcc)*(To)0.5/(To)inT->getScale()[0];
-                    else if(axis=='y') cimg_forC(inimg(l),c) cimg_for3x3x3(inimg(l),x,y,z,c,I,To) *(ptrd++) = (Icnc - Icpc)*(To)0.5/(To)inT->getScale()[1];
-                    else if(axis=='z') cimg_forC(inimg(l),c) cimg_for3x3x3(inimg(l),x,y,z,c,I,To) *(ptrd++) = (Iccn - Iccp)*(To)0.5/(To)inT->getScale()[2];
-                    else  cimg_forC(inimg(l),c) cimg_for3x3x3(inimg(l),x,y,z,c,I,To)
+                    if(axis=='x') cimg_forC(im,c) cimg_for3x3x3(im,x,y,z,c,I,To)      *(ptrd++) = (Incc - Ipcc)*(To)0.5/(To)inT->getScale()[0];
+                    else if(axis=='y') cimg_forC(im,c) cimg_for3x3x3(im,x,y,z,c,I,To) *(ptrd++) = (Icnc - Icpc)*(To)0.5/(To)inT->getScale()[1];
+                    else if(axis=='z') cimg_forC(im,c) cimg_for3x3x3(im,x,y,z,c,I,To) *(ptrd++) = (Iccn - Iccp)*(To)0.5/(To)inT->getScale()[2];
+                    else  cimg_forC(im,c) cimg_for3x3x3(im,x,y,z,c,I,To)
                     {
                         To ix = (Incc - Ipcc)*(To)0.5/(To)inT->getScale()[0];
                         To iy = (Icnc - Icpc)*(To)0.5/(To)inT->getScale()[1];
                         To iz = (Iccn - Iccp)*(To)0.5/(To)inT->getScale()[2];
                         *(ptrd++) = (To)sqrt( (SReal) ix*ix+iy*iy+iz*iz);
                     }
-                }
+                    return res;
+                };
+                if(tiled) cimglist_for(img,l) tiledFilter(img(l),inimg(l),tileSize,1,m_taskScheduler,gradient);
+                else cimglist_for(img,l) img(l)=gradient(inimg(l));
             }
             break;
         case HESSIAN:
@@ -403,18 +445,22 @@ protected:
                 char axis1='x';  if(p.size()) { if((int)p[0]==1) axis1='y'; else if((int)p[0]==2) axis1='z'; }
                 char axis2='x';  if(p.size()>1) { if((int)p[1]==1) axis2='y'; else if((int)p[1]==2) axis2='z'; }
                 if (axis1>axis2) cimg_library::cimg::swap(axis1,axis2);
-                CImg_3x3x3(I,To);
-                cimglist_for(img,l)
+                auto hessian = [&](const cimg_library::CImg<Ti>& im)
                 {
-                    To *ptrd = img(l)._data;
+                    cimg_library::CImg<To> res(im.width(),im.height(),im.depth(),im.spectrum());
+                    CImg_3x3x3(I,To);
+                    To *ptrd = res._data;
                     // Central finite differences.
-                    if(axis1=='x' && axis2=='x') cimg_forC(inimg(l),c) cimg_for3x3x3(inimg(l),x,y,z,c,I,To)  *(ptrd++) = (Ipcc + Incc - 2*Iccc)              /(To)(inT->getScale()[0]*inT->getScale()[0]);
-                    else if(axis1=='x' && axis2=='y') cimg_forC(inimg(l),c) cimg_for3x3x3(inimg(l),x,y,z,c,I,To)  *(ptrd++) = (Ippc + Innc - Ipnc - Inpc)*(To)0.25/(To)(inT->getScale()[0]*inT->getScale()[1]);
-                    else if(axis1=='x' && axis2=='z') cimg_forC(inimg(l),c) cimg_for3x3x3(inimg(l),x,y,z,c,I,To)  *(ptrd++) = (Ipcp + Incn - Ipcn - Incp)*(To)0.25/(To)(inT->getScale()[0]*inT->getScale()[2]);
-                    else if(axis1=='y' && axis2=='y') cimg_forC(inimg(l),c) cimg_for3x3x3(inimg(l),x,y,z,c,I,To)  *(ptrd++) = (Icpc + Icnc - 2*Iccc)              /(To)(inT->getScale()[1]*inT->getScale()[1]);
-                    else if(axis1=='y' && axis2=='z') cimg_forC(inimg(l),c) cimg_for3x3x3(inimg(l),x,y,z,c,I,To)  *(ptrd++) = (Icpp + Icnn - Icpn - Icnp)*(To)0.25/(To)(inT->getScale()[1]*inT->getScale()[2]);
-                    else if(axis1=='z' && axis2=='z') cimg_forC(inimg(l),c) cimg_for3x3x3(inimg(l),x,y,z,c,I,To)  *(ptrd++) = (Iccn + Iccp - 2*Iccc)              /(To)(inT->getScale()[2]*inT->getScale()[2]);
-                }
+                    if(axis1=='x' && axis2=='x') cimg_forC(im,c) cimg_for3x3x3(im,x,y,z,c,I,To)  *(ptrd++) = (Ipcc + Incc - 2*Iccc)              /(To)(inT->getScale()[0]*inT->getScale()[0]);
+                    else if(axis1=='x' && axis2=='y') cimg_forC(im,c) cimg_for3x3x3(im,x,y,z,c,I,To)  *(ptrd++) = (Ippc + Innc - Ipnc - Inpc)*(To)0.25/(To)(inT->getScale()[0]*inT->getScale()[1]);
+                    else if(axis1=='x' && axis2=='z') cimg_forC(im,c) cimg_for3x3x3(im,x,y,z,c,I,To)  *(ptrd++) = (Ipcp + Incn - Ipcn - Incp)*(To)0.25/(To)(inT->getScale()[0]*inT->getScale()[2]);
+                    else if(axis1=='y' && axis2=='y') cimg_forC(im,c) cimg_for3x3x3(im,x,y,z,c,I,To)  *(ptrd++) = (Icpc + Icnc - 2*Iccc)              /(To)(inT->getScale()[1]*inT->getScale()[1]);
+                    else if(axis1=='y' && axis2=='z') cimg_forC(im,c) cimg_for3x3x3(im,x,y,z,c,I,To)  *(ptrd++) = (Icpp + Icnn - Icpn - Icnp)*(To)0.25/(To)(inT->getScale()[1]*inT->getScale()[2]);
+                    else if(axis1=='z' && axis2=='z') cimg_forC(im,c) cimg_for3x3x3(im,x,y,z,c,I,To)  *(ptrd++) = (Iccn + Iccp - 2*Iccc)              /(To)(inT->getScale()[2]*inT->getScale()[2]);
+                    return res;
+                };
+                if(tiled) cimglist_for(img,l) tiledFilter(img(l),inimg(l),tileSize,1,m_taskScheduler,hessian);
+                else cimglist_for(img,l) img(l)=hessian(inimg(l));
             }
             break;
 
@@ -457,18 +503,23 @@ protected:
                 cimglist_for(img,l)
                 {
                     img(l).resize(dimx,dimy,dimz,nbc);
-                    cimg_forXYZ(img(l),x,y,z)
+                    auto resample = [&](const ImageTile& t)
                     {
-                        Coord p=inT->toImage(outT->fromImage(Coord(x,y,z)));
-                        if(p[0]<-0.5 || p[1]<-0.5 || p[2]<-0.5 || p[0]>inimg(l).width()-0.5 || p[1]>inimg(l).height()-0.5 || p[2]>inimg(l).depth()-0.5)
-                            for(unsigned int k=0; k<nbc; k++) img(l)(x,y,z,k) = OutValue;
-                        else
+                        for(int z=t.z0; z<=t.z1; ++z) for(int y=t.y0; y<=t.y1; ++y) for(int x=t.x0; x<=t.x1; ++x)
                         {
-                            if(interpolation==0) for(unsigned int k=0; k<nbc; k++) img(l)(x,y,z,k) = (To) inimg(l).atXYZ(sofa::helper::round((double)p[0]),sofa::helper::round((double)p[1]),sofa::helper::round((double)p[2]),k);
-                            else if(interpolation==1) for(unsigned int k=0; k<nbc; k++) img(l)(x,y,z,k) = (To) inimg(l).linear_atXYZ(p[0],p[1],p[2],k,OutValue);
-                            else if(interpolation==2) for(unsigned int k=0; k<nbc; k++) img(l)(x,y,z,k) = (To) inimg(l).cubic_atXYZ(p[0],p[1],p[2],k,OutValue,cimg_library::cimg::type<Ti>::min(),cimg_library::cimg::type<Ti>::max());
+                            Coord p=inT->toImage(outT->fromImage(Coord(x,y,z)));
+                            if(p[0]<-0.5 || p[1]<-0.5 || p[2]<-0.5 || p[0]>inimg(l).width()-0.5 || p[1]>inimg(l).height()-0.5 || p[2]>inimg(l).depth()-0.5)
+                                for(unsigned int k=0; k<nbc; k++) img(l)(x,y,z,k) = OutValue;
+                            else
+                            {
+                                if(interpolation==0) for(unsigned int k=0; k<nbc; k++) img(l)(x,y,z,k) = (To) inimg(l).atXYZ(sofa::helper::round((double)p[0]),sofa::helper::round((double)p[1]),sofa::helper::round((double)p[2]),k);
+                                else if(interpolation==1) for(unsigned int k=0; k<nbc; k++) img(l)(x,y,z,k) = (To) inimg(l).linear_atXYZ(p[0],p[1],p[2],k,OutValue);
+                                else if(interpolation==2) for(unsigned int k=0; k<nbc; k++) img(l)(x,y,z,k) = (To) inimg(l).cubic_atXYZ(p[0],p[1],p[2],k,OutValue,cimg_library::cimg::type<Ti>::min(),cimg_library::cimg::type<Ti>::max());
+                            }
                         }
-                    }
+                    };
+                    if(tiled) forEachImageTile(img(l),tileSize,m_taskScheduler,resample);
+                    else resample(ImageTile{0,0,0,img(l).width()-1,img(l).height()-1,img(l).depth()-1});
                 }
 
             }
@@ -0,0 +1,92 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+
+#ifndef IMAGE_IMAGETILING_H
+#define IMAGE_IMAGETILING_H
+
+#include <CImgPlugin/SOFACImg.h>
+#include <sofa/simulation/ParallelForEach.h>
+#include <algorithm>
+#include <vector>
+
+/**
+*  Brick of voxels [x0,x1]x[y0,y1]x[z0,z1] (inclusive bounds, as in CImg::crop)
+*/
+
+struct ImageTile
+{
+    int x0,y0,z0,x1,y1,z1;
+};
+
+/// @brief Split the spatial domain of an image in bricks of at most tileSize^3 voxels
+template<typename T>
+std::vector<ImageTile> imageTiles(const cimg_library::CImg<T>& img, const unsigned int tileSize)
+{
+    const int s = (int)std::max(tileSize,1u);
+    std::vector<ImageTile> tiles;
+    for(int z=0; z<img.depth(); z+=s) for(int y=0; y<img.height(); y+=s) for(int x=0; x<img.width(); x+=s)
+    {
+        ImageTile t;
+        t.x0=x; t.x1=std::min(x+s,img.width())-1;
+        t.y0=y; t.y1=std::min(y+s,img.height())-1;
+        t.z0=z; t.z1=std::min(z+s,img.depth())-1;
+        tiles.push_back(t);
+    }
+    return tiles;
+}
+
+/// @brief Call f(tile) on the bricks of an image, concurrently with the task scheduler (sequentially if scheduler is NULL).
+/// f must only write the voxels of its brick.
+template<typename T,typename F>
+void forEachImageTile(const cimg_library::CImg<T>& img, const unsigned int tileSize, sofa::simulation::TaskScheduler* scheduler, const F& f)
+{
+    const std::vector<ImageTile> tiles = imageTiles(img,tileSize);
+    sofa::simulation::parallelForEachRange(scheduler, 0, tiles.size(), [&](std::size_t begin, std::size_t end)
+    {
+        for(std::size_t i=begin; i<end; ++i) f(tiles[i]);
+    });
+}
+
+/// @brief Apply a neighborhood filter brick by brick: res = filter(img).
+/// Each brick is enlarged by halo voxels with replicated borders, filtered by f (CImg<Ti> -> CImg<To> of the same size),
+/// and its interior is copied to res. The result is the one of f on the whole image when each output voxel only depends on the
+/// input voxels within halo, and when f handles the image borders by replicating them (as cimg_for3x3x3, erode or dilate do).
+/// The memory overhead is one enlarged brick per thread instead of the temporaries of f on the whole image.
+template<typename To,typename Ti,typename F>
+void tiledFilter(cimg_library::CImg<To>& res, const cimg_library::CImg<Ti>& img, const unsigned int tileSize, const unsigned int halo, sofa::simulation::TaskScheduler* scheduler, const F& f)
+{
+    res.assign(img.width(),img.height(),img.depth(),img.spectrum());
+    if(img.is_empty()) return;
+
+    // no halo along flat dimensions
+    const int hx = img.width()>1?(int)halo:0, hy = img.height()>1?(int)halo:0, hz = img.depth()>1?(int)halo:0;
+
+    forEachImageTile(img, tileSize, scheduler, [&](const ImageTile& t)
+    {
+        const cimg_library::CImg<Ti> brick = img.get_crop(t.x0-hx,t.y0-hy,t.z0-hz,0,t.x1+hx,t.y1+hy,t.z1+hz,img.spectrum()-1,true);
+        const cimg_library::CImg<To> filtered = f(brick);
+        for(int c=0; c<res.spectrum(); ++c) for(int z=t.z0; z<=t.z1; ++z) for(int y=t.y0; y<=t.y1; ++y) for(int x=t.x0; x<=t.x1; ++x)
+            res(x,y,z,c) = filtered(x-t.x0+hx,y-t.y0+hy,z-t.z0+hz,c);
+    });
+}
+
+#endif // IMAGE_IMAGETILING_H
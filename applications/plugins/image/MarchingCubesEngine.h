@@ -31,9 +31,13 @@
 
 #include <sofa/core/objectmodel/Event.h>
 #include <sofa/simulation/AnimateEndEvent.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/simulation/InitTasks.h>
+#include <sofa/simulation/ParallelForEach.h>
 
 #include <sofa/defaulttype/Vec.h>
 #include <sofa/helper/gl/Texture.h>
+#include <sofa/helper/MarchingCubeSlabs.h>
 
 namespace sofa
 {
@@ -62,6 +66,7 @@ public:
     Data< defaulttype::Vec<3,unsigned int> > subdiv; ///< number of subdividions in x,y,z directions (use image dimension if =0)
     Data< bool > invertNormals; ///< invert triangle vertex order
     Data< bool > showMesh; ///< show reconstructed mesh
+    Data< bool > d_parallel; ///< Extract the isosurface by slabs concurrently with the task scheduler
 
     typedef _ImageTypes ImageTypes;
     typedef typename ImageTypes::T T;
@@ -90,11 +95,13 @@ public:
         , subdiv(initData(&subdiv,defaulttype::Vec<3,unsigned int>(0,0,0),"subdiv","number of subdividions in x,y,z directions (use image dimension if =0)"))
         , invertNormals(initData(&invertNormals,true,"invertNormals","invert triangle vertex order"))
         , showMesh(initData(&showMesh,false,"showMesh","show reconstructed mesh"))
+        , d_parallel(initData(&d_parallel,false,"parallel","Extract the isosurface by slabs concurrently with the task scheduler, when there is no subdivision. Same mesh as the sequential extraction"))
         , image(initData(&image,ImageTypes(),"image",""))
         , transform(initData(&transform,TransformType(),"transform",""))
         , position(initData(&position,SeqPositions(),"position","output positions"))
         , triangles(initData(&triangles,SeqTriangles(),"triangles","output triangles"))
         , time((unsigned int)0)
+        , m_taskScheduler(NULL)
     {
         image.setReadOnly(true);
         transform.setReadOnly(true);
@@ -107,6 +114,17 @@ public:
         addInput(&transform);
         addOutput(&position);
         addOutput(&triangles);
+
+        if(d_parallel.getValue())
+        {
+            m_taskScheduler = simulation::TaskScheduler::getInstance();
+            if(m_taskScheduler->getThreadCount() < 1)
+            {
+                m_taskScheduler->init(0);
+                simulation::initThreadLocalData();
+            }
+        }
+
         setDirtyValue();
     }
 
@@ -116,6 +134,39 @@ protected:
 
     unsigned int time;
 
+    simulation::TaskScheduler* m_taskScheduler;
+
+    /// Same mesh as CImg::get_isosurface3d at the image resolution: vertices are welded by voxel edge, and slabs of voxels along z are
+    /// polygonized concurrently then merged in order.
+    void isosurfaceSlabs(const cimg_library::CImg<T>& img, const float val, cimg_library::CImg<float>& points, cimg_library::CImgList<unsigned int>& faces) const
+    {
+        typedef defaulttype::Vec<3,int> Vec3i;
+        auto value = [&img](int x, int y, int z) { return (float)img(x,y,z); };
+        auto forEachSlab = [this](std::size_t nbSlabs, const auto& slabTask)
+        {
+            simulation::parallelForEachRange(m_taskScheduler, 0, nbSlabs, [&](std::size_t begin, std::size_t end)
+            {
+                for(std::size_t s=begin; s<end; ++s) slabTask(s);
+            });
+        };
+        const unsigned int nbThreads = m_taskScheduler ? m_taskScheduler->getThreadCount() : 1;
+
+        helper::vector<helper::MarchingCubeEdgeVertex> vertices;
+        helper::vector<defaulttype::Vec<3,unsigned int> > tri;
+        helper::marchingCubeSlabs(value, Vec3i(0,0,0), Vec3i(img.width()-1,img.height()-1,img.depth()-1), val, false, 4*nbThreads, forEachSlab, vertices, tri);
+
+        points.assign((unsigned int)vertices.size(),3);
+        for(std::size_t i=0; i<vertices.size(); ++i)
+        {
+            for(unsigned int j=0; j<3; ++j) points((unsigned int)i,j)=(float)vertices[i].p[j];
+            points((unsigned int)i,vertices[i].axis)+=vertices[i].mu;
+        }
+
+        // CImg reverses the triangles of the marching cubes table
+        faces.assign((unsigned int)tri.size());
+        for(std::size_t l=0; l<tri.size(); ++l) faces((unsigned int)l)=cimg_library::CImg<unsigned int>::vector(tri[l][0],tri[l][2],tri[l][1]);
+    }
+
     void doUpdate() override
     {
         raImage in(this->image);
@@ -133,7 +184,9 @@ protected:
 
         // marching cubes using cimg
         cimg_library::CImgList<unsigned int> faces;
-        cimg_library::CImg<float> points = img.get_shared_channel(0).get_isosurface3d (faces, val,r[0],r[1],r[2]);
+        cimg_library::CImg<float> points;
+        if(this->d_parallel.getValue() && r[0]==-100 && r[1]==-100 && r[2]==-100) isosurfaceSlabs(img.get_shared_channel(0),val,points,faces);
+        else points = img.get_shared_channel(0).get_isosurface3d (faces, val,r[0],r[1],r[2]);
 
         // update points and faces
         waPositions pos(this->position);
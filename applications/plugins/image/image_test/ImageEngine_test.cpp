@@ -272,6 +272,8 @@ TEST_F(ImageEngine_test , testImageViewer )
 #include "TestImageEngine.h"
 #include "../TransferFunction.h"
 #include "../VoronoiToMeshEngine.h"
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/simulation/InitTasks.h>
 
 
 namespace sofa {
@@ -351,4 +353,117 @@ TYPED_TEST( ImageDataEngine_test , basic_test )
     this->run_basic_test();
 }
 
+
+
+/// ImageFilter brick processing gives the same images as the whole image processing
+struct ImageFilterTiling_test : public Sofa_test<>
+{
+    typedef defaulttype::ImageD Image;
+    typedef component::engine::ImageFilter<Image,Image> Filter;
+
+    Image filter(const Image& image, unsigned int id, const std::string& param, bool parallel)
+    {
+        Filter::SPtr f = core::objectmodel::New<Filter>();
+        f->d_parallel.setValue(parallel);
+        f->d_tileSize.setValue(4);
+        f->filter.beginEdit()->setSelectedItem(id);
+        f->filter.endEdit();
+        f->param.read(param);
+        f->inputImage.setValue(image);
+        f->init();
+        return f->outputImage.getValue();
+    }
+
+    void testFilters()
+    {
+        // several threads, so that the bricks are processed concurrently
+        simulation::TaskScheduler* taskScheduler = simulation::TaskScheduler::getInstance();
+        if(taskScheduler->getThreadCount() < 2)
+        {
+            taskScheduler->init(4);
+            simulation::initThreadLocalData();
+        }
+
+        Image image;
+        image.setDimensions(Image::imCoord(11,9,7,2,1));
+        image.getCImg(0).rand(0,1);
+
+        const std::vector< std::pair<unsigned int,std::string> > filters = {
+            {DILATE,"3"}, {ERODE,"2"}, {THRESHOLD,"0.2 0.6"}, {LAPLACIAN,""}, {GRADIENT,"3"}, {HESSIAN,"0 2"},
+            {RESAMPLE,"0.3 0.2 0.1 9 8 7 0.9 1.1 1.2 1"} };
+
+        for(const auto& f : filters)
+        {
+            const Image whole = filter(image,f.first,f.second,false);
+            const Image tiled = filter(image,f.first,f.second,true);
+            ASSERT_FALSE(whole.getCImg(0).is_empty());
+            ASSERT_TRUE(whole.getCImg(0).is_sameXYZC(tiled.getCImg(0))) << "filter " << f.first;
+            EXPECT_EQ((whole.getCImg(0)-tiled.getCImg(0)).abs().max(), 0.) << "filter " << f.first;
+        }
+    }
+};
+
+TEST_F(ImageFilterTiling_test , testFilters )
+{
+    this->testFilters();
+}
+
+
+
+/// MarchingCubesEngine slab extraction gives the same mesh as CImg::get_isosurface3d
+struct MarchingCubesEngineSlabs_test : public Sofa_test<>
+{
+    typedef defaulttype::ImageUC Image;
+    typedef component::engine::MarchingCubesEngine<Image> Engine;
+
+    Engine::SPtr extract(const Image& image, SReal isoValue, bool parallel)
+    {
+        Engine::SPtr e = core::objectmodel::New<Engine>();
+        e->d_parallel.setValue(parallel);
+        e->isoValue.setValue(isoValue);
+        e->image.setValue(image);
+        e->init();
+        e->update();
+        return e;
+    }
+
+    void testSlabs()
+    {
+        // several threads, so that the image is split in more slabs, polygonized concurrently
+        simulation::TaskScheduler* taskScheduler = simulation::TaskScheduler::getInstance();
+        if(taskScheduler->getThreadCount() < 2)
+        {
+            taskScheduler->init(4);
+            simulation::initThreadLocalData();
+        }
+
+        Image image;
+        image.setDimensions(Image::imCoord(13,11,17,1,1));
+        cimg_library::CImg<unsigned char>& img = image.getCImg(0);
+        img.rand(0,255);
+        img.blur(1.f);
+
+        // isovalue between voxel values, and equal to voxel values
+        const SReal voxelValue = (SReal)img(6,5,8);
+        for(const SReal isoValue : {voxelValue+0.5, voxelValue})
+        {
+            const Engine::SPtr sequential = extract(image,isoValue,false);
+            const Engine::SPtr slabs = extract(image,isoValue,true);
+            ASSERT_FALSE(sequential->triangles.getValue().empty());
+            EXPECT_EQ(sequential->position.getValue(), slabs->position.getValue()) << "isoValue " << isoValue;
+            const Engine::SeqTriangles& triangles = sequential->triangles.getValue();
+            const Engine::SeqTriangles& slabTriangles = slabs->triangles.getValue();
+            ASSERT_EQ(triangles.size(), slabTriangles.size()) << "isoValue " << isoValue;
+            for(std::size_t i=0; i<triangles.size(); ++i)
+                for(unsigned int j=0; j<3; ++j)
+                    ASSERT_EQ(triangles[i][j], slabTriangles[i][j]) << "isoValue " << isoValue << " triangle " << i;
+        }
+    }
+};
+
+TEST_F(MarchingCubesEngineSlabs_test , testSlabs )
+{
+    this->testSlabs();
+}
+
 }// namespace sofa
@@ -25,6 +25,15 @@ using sofa::helper::testing::BaseSimulationTest;
 #include <SofaSimulationGraph/SimpleApi.h>
 using namespace sofa::simpleapi;
 
+#include <SofaConstraint/FreeMotionAnimationLoop.h>
+using sofa::component::animationloop::FreeMotionAnimationLoop;
+
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/simulation/InitTasks.h>
+
+#include <iterator>
+#include <sstream>
+
 namespace
 {
 
@@ -59,6 +68,104 @@ struct GenericConstraintSolver_test : BaseSimulationTest
         ASSERT_NE(solver, nullptr);
         ASSERT_STREQ(solver->findData("constraintForces")->getValueString().c_str(), "");
     }
+
+    /// Simulate spheres falling on a floor, return the positions and the constraint forces of the last step,
+    /// and whether the free motion was executed concurrently with the collision detection
+    void simulateContacts(bool parallel, const std::string& intersection, std::vector<double>& positions, std::vector<double>& forces, bool& overlap)
+    {
+        const std::string p = parallel ? "true" : "false";
+        SceneInstance sceneinstance("xml",
+                    "<Node dt='0.01' gravity='0 -9.81 0'>\n"
+                    "   <RequiredPlugin name='SofaComponentAll'/>"
+                    "   <RequiredPlugin name='SofaMiscCollision'/>"
+                    "   <FreeMotionAnimationLoop name='loop' parallelCollisionDetectionAndFreeMotion='" + p + "' />\n"
+                    "   <GenericConstraintSolver name='solver' multithreading='" + p + "' computeConstraintForces='true' maxIt='1000' tolerance='1e-8' />\n"
+                    "   <DefaultPipeline/>\n"
+                    "   <BruteForceDetection/>\n"
+                    "   <" + intersection + " alarmDistance='0.3' contactDistance='0.05'/>\n"
+                    "   <DefaultContactManager response='FrictionContact' responseParams='mu=0.1'/>\n"
+                    "   <Node name='floor'>\n"
+                    "         <MeshTopology position='-5 0 -5  5 0 -5  5 0 5  -5 0 5' triangles='0 2 1  0 3 2'/>\n"
+                    "         <MechanicalObject/>\n"
+                    "         <TriangleCollisionModel moving='0' simulated='0'/>\n"
+                    "   </Node>\n"
+                    "   <Node name='spheres'>\n"
+                    "         <EulerImplicitSolver rayleighStiffness='0' rayleighMass='0'/>\n"
+                    "         <CGLinearSolver iterations='25' tolerance='1e-10' threshold='1e-10'/>\n"
+                    "         <MechanicalObject name='dofs' position='0.3 0.3 -0.2  1 0.4 0  0 0.5 1'/>\n"
+                    "         <UniformMass totalMass='3'/>\n"
+                    "         <UncoupledConstraintCorrection/>\n"
+                    "         <SphereCollisionModel radius='0.1'/>\n"
+                    "   </Node>\n"
+                    "</Node>\n"
+                    );
+
+        sceneinstance.initScene();
+
+        const FreeMotionAnimationLoop* loop = dynamic_cast<FreeMotionAnimationLoop*>(sceneinstance.root->getObject("loop"));
+        ASSERT_NE(loop, nullptr);
+        overlap = loop->canOverlapFreeMotionAndCollisionDetection();
+
+        for (unsigned int i = 0; i < 40; ++i)
+            sceneinstance.simulate(0.01);
+
+        const auto read = [](const sofa::core::objectmodel::BaseData* data, std::vector<double>& values)
+        {
+            ASSERT_NE(data, nullptr);
+            std::istringstream in(data->getValueString());
+            values.assign(std::istream_iterator<double>(in), std::istream_iterator<double>());
+        };
+        read(sceneinstance.root->getChild("spheres")->getObject("dofs")->findData("position"), positions);
+        read(sceneinstance.root->getObject("solver")->findData("constraintForces"), forces);
+    }
+
+    void parallelFreeMotionAndCompliance()
+    {
+        // several threads, so that the free motion task actually runs concurrently
+        sofa::simulation::TaskScheduler* taskScheduler = sofa::simulation::TaskScheduler::getInstance();
+        if (taskScheduler->getThreadCount() < 2)
+        {
+            taskScheduler->init(4);
+            sofa::simulation::initThreadLocalData();
+        }
+
+        // NewProximityIntersection does not read the free positions
+        std::vector<double> positions, forces;
+        bool overlap = true;
+        simulateContacts(false, "NewProximityIntersection", positions, forces, overlap);
+        EXPECT_FALSE(overlap);
+
+        std::vector<double> parallelPositions, parallelForces;
+        simulateContacts(true, "NewProximityIntersection", parallelPositions, parallelForces, overlap);
+        ASSERT_TRUE(overlap);
+
+        // the spheres are resting on the floor
+        ASSERT_EQ(positions.size(), 9u);
+        ASSERT_FALSE(forces.empty());
+        for (unsigned int i = 0; i < 3; ++i)
+            EXPECT_GT(positions[3*i+1], 0.0);
+
+        ASSERT_EQ(parallelPositions.size(), positions.size());
+        for (std::size_t i = 0; i < positions.size(); ++i)
+            EXPECT_NEAR(parallelPositions[i], positions[i], 1e-10) << i;
+
+        ASSERT_EQ(parallelForces.size(), forces.size());
+        for (std::size_t i = 0; i < forces.size(); ++i)
+            EXPECT_NEAR(parallelForces[i], forces[i], 1e-10) << i;
+    }
+
+    void freePositionReaderIsNotOverlapped()
+    {
+        // LocalMinDistance reads the free positions written by the free motion
+        std::vector<double> positions, forces;
+        bool overlap = true;
+        simulateContacts(true, "LocalMinDistance", positions, forces, overlap);
+        EXPECT_FALSE(overlap);
+
+        ASSERT_EQ(positions.size(), 9u);
+        for (unsigned int i = 0; i < 3; ++i)
+            EXPECT_GT(positions[3*i+1], 0.0);
+    }
 };
 
 /// run the tests
@@ -68,6 +175,18 @@ TEST_F(GenericConstraintSolver_test, checkConstraintForce)
     enableConstraintForce();
 }
 
+TEST_F(GenericConstraintSolver_test, parallelFreeMotionAndCompliance)
+{
+    EXPECT_MSG_NOEMIT(Error);
+    parallelFreeMotionAndCompliance();
+}
+
+TEST_F(GenericConstraintSolver_test, freePositionReaderIsNotOverlapped)
+{
+    EXPECT_MSG_NOEMIT(Error);
+    freePositionReaderIsNotOverlapped();
+}
+
 
 } /// namespace sofa
 
@@ -26,6 +26,7 @@
 
 #include <sofa/core/ObjectFactory.h>
 #include <sofa/core/VecId.h>
+#include <sofa/core/collision/Intersection.h>
 
 #include <sofa/helper/AdvancedTimer.h>
 #include <sofa/simulation/UpdateInternalDataVisitor.h>
@@ -40,6 +41,11 @@
 #include <sofa/simulation/UpdateMappingVisitor.h>
 #include <sofa/simulation/UpdateMappingEndEvent.h>
 #include <sofa/simulation/UpdateBoundingBoxVisitor.h>
+#include <sofa/simulation/CollisionVisitor.h>
+#include <sofa/simulation/CollisionBeginEvent.h>
+#include <sofa/simulation/CollisionEndEvent.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/simulation/InitTasks.h>
 #include <SofaConstraint/LCPConstraintSolver.h>
 
 namespace sofa::component::animationloop
@@ -50,12 +56,42 @@ using namespace sofa::simulation;
 using helper::system::thread::CTime;
 using sofa::helper::ScopedAdvancedTimer;
 
+namespace
+{
+
+/// Task running the free motion of the scene, so that it can overlap with the collision detection
+class FreeMotionTask : public sofa::simulation::CpuTask
+{
+public:
+    typedef std::function<void()> Function;
+
+    FreeMotionTask(const Function& freeMotion, sofa::simulation::CpuTask::Status* status)
+        : sofa::simulation::CpuTask(status)
+        , m_freeMotion(freeMotion)
+    {}
+
+    ~FreeMotionTask() override {}
+
+    MemoryAlloc run() final
+    {
+        m_freeMotion();
+        return MemoryAlloc::Stack;
+    }
+
+private:
+    Function m_freeMotion;
+};
+
+} // anonymous namespace
+
 FreeMotionAnimationLoop::FreeMotionAnimationLoop(simulation::Node* gnode)
     : Inherit1(gnode)
     , m_solveVelocityConstraintFirst(initData(&m_solveVelocityConstraintFirst , false, "solveVelocityConstraintFirst", "solve separately velocity constraint violations before position constraint violations"))
     , d_threadSafeVisitor(initData(&d_threadSafeVisitor, false, "threadSafeVisitor", "If true, do not use realloc and free visitors in fwdInteractionForceField."))
+    , d_parallelCollisionDetectionAndFreeMotion(initData(&d_parallelCollisionDetectionAndFreeMotion, false, "parallelCollisionDetectionAndFreeMotion", "If true, executes the free motion and the collision detection concurrently (when the intersection method does not read the free positions)"))
     , constraintSolver(nullptr)
     , defaultSolver(nullptr)
+    , m_taskScheduler(nullptr)
 {
 }
 
@@ -92,6 +128,16 @@ void FreeMotionAnimationLoop::init()
     {
         defaultSolver.reset();
     }
+
+    if (d_parallelCollisionDetectionAndFreeMotion.getValue())
+    {
+        m_taskScheduler = sofa::simulation::TaskScheduler::getInstance();
+        if (m_taskScheduler->getThreadCount() < 1)
+        {
+            m_taskScheduler->init(0);
+            sofa::simulation::initThreadLocalData();
+        }
+    }
 }
 
 
@@ -178,61 +224,16 @@ void FreeMotionAnimationLoop::step(const sofa::core::ExecParams* params, SReal d
 
     dmsg_info() << "beginVisitor performed - SolveVisitor for freeMotion is called" ;
 
-    // Mapping geometric stiffness coming from previous lambda.
-    {
-        ScopedAdvancedTimer timer("lambdaMultInvDt");
-        simulation::MechanicalVOpVisitor lambdaMultInvDt(params, cparams.lambda(), sofa::core::ConstMultiVecId::null(), cparams.lambda(), 1.0 / dt);
-        lambdaMultInvDt.setMapped(true);
-        getContext()->executeVisitor(&lambdaMultInvDt);
-    }
-
-    {
-        ScopedAdvancedTimer timer("MechanicalComputeGeometricStiffness");
-        simulation::MechanicalComputeGeometricStiffness geometricStiffnessVisitor(&mop.mparams, cparams.lambda());
-        getContext()->executeVisitor(&geometricStiffnessVisitor);
-    }
-
-    // Free Motion
-    {
-        ScopedAdvancedTimer timer("FreeMotion");
-        simulation::SolveVisitor freeMotion(params, dt, true);
-        gnode->execute(&freeMotion);
-    }
-
-    
-    mop.projectResponse(freeVel);
-    mop.propagateDx(freeVel, true);
-
-    if (cparams.constOrder() == core::ConstraintParams::POS ||
-        cparams.constOrder() == core::ConstraintParams::POS_AND_VEL)
-    {
-        ScopedAdvancedTimer timer("freePosEqPosPlusFreeVelDt");
-        simulation::MechanicalVOpVisitor freePosEqPosPlusFreeVelDt(params, freePos, pos, freeVel, dt);
-        freePosEqPosPlusFreeVelDt.setMapped(true);
-        getContext()->executeVisitor(&freePosEqPosPlusFreeVelDt);
-    }
-    dmsg_info() << " SolveVisitor for freeMotion performed" ;
+    computeFreeMotionAndCollisionDetection(params, cparams, dt, pos, freePos, freeVel, &mop);
 
     if (displayTime.getValue())
     {
         msg_info() << " >>>>> Begin display FreeMotionAnimationLoop time  " << msgendl
-                   <<" Free Motion " << ((double)CTime::getTime() - time) * timeScale << " ms" ;
+                   << " Free Motion and computeCollision " << ((double)CTime::getTime() - time) * timeScale << " ms";
 
         time = (double)CTime::getTime();
     }
 
-    // Collision detection and response creation
-    {
-        ScopedAdvancedTimer timer("Collision");
-        computeCollision(params);
-    }
-
-    if (displayTime.getValue())
-    {
-        msg_info() << " computeCollision " << ((double) CTime::getTime() - time) * timeScale << " ms";
-        time = (double)CTime::getTime();
-    }
-
     // Solve constraints
     if (constraintSolver)
     {
@@ -298,6 +299,125 @@ void FreeMotionAnimationLoop::step(const sofa::core::ExecParams* params, SReal d
 
 }
 
+void FreeMotionAnimationLoop::computeFreeMotion(const sofa::core::ExecParams* params, const core::ConstraintParams& cparams, SReal dt,
+                                                core::MultiVecCoordId pos, core::MultiVecCoordId freePos, core::MultiVecDerivId freeVel,
+                                                simulation::common::MechanicalOperations* mop)
+{
+    // Mapping geometric stiffness coming from previous lambda.
+    {
+        ScopedAdvancedTimer timer("lambdaMultInvDt");
+        simulation::MechanicalVOpVisitor lambdaMultInvDt(params, cparams.lambda(), sofa::core::ConstMultiVecId::null(), cparams.lambda(), 1.0 / dt);
+        lambdaMultInvDt.setMapped(true);
+        getContext()->executeVisitor(&lambdaMultInvDt);
+    }
+
+    {
+        ScopedAdvancedTimer timer("MechanicalComputeGeometricStiffness");
+        simulation::MechanicalComputeGeometricStiffness geometricStiffnessVisitor(&mop->mparams, cparams.lambda());
+        getContext()->executeVisitor(&geometricStiffnessVisitor);
+    }
+
+    // Free Motion
+    {
+        ScopedAdvancedTimer timer("FreeMotion");
+        simulation::SolveVisitor freeMotion(params, dt, true);
+        gnode->execute(&freeMotion);
+    }
+
+    mop->projectResponse(freeVel);
+    mop->propagateDx(freeVel, true);
+
+    if (cparams.constOrder() == core::ConstraintParams::POS ||
+        cparams.constOrder() == core::ConstraintParams::POS_AND_VEL)
+    {
+        ScopedAdvancedTimer timer("freePosEqPosPlusFreeVelDt");
+        simulation::MechanicalVOpVisitor freePosEqPosPlusFreeVelDt(params, freePos, pos, freeVel, dt);
+        freePosEqPosPlusFreeVelDt.setMapped(true);
+        getContext()->executeVisitor(&freePosEqPosPlusFreeVelDt);
+    }
+    dmsg_info() << " SolveVisitor for freeMotion performed" ;
+}
+
+bool FreeMotionAnimationLoop::canOverlapFreeMotionAndCollisionDetection() const
+{
+    if (!d_parallelCollisionDetectionAndFreeMotion.getValue() || m_taskScheduler == nullptr)
+        return false;
+
+    // The free motion writes the free positions: the detection must not read them
+    helper::vector<core::collision::Intersection*> intersections;
+    getContext()->get<core::collision::Intersection>(&intersections, core::objectmodel::BaseContext::SearchDown);
+
+    for (const core::collision::Intersection* intersection : intersections)
+    {
+        if (intersection->useFreePosition())
+            return false;
+    }
+    return true;
+}
+
+void FreeMotionAnimationLoop::computeFreeMotionAndCollisionDetection(const sofa::core::ExecParams* params, const core::ConstraintParams& cparams, SReal dt,
+                                                                     core::MultiVecCoordId pos, core::MultiVecCoordId freePos, core::MultiVecDerivId freeVel,
+                                                                     simulation::common::MechanicalOperations* mop)
+{
+    if (!canOverlapFreeMotionAndCollisionDetection())
+    {
+        computeFreeMotion(params, cparams, dt, pos, freePos, freeVel, mop);
+
+        // Collision detection and response creation
+        {
+            ScopedAdvancedTimer timer("Collision");
+            computeCollision(params);
+        }
+        return;
+    }
+
+    ScopedAdvancedTimer timer("FreeMotion+Collision");
+
+    {
+        ScopedAdvancedTimer timer("CollisionBeginEvent");
+        CollisionBeginEvent evBegin;
+        PropagateEventVisitor eventPropagation(params, &evBegin);
+        eventPropagation.execute(getContext());
+    }
+
+    // The reset removes the contact responses of the previous step from the graph:
+    // it must be done before the free motion starts traversing it.
+    {
+        ScopedAdvancedTimer timer("CollisionReset");
+        CollisionResetVisitor act(params);
+        act.setTags(this->getTags());
+        act.execute(getContext());
+    }
+
+    sofa::simulation::CpuTask::Status freeMotionTaskStatus;
+    FreeMotionTask freeMotionTask([&]() { computeFreeMotion(params, cparams, dt, pos, freePos, freeVel, mop); }, &freeMotionTaskStatus);
+    m_taskScheduler->addTask(&freeMotionTask);
+
+    // The intersection methods do not read the free vectors written by the free motion
+    {
+        ScopedAdvancedTimer timer("CollisionDetection");
+        CollisionDetectionVisitor act(params);
+        act.setTags(this->getTags());
+        act.execute(getContext());
+    }
+
+    m_taskScheduler->workUntilDone(&freeMotionTaskStatus);
+
+    {
+        ScopedAdvancedTimer timer("CollisionResponse");
+        CollisionResponseVisitor act(params);
+        act.setTags(this->getTags());
+        act.execute(getContext());
+    }
+
+    {
+        ScopedAdvancedTimer timer("CollisionEndEvent");
+        CollisionEndEvent evEnd;
+        PropagateEventVisitor eventPropagation(params, &evEnd);
+        eventPropagation.execute(getContext());
+    }
+}
+
 int FreeMotionAnimationLoopClass = core::RegisterObject(R"(
 The animation loop to use with constraints.
 You must add this loop at the beginning of the scene if you are using constraints.")")
@@ -25,6 +25,12 @@
 #include <sofa/simulation/CollisionAnimationLoop.h>
 #include <SofaConstraint/LCPConstraintSolver.h>
 
+namespace sofa::simulation
+{
+    class TaskScheduler;
+    namespace common { class MechanicalOperations; }
+}
+
 namespace sofa::component::animationloop
 {
 
@@ -38,6 +44,11 @@ public:
     void init() override;
     void parse ( sofa::core::objectmodel::BaseObjectDescription* arg ) override;
 
+    /// Whether the next steps run the free motion concurrently with the collision detection:
+    /// parallelCollisionDetectionAndFreeMotion is set, a task scheduler is available, and
+    /// no intersection method of the scene reads the free positions.
+    bool canOverlapFreeMotionAndCollisionDetection() const;
+
     /// Construction method called by ObjectFactory. An animation loop can only
     /// be created if
     template<class T>
@@ -53,13 +64,33 @@ public:
     Data<bool> displayTime;
     Data<bool> m_solveVelocityConstraintFirst; ///< solve separately velocity constraint violations before position constraint violations
     Data<bool> d_threadSafeVisitor;
+    Data<bool> d_parallelCollisionDetectionAndFreeMotion; ///< run the collision detection concurrently with the free motion
 
 protected:
     FreeMotionAnimationLoop(simulation::Node* gnode);
     ~FreeMotionAnimationLoop() override ;
 
+    /// Solve the unconstrained motion of the scene, writing freePosition and freeVelocity.
+    void computeFreeMotion(const sofa::core::ExecParams* params, const core::ConstraintParams& cparams, SReal dt,
+                           core::MultiVecCoordId pos, core::MultiVecCoordId freePos, core::MultiVecDerivId freeVel,
+                           simulation::common::MechanicalOperations* mop);
+
+    /// Compute the free motion and the collision detection, either sequentially or
+    /// concurrently when parallelCollisionDetectionAndFreeMotion is set.
+    /// In the concurrent mode, the collision reset and the response creation (which both
+    /// modify the scene graph) are kept on the calling thread, and only the collision
+    /// detection overlaps with the free motion.
+    /// Some intersection methods (LocalMinDistance, MinProximityIntersection) read the free
+    /// positions: the free motion is then finished before the detection starts, as in the
+    /// sequential mode.
+    void computeFreeMotionAndCollisionDetection(const sofa::core::ExecParams* params, const core::ConstraintParams& cparams, SReal dt,
+                                                core::MultiVecCoordId pos, core::MultiVecCoordId freePos, core::MultiVecDerivId freeVel,
+                                                simulation::common::MechanicalOperations* mop);
+
     sofa::core::behavior::ConstraintSolver *constraintSolver;
     component::constraintset::LCPConstraintSolver::SPtr defaultSolver;
+
+    sofa::simulation::TaskScheduler* m_taskScheduler;
 };
 
 } // namespace sofa::component::animationloop
@@ -26,7 +26,10 @@
 #include <sofa/helper/AdvancedTimer.h>
 #include <sofa/core/ObjectFactory.h>
 #include <SofaConstraint/ConstraintStoreLambdaVisitor.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/simulation/InitTasks.h>
 #include <algorithm>
+#include <list>
 
 namespace sofa::component::constraintset
 {
@@ -46,6 +49,33 @@ void clearMultiVecId(sofa::core::objectmodel::BaseContext* ctx, const sofa::core
     ctx->executeVisitor(&clearVisitor);
 }
 
+/// Task computing the compliance of one constraint correction in its own matrix,
+/// so that independent constraint corrections can be processed concurrently
+class ComputeComplianceTask : public simulation::CpuTask
+{
+public:
+    ComputeComplianceTask(simulation::CpuTask::Status* status)
+        : simulation::CpuTask(status)
+        , cc(nullptr)
+        , cParams(nullptr)
+        , dimension(0)
+    {}
+
+    ~ComputeComplianceTask() override {}
+
+    MemoryAlloc run() final
+    {
+        W.resize(dimension, dimension);
+        cc->addComplianceInConstraintSpace(cParams, &W);
+        return MemoryAlloc::Stack;
+    }
+
+    core::behavior::BaseConstraintCorrection* cc;
+    const core::ConstraintParams* cParams;
+    unsigned int dimension;
+    sofa::component::linearsolver::FullMatrix<double> W;
+};
+
 }
 
 GenericConstraintSolver::GenericConstraintSolver()
@@ -71,6 +101,7 @@ GenericConstraintSolver::GenericConstraintSolver()
     , d_computeConstraintForces(initData(&d_computeConstraintForces,false,
                                         "computeConstraintForces",
                                         "enable the storage of the constraintForces (default = False)."))
+    , d_multithreading(initData(&d_multithreading, false, "multithreading", "Build the compliances of the constraint corrections concurrently"))
     , current_cp(&m_cpBuffer[0])
     , last_cp(nullptr)
 {
@@ -289,13 +320,55 @@ bool GenericConstraintSolver::buildSystem(const core::ConstraintParams *cParams,
         sofa::helper::AdvancedTimer::stepBegin("Get Compliance");
         msg_info() <<" computeCompliance in "  << constraintCorrections.size()<< " constraintCorrections" ;
 
-        for (unsigned int i=0; i<constraintCorrections.size(); i++)
+        if (!d_multithreading.getValue())
         {
-            core::behavior::BaseConstraintCorrection* cc = constraintCorrections[i];
-            if (!cc->isActive()) continue;
-            sofa::helper::AdvancedTimer::stepBegin("Object name: " + cc->getName());
-            cc->addComplianceInConstraintSpace(cParams, &current_cp->W);
-            sofa::helper::AdvancedTimer::stepEnd("Object name: " + cc->getName());
+            for (unsigned int i=0; i<constraintCorrections.size(); i++)
+            {
+                core::behavior::BaseConstraintCorrection* cc = constraintCorrections[i];
+                if (!cc->isActive()) continue;
+                sofa::helper::AdvancedTimer::stepBegin("Object name: " + cc->getName());
+                cc->addComplianceInConstraintSpace(cParams, &current_cp->W);
+                sofa::helper::AdvancedTimer::stepEnd("Object name: " + cc->getName());
+            }
+        }
+        else
+        {
+            // each active constraint correction adds its compliance into a private matrix,
+            // the matrices are then summed in a deterministic order
+            simulation::TaskScheduler* taskScheduler = simulation::TaskScheduler::getInstance();
+            if (taskScheduler->getThreadCount() < 1)
+            {
+                taskScheduler->init(0);
+                simulation::initThreadLocalData();
+            }
+
+            simulation::CpuTask::Status status;
+            // std::list: the tasks own their matrix and must not be relocated
+            std::list<ComputeComplianceTask> tasks;
+            for (unsigned int i=0; i<constraintCorrections.size(); i++)
+            {
+                core::behavior::BaseConstraintCorrection* cc = constraintCorrections[i];
+                if (!cc->isActive()) continue;
+                tasks.emplace_back(&status);
+                tasks.back().cc = cc;
+                tasks.back().cParams = cParams;
+                tasks.back().dimension = numConstraints;
+            }
+
+            for (ComputeComplianceTask& task : tasks)
+                taskScheduler->addTask(&task);
+            taskScheduler->workUntilDone(&status);
+
+            double** w = current_cp->getW();
+            for (ComputeComplianceTask& task : tasks)
+            {
+                for (unsigned int j = 0; j < numConstraints; ++j)
+                {
+                    const double* wj = task.W[j];
+                    for (unsigned int l = 0; l < numConstraints; ++l)
+                        w[j][l] += wj[l];
+                }
+            }
         }
 
         sofa::helper::AdvancedTimer::stepEnd  ("Get Compliance");
@@ -52,6 +52,9 @@ protected:
 public:
     void init() override;
 
+    /// The contacts store the free positions of the elements when they are set
+    bool useFreePosition() const override { return true; }
+
     bool testIntersection(Cube& ,Cube&);
 
     bool testIntersection(Point&, Point&);
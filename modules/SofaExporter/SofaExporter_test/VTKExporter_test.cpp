@@ -0,0 +1,224 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaExporter/VTUBinaryWriter.h>
+using sofa::component::misc::VTUBinaryWriter;
+
+#include <sofa/helper/testing/BaseTest.h>
+using sofa::helper::testing::BaseTest;
+
+#include <SofaSimulationGraph/DAGSimulation.h>
+using sofa::simulation::Node;
+using sofa::simulation::graph::DAGSimulation;
+
+#include <SofaSimulationCommon/SceneLoaderXML.h>
+using sofa::simulation::SceneLoaderXML;
+using sofa::core::ExecParams;
+
+#include <sofa/helper/system/FileSystem.h>
+using sofa::helper::system::FileSystem;
+
+#include <boost/filesystem.hpp>
+#include <zlib.h>
+
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+
+std::string tempdir = boost::filesystem::temp_directory_path().string();
+
+class VTKExporter_test : public BaseTest
+{
+public:
+    std::vector<std::string> dataPath;
+
+    void SetUp() override
+    {
+        sofa::simulation::setSimulation(new DAGSimulation());
+    }
+
+    void TearDown() override
+    {
+        for (auto& pathToRemove : dataPath)
+        {
+            if (FileSystem::exists(pathToRemove))
+                FileSystem::removeAll(pathToRemove);
+        }
+    }
+
+    static std::uint64_t readUInt64(const std::string& content, std::size_t position)
+    {
+        std::uint64_t value;
+        std::memcpy(&value, content.data() + position, sizeof(value));
+        return value;
+    }
+
+    /// Decode the appended blocks of a file written by VTUBinaryWriter
+    static std::vector< std::vector<char> > readAppendedArrays(const std::string& filename, std::size_t nbArrays, bool compressed)
+    {
+        std::ifstream file(filename.c_str(), std::ios::binary);
+        const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::size_t position = content.find("<AppendedData encoding=\"raw\">");
+        position = content.find('_', position) + 1;
+
+        std::vector< std::vector<char> > arrays;
+        for (std::size_t a = 0; a < nbArrays; ++a)
+        {
+            std::vector<char> bytes;
+            if (!compressed)
+            {
+                const std::uint64_t size = readUInt64(content, position);
+                position += sizeof(std::uint64_t);
+                bytes.assign(content.begin() + position, content.begin() + position + size);
+                position += size;
+            }
+            else
+            {
+                const std::uint64_t nbBlocks = readUInt64(content, position);
+                const std::uint64_t blockSize = readUInt64(content, position + 8);
+                const std::uint64_t lastBlockSize = readUInt64(content, position + 16);
+                std::size_t data = position + 24 + 8 * nbBlocks;
+                for (std::uint64_t b = 0; b < nbBlocks; ++b)
+                {
+                    const std::uint64_t compressedSize = readUInt64(content, position + 24 + 8 * b);
+                    uLongf size = uLongf((b + 1 == nbBlocks && lastBlockSize) ? lastBlockSize : blockSize);
+                    std::vector<char> block(size);
+                    EXPECT_EQ(uncompress(reinterpret_cast<Bytef*>(block.data()), &size,
+                                         reinterpret_cast<const Bytef*>(content.data() + data), uLong(compressedSize)), Z_OK);
+                    bytes.insert(bytes.end(), block.begin(), block.begin() + size);
+                    data += compressedSize;
+                }
+                position = data;
+            }
+            arrays.push_back(bytes);
+        }
+        EXPECT_NE(content.find("</AppendedData>", position), std::string::npos);
+        return arrays;
+    }
+
+    void checkWriteSnapshot(bool compress)
+    {
+        const std::string filename = tempdir + "/VTUBinaryWriter_test.vtu";
+        dataPath = {filename};
+
+        VTUBinaryWriter::Snapshot snapshot;
+        snapshot.filename = filename;
+        snapshot.compress = compress;
+        snapshot.nbPoints = 20000;
+        snapshot.nbCells = 1;
+
+        std::vector<double> points(3 * snapshot.nbPoints);
+        for (std::size_t i = 0; i < points.size(); ++i)
+            points[i] = 0.5 * double(i);
+        const std::vector<int> connectivity = {0, 1, 2, 3};
+        const std::vector<int> offsets = {4};
+        const std::vector<unsigned char> types = {10};
+
+        snapshot.pointData.resize(1);
+        snapshot.pointData[0].type = "Float64";
+        snapshot.pointData[0].name = "values";
+        snapshot.pointData[0].assign(points.data(), snapshot.nbPoints);
+        snapshot.points.type = "Float64";
+        snapshot.points.nbComponents = 3;
+        snapshot.points.assign(points.data(), points.size());
+        snapshot.connectivity.assign(connectivity.data(), connectivity.size());
+        snapshot.offsets.assign(offsets.data(), offsets.size());
+        snapshot.types.assign(types.data(), types.size());
+
+        std::string error;
+        ASSERT_TRUE(VTUBinaryWriter::write(snapshot, error)) << error;
+
+        const auto arrays = readAppendedArrays(filename, 5, compress);
+        ASSERT_EQ(arrays.size(), 5u);
+        EXPECT_EQ(arrays[0], snapshot.pointData[0].bytes);
+        EXPECT_EQ(arrays[1], snapshot.points.bytes);
+        EXPECT_EQ(arrays[2], snapshot.connectivity.bytes);
+        EXPECT_EQ(arrays[3], snapshot.offsets.bytes);
+        EXPECT_EQ(arrays[4], snapshot.types.bytes);
+    }
+
+    void checkBackgroundExport()
+    {
+        const std::string filename = tempdir + "/VTKExporter_test";
+        dataPath = {filename + "0.vtu", filename + "1.vtu", filename + "2.vtu", filename + "3.vtu"};
+
+        EXPECT_MSG_NOEMIT(Error, Warning);
+        std::stringstream scene;
+        scene <<
+                "<?xml version='1.0'?> \n"
+                "<Node name='Root' gravity='0 0 0' time='0' animate='0'   >       \n"
+                "   <DefaultAnimationLoop/>                                        \n"
+                "   <RegularGridTopology name='grid' n='6 6 6' min='-10 -10 -10' max='10 10 10' computeHexaList='1'/> \n"
+                "   <MechanicalObject name='dofs'/>                                \n"
+                "   <VTKExporter name='exporter' listening='1' filename='" << filename << "' edges='0' hexas='1' binary='1' compress='1' \n"
+                "                pointsDataFields='position=@dofs.position' exportEveryNumberOfSteps='5' /> \n"
+                "</Node>                                                           \n";
+
+        Node::SPtr root = SceneLoaderXML::loadFromMemory("testscene", scene.str().c_str(), scene.str().size());
+        ASSERT_NE(root.get(), nullptr);
+        root->init(ExecParams::defaultInstance());
+
+        for (unsigned int i = 0; i < 20; i++)
+            sofa::simulation::getSimulation()->animate(root.get(), 0.5);
+
+        // the files are all written when the exporter is cleaned up
+        sofa::simulation::getSimulation()->unload(root);
+
+        for (auto& pathToCheck : dataPath)
+            EXPECT_TRUE(FileSystem::exists(pathToCheck)) << "Problem with '" << pathToCheck << "'";
+
+        // the points are written in the precision of SReal, and declared as such
+        std::ifstream file(dataPath[0].c_str(), std::ios::binary);
+        const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        const std::string pointsType = (sizeof(SReal) == sizeof(float)) ? "Float32" : "Float64";
+        const std::size_t points = content.find("<Points>");
+        ASSERT_NE(points, std::string::npos);
+        EXPECT_EQ(content.find("<DataArray type=\"" + pointsType + "\"", points), content.find("<DataArray", points));
+
+        const auto arrays = readAppendedArrays(dataPath[0], 5, true);
+        ASSERT_EQ(arrays.size(), 5u);
+        EXPECT_EQ(arrays[0].size(), 216 * 3 * sizeof(SReal)); // position
+        EXPECT_EQ(arrays[1].size(), 216 * 3 * sizeof(SReal)); // points
+        EXPECT_EQ(arrays[2].size(), 125 * 8 * sizeof(int)); // connectivity
+        EXPECT_EQ(arrays[3].size(), 125 * sizeof(int)); // offsets
+        EXPECT_EQ(arrays[4].size(), 125u); // types
+    }
+};
+
+TEST_F(VTKExporter_test, writeRawSnapshot)
+{
+    this->checkWriteSnapshot(false);
+}
+
+TEST_F(VTKExporter_test, writeCompressedSnapshot)
+{
+    this->checkWriteSnapshot(true);
+}
+
+TEST_F(VTKExporter_test, backgroundBinaryExport)
+{
+    this->checkBackgroundExport();
+}
+
+} // namespace
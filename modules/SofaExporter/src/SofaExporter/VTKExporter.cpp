@@ -60,6 +60,8 @@ VTKExporter::VTKExporter()
     , exportAtBegin( initData(&exportAtBegin, false, "exportAtBegin", "export file at the initialization"))
     , exportAtEnd( initData(&exportAtEnd, false, "exportAtEnd", "export file when the simulation is finished"))
     , overwrite( initData(&overwrite, false, "overwrite", "overwrite the file, otherwise create a new file at each export, with suffix in the filename"))
+    , d_binary( initData(&d_binary, false, "binary", "write the XML files with binary appended data. The files are written on a background thread, the simulation does not wait for the disk"))
+    , d_compress( initData(&d_compress, false, "compress", "compress the binary appended data with zlib"))
 {
 }
 
@@ -91,6 +93,9 @@ void VTKExporter::init()
 
     nbFiles = 0;
 
+    if (d_binary.getValue() && !fileFormat.getValue())
+        msg_warning() << "Binary export is only available with the XML format, legacy files are written in ASCII.";
+
     const helper::vector<std::string>& pointsData = dPointsDataFields.getValue();
     const helper::vector<std::string>& cellsData = dCellsDataFields.getValue();
 
@@ -538,7 +543,7 @@ void VTKExporter::writeVTKSimple()
     msg_info() << "Export VTK in file " << filename << "  done.";
 }
 
-void VTKExporter::writeVTKXML()
+std::string VTKExporter::getXMLFilename() const
 {
     std::string filename = vtkFilename.getFullPath();
 
@@ -556,6 +561,18 @@ void VTKExporter::writeVTKXML()
             filename += oss.str();
         filename += ".vtu";
     }
+    return filename;
+}
+
+void VTKExporter::writeVTKXML()
+{
+    if (d_binary.getValue())
+    {
+        writeVTKXMLBinary();
+        return;
+    }
+
+    const std::string filename = getXMLFilename();
 
     outfile = new std::ofstream(filename.c_str());
     if( !outfile->is_open() )
@@ -755,6 +772,175 @@ void VTKExporter::writeVTKXML()
     msg_info() << "Export VTK XML in file " << filename << "  done.";
 }
 
+namespace
+{
+
+/// Copy the values of field in array if it is a vector of T
+template<class T>
+bool copyDataArray(core::objectmodel::BaseData* field, const char* type, unsigned int nbComponents, VTUBinaryWriter::DataArray& array)
+{
+    const auto* data = dynamic_cast<const Data< helper::vector<T> >* >(field);
+    if (!data)
+        return false;
+
+    const helper::vector<T>& values = data->getValue();
+    array.type = type;
+    array.nbComponents = nbComponents;
+    array.assign(values.data(), values.size());
+    return true;
+}
+
+template<class Element>
+void appendCells(const helper::vector<Element>& elements, unsigned char type, VTUBinaryWriter::Snapshot& snapshot,
+                 helper::vector<int>& connectivity, helper::vector<int>& offsets, helper::vector<unsigned char>& types)
+{
+    for (const Element& e : elements)
+    {
+        for (unsigned int j=0 ; j<e.size() ; j++)
+            connectivity.push_back(int(e[j]));
+        offsets.push_back(int(connectivity.size()));
+        types.push_back(type);
+    }
+    snapshot.nbCells += elements.size();
+}
+
+} // namespace
+
+void VTKExporter::fetchDataArrays(const helper::vector<std::string>& objects, const helper::vector<std::string>& fields, const helper::vector<std::string>& names, std::vector<VTUBinaryWriter::DataArray>& arrays)
+{
+    sofa::core::objectmodel::BaseContext* context = this->getContext();
+
+    arrays.resize(objects.size());
+    std::size_t nbArrays = 0;
+    for (unsigned int i=0 ; i<objects.size() ; i++)
+    {
+        core::objectmodel::BaseObject* obj = context->get<core::objectmodel::BaseObject> (objects[i]);
+        core::objectmodel::BaseData* field = nullptr;
+        if (obj)
+        {
+            field = obj->findData(fields[i]);
+        }
+
+        if (!obj)
+        {
+            msg_error() << "VTKExporter : error while fetching data field '" << msgendl
+                        << fields[i] << "' of object '" << objects[i] << msgendl
+                        << "', check object name" << msgendl;
+            continue;
+        }
+        if (!field)
+        {
+            msg_error()  << "VTKExporter : error while fetching data field " << msgendl
+                         << fields[i] << " of object '" << objects[i] << msgendl
+                         << "', check field name " << msgendl;
+            continue;
+        }
+
+        VTUBinaryWriter::DataArray& array = arrays[nbArrays];
+        const bool isSupported = copyDataArray<int>(field, "Int32", 1, array)
+                || copyDataArray<unsigned int>(field, "UInt32", 1, array)
+                || copyDataArray<float>(field, "Float32", 1, array)
+                || copyDataArray<double>(field, "Float64", 1, array)
+                || copyDataArray<defaulttype::Vec1f>(field, "Float32", 1, array)
+                || copyDataArray<defaulttype::Vec1d>(field, "Float64", 1, array)
+                || copyDataArray<defaulttype::Vec2f>(field, "Float32", 2, array)
+                || copyDataArray<defaulttype::Vec2d>(field, "Float64", 2, array)
+                || copyDataArray<defaulttype::Vec3f>(field, "Float32", 3, array)
+                || copyDataArray<defaulttype::Vec3d>(field, "Float64", 3, array);
+        if (!isSupported)
+        {
+            msg_warning() << "Data field " << fields[i] << " of object '" << objects[i]
+                          << "' has a type which cannot be written in binary: it is ignored.";
+            continue;
+        }
+        array.name = names[i];
+        ++nbArrays;
+    }
+    arrays.resize(nbArrays);
+}
+
+void VTKExporter::writeVTKXMLBinary()
+{
+    if (!m_binaryWriter)
+        m_binaryWriter.reset(new VTUBinaryWriter);
+
+    for (const std::string& error : m_binaryWriter->takeErrors())
+        msg_error() << error;
+
+    // Only the copy of the exported values is made on the simulation thread
+    VTUBinaryWriter::Snapshot& snapshot = m_binaryWriter->acquireSnapshot();
+    snapshot.filename = getXMLFilename();
+    snapshot.compress = d_compress.getValue();
+
+    helper::ReadAccessor<Data<defaulttype::Vec3Types::VecCoord> > pointsPos = position;
+    snapshot.nbPoints = (!pointsPos.empty()) ? pointsPos.size() : topology->getNbPoints();
+
+    // the coordinates are written as they are stored, in the precision of SReal
+    snapshot.points.type = (sizeof(SReal) == sizeof(float)) ? "Float32" : "Float64";
+    snapshot.points.name.clear();
+    snapshot.points.nbComponents = 3;
+    if (!pointsPos.empty())
+    {
+        snapshot.points.assign(pointsPos.ref().data(), pointsPos.size());
+    }
+    else
+    {
+        const bool useState = mstate && mstate->getSize() == snapshot.nbPoints;
+        helper::vector<SReal> coordinates(3 * snapshot.nbPoints);
+        for (size_t i = 0; i < snapshot.nbPoints; i++)
+        {
+            coordinates[3*i  ] = useState ? mstate->getPX(i) : topology->getPX(i);
+            coordinates[3*i+1] = useState ? mstate->getPY(i) : topology->getPY(i);
+            coordinates[3*i+2] = useState ? mstate->getPZ(i) : topology->getPZ(i);
+        }
+        snapshot.points.assign(coordinates.data(), coordinates.size());
+    }
+
+    helper::vector<int> connectivity;
+    helper::vector<int> offsets;
+    helper::vector<unsigned char> types;
+    snapshot.nbCells = 0;
+    if (writeEdges.getValue())
+        appendCells(topology->getEdges(), 3, snapshot, connectivity, offsets, types);
+    if (writeTriangles.getValue())
+        appendCells(topology->getTriangles(), 5, snapshot, connectivity, offsets, types);
+    if (writeQuads.getValue())
+        appendCells(topology->getQuads(), 9, snapshot, connectivity, offsets, types);
+    if (writeTetras.getValue())
+        appendCells(topology->getTetrahedra(), 10, snapshot, connectivity, offsets, types);
+    if (writeHexas.getValue())
+        appendCells(topology->getHexahedra(), 12, snapshot, connectivity, offsets, types);
+
+    snapshot.connectivity.type = "Int32";
+    snapshot.connectivity.name = "connectivity";
+    snapshot.connectivity.assign(connectivity.data(), connectivity.size());
+    snapshot.offsets.type = "Int32";
+    snapshot.offsets.name = "offsets";
+    snapshot.offsets.assign(offsets.data(), offsets.size());
+    snapshot.types.type = "UInt8";
+    snapshot.types.name = "types";
+    snapshot.types.assign(types.data(), types.size());
+
+    fetchDataArrays(pointsDataObject, pointsDataField, pointsDataName, snapshot.pointData);
+    fetchDataArrays(cellsDataObject, cellsDataField, cellsDataName, snapshot.cellData);
+
+    const std::string filename = snapshot.filename;
+    m_binaryWriter->submit();
+    ++nbFiles;
+
+    msg_info() << "Export VTK XML in file " << filename << "  queued.";
+}
+
+void VTKExporter::flushBinaryWriter()
+{
+    if (!m_binaryWriter)
+        return;
+
+    m_binaryWriter->flush();
+    for (const std::string& error : m_binaryWriter->takeErrors())
+        msg_error() << error;
+}
+
 void VTKExporter::writeParallelFile()
 {
     std::string filename = vtkFilename.getFullPath();
@@ -992,6 +1178,8 @@ void VTKExporter::cleanup()
     if (exportAtEnd.getValue())
         (fileFormat.getValue()) ? writeVTKXML() : writeVTKSimple();
 
+    flushBinaryWriter();
+
 }
 
 void VTKExporter::bwdInit()
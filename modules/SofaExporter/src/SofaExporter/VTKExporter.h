@@ -28,8 +28,10 @@
 #include <sofa/core/objectmodel/DataFileName.h>
 #include <sofa/core/topology/BaseMeshTopology.h>
 #include <sofa/core/behavior/BaseMechanicalState.h>
+#include <SofaExporter/VTUBinaryWriter.h>
 
 #include <fstream>
+#include <memory>
 
 namespace sofa
 {
@@ -55,6 +57,10 @@ protected:
     void fetchDataFields(const helper::vector<std::string>& strData, helper::vector<std::string>& objects, helper::vector<std::string>& fields, helper::vector<std::string>& names);
     void writeVTKSimple();
     void writeVTKXML();
+    void writeVTKXMLBinary();
+    void fetchDataArrays(const helper::vector<std::string>& objects, const helper::vector<std::string>& fields, const helper::vector<std::string>& names, std::vector<VTUBinaryWriter::DataArray>& arrays);
+    std::string getXMLFilename() const;
+    void flushBinaryWriter();
     void writeParallelFile();
     void writeData(const helper::vector<std::string>& objects, const helper::vector<std::string>& fields, const helper::vector<std::string>& names);
     void writeDataArray(const helper::vector<std::string>& objects, const helper::vector<std::string>& fields, const helper::vector<std::string>& names);
@@ -75,6 +81,8 @@ public:
     Data<bool> exportAtBegin; ///< export file at the initialization
     Data<bool> exportAtEnd; ///< export file when the simulation is finished
     Data<bool> overwrite; ///< overwrite the file, otherwise create a new file at each export, with suffix in the filename
+    Data<bool> d_binary; ///< write the XML files with binary appended data, on a background thread
+    Data<bool> d_compress; ///< compress the binary appended data with zlib
 
     int nbFiles;
 
@@ -86,6 +94,9 @@ public:
     helper::vector<std::string> cellsDataField;
     helper::vector<std::string> cellsDataName;
 protected:
+    /// Background writer of the binary files, created at the first binary export
+    std::unique_ptr<VTUBinaryWriter> m_binaryWriter;
+
     VTKExporter();
     ~VTKExporter() override;
 public:
@@ -0,0 +1,288 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaExporter/VTUBinaryWriter.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+
+#if SOFAEXPORTER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace sofa
+{
+
+namespace component
+{
+
+namespace misc
+{
+
+namespace
+{
+
+/// Size of the blocks compressed independently, as expected by vtkZLibDataCompressor
+constexpr std::uint64_t s_compressionBlockSize = 1 << 15;
+
+bool isLittleEndian()
+{
+    const std::uint16_t one = 1;
+    return *reinterpret_cast<const unsigned char*>(&one) == 1;
+}
+
+void appendHeader(std::vector<char>& block, std::uint64_t value)
+{
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    block.insert(block.end(), bytes, bytes + sizeof(value));
+}
+
+/// Appended block of an array: its byte count followed by its content, or the zlib block
+/// header followed by the compressed blocks
+bool encodeArray(const VTUBinaryWriter::DataArray& array, bool compress, std::vector<char>& block, std::string& error)
+{
+    block.clear();
+    const std::uint64_t size = array.bytes.size();
+    if (!compress)
+    {
+        appendHeader(block, size);
+        block.insert(block.end(), array.bytes.begin(), array.bytes.end());
+        return true;
+    }
+
+#if SOFAEXPORTER_HAVE_ZLIB
+    const std::uint64_t nbBlocks = (size + s_compressionBlockSize - 1) / s_compressionBlockSize;
+    appendHeader(block, nbBlocks);
+    appendHeader(block, s_compressionBlockSize);
+    appendHeader(block, size % s_compressionBlockSize);
+    const std::size_t sizesBegin = block.size();
+    block.resize(block.size() + nbBlocks * sizeof(std::uint64_t));
+
+    std::vector<Bytef> compressed(compressBound(uLong(s_compressionBlockSize)));
+    for (std::uint64_t b = 0; b < nbBlocks; ++b)
+    {
+        const std::uint64_t begin = b * s_compressionBlockSize;
+        const uLong blockSize = uLong(std::min(s_compressionBlockSize, size - begin));
+        uLongf compressedSize = uLongf(compressed.size());
+        if (compress2(compressed.data(), &compressedSize, reinterpret_cast<const Bytef*>(array.bytes.data() + begin), blockSize, Z_DEFAULT_COMPRESSION) != Z_OK)
+        {
+            error = "compression of the array '" + array.name + "' failed";
+            return false;
+        }
+        const std::uint64_t compressedSize64 = compressedSize;
+        std::memcpy(block.data() + sizesBegin + b * sizeof(std::uint64_t), &compressedSize64, sizeof(compressedSize64));
+        block.insert(block.end(), compressed.begin(), compressed.begin() + compressedSize);
+    }
+    return true;
+#else
+    error = "compression requires zlib";
+    return false;
+#endif
+}
+
+void writeArrayHeader(std::ostream& out, const VTUBinaryWriter::DataArray& array, std::size_t offset)
+{
+    out << "        <DataArray type=\"" << array.type << "\"";
+    if (!array.name.empty())
+        out << " Name=\"" << array.name << "\"";
+    if (array.nbComponents > 1)
+        out << " NumberOfComponents=\"" << array.nbComponents << "\"";
+    out << " format=\"appended\" offset=\"" << offset << "\"/>\n";
+}
+
+} // namespace
+
+VTUBinaryWriter::VTUBinaryWriter()
+{
+    m_thread = std::thread(&VTUBinaryWriter::run, this);
+}
+
+VTUBinaryWriter::~VTUBinaryWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+    m_thread.join();
+}
+
+VTUBinaryWriter::Snapshot& VTUBinaryWriter::acquireSnapshot()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(lock, [this]
+    {
+        return m_states[0] == SnapshotState::Free || m_states[1] == SnapshotState::Free;
+    });
+    m_filling = (m_states[0] == SnapshotState::Free) ? 0 : 1;
+    m_states[m_filling] = SnapshotState::Filling;
+    return m_snapshots[m_filling];
+}
+
+void VTUBinaryWriter::submit()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_states[m_filling] != SnapshotState::Filling)
+            return;
+        m_states[m_filling] = SnapshotState::Queued;
+        m_queue.push_back(m_filling);
+    }
+    m_condition.notify_all();
+}
+
+void VTUBinaryWriter::flush()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(lock, [this]
+    {
+        return m_queue.empty() && m_states[0] != SnapshotState::Writing && m_states[1] != SnapshotState::Writing;
+    });
+}
+
+std::vector<std::string> VTUBinaryWriter::takeErrors()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<std::string> errors;
+    errors.swap(m_errors);
+    return errors;
+}
+
+void VTUBinaryWriter::run()
+{
+    for (;;)
+    {
+        std::size_t index;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+            if (m_queue.empty())
+                return; // stopped, and all the submitted files are written
+            index = m_queue.front();
+            m_queue.pop_front();
+            m_states[index] = SnapshotState::Writing;
+        }
+
+        std::string error;
+        const bool success = write(m_snapshots[index], error);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!success)
+                m_errors.push_back(error);
+            m_states[index] = SnapshotState::Free;
+        }
+        m_condition.notify_all();
+    }
+}
+
+bool VTUBinaryWriter::write(const Snapshot& snapshot, std::string& error)
+{
+    // The offsets of the arrays in the appended data are needed in the XML header, so the
+    // arrays are encoded first
+    std::vector<const DataArray*> arrays;
+    for (const DataArray& array : snapshot.pointData)
+        arrays.push_back(&array);
+    for (const DataArray& array : snapshot.cellData)
+        arrays.push_back(&array);
+    arrays.push_back(&snapshot.points);
+    arrays.push_back(&snapshot.connectivity);
+    arrays.push_back(&snapshot.offsets);
+    arrays.push_back(&snapshot.types);
+
+    std::vector< std::vector<char> > blocks(arrays.size());
+    std::vector<std::size_t> offsets(arrays.size());
+    std::size_t offset = 0;
+    for (std::size_t i = 0; i < arrays.size(); ++i)
+    {
+        if (!encodeArray(*arrays[i], snapshot.compress, blocks[i], error))
+        {
+            error = "Error writing " + snapshot.filename + ": " + error;
+            return false;
+        }
+        offsets[i] = offset;
+        offset += blocks[i].size();
+    }
+
+    std::ostringstream header;
+    header << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\""
+           << (isLittleEndian() ? "LittleEndian" : "BigEndian") << "\" header_type=\"UInt64\"";
+    if (snapshot.compress)
+        header << " compressor=\"vtkZLibDataCompressor\"";
+    header << ">\n";
+    header << "  <UnstructuredGrid>\n";
+    header << "    <Piece NumberOfPoints=\"" << snapshot.nbPoints << "\" NumberOfCells=\"" << snapshot.nbCells << "\">\n";
+
+    std::size_t a = 0;
+    if (!snapshot.pointData.empty())
+    {
+        header << "      <PointData>\n";
+        for (std::size_t i = 0; i < snapshot.pointData.size(); ++i, ++a)
+            writeArrayHeader(header, *arrays[a], offsets[a]);
+        header << "      </PointData>\n";
+    }
+    if (!snapshot.cellData.empty())
+    {
+        header << "      <CellData>\n";
+        for (std::size_t i = 0; i < snapshot.cellData.size(); ++i, ++a)
+            writeArrayHeader(header, *arrays[a], offsets[a]);
+        header << "      </CellData>\n";
+    }
+    header << "      <Points>\n";
+    writeArrayHeader(header, *arrays[a], offsets[a]);
+    ++a;
+    header << "      </Points>\n";
+    header << "      <Cells>\n";
+    for (; a < arrays.size(); ++a)
+        writeArrayHeader(header, *arrays[a], offsets[a]);
+    header << "      </Cells>\n";
+    header << "    </Piece>\n";
+    header << "  </UnstructuredGrid>\n";
+    header << "  <AppendedData encoding=\"raw\">\n   _";
+
+    std::ofstream file(snapshot.filename.c_str(), std::ios::out | std::ios::binary);
+    if (!file.is_open())
+    {
+        error = "Error creating file " + snapshot.filename;
+        return false;
+    }
+    const std::string headerString = header.str();
+    file.write(headerString.data(), std::streamsize(headerString.size()));
+    for (const std::vector<char>& block : blocks)
+        file.write(block.data(), std::streamsize(block.size()));
+    file << "\n  </AppendedData>\n</VTKFile>\n";
+    file.close();
+
+    if (!file)
+    {
+        error = "Error writing file " + snapshot.filename;
+        return false;
+    }
+    return true;
+}
+
+} // namespace misc
+
+} // namespace component
+
+} // namespace sofa
@@ -0,0 +1,129 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFAEXPORTER_VTUBINARYWRITER_H
+#define SOFAEXPORTER_VTUBINARYWRITER_H
+#include <SofaExporter/config.h>
+
+#include <array>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sofa
+{
+
+namespace component
+{
+
+namespace misc
+{
+
+/**
+ * Writes VTK XML unstructured grid files (.vtu) with binary appended data, optionally compressed
+ * with zlib, on a background thread.
+ *
+ * The simulation thread copies the arrays to export in a snapshot and submits it. The encoding,
+ * the compression and the disk access are then made by the writer thread. Two snapshots are
+ * used alternately: the simulation only waits when it submits a file while the two previous
+ * ones are still being written.
+ */
+class SOFA_SOFAEXPORTER_API VTUBinaryWriter
+{
+public:
+    struct DataArray
+    {
+        std::string type; ///< VTK type name (Int32, UInt32, Float32, Float64, UInt8)
+        std::string name;
+        unsigned int nbComponents {1};
+        std::vector<char> bytes;
+
+        template<class T>
+        void assign(const T* values, std::size_t nbValues)
+        {
+            bytes.resize(nbValues * sizeof(T));
+            if (nbValues)
+                std::memcpy(bytes.data(), values, bytes.size());
+        }
+    };
+
+    struct Snapshot
+    {
+        std::string filename;
+        bool compress {false};
+        std::size_t nbPoints {0};
+        std::size_t nbCells {0};
+        std::vector<DataArray> pointData;
+        std::vector<DataArray> cellData;
+        DataArray points;
+        DataArray connectivity;
+        DataArray offsets;
+        DataArray types;
+    };
+
+    VTUBinaryWriter();
+
+    /// Waits until all the submitted files are written
+    ~VTUBinaryWriter();
+
+    /// Snapshot to fill with the next file. Waits while the two snapshots are in use.
+    Snapshot& acquireSnapshot();
+
+    /// Queue the acquired snapshot to be written
+    void submit();
+
+    /// Wait until all the submitted files are written
+    void flush();
+
+    /// Errors of the files written since the last call, to be reported by the simulation thread
+    std::vector<std::string> takeErrors();
+
+    /// Write a snapshot on the calling thread
+    static bool write(const Snapshot& snapshot, std::string& error);
+
+protected:
+    enum class SnapshotState { Free, Filling, Queued, Writing };
+
+    void run();
+
+    std::array<Snapshot, 2> m_snapshots;
+    std::array<SnapshotState, 2> m_states {{SnapshotState::Free, SnapshotState::Free}};
+    std::deque<std::size_t> m_queue;
+    std::size_t m_filling {0};
+    std::vector<std::string> m_errors;
+    bool m_stop {false};
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::thread m_thread;
+};
+
+} // namespace misc
+
+} // namespace component
+
+} // namespace sofa
+
+#endif
@@ -30,6 +30,7 @@
 #include <sofa/core/behavior/MechanicalState.h>
 #include <sofa/core/topology/BaseMeshTopology.h>
 #include <sofa/core/loader/MeshLoader.h>
+#include <SofaEngine/ROISpatialIndex.h>
 
 namespace sofa::component::engine
 {
@@ -153,6 +154,19 @@ public:
     Data<bool> p_drawTetrahedra; ///< Draw Tetrahedra
     Data<float> _drawSize; ///< rendering size for box and topological elements
 
+protected:
+    /// Spatial indices on the rest positions and the elements, rebuilt only when they change,
+    /// so that moving the spheres does not require a scan of the whole mesh
+    ROIPointGrid m_pointGrid;
+    ROIElementsByVertex m_edgesByVertex;
+    ROIElementsByVertex m_trianglesByVertex;
+    ROIElementsByVertex m_quadsByVertex;
+    ROIElementsByVertex m_tetrahedraByVertex;
+    helper::vector<sofa::Index> m_candidates;
+
+    /// Clear the spatial indices whose inputs changed
+    void updateSpatialIndices();
+
 };
 
 template<> bool SphereROI<defaulttype::Rigid3Types>::isPointInSphere(const Vec3& c, const Real& r, const Coord& p);
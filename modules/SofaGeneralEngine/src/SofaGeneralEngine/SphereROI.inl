@@ -261,9 +261,32 @@ bool SphereROI<DataTypes>::isTetrahedronInSphere(const Vec3& c, const Real& r, c
 }
 
 
+template <class DataTypes>
+void SphereROI<DataTypes>::updateSpatialIndices()
+{
+    if (m_dataTracker.hasChanged(f_X0))
+    {
+        m_pointGrid.clear();
+        m_edgesByVertex.clear();
+        m_trianglesByVertex.clear();
+        m_quadsByVertex.clear();
+        m_tetrahedraByVertex.clear();
+    }
+    if (m_dataTracker.hasChanged(f_edges))
+        m_edgesByVertex.clear();
+    if (m_dataTracker.hasChanged(f_triangles))
+        m_trianglesByVertex.clear();
+    if (m_dataTracker.hasChanged(f_quads))
+        m_quadsByVertex.clear();
+    if (m_dataTracker.hasChanged(f_tetrahedra))
+        m_tetrahedraByVertex.clear();
+}
+
 template <class DataTypes>
 void SphereROI<DataTypes>::doUpdate()
 {
+    updateSpatialIndices();
+
     const helper::vector<Vec3>& cen = (centers.getValue());
     const helper::vector<Real>& rad = (radii.getValue());
 
@@ -336,26 +359,55 @@ void SphereROI<DataTypes>::doUpdate()
 
 
     //Points
-    for( unsigned i=0; i<x0->size(); ++i )
+    if (!m_pointGrid.isBuilt())
+    {
+        helper::vector<defaulttype::Vector3> positions(x0->size());
+        for (unsigned int i=0; i<x0->size(); ++i)
+        {
+            const CPos p = DataTypes::getCPos((*x0)[i]);
+            positions[i] = defaulttype::Vector3(p[0], p[1], p[2]);
+        }
+        m_pointGrid.build(positions);
+    }
+
+    helper::vector<defaulttype::BoundingBox> spheresBBoxes;
+    for (unsigned int j=0; j<cen.size(); ++j)
+    {
+        // rounding margin, as the inclusion test is made on the distance to the center
+        const Real margin = (fabs(rad[j]) + cen[j].norm()) * 1.0e-8;
+        const defaulttype::Vector3 halfSize(rad[j] + margin, rad[j] + margin, rad[j] + margin);
+        spheresBBoxes.push_back(defaulttype::BoundingBox(defaulttype::Vector3(cen[j]) - halfSize, defaulttype::Vector3(cen[j]) + halfSize));
+    }
+    m_pointGrid.findCandidates(spheresBBoxes, m_candidates);
+
+    for (const sofa::Index i : m_candidates)
     {
-        bool isInSpheres = false;
         for (unsigned int j=0; j<cen.size(); ++j)
         {
             if (isPointInSphere(cen[j], rad[j], (*x0)[i]))
             {
                 indices.push_back(i);
                 pointsInROI.push_back((*x0)[i]);
-                isInSpheres = true;
                 break;
             }
         }
-        if (!isInSpheres) indicesOut.push_back(i);
+    }
+
+    for (unsigned int i=0, k=0; i<x0->size(); ++i)
+    {
+        if (k < indices.size() && indices[k] == i)
+            ++k;
+        else
+            indicesOut.push_back(i);
     }
 
     //Edges
     if (f_computeEdges.getValue())
     {
-        for(unsigned int i=0 ; i<edges.size() ; i++)
+        if (!m_edgesByVertex.isBuilt())
+            m_edgesByVertex.build(x0->size(), edges.ref());
+        m_edgesByVertex.findCandidates(indices, m_candidates);
+        for (const sofa::Index i : m_candidates)
         {
             Edge edge = edges[i];
             for (unsigned int j=0; j<cen.size(); ++j)
@@ -379,7 +431,10 @@ void SphereROI<DataTypes>::doUpdate()
     //Triangles
     if (f_computeTriangles.getValue())
     {
-        for(unsigned int i=0 ; i<triangles.size() ; i++)
+        if (!m_trianglesByVertex.isBuilt())
+            m_trianglesByVertex.build(x0->size(), triangles.ref());
+        m_trianglesByVertex.findCandidates(indices, m_candidates);
+        for (const sofa::Index i : m_candidates)
         {
             Triangle tri = triangles[i];
             for (unsigned int j=0; j<cen.size(); ++j)
@@ -403,7 +458,10 @@ void SphereROI<DataTypes>::doUpdate()
     //Quads
     if (f_computeQuads.getValue())
     {
-        for(unsigned int i=0 ; i<quads.size() ; i++)
+        if (!m_quadsByVertex.isBuilt())
+            m_quadsByVertex.build(x0->size(), quads.ref());
+        m_quadsByVertex.findCandidates(indices, m_candidates);
+        for (const sofa::Index i : m_candidates)
         {
             Quad qua = quads[i];
             for (unsigned int j=0; j<cen.size(); ++j)
@@ -421,7 +479,10 @@ void SphereROI<DataTypes>::doUpdate()
     //Tetrahedra
     if (f_computeTetrahedra.getValue())
     {
-        for(unsigned int i=0 ; i<tetrahedra.size() ; i++)
+        if (!m_tetrahedraByVertex.isBuilt())
+            m_tetrahedraByVertex.build(x0->size(), tetrahedra.ref());
+        m_tetrahedraByVertex.findCandidates(indices, m_candidates);
+        for (const sofa::Index i : m_candidates)
         {
             Tetra t = tetrahedra[i];
             for (unsigned int j=0; j<cen.size(); ++j)
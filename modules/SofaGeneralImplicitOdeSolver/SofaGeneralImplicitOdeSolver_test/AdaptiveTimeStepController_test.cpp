@@ -0,0 +1,136 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaTest/Sofa_test.h>
+#include <SceneCreator/SceneCreator.h>
+#include <SceneCreator/SceneUtils.h>
+#include <SofaGeneralImplicitOdeSolver/AdaptiveTimeStepController.h>
+#include <SofaImplicitOdeSolver/EulerImplicitSolver.h>
+#include <SofaBaseLinearSolver/CGLinearSolver.h>
+#include <SofaBoundaryCondition/FixedConstraint.h>
+
+#include <sofa/simulation/Simulation.h>
+
+#include <SofaTest/TestMessageHandler.h>
+
+
+namespace sofa {
+
+using namespace modeling;
+using namespace defaulttype;
+
+using sofa::component::projectiveconstraintset::FixedConstraint;
+using sofa::component::odesolver::AdaptiveTimeStepController;
+using sofa::component::odesolver::EulerImplicitSolver;
+typedef component::linearsolver::CGLinearSolver<component::linearsolver::GraphScatteredMatrix, component::linearsolver::GraphScatteredVector> CGLinearSolver;
+
+
+/** Mass-spring string composed of two particles in gravity, one is fixed, integrated with an adaptive time step.
+ * The initial time step is much too large for the requested tolerance: the first steps must be rejected,
+ * and all the accepted ones must respect the tolerance.
+ */
+struct AdaptiveTimeStepController_test : public Sofa_test<>
+{
+    simulation::Node::SPtr root;
+    AdaptiveTimeStepController::SPtr controller;
+
+    void createScene(SReal dt, SReal tolerance)
+    {
+        root = modeling::initSofa();
+        root->setDt(dt);
+
+        controller = addNew<AdaptiveTimeStepController>(root);
+        controller->d_tolerance.setValue(tolerance);
+        controller->d_minDt.setValue(1e-5);
+        controller->d_maxDt.setValue(dt);
+
+        EulerImplicitSolver::SPtr odeSolver = addNew<EulerImplicitSolver>(root);
+        CGLinearSolver::SPtr linearSolver = addNew<CGLinearSolver>(root);
+        linearSolver->f_maxIter.setValue(25);
+        linearSolver->f_tolerance.setValue(1e-10);
+        linearSolver->f_smallDenominatorThreshold.setValue(1e-10);
+
+        simulation::Node::SPtr string = massSpringString(
+                    root, // attached to root node
+                    0,1,0,     // first particle position
+                    0,0,0,     // last  particle position
+                    2,      // number of particles
+                    2.0,    // total mass
+                    1000.0, // stiffness
+                    0.1     // damping ratio
+                    );
+        FixedConstraint<Vec3Types>::SPtr fixed = modeling::addNew<FixedConstraint<Vec3Types> >(string,"fixedConstraint");
+        fixed->addConstraint(0);      // attach first particle
+
+        initScene(root);
+    }
+
+    void step()
+    {
+        sofa::simulation::getSimulation()->animate(root.get(), root->getDt());
+    }
+};
+
+TEST_F( AdaptiveTimeStepController_test, rejectedStepRestoresState )
+{
+    EXPECT_MSG_NOEMIT(Error) ;
+    createScene(0.1, 1e-4);
+
+    const Vector x0 = getVector( core::VecId::position() );
+    step();
+
+    EXPECT_EQ(controller->d_nbRejectedSteps.getValue(), 1u);
+    EXPECT_EQ(root->getTime(), 0.0);
+    EXPECT_LT(root->getDt(), 0.1);
+    EXPECT_LE(vectorMaxDiff(x0, getVector( core::VecId::position() )), 1e-12);
+}
+
+TEST_F( AdaptiveTimeStepController_test, acceptedStepsRespectTolerance )
+{
+    EXPECT_MSG_NOEMIT(Error) ;
+    const SReal tolerance = 1e-4;
+    createScene(0.1, tolerance);
+
+    for (unsigned int i = 0; i < 200; ++i)
+    {
+        const unsigned int nbRejected = controller->d_nbRejectedSteps.getValue();
+        const SReal time = root->getTime();
+        step();
+
+        if (controller->d_nbRejectedSteps.getValue() == nbRejected)
+        {
+            EXPECT_LE(controller->d_errorEstimate.getValue(), tolerance);
+            EXPECT_NEAR(root->getTime(), time + controller->d_acceptedDt.getValue(), 1e-12);
+        }
+        else
+        {
+            EXPECT_EQ(root->getTime(), time);
+        }
+
+        EXPECT_GE(root->getDt(), controller->d_minDt.getValue());
+        EXPECT_LE(root->getDt(), controller->d_maxDt.getValue());
+    }
+
+    EXPECT_GT(controller->d_nbRejectedSteps.getValue(), 0u);
+    EXPECT_GT(root->getTime(), 0.0);
+}
+
+}// namespace sofa
@@ -0,0 +1,194 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaGeneralImplicitOdeSolver/AdaptiveTimeStepController.h>
+
+#include <sofa/core/ObjectFactory.h>
+#include <sofa/simulation/AnimateBeginEvent.h>
+#include <sofa/simulation/AnimateEndEvent.h>
+#include <sofa/simulation/MechanicalOperations.h>
+#include <sofa/simulation/VectorOperations.h>
+#include <sofa/simulation/UpdateContextVisitor.h>
+#include <sofa/simulation/Node.h>
+#include <sofa/helper/AdvancedTimer.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace sofa::component::odesolver
+{
+
+using sofa::core::VecCoordId;
+using sofa::core::VecDerivId;
+using sofa::simulation::common::VectorOperations;
+using sofa::simulation::common::MechanicalOperations;
+
+AdaptiveTimeStepController::AdaptiveTimeStepController()
+    : d_tolerance(initData(&d_tolerance, (SReal)1e-4, "tolerance", "Maximum local position error accepted on a time step"))
+    , d_minDt(initData(&d_minDt, (SReal)1e-6, "minDt", "Minimum time step"))
+    , d_maxDt(initData(&d_maxDt, (SReal)0.1, "maxDt", "Maximum time step"))
+    , d_safetyFactor(initData(&d_safetyFactor, (SReal)0.9, "safetyFactor", "Safety factor applied to the optimal time step"))
+    , d_minFactor(initData(&d_minFactor, (SReal)0.2, "minFactor", "Maximum decrease factor of the time step between two steps"))
+    , d_maxFactor(initData(&d_maxFactor, (SReal)2.0, "maxFactor", "Maximum increase factor of the time step between two steps"))
+    , d_acceptedDt(initData(&d_acceptedDt, (SReal)0.0, "acceptedDt", "OUTPUT: time step of the last accepted step"))
+    , d_errorEstimate(initData(&d_errorEstimate, (SReal)0.0, "errorEstimate", "OUTPUT: local error estimate of the last step"))
+    , d_nbRejectedSteps(initData(&d_nbRejectedSteps, 0u, "nbRejectedSteps", "OUTPUT: number of rejected steps since the beginning of the simulation"))
+    , m_startTime(0)
+    , m_hasStartState(false)
+{
+    f_listening.setValue(true);
+
+    d_acceptedDt.setReadOnly(true);
+    d_errorEstimate.setReadOnly(true);
+    d_nbRejectedSteps.setReadOnly(true);
+    d_acceptedDt.setGroup("Stats");
+    d_errorEstimate.setGroup("Stats");
+    d_nbRejectedSteps.setGroup("Stats");
+}
+
+void AdaptiveTimeStepController::init()
+{
+    Inherit1::init();
+
+    if (d_tolerance.getValue() <= 0)
+    {
+        msg_warning() << "tolerance must be strictly positive, 1e-4 is used instead";
+        d_tolerance.setValue(1e-4);
+    }
+    if (d_minDt.getValue() <= 0 || d_maxDt.getValue() < d_minDt.getValue())
+    {
+        msg_warning() << "Invalid time step bounds [" << d_minDt.getValue() << ", " << d_maxDt.getValue()
+                      << "], [1e-6, 0.1] is used instead";
+        d_minDt.setValue(1e-6);
+        d_maxDt.setValue(0.1);
+    }
+    if (d_minFactor.getValue() <= 0 || d_minFactor.getValue() > 1 || d_maxFactor.getValue() < 1)
+    {
+        msg_warning() << "minFactor must be in ]0,1] and maxFactor must be larger than 1, 0.2 and 2 are used instead";
+        d_minFactor.setValue(0.2);
+        d_maxFactor.setValue(2.0);
+    }
+
+    reset();
+}
+
+void AdaptiveTimeStepController::reset()
+{
+    d_acceptedDt.setValue(0);
+    d_errorEstimate.setValue(0);
+    d_nbRejectedSteps.setValue(0);
+    m_hasStartState = false;
+}
+
+void AdaptiveTimeStepController::cleanup()
+{
+    VectorOperations vop(core::ExecParams::defaultInstance(), this->getContext());
+    vop.v_free(m_startPosition.id(), false, true);
+    vop.v_free(m_startVelocity.id(), false, true);
+    Inherit1::cleanup();
+}
+
+void AdaptiveTimeStepController::handleEvent(sofa::core::objectmodel::Event* event)
+{
+    if (sofa::simulation::AnimateBeginEvent::checkEventType(event))
+    {
+        onBeginAnimationStep(static_cast<sofa::simulation::AnimateBeginEvent*>(event)->getDt());
+    }
+    else if (sofa::simulation::AnimateEndEvent::checkEventType(event))
+    {
+        onEndAnimationStep(static_cast<sofa::simulation::AnimateEndEvent*>(event)->getDt());
+    }
+}
+
+void AdaptiveTimeStepController::onBeginAnimationStep(SReal /*dt*/)
+{
+    const core::ExecParams* params = core::ExecParams::defaultInstance();
+    VectorOperations vop(params, this->getContext());
+
+    m_startPosition.realloc(&vop, false, true);
+    m_startVelocity.realloc(&vop, false, true);
+    m_startPosition.eq(VecCoordId::position());
+    m_startVelocity.eq(VecDerivId::velocity());
+
+    m_startTime = this->getContext()->getTime();
+    m_hasStartState = true;
+}
+
+void AdaptiveTimeStepController::onEndAnimationStep(SReal dt)
+{
+    if (!m_hasStartState || dt <= 0)
+        return;
+    m_hasStartState = false;
+
+    sofa::helper::ScopedAdvancedTimer timer("AdaptiveTimeStep");
+
+    const core::ExecParams* params = core::ExecParams::defaultInstance();
+    VectorOperations vop(params, this->getContext());
+    MechanicalOperations mop(params, this->getContext());
+
+    // difference between the backward Euler and the trapezoidal position updates
+    core::behavior::MultiVecDeriv dv(&vop);
+    dv.eq(VecDerivId::velocity(), m_startVelocity.id(), -1.0);
+    const SReal error = dt * (SReal)0.5 * dv.norm(0);
+    d_errorEstimate.setValue(error);
+
+    const SReal minDt = d_minDt.getValue();
+    const SReal maxDt = d_maxDt.getValue();
+    const SReal scaledError = error / d_tolerance.getValue();
+
+    // the error of the first order scheme is O(dt^2)
+    SReal factor = d_maxFactor.getValue();
+    if (scaledError > 0)
+        factor = std::clamp(d_safetyFactor.getValue() * std::sqrt(1 / scaledError), d_minFactor.getValue(), d_maxFactor.getValue());
+
+    sofa::simulation::Node* root = dynamic_cast<sofa::simulation::Node*>(this->getContext()->getRootContext());
+    if (!root)
+    {
+        msg_error() << "The root context is not a node: the time step cannot be controlled";
+        return;
+    }
+
+    if (scaledError > 1 && dt > minDt)
+    {
+        // reject the step: go back to the state at the beginning of the step
+        msg_info() << "Step rejected at t=" << m_startTime << " with dt=" << dt << " (error " << error << ")";
+
+        vop.v_eq(VecCoordId::position(), m_startPosition.id());
+        vop.v_eq(VecDerivId::velocity(), m_startVelocity.id());
+        mop.propagateXAndV(VecCoordId::position(), VecDerivId::velocity());
+
+        root->setTime(m_startTime);
+        root->execute<sofa::simulation::UpdateSimulationContextVisitor>(params);
+
+        d_nbRejectedSteps.setValue(d_nbRejectedSteps.getValue() + 1);
+    }
+    else
+    {
+        d_acceptedDt.setValue(dt);
+    }
+
+    root->setDt(std::clamp(dt * factor, minDt, maxDt));
+}
+
+int AdaptiveTimeStepControllerClass = core::RegisterObject("Adaptive time step with local error control, rejecting the steps whose error is too large")
+        .add< AdaptiveTimeStepController >();
+
+} // namespace sofa::component::odesolver
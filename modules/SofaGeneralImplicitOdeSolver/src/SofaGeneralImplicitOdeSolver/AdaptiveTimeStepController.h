@@ -0,0 +1,86 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <SofaGeneralImplicitOdeSolver/config.h>
+
+#include <sofa/core/behavior/BaseController.h>
+#include <sofa/core/behavior/MultiVec.h>
+
+namespace sofa::component::odesolver
+{
+
+/** Adaptive time step driver with local error control, for the ODE solvers of its subtree.
+ *
+ * The local error of a step of size h is estimated by comparing the first order (backward Euler)
+ * position update x_{t+h} = x_t + h v_{t+h} with the second order (trapezoidal) one
+ * x_{t+h} = x_t + h/2 (v_t + v_{t+h}):
+ *
+ *   \f$ e = h/2 \| v_{t+h} - v_t \|_\infty \f$
+ *
+ * This estimate only uses the states at the beginning and at the end of the step, so it can be
+ * used with any integrator (EulerImplicitSolver, NewmarkImplicitSolver, VariationalSymplecticSolver...).
+ * For second order integrators, it is a conservative bound.
+ *
+ * After each step, the time step of the root node is scaled by safetyFactor * sqrt(tolerance / e),
+ * bounded by [minFactor, maxFactor] and [minDt, maxDt]. When e is larger than the tolerance (and dt is
+ * larger than minDt), the step is rejected: the positions, the velocities and the time are restored
+ * to their values at the beginning of the step, which is then computed again with the reduced dt.
+ */
+class SOFA_SOFAGENERALIMPLICITODESOLVER_API AdaptiveTimeStepController : public sofa::core::behavior::BaseController
+{
+public:
+    SOFA_CLASS(AdaptiveTimeStepController, sofa::core::behavior::BaseController);
+
+    Data<SReal> d_tolerance; ///< Maximum local position error accepted on a time step
+    Data<SReal> d_minDt; ///< Minimum time step
+    Data<SReal> d_maxDt; ///< Maximum time step
+    Data<SReal> d_safetyFactor; ///< Safety factor applied to the optimal time step
+    Data<SReal> d_minFactor; ///< Maximum decrease factor of the time step between two steps
+    Data<SReal> d_maxFactor; ///< Maximum increase factor of the time step between two steps
+
+    Data<SReal> d_acceptedDt; ///< OUTPUT: time step of the last accepted step
+    Data<SReal> d_errorEstimate; ///< OUTPUT: local error estimate of the last step
+    Data<unsigned int> d_nbRejectedSteps; ///< OUTPUT: number of rejected steps since the beginning of the simulation
+
+protected:
+    AdaptiveTimeStepController();
+
+public:
+    void init() override;
+    void reset() override;
+    void cleanup() override;
+    void handleEvent(sofa::core::objectmodel::Event* event) override;
+
+protected:
+    /// Save the state at the beginning of the time step
+    void onBeginAnimationStep(SReal dt);
+
+    /// Estimate the error of the step, accept or reject it and choose the next time step
+    void onEndAnimationStep(SReal dt);
+
+    sofa::core::behavior::MultiVecCoord m_startPosition;
+    sofa::core::behavior::MultiVecDeriv m_startVelocity;
+    SReal m_startTime;
+    bool m_hasStartState;
+};
+
+} // namespace sofa::component::odesolver
@@ -0,0 +1,203 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include "AsyncFrameRecorder.h"
+
+#include <sofa/helper/logging/Messaging.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace sofa
+{
+
+namespace gui
+{
+
+namespace hRecorder
+{
+
+AsyncFrameRecorder::AsyncFrameRecorder()
+    : m_width(0)
+    , m_height(0)
+    , m_format(GL_RGBA)
+    , m_frameSize(0)
+    , m_active(false)
+    , m_useFences(false)
+    , m_nextPixelBuffer(0)
+    , m_nbFramesInFlight(0)
+    , m_maxPendingFrames(1)
+    , m_stopWriter(false)
+{
+}
+
+AsyncFrameRecorder::~AsyncFrameRecorder()
+{
+    finish();
+}
+
+void AsyncFrameRecorder::init(GLsizei width, GLsizei height, GLenum format, unsigned int nbPixelBuffers, unsigned int maxPendingFrames, FrameWriter writer)
+{
+    finish();
+
+    m_width = width;
+    m_height = height;
+    m_format = format;
+    m_frameSize = static_cast<size_t>(width) * static_cast<size_t>(height) * (format == GL_RGB ? 3 : 4);
+    m_writer = writer;
+    m_maxPendingFrames = std::max(maxPendingFrames, 1u);
+
+    // Without fences, mapping a buffer waits for its readback to complete, which is still
+    // asynchronous as long as the ring holds more than one buffer.
+    m_useFences = GLEW_ARB_sync != 0;
+
+    m_pixelBuffers.resize(std::max(nbPixelBuffers, 1u));
+    for (PixelBuffer& buffer : m_pixelBuffers)
+    {
+        glGenBuffers(1, &buffer.pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, m_frameSize, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    m_nextPixelBuffer = 0;
+    m_nbFramesInFlight = 0;
+
+    m_stopWriter = false;
+    m_writerThread = std::thread(&AsyncFrameRecorder::writerLoop, this);
+    m_active = true;
+}
+
+void AsyncFrameRecorder::capture(unsigned int frameIndex)
+{
+    if (!m_active)
+        return;
+
+    if (m_nbFramesInFlight == m_pixelBuffers.size())
+        retrieveOldestFrame();
+
+    PixelBuffer& buffer = m_pixelBuffers[m_nextPixelBuffer];
+    buffer.frameIndex = frameIndex;
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.pbo);
+    glReadPixels(0, 0, m_width, m_height, m_format, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (m_useFences)
+        buffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    m_nextPixelBuffer = (m_nextPixelBuffer + 1) % m_pixelBuffers.size();
+    ++m_nbFramesInFlight;
+}
+
+void AsyncFrameRecorder::retrieveOldestFrame()
+{
+    const size_t nbPixelBuffers = m_pixelBuffers.size();
+    PixelBuffer& buffer = m_pixelBuffers[(m_nextPixelBuffer + nbPixelBuffers - m_nbFramesInFlight) % nbPixelBuffers];
+    --m_nbFramesInFlight;
+
+    if (buffer.fence)
+    {
+        while (glClientWaitSync(buffer.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED) {}
+        glDeleteSync(buffer.fence);
+        buffer.fence = nullptr;
+    }
+
+    // Get a frame from the pool, waiting for the writer if it is too far behind
+    Frame frame;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_frameWritten.wait(lock, [this]{ return m_pendingFrames.size() < m_maxPendingFrames; });
+        if (!m_freeFrames.empty())
+        {
+            frame.swap(m_freeFrames.back());
+            m_freeFrames.pop_back();
+        }
+    }
+    frame.resize(m_frameSize);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.pbo);
+    const void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, m_frameSize, GL_MAP_READ_BIT);
+    if (pixels)
+    {
+        std::memcpy(frame.data(), pixels, m_frameSize);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    else
+    {
+        msg_error("HeadlessRecorder") << "Failed to map the pixels of frame " << buffer.frameIndex;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pendingFrames.emplace_back(buffer.frameIndex, std::move(frame));
+    }
+    m_frameQueued.notify_one();
+}
+
+void AsyncFrameRecorder::writerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_frameQueued.wait(lock, [this]{ return m_stopWriter || !m_pendingFrames.empty(); });
+        if (m_pendingFrames.empty())
+            break;
+
+        std::pair<unsigned int, Frame> pending = std::move(m_pendingFrames.front());
+        m_pendingFrames.pop_front();
+
+        lock.unlock();
+        m_writer(pending.first, pending.second);
+        lock.lock();
+
+        m_freeFrames.push_back(std::move(pending.second));
+        m_frameWritten.notify_one();
+    }
+}
+
+void AsyncFrameRecorder::finish()
+{
+    if (!m_active)
+        return;
+
+    while (m_nbFramesInFlight > 0)
+        retrieveOldestFrame();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopWriter = true;
+    }
+    m_frameQueued.notify_one();
+    m_writerThread.join();
+
+    for (PixelBuffer& buffer : m_pixelBuffers)
+        glDeleteBuffers(1, &buffer.pbo);
+    m_pixelBuffers.clear();
+    m_freeFrames.clear();
+    m_active = false;
+}
+
+} // namespace hRecorder
+
+} // namespace gui
+
+} // namespace sofa
@@ -0,0 +1,114 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#ifndef SOFA_GUI_HEADLESSRECORDER_ASYNCFRAMERECORDER_H
+#define SOFA_GUI_HEADLESSRECORDER_ASYNCFRAMERECORDER_H
+
+#include <sofa/helper/system/gl.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sofa
+{
+
+namespace gui
+{
+
+namespace hRecorder
+{
+
+/** Asynchronous capture of the frames rendered by the HeadlessRecorder.
+ *
+ * The pixels of each frame are read back into a ring of pixel buffer objects, so that the rendering thread
+ * does not wait for the GPU to complete the frame. A pixel buffer is mapped only when the ring wraps around,
+ * and its pixels are handed over to a writer thread which encodes or saves the frames one at a time, in the
+ * order they were captured.
+ */
+class AsyncFrameRecorder
+{
+public:
+    typedef std::vector<unsigned char> Frame;
+
+    /// Called by the writer thread for each frame, in capture order
+    typedef std::function<void(unsigned int frameIndex, const Frame& pixels)> FrameWriter;
+
+    AsyncFrameRecorder();
+    ~AsyncFrameRecorder();
+
+    /// Allocates the pixel buffers and starts the writer thread. Requires the GL context to be current.
+    /// @param format GL_RGB or GL_RGBA, rows are not padded
+    /// @param nbPixelBuffers number of frames in flight between the GPU and the rendering thread
+    /// @param maxPendingFrames number of frames waiting for the writer before the rendering thread blocks
+    void init(GLsizei width, GLsizei height, GLenum format, unsigned int nbPixelBuffers, unsigned int maxPendingFrames, FrameWriter writer);
+
+    /// Starts the readback of the current read framebuffer
+    void capture(unsigned int frameIndex);
+
+    /// Hands over the frames still in flight, waits until all frames are written and releases the pixel buffers
+    void finish();
+
+    bool isActive() const { return m_active; }
+
+protected:
+    struct PixelBuffer
+    {
+        GLuint pbo {0};
+        GLsync fence {nullptr};
+        unsigned int frameIndex {0};
+    };
+
+    /// Maps the oldest pixel buffer in flight and queues its pixels for the writer thread
+    void retrieveOldestFrame();
+    void writerLoop();
+
+    GLsizei m_width, m_height;
+    GLenum m_format;
+    size_t m_frameSize;
+    bool m_active;
+    bool m_useFences;
+
+    std::vector<PixelBuffer> m_pixelBuffers;
+    unsigned int m_nextPixelBuffer;
+    unsigned int m_nbFramesInFlight;
+
+    FrameWriter m_writer;
+    std::thread m_writerThread;
+    std::mutex m_mutex;
+    std::condition_variable m_frameQueued;
+    std::condition_variable m_frameWritten;
+    std::deque<std::pair<unsigned int, Frame> > m_pendingFrames; ///< frames waiting for the writer, in capture order
+    std::vector<Frame> m_freeFrames; ///< written frames, reused to avoid reallocations
+    unsigned int m_maxPendingFrames;
+    bool m_stopWriter;
+};
+
+} // namespace hRecorder
+
+} // namespace gui
+
+} // namespace sofa
+
+#endif
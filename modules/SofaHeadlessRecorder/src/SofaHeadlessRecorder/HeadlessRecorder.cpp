@@ -29,6 +29,13 @@ using sofa::helper::system::SetDirectory;
 #include <boost/program_options.hpp>
 #include <thread>
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef SOFA_HEADLESSRECORDER_HAVE_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
 
 namespace sofa
 {
@@ -51,6 +58,10 @@ bool HeadlessRecorder::recordUntilStopAnimate = false;
 std::string HeadlessRecorder::recordTypeRaw = "wallclocktime";
 RecordMode HeadlessRecorder::recordType = RecordMode::wallclocktime;
 float HeadlessRecorder::skipTime = 0;
+unsigned int HeadlessRecorder::recordEvery = 1;
+bool HeadlessRecorder::asyncRecording = true;
+std::string HeadlessRecorder::glContextType = "auto";
+bool HeadlessRecorder::softwareGL = false;
 
 using namespace sofa::defaulttype;
 using sofa::simulation::getSimulation;
@@ -61,6 +72,151 @@ typedef Bool (*glXMakeContextCurrentARBProc)(Display*, GLXDrawable, GLXDrawable,
 static glXCreateContextAttribsARBProc glXCreateContextAttribsARB = nullptr;
 static glXMakeContextCurrentARBProc glXMakeContextCurrentARB = nullptr;
 
+/// Creates a GL context rendering into a pbuffer of an X display (real or virtual, like Xvfb)
+static bool createGLXContext(GLsizei width, GLsizei height)
+{
+    int context_attribs[] = {
+        GLX_CONTEXT_MAJOR_VERSION_ARB, 3,
+        GLX_CONTEXT_MINOR_VERSION_ARB, 0,
+        None
+    };
+
+    /* open display */
+    Display* m_display = XOpenDisplay(nullptr);
+    if (!m_display){
+        msg_error("HeadlessRecorder") << "Failed to open display";
+        return false;
+    }
+
+    /* get framebuffer configs, any is usable (might want to add proper attribs) */
+    int fbcount = 0;
+    GLXFBConfig* fbc = glXChooseFBConfig(m_display, DefaultScreen(m_display), nullptr, &fbcount);
+    if (!fbc){
+        msg_error("HeadlessRecorder") << "Failed to get FBConfig";
+        return false;
+    }
+
+    /* get the required extensions */
+    glXCreateContextAttribsARB = (glXCreateContextAttribsARBProc)glXGetProcAddressARB( (const GLubyte *) "glXCreateContextAttribsARB");
+    glXMakeContextCurrentARB = (glXMakeContextCurrentARBProc)glXGetProcAddressARB( (const GLubyte *) "glXMakeContextCurrent");
+    if ( !(glXCreateContextAttribsARB && glXMakeContextCurrentARB) ){
+        msg_error("HeadlessRecorder") << "Missing support for GLX_ARB_create_context";
+        XFree(fbc);
+        return false;
+    }
+
+    /* create a context using glXCreateContextAttribsARB */
+    GLXContext ctx = glXCreateContextAttribsARB(m_display, fbc[0], nullptr, True, context_attribs);
+    if (!ctx){
+        msg_error("HeadlessRecorder") << "Failed to create opengl context";
+        XFree(fbc);
+        return false;
+    }
+
+    /* create temporary pbuffer */
+    int pbuffer_attribs[] = {
+        GLX_PBUFFER_WIDTH, width,
+        GLX_PBUFFER_HEIGHT, height,
+        None
+    };
+    GLXPbuffer pbuf = glXCreatePbuffer(m_display, fbc[0], pbuffer_attribs);
+
+    XFree(fbc);
+    XSync(m_display, False);
+
+    /* try to make it the current context */
+    if ( !glXMakeContextCurrent(m_display, pbuf, pbuf, ctx) ){
+        /* some drivers does not support context without default framebuffer, so fallback on
+                    * using the default window.
+                    */
+        if ( !glXMakeContextCurrent(m_display, DefaultRootWindow(m_display), DefaultRootWindow(m_display), ctx) ){
+            msg_error("HeadlessRecorder") << "Failed to make current";
+            return false;
+        }
+    }
+    return true;
+}
+
+#ifdef SOFA_HEADLESSRECORDER_HAVE_EGL
+/// Creates a GL context without any X server. With Mesa, the surfaceless platform renders on the GPU
+/// when there is one and falls back on llvmpipe (software rendering) otherwise.
+static bool createEGLContext(GLsizei width, GLsizei height)
+{
+    EGLDisplay display = EGL_NO_DISPLAY;
+
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (clientExtensions && getPlatformDisplay && std::strstr(clientExtensions, "EGL_MESA_platform_surfaceless"))
+    {
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (display == EGL_NO_DISPLAY)
+    {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    EGLint major = 0, minor = 0;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+    {
+        msg_error("HeadlessRecorder") << "Failed to initialize the EGL display";
+        return false;
+    }
+
+    /* the scene is rendered into a framebuffer object, so the surface type does not matter
+     * and the surfaceless platform may not provide pbuffer configs at all */
+    EGLint config_attribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_DEPTH_SIZE, 16,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint nbConfigs = 0;
+    if (!eglChooseConfig(display, config_attribs, &config, 1, &nbConfigs) || nbConfigs < 1)
+    {
+        config_attribs[1] = EGL_DONT_CARE;
+        if (!eglChooseConfig(display, config_attribs, &config, 1, &nbConfigs) || nbConfigs < 1)
+        {
+            msg_error("HeadlessRecorder") << "Failed to get an EGL config";
+            return false;
+        }
+    }
+
+    /* a compatibility context is required by the fixed pipeline drawing of the visual models */
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        msg_error("HeadlessRecorder") << "Missing support for desktop OpenGL in EGL";
+        return false;
+    }
+    EGLContext ctx = eglCreateContext(display, config, EGL_NO_CONTEXT, nullptr);
+    if (ctx == EGL_NO_CONTEXT)
+    {
+        msg_error("HeadlessRecorder") << "Failed to create opengl context";
+        return false;
+    }
+
+    const EGLint pbuffer_attribs[] = {
+        EGL_WIDTH, width,
+        EGL_HEIGHT, height,
+        EGL_NONE
+    };
+    EGLSurface surface = eglCreatePbufferSurface(display, config, pbuffer_attribs);
+
+    /* without pbuffer, rely on EGL_KHR_surfaceless_context */
+    if (!eglMakeCurrent(display, surface, surface, ctx))
+    {
+        msg_error("HeadlessRecorder") << "Failed to make current";
+        return false;
+    }
+
+    msg_info("HeadlessRecorder") << "Rendering with EGL " << major << "." << minor << " on " << glGetString(GL_RENDERER);
+    return true;
+}
+#endif
+
 void static_handler(int /*signum*/)
 {
     HeadlessRecorder::recordUntilStopAnimate = false;
@@ -71,6 +227,7 @@ void static_handler(int /*signum*/)
 HeadlessRecorder::HeadlessRecorder()
     : groot(nullptr)
     , m_nFrames(0)
+    , m_nSteps(0)
     , initTexturesDone(false)
     , initVideoRecorder(true)
 {
@@ -83,6 +240,7 @@ HeadlessRecorder::HeadlessRecorder()
 
 HeadlessRecorder::~HeadlessRecorder()
 {
+    m_frameRecorder.finish();
     glDeleteFramebuffers(1, &fbo);
     glDeleteRenderbuffers(1, &rbo_color);
     glDeleteRenderbuffers(1, &rbo_depth);
@@ -132,6 +290,14 @@ int HeadlessRecorder::RegisterGUIParameters(ArgumentParser* argumentParser)
                                 "recordUntilEndAnimate", "(only HeadLessRecorder) recording until the end of animation does not care how many seconds have been set");
     argumentParser->addArgument(boost::program_options::value<std::string>(&recordTypeRaw)->default_value("wallclocktime"),
                                 "recordingmode", "(only HeadLessRecorder) define how the recording should be made; either \"simulationtime\" (records as if it was simulating in real time and skips frames accordingly), \"wallclocktime\" (records a frame for each time step) or an arbitrary interval time between each frame as a float.");
+    argumentParser->addArgument(boost::program_options::value<unsigned int>(&recordEvery)->default_value(1),
+                                "recordEvery", "(only HeadLessRecorder) in \"wallclocktime\" recording mode, render and record a frame only every N time steps");
+    argumentParser->addArgument(boost::program_options::value<bool>(&asyncRecording)->default_value(true),
+                                "asyncRecording", "(only HeadLessRecorder) read back the frames through pixel buffers and encode them in a separate thread, in parallel with the simulation");
+    argumentParser->addArgument(boost::program_options::value<std::string>(&glContextType)->default_value("auto"),
+                                "glContext", "(only HeadLessRecorder) how the OpenGL context is created; either \"glx\" (requires an X server, possibly virtual like Xvfb), \"egl\" (no X server) or \"auto\" (egl when DISPLAY is not set, if available)");
+    argumentParser->addArgument(boost::program_options::value<bool>(&softwareGL)->default_value(false)->implicit_value(true),
+                                "softwareGL", "(only HeadLessRecorder) force software rendering (Mesa llvmpipe), for machines without GPU");
     return 0;
 }
 
@@ -142,72 +308,62 @@ BaseGUI* HeadlessRecorder::CreateGUI(const char* name, sofa::simulation::Node::S
     SOFA_UNUSED(filename);
     msg_warning("HeadlessRecorder") << "This is an experimental feature. \n\t" << "For any suggestion/help/bug please report to:\n\t" << "https://github.com/sofa-framework/sofa/pull/538";
 
-    int context_attribs[] = {
-        GLX_CONTEXT_MAJOR_VERSION_ARB, 3,
-        GLX_CONTEXT_MINOR_VERSION_ARB, 0,
-        None
-    };
-
-    /* open display */
-    Display* m_display = XOpenDisplay(nullptr);
-    if (!m_display){
-        msg_error("HeadlessRecorder") << "Failed to open display";
-        exit(EXIT_FAILURE);
+    /* Mesa then renders with llvmpipe, even if a GPU is available */
+    if (softwareGL)
+    {
+        setenv("LIBGL_ALWAYS_SOFTWARE", "1", 1);
     }
 
-    /* get framebuffer configs, any is usable (might want to add proper attribs) */
-    int fbcount = 0;
-    GLXFBConfig* fbc = glXChooseFBConfig(m_display, DefaultScreen(m_display), nullptr, &fbcount);
-    if (!fbc){
-        msg_error("HeadlessRecorder") << "Failed to get FBConfig";
-        exit(EXIT_FAILURE);
+    bool contextCreated = false;
+    bool useEGL = false;
+    if (glContextType == "glx")
+    {
+        contextCreated = createGLXContext(width, height);
     }
-
-    /* get the required extensions */
-    glXCreateContextAttribsARB = (glXCreateContextAttribsARBProc)glXGetProcAddressARB( (const GLubyte *) "glXCreateContextAttribsARB");
-    glXMakeContextCurrentARB = (glXMakeContextCurrentARBProc)glXGetProcAddressARB( (const GLubyte *) "glXMakeContextCurrent");
-    if ( !(glXCreateContextAttribsARB && glXMakeContextCurrentARB) ){
-        msg_error("HeadlessRecorder") << "Missing support for GLX_ARB_create_context";
-        XFree(fbc);
-        exit(EXIT_FAILURE);
+#ifdef SOFA_HEADLESSRECORDER_HAVE_EGL
+    else if (glContextType == "egl")
+    {
+        useEGL = true;
+        contextCreated = createEGLContext(width, height);
     }
-
-    /* create a context using glXCreateContextAttribsARB */
-    GLXContext ctx = glXCreateContextAttribsARB(m_display, fbc[0], nullptr, True, context_attribs);
-    if (!ctx){
-        msg_error("HeadlessRecorder") << "Failed to create opengl context";
-        XFree(fbc);
-        exit(EXIT_FAILURE);
+    else if (glContextType == "auto")
+    {
+        /* GLX when there is an X server, EGL otherwise */
+        const char* xDisplay = std::getenv("DISPLAY");
+        useEGL = (xDisplay == nullptr || xDisplay[0] == '\0');
+        contextCreated = useEGL ? createEGLContext(width, height) : createGLXContext(width, height);
     }
-
-    /* create temporary pbuffer */
-    int pbuffer_attribs[] = {
-        GLX_PBUFFER_WIDTH, width,
-        GLX_PBUFFER_HEIGHT, height,
-        None
-    };
-    GLXPbuffer pbuf = glXCreatePbuffer(m_display, fbc[0], pbuffer_attribs);
-
-    XFree(fbc);
-    XSync(m_display, False);
-
-    /* try to make it the current context */
-    if ( !glXMakeContextCurrent(m_display, pbuf, pbuf, ctx) ){
-        /* some drivers does not support context without default framebuffer, so fallback on
-                    * using the default window.
-                    */
-        if ( !glXMakeContextCurrent(m_display, DefaultRootWindow(m_display), DefaultRootWindow(m_display), ctx) ){
-            msg_error("HeadlessRecorder") << "Failed to make current";
-            exit(EXIT_FAILURE);
-        }
+#else
+    else if (glContextType == "auto")
+    {
+        contextCreated = createGLXContext(width, height);
+    }
+#endif
+    else
+    {
+        msg_error("HeadlessRecorder") << "Unsupported GL context \"" << glContextType << "\"";
+    }
+    if (!contextCreated)
+    {
+        exit(EXIT_FAILURE);
     }
 
     GLenum err = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    /* GLEW built for GLX loads the GL entry points but fails on the GLX ones without X display */
+    if (useEGL && err == GLEW_ERROR_NO_GLX_DISPLAY)
+    {
+        err = GLEW_OK;
+    }
+#endif
     if (GLEW_OK != err)
     {
         msg_error("HeadlessRecorder") << "GLEW Error: " << glewGetErrorString(err);
         exit(EXIT_FAILURE);
     }
+#ifndef GLEW_ERROR_NO_GLX_DISPLAY
+    SOFA_UNUSED(useEGL);
+#endif
 
     HeadlessRecorder* gui = new HeadlessRecorder();
     //gui->setScene(groot, filename);
@@ -359,15 +515,13 @@ int HeadlessRecorder::mainLoop()
         if (currentSimulation()) // && currentSimulation()->getContext()->getAnimate())
         {
             step();
-            GLint viewport[4];
-            glGetIntegerv(GL_VIEWPORT, viewport);
-            std::cout <<"vport " << viewport[0] << " "<< viewport[1] << " "<< viewport[2] << " "<< viewport[3] << std::endl;
         }
         else
         {
             std::this_thread::sleep_for(std::chrono::seconds(10));
         }
     }
+    finishRecording();
     msg_info("HeadlessRecorder") << "Recording time: " << recordTimeInSeconds << " seconds at: " << fps << " fps.";
     return 0;
 }
@@ -377,7 +531,7 @@ bool HeadlessRecorder::keepFrame()
     switch(recordType)
     {
         case RecordMode::wallclocktime :
-            return true;
+            return m_nSteps % std::max(recordEvery, 1u) == 0;
         case RecordMode::simulationtime :
         case RecordMode::timeinterval :
             return groot->getTime() >= m_nFrames * skipTime;
@@ -515,7 +669,7 @@ void HeadlessRecorder::step()
     getSimulation()->animate(groot.get());
     sofa::helper::AdvancedTimer::end("Animate");
     getSimulation()->updateVisual(groot.get());
-    redraw();
+    ++m_nSteps;
 }
 
 void HeadlessRecorder::resetView()
@@ -599,42 +753,106 @@ void HeadlessRecorder::setViewerResolution(int width, int height)
 // -----------------------------------------------------------------
 void HeadlessRecorder::record()
 {
+    if (saveAsVideo && !saveAsScreenShot && initVideoRecorder)
+    {
+        startVideo();
+        initVideoRecorder = false;
+    }
 
-    if (saveAsScreenShot)
+    if (asyncRecording)
+    {
+        if (!m_frameRecorder.isActive())
+        {
+            startAsyncRecording();
+        }
+        m_frameRecorder.capture(m_nFrames);
+    }
+    else if (saveAsScreenShot)
     {
         std::string pngFilename = fileName + std::to_string(m_nFrames) + ".png" ;
         m_screencapture.saveScreen(pngFilename, 0);
     } else if (saveAsVideo)
     {
-        if (initVideoRecorder)
+        //m_videorecorder->encodeFrame();
+        m_videorecorder.addFrame();
+    }
+}
+
+void HeadlessRecorder::startVideo()
+{
+    std::string ffmpeg_exec_path = "";
+    const std::string ffmpegIniFilePath = Utils::getSofaPathTo("etc/SofaHeadlessRecorder.ini");
+    std::map<std::string, std::string> iniFileValues = Utils::readBasicIniFile(ffmpegIniFilePath);
+    if (iniFileValues.find("FFMPEG_EXEC_PATH") != iniFileValues.end())
+    {
+        // get absolute path of FFMPEG executable
+        ffmpeg_exec_path = SetDirectory::GetRelativeFromProcess( iniFileValues["FFMPEG_EXEC_PATH"].c_str() );
+    }
+
+    std::string videoFilename = fileName;
+    int bitrate = 100000000;
+    videoFilename.append(".avi");
+    //videoFilename.append(".mp4");
+    //m_videorecorder = std::unique_ptr<VideoRecorderFFmpeg>(new VideoRecorderFFmpeg(fps, width, height, videoFilename.c_str(), AV_CODEC_ID_H264));
+    //std::string codec = "yuv420p";
+    std::string codec = "yuv444p";
+    m_videorecorder.init(ffmpeg_exec_path, videoFilename, width, height, fps, bitrate, codec);
+    //m_videorecorder->start();
+}
+
+void HeadlessRecorder::startAsyncRecording()
+{
+    // Three pixel buffers give the GPU two frames to complete the readback before the pixels are mapped,
+    // and the writer thread may lag a few frames behind before the simulation waits for it.
+    const unsigned int nbPixelBuffers = 3;
+    const unsigned int maxPendingFrames = 4;
+
+    if (saveAsScreenShot)
+    {
+        m_frameRecorder.init(width, height, GL_RGB, nbPixelBuffers, maxPendingFrames,
+                             [this](unsigned int frameIndex, const AsyncFrameRecorder::Frame& pixels)
         {
-            std::string ffmpeg_exec_path = "";
-            const std::string ffmpegIniFilePath = Utils::getSofaPathTo("etc/SofaHeadlessRecorder.ini");
-            std::map<std::string, std::string> iniFileValues = Utils::readBasicIniFile(ffmpegIniFilePath);
-            if (iniFileValues.find("FFMPEG_EXEC_PATH") != iniFileValues.end())
-            {
-                // get absolute path of FFMPEG executable
-                ffmpeg_exec_path = SetDirectory::GetRelativeFromProcess( iniFileValues["FFMPEG_EXEC_PATH"].c_str() );
-            }
+            savePicture(frameIndex, pixels);
+        });
+    }
+    else
+    {
+        m_frameRecorder.init(width, height, GL_RGBA, nbPixelBuffers, maxPendingFrames,
+                             [this](unsigned int /*frameIndex*/, const AsyncFrameRecorder::Frame& pixels)
+        {
+            m_videorecorder.addFrame(pixels.data());
+        });
+    }
+}
 
-            std::string videoFilename = fileName;
-            int bitrate = 100000000;
-            videoFilename.append(".avi");
-            //videoFilename.append(".mp4");
-            //m_videorecorder = std::unique_ptr<VideoRecorderFFmpeg>(new VideoRecorderFFmpeg(fps, width, height, videoFilename.c_str(), AV_CODEC_ID_H264));
-            //std::string codec = "yuv420p";
-            std::string codec = "yuv444p";
-            m_videorecorder.init(ffmpeg_exec_path, videoFilename, width, height, fps, bitrate, codec);
-            //m_videorecorder->start();
-            initVideoRecorder = false;
-        }
-        if (canRecord()) {
-            //m_videorecorder->encodeFrame();
-            m_videorecorder.addFrame();
-        } else {
-            //m_videorecorder->stop();
-            m_videorecorder.finishVideo();
-        }
+void HeadlessRecorder::savePicture(unsigned int frameIndex, const AsyncFrameRecorder::Frame& pixels) const
+{
+    const std::string pngFilename = fileName + std::to_string(frameIndex) + ".png";
+
+    std::unique_ptr<sofa::helper::io::Image> img(sofa::helper::io::Image::FactoryImage::getInstance()->createObject("png", ""));
+    if (!img)
+    {
+        msg_error("HeadlessRecorder") << "Could not write png image format (no support found)";
+        return;
+    }
+    img->init(width, height, 1, 1, sofa::helper::io::Image::UNORM8, sofa::helper::io::Image::RGB);
+    std::memcpy(img->getPixels(), pixels.data(), pixels.size());
+    if (!img->save(pngFilename, 0))
+    {
+        msg_error("HeadlessRecorder") << "Unknown error while saving screen image to " << pngFilename;
+    }
+}
+
+void HeadlessRecorder::finishRecording()
+{
+    // All the frames must be written before closing the video
+    m_frameRecorder.finish();
+
+    if (saveAsVideo && !saveAsScreenShot && !initVideoRecorder)
+    {
+        //m_videorecorder->stop();
+        m_videorecorder.finishVideo();
+        initVideoRecorder = true;
     }
 }
 
@@ -50,6 +50,8 @@
 #include <sofa/helper/gl/VideoRecorderFFMPEG.h>
 #include <sofa/helper/gl/Capture.h>
 
+#include "AsyncFrameRecorder.h"
+
 namespace sofa
 {
 
@@ -99,6 +101,10 @@ public:
 
 private:
     void record();
+    void startVideo();
+    void startAsyncRecording();
+    void finishRecording();
+    void savePicture(unsigned int frameIndex, const AsyncFrameRecorder::Frame& pixels) const;
     bool canRecord();
     bool keepFrame();
 
@@ -115,6 +121,8 @@ private:
 
     sofa::helper::gl::VideoRecorderFFMPEG m_videorecorder;
     int m_nFrames;
+    unsigned int m_nSteps;
+    AsyncFrameRecorder m_frameRecorder;
 
     GLuint fbo;
     GLuint rbo_color, rbo_depth;
@@ -132,6 +140,10 @@ private:
     static std::string recordTypeRaw;
     static RecordMode recordType;
     static float skipTime;
+    static unsigned int recordEvery;
+    static bool asyncRecording;
+    static std::string glContextType;
+    static bool softwareGL;
 };
 
 } // namespace hRecorder
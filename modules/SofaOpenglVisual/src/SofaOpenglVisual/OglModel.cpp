@@ -29,6 +29,7 @@
 #include <sofa/core/ObjectFactory.h>
 #include <sofa/core/topology/BaseMeshTopology.h>
 #include <cstring>
+#include <algorithm>
 #include <sofa/helper/types/RGBAColor.h>
 
 //#define DEBUG_DRAW
@@ -68,11 +69,16 @@ OglModel::OglModel()
     , blendEquation( initData(&blendEquation, "blendEquation", "if alpha blending is enabled this specifies how source and destination colors are combined") )
     , sourceFactor( initData(&sourceFactor, "sfactor", "if alpha blending is enabled this specifies how the red, green, blue, and alpha source blending factors are computed") )
     , destFactor( initData(&destFactor, "dfactor", "if alpha blending is enabled this specifies how the red, green, blue, and alpha destination blending factors are computed") )
+    , d_streamingBuffers( initData(&d_streamingBuffers, false, "streamingBuffers", "Upload positions and normals through persistently mapped, triple-buffered buffers synchronized with fences (requires GL_ARB_buffer_storage), for large deforming meshes") )
+    , d_interleavedAttributes( initData(&d_interleavedAttributes, false, "interleavedAttributes", "With streamingBuffers, store the position and normal of each vertex contiguously") )
     , tex(nullptr)
     , vbo(0), iboEdges(0), iboTriangles(0), iboQuads(0)
     , VBOGenDone(false), initDone(false), useEdges(false), useTriangles(false), useQuads(false), canUsePatches(false)
     , oldVerticesSize(0), oldNormalsSize(0), oldTexCoordsSize(0), oldTangentsSize(0), oldBitangentsSize(0), oldEdgesSize(0), oldTrianglesSize(0), oldQuadsSize(0)
+    , useStreaming(false), streamVbo(0), streamMapping(nullptr), streamRegionSize(0), streamNbVertices(0), streamRegion(0)
 {
+    for (GLsync& fence : streamFences)
+        fence = nullptr;
 
     textures.clear();
 
@@ -127,6 +133,7 @@ OglModel::~OglModel()
     {
         glDeleteBuffers(1,&iboQuads);
     }
+    deleteStreamBuffer();
 
 }
 
@@ -152,7 +159,6 @@ void OglModel::drawGroup(int ig, bool transparent)
     const Inherit::VecVisualQuad& quads = this->getQuads();
 
     const VecCoord& vertices = this->getVertices();
-    const VecDeriv& vnormals = this->getVnormals();
 
     FaceGroup g;
     if (ig < 0)
@@ -191,9 +197,7 @@ void OglModel::drawGroup(int ig, bool transparent)
         glEnable(GL_TEXTURE_2D);
 
         glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	    uintptr_t pt = (vertices.size()*sizeof(vertices[0]))
-                    + (vnormals.size()*sizeof(vnormals[0]));
-        glTexCoordPointer(2, GL_FLOAT, 0, reinterpret_cast<void*>(pt));
+        glTexCoordPointer(2, GL_FLOAT, 0, reinterpret_cast<void*>(getTexCoordsOffset()));
         glBindBuffer(GL_ARRAY_BUFFER, 0);
         glEnableClientState(GL_TEXTURE_COORD_ARRAY);
     }
@@ -387,16 +391,21 @@ void OglModel::internalDraw(const core::visual::VisualParams* vparams, bool tran
     /// Force the data to be of float type before sending to opengl...
     GLuint datatype = GL_FLOAT;
     GLuint vertexdatasize = sizeof(verticesTmpBuffer[0]);
-    GLuint normaldatasize = sizeof(normalsTmpBuffer[0]);
 
     GLulong vertexArrayByteSize = vertices.size() * vertexdatasize;
-    GLulong normalArrayByteSize = vnormals.size() * normaldatasize;
 
     //// Update the vertex buffers.
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glVertexPointer(3, datatype, 0, nullptr);
-    glNormalPointer(datatype, 0, reinterpret_cast<void*>(vertexArrayByteSize));
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if (useStreaming)
+    {
+        bindStreamBuffer();
+    }
+    else
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glVertexPointer(3, datatype, 0, nullptr);
+        glNormalPointer(datatype, 0, reinterpret_cast<void*>(vertexArrayByteSize));
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
 
 
     glEnableClientState(GL_NORMAL_ARRAY);
@@ -411,8 +420,9 @@ void OglModel::internalDraw(const core::visual::VisualParams* vparams, bool tran
         }
 
         size_t textureArrayByteSize = vtexcoords.size()*sizeof(vtexcoords[0]);
+        const GLulong texCoordsOffset = getTexCoordsOffset();
         glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glTexCoordPointer(2, GL_FLOAT, 0, reinterpret_cast<void*>(vertexArrayByteSize + normalArrayByteSize ));
+        glTexCoordPointer(2, GL_FLOAT, 0, reinterpret_cast<void*>(texCoordsOffset));
         glBindBuffer(GL_ARRAY_BUFFER, 0);
 
         glEnableClientState(GL_TEXTURE_COORD_ARRAY);
@@ -426,7 +436,7 @@ void OglModel::internalDraw(const core::visual::VisualParams* vparams, bool tran
 
             glBindBuffer(GL_ARRAY_BUFFER, vbo);
             glTexCoordPointer(3, GL_FLOAT, 0,
-                              reinterpret_cast<void*>(vertexArrayByteSize + normalArrayByteSize + textureArrayByteSize));
+                              reinterpret_cast<void*>(texCoordsOffset + textureArrayByteSize));
             glBindBuffer(GL_ARRAY_BUFFER, 0);
 
             glClientActiveTexture(GL_TEXTURE2);
@@ -434,8 +444,7 @@ void OglModel::internalDraw(const core::visual::VisualParams* vparams, bool tran
 
             glBindBuffer(GL_ARRAY_BUFFER, vbo);
             glTexCoordPointer(3, GL_FLOAT, 0,
-                              reinterpret_cast<void*>(vertexArrayByteSize + normalArrayByteSize
-                              + textureArrayByteSize + tangentArrayByteSize));
+                              reinterpret_cast<void*>(texCoordsOffset + textureArrayByteSize + tangentArrayByteSize));
             glBindBuffer(GL_ARRAY_BUFFER, 0);
 
             glClientActiveTexture(GL_TEXTURE0);
@@ -505,6 +514,15 @@ void OglModel::internalDraw(const core::visual::VisualParams* vparams, bool tran
 
     drawGroups(transparent);
 
+    if (useStreaming)
+    {
+        // the region can be written again once the GPU is done with these draws
+        GLsync& fence = streamFences[streamRegion];
+        if (fence)
+            glDeleteSync(fence);
+        fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
     if (lineSmooth.getValue())
     {
         glDisable(GL_LINE_SMOOTH);
@@ -695,6 +713,14 @@ void OglModel::initVisual()
 
     canUsePatches = (glewIsSupported("GL_ARB_tessellation_shader")!=0);
 
+    useStreaming = false;
+    if (d_streamingBuffers.getValue())
+    {
+        useStreaming = (glewIsSupported("GL_ARB_buffer_storage GL_ARB_sync")!=0);
+        if (!useStreaming)
+            msg_warning() << "GL_ARB_buffer_storage not supported by your graphics card and/or OpenGL driver, streamingBuffers is ignored." ;
+    }
+
     if (primitiveType.getValue().getSelectedId() == 2 && !canUsePatches)
     {
         msg_warning() << "GL_ARB_tessellation_shader not supported by your graphics card and/or OpenGL driver." ;
@@ -781,6 +807,14 @@ void OglModel::initVertexBuffer()
     positionsBufferSize = (vertices.size()*sizeof(Vec3f));
     normalsBufferSize = (vnormals.size()*sizeof(Vec3f));
 
+    if (useStreaming)
+        createStreamBuffer();
+    if (useStreaming)
+    {
+        // positions and normals are stored in streamVbo
+        positionsBufferSize = normalsBufferSize = 0;
+    }
+
     if (tex || putOnlyTexCoords.getValue() || !textures.empty())
     {
         textureCoordsBufferSize = vtexcoords.size() * sizeof(vtexcoords[0]);
@@ -849,25 +883,31 @@ void OglModel::updateVertexBuffer()
     const VecCoord& vbitangents= this->getVbitangents();
     bool hasTangents = vtangents.size() && vbitangents.size();
 
-    size_t positionsBufferSize, normalsBufferSize;
+    size_t positionsBufferSize = 0, normalsBufferSize = 0;
     size_t textureCoordsBufferSize = 0, tangentsBufferSize = 0, bitangentsBufferSize = 0;
+    const void* positionBuffer = nullptr;
+    const void* normalBuffer = nullptr;
 
-    positionsBufferSize = (vertices.size()*sizeof(vertices[0]));
-    normalsBufferSize = (vnormals.size()*sizeof(vnormals[0]));
-    const void* positionBuffer = vertices.data();
-    const void* normalBuffer = vnormals.data();
-
-
-    verticesTmpBuffer.resize( vertices.size() );
-    normalsTmpBuffer.resize( vnormals.size() );
+    if (useStreaming)
+    {
+        updateStreamBuffer();
+        // the stream buffer could not be mapped again and the vertex buffer was rebuilt
+        if (!useStreaming)
+            return;
+    }
+    else
+    {
+        verticesTmpBuffer.resize( vertices.size() );
+        normalsTmpBuffer.resize( vnormals.size() );
 
-    copyVector(vertices, verticesTmpBuffer);
-    copyVector(vnormals, normalsTmpBuffer);
+        copyVector(vertices, verticesTmpBuffer);
+        copyVector(vnormals, normalsTmpBuffer);
 
-    positionsBufferSize = (vertices.size()*sizeof(Vec3f));
-    normalsBufferSize = (vnormals.size()*sizeof(Vec3f));
-    positionBuffer = verticesTmpBuffer.data();
-    normalBuffer = normalsTmpBuffer.data();
+        positionsBufferSize = (vertices.size()*sizeof(Vec3f));
+        normalsBufferSize = (vnormals.size()*sizeof(Vec3f));
+        positionBuffer = verticesTmpBuffer.data();
+        normalBuffer = normalsTmpBuffer.data();
+    }
 
     if (tex || putOnlyTexCoords.getValue() || !textures.empty())
     {
@@ -881,17 +921,20 @@ void OglModel::updateVertexBuffer()
     }
 
     glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    //Positions
-    glBufferSubData(GL_ARRAY_BUFFER,
-                    0,
-                    positionsBufferSize,
-                    positionBuffer);
-
-    //Normals
-    glBufferSubData(GL_ARRAY_BUFFER,
-                    positionsBufferSize,
-                    normalsBufferSize,
-                    normalBuffer);
+    if (!useStreaming)
+    {
+        //Positions
+        glBufferSubData(GL_ARRAY_BUFFER,
+                        0,
+                        positionsBufferSize,
+                        positionBuffer);
+
+        //Normals
+        glBufferSubData(GL_ARRAY_BUFFER,
+                        positionsBufferSize,
+                        normalsBufferSize,
+                        normalBuffer);
+    }
 
     //Texture coords
     if(tex || putOnlyTexCoords.getValue() ||!textures.empty())
@@ -918,6 +961,133 @@ void OglModel::updateVertexBuffer()
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
+GLulong OglModel::getTexCoordsOffset() const
+{
+    if (useStreaming)
+        return 0;
+    return GLulong(getVertices().size() + getVnormals().size()) * sizeof(Vec3f);
+}
+
+void OglModel::createStreamBuffer()
+{
+    deleteStreamBuffer();
+
+    streamNbVertices = std::max(getVertices().size(), getVnormals().size());
+    // keep each region aligned for the vertex fetch
+    streamRegionSize = GLsizeiptr((streamNbVertices * 2 * sizeof(Vec3f) + 255) & ~size_t(255));
+    if (streamRegionSize == 0)
+        return;
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &streamVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, streamVbo);
+    glBufferStorage(GL_ARRAY_BUFFER, streamRegionSize * NB_STREAM_REGIONS, nullptr, flags);
+    streamMapping = static_cast<GLubyte*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, streamRegionSize * NB_STREAM_REGIONS, flags));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (!streamMapping)
+    {
+        msg_warning() << "Failed to map the streamed vertex buffer, streamingBuffers is disabled." ;
+        deleteStreamBuffer();
+        useStreaming = false;
+    }
+    streamRegion = 0;
+}
+
+void OglModel::deleteStreamBuffer()
+{
+    for (GLsync& fence : streamFences)
+    {
+        if (fence)
+            glDeleteSync(fence);
+        fence = nullptr;
+    }
+    if (streamVbo > 0)
+    {
+        if (streamMapping)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, streamVbo);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+        glDeleteBuffers(1, &streamVbo);
+    }
+    streamVbo = 0;
+    streamMapping = nullptr;
+    streamRegionSize = 0;
+    streamNbVertices = 0;
+}
+
+void OglModel::updateStreamBuffer()
+{
+    const VecCoord& vertices = this->getVertices();
+    const VecDeriv& vnormals = this->getVnormals();
+
+    if (std::max(vertices.size(), vnormals.size()) > streamNbVertices)
+    {
+        createStreamBuffer();
+        // the positions and normals are stored in vbo again: it must be resized, and the
+        // texture coordinates moved after them (see getTexCoordsOffset)
+        if (!useStreaming)
+        {
+            initVertexBuffer();
+            return;
+        }
+    }
+    if (!streamMapping)
+        return;
+
+    // write the region least recently read by the GPU
+    streamRegion = (streamRegion + 1) % NB_STREAM_REGIONS;
+    GLsync& fence = streamFences[streamRegion];
+    if (fence)
+    {
+        GLenum status = glClientWaitSync(fence, 0, 0);
+        while (status == GL_TIMEOUT_EXPIRED)
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    Vec3f* region = reinterpret_cast<Vec3f*>(streamMapping + streamRegion * streamRegionSize);
+    const size_t nbVertices = vertices.size();
+    if (d_interleavedAttributes.getValue())
+    {
+        for (size_t i = 0; i < nbVertices; ++i)
+        {
+            region[2*i].set(vertices[i]);
+            if (i < vnormals.size())
+                region[2*i+1].set(vnormals[i]);
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < nbVertices; ++i)
+            region[i].set(vertices[i]);
+        Vec3f* normals = region + nbVertices;
+        for (size_t i = 0; i < vnormals.size(); ++i)
+            normals[i].set(vnormals[i]);
+    }
+}
+
+void OglModel::bindStreamBuffer()
+{
+    const size_t nbVertices = getVertices().size();
+    const GLulong regionOffset = GLulong(streamRegion * streamRegionSize);
+    glBindBuffer(GL_ARRAY_BUFFER, streamVbo);
+    if (d_interleavedAttributes.getValue())
+    {
+        glVertexPointer(3, GL_FLOAT, 2*sizeof(Vec3f), reinterpret_cast<void*>(regionOffset));
+        glNormalPointer(GL_FLOAT, 2*sizeof(Vec3f), reinterpret_cast<void*>(regionOffset + sizeof(Vec3f)));
+    }
+    else
+    {
+        glVertexPointer(3, GL_FLOAT, 0, reinterpret_cast<void*>(regionOffset));
+        glNormalPointer(GL_FLOAT, 0, reinterpret_cast<void*>(regionOffset + nbVertices * sizeof(Vec3f)));
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
 void OglModel::updateEdgesIndicesBuffer()
 {
     const VecVisualEdge& edges = this->getEdges();
@@ -83,6 +83,9 @@ protected:
     Data<sofa::helper::OptionsGroup> destFactor; ///< if alpha blending is enabled this specifies how the red, green, blue, and alpha destination blending factors are computed
     GLenum blendEq, sfactor, dfactor;
 
+    Data<bool> d_streamingBuffers; ///< Upload positions and normals through persistently mapped, triple-buffered buffers (requires GL_ARB_buffer_storage)
+    Data<bool> d_interleavedAttributes; ///< With streamingBuffers, store the position and normal of each vertex contiguously
+
     helper::gl::Texture *tex; //this texture is used only if a texture name is specified in the scn
     GLuint vbo, iboEdges, iboTriangles, iboQuads;
     bool VBOGenDone, initDone, useEdges, useTriangles, useQuads, canUsePatches;
@@ -93,6 +96,33 @@ protected:
     std::vector<sofa::defaulttype::Vec3f> verticesTmpBuffer;
     std::vector<sofa::defaulttype::Vec3f> normalsTmpBuffer;
 
+    /// @name Streaming of positions and normals
+    /// With streamingBuffers, positions and normals are converted to float directly into a persistently
+    /// mapped buffer split in several regions. Each update writes the next region, after waiting for the
+    /// fence set by the last draw reading it, so that the GPU never waits for the upload.
+    /// The other attributes stay in vbo.
+    /// @{
+    enum { NB_STREAM_REGIONS = 3 };
+    bool useStreaming;
+    GLuint streamVbo;
+    GLubyte* streamMapping; ///< persistent mapping of the whole streamVbo
+    GLsizeiptr streamRegionSize; ///< size of each region, in bytes
+    size_t streamNbVertices; ///< number of vertices each region can hold
+    unsigned int streamRegion; ///< region written by the last update, read by the next draws
+    GLsync streamFences[NB_STREAM_REGIONS]; ///< set after the draws reading each region
+
+    void createStreamBuffer();
+    void deleteStreamBuffer();
+    /// Write the positions and normals in the next region of the streamed buffer.
+    /// If the buffer cannot be mapped again, the streaming is disabled and vbo is rebuilt.
+    void updateStreamBuffer();
+    /// Set the vertex and normal arrays to the current region of the streamed buffer
+    void bindStreamBuffer();
+    /// @}
+
+    /// Offset of the texture coordinates in vbo
+    GLulong getTexCoordsOffset() const;
+
     void internalDraw(const core::visual::VisualParams* vparams, bool transparent) override;
 
     void drawGroup(int ig, bool transparent);